@@ -4,27 +4,15 @@
 #
 #-------------------------------------------------
 
-QT       += core gui
-
-greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
-
-TARGET = IA
-TEMPLATE = app
-
-INCLUDEPATH = ./include
-
-SOURCES += src/main.cpp\
-        src/mainwindow.cpp \
-    src/celda.cpp \
-    src/cortadora.cpp
-
-HEADERS  += include/mainwindow.h \
-    include/celda.h \
-    include/cortadora.h
-
-FORMS    += mainwindow.ui
-
-RESOURCES += \
-    Recursos.qrc
-
-#CONFIG += release
+# El proyecto se divide en tres partes: el núcleo, una biblioteca estática
+# con el modelo del jardín, los ficheros y los planificadores que sólo usa
+# QtCore; la interfaz gráfica, y las herramientas de consola, que enlazan con
+# el núcleo sin necesitar pantalla.
+TEMPLATE = subdirs
+
+SUBDIRS = core \
+    app \
+    tools
+
+app.depends = core
+tools.depends = core
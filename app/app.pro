@@ -0,0 +1,31 @@
+# Interfaz gráfica del simulador.
+
+QT       += core gui
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets concurrent
+
+TARGET = IA
+TEMPLATE = app
+
+INCLUDEPATH = ../include
+
+NUCLEO = $$OUT_PWD/../core
+include(../core/nucleo.pri)
+
+SOURCES += ../src/main.cpp\
+        ../src/mainwindow.cpp \
+    ../src/celda.cpp \
+    ../src/cortadora.cpp \
+    ../src/imagen_qt.cpp
+
+HEADERS  += ../include/mainwindow.h \
+    ../include/celda.h \
+    ../include/cortadora.h \
+    ../include/imagen_qt.h
+
+FORMS    += ../mainwindow.ui
+
+RESOURCES += \
+    ../Recursos.qrc
+
+#CONFIG += release
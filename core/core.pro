@@ -0,0 +1,79 @@
+# Biblioteca estática con todo lo que no depende de la interfaz.
+
+QT       += core
+QT       -= gui
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += concurrent
+
+TARGET = nucleo
+TEMPLATE = lib
+CONFIG += staticlib
+
+INCLUDEPATH = ../include
+
+SOURCES += ../src/anytime.cpp \
+    ../src/archivo.cpp \
+    ../src/barrido.cpp \
+    ../src/comparativa.cpp \
+    ../src/consultas.cpp \
+    ../src/dinamico.cpp \
+    ../src/estres.cpp \
+    ../src/exploracion.cpp \
+    ../src/generador.cpp \
+    ../src/giros.cpp \
+    ../src/historial.cpp \
+    ../src/imagen.cpp \
+    ../src/jardin.cpp \
+    ../src/mapabits.cpp \
+    ../src/multiagente.cpp \
+    ../src/planificadores.cpp \
+    ../src/plato.cpp \
+    ../src/ponderado.cpp \
+    ../src/reanudable.cpp \
+    ../src/reservas.cpp \
+    ../src/servicio.cpp \
+    ../src/telemetria.cpp \
+    ../src/temporada.cpp \
+    ../src/ruta.cpp \
+    ../src/trazo.cpp \
+    ../src/visitas.cpp
+
+HEADERS += ../include/aleatorio.h \
+    ../include/anytime.h \
+    ../include/archivo.h \
+    ../include/barrido.h \
+    ../include/comparativa.h \
+    ../include/consultas.h \
+    ../include/dinamico.h \
+    ../include/estres.h \
+    ../include/exploracion.h \
+    ../include/generador.h \
+    ../include/giros.h \
+    ../include/historial.h \
+    ../include/imagen.h \
+    ../include/jardin.h \
+    ../include/mapabits.h \
+    ../include/multiagente.h \
+    ../include/planificadores.h \
+    ../include/plato.h \
+    ../include/ponderado.h \
+    ../include/reanudable.h \
+    ../include/reservas.h \
+    ../include/servicio.h \
+    ../include/telemetria.h \
+    ../include/temporada.h \
+    ../include/ruta.h \
+    ../include/tipos.h \
+    ../include/trazo.h \
+    ../include/visitas.h
+
+# Identificador de la compilación que se guarda en el historial de las
+# pruebas. Fuera de un repositorio de git se usa la fecha de compilación.
+COMPILACION = $$system(git -C $$PWD describe --always --dirty)
+!isEmpty(COMPILACION): DEFINES += IA_COMPILACION=\\\"$$COMPILACION\\\"
+
+#CONFIG += release
+
+# Las búsquedas sobre mapas de bits usan AVX2 si se compila con soporte para
+# estas instrucciones.
+#QMAKE_CXXFLAGS += -mavx2
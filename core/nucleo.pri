@@ -0,0 +1,13 @@
+# Enlace con la biblioteca del núcleo. Antes de incluir este fichero hay que
+# poner en NUCLEO la carpeta en la que se compila core.
+
+INCLUDEPATH += $$PWD/../include
+DEPENDPATH += $$PWD/../include
+
+win32:CONFIG(release, debug|release): NUCLEO = $$NUCLEO/release
+else:win32:CONFIG(debug, debug|release): NUCLEO = $$NUCLEO/debug
+
+LIBS += -L$$NUCLEO -lnucleo
+
+win32-g++|!win32: PRE_TARGETDEPS += $$NUCLEO/libnucleo.a
+else: PRE_TARGETDEPS += $$NUCLEO/nucleo.lib
@@ -0,0 +1,30 @@
+#ifndef ALEATORIO_H
+#define ALEATORIO_H
+
+// Generador de números pseudoaleatorios con semilla propia (xorshift32). A
+// diferencia de rand(), cada objeto tiene su propio estado, da la misma
+// secuencia en cualquier plataforma y se puede usar desde varios hilos a la
+// vez siempre que cada hilo tenga su propio generador.
+class Aleatorio {
+public:
+  explicit Aleatorio(unsigned semilla = 1): estado(semilla? semilla : 0x9E3779B9u) {}
+
+  // Devuelve el siguiente número de la secuencia.
+  unsigned siguiente(){
+    estado ^= estado << 13;
+    estado ^= estado >> 17;
+    estado ^= estado << 5;
+    return estado;
+  }
+
+  // Número entero entre 0 y n-1.
+  int entero(int n){ return n > 0? static_cast<int>(siguiente() % n) : 0; }
+
+  // Devuelve true con la probabilidad indicada en tanto por ciento.
+  bool porcentaje(int p){ return entero(100) < p; }
+
+private:
+  unsigned estado;
+};
+
+#endif // ALEATORIO_H
@@ -0,0 +1,120 @@
+#ifndef ANYTIME_H
+#define ANYTIME_H
+
+#include <vector>
+
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QObject>
+
+#include "jardin.h"
+
+// Una de las soluciones que va devolviendo el planificador anytime. La cota
+// indica cuántas veces más caro que el óptimo puede ser, como mucho, el
+// camino encontrado; con cota 1 el camino es óptimo.
+struct SolucionAnytime {
+  SolucionAnytime(): coste(-1), inflacion(0), cota(0), expandidas(0), tiempo_us(0) {}
+
+  bool valida() const { return coste >= 0; }
+
+  std::vector<Movimientos> movimientos;
+  int coste;          // -1 si todavía no hay camino
+  double inflacion;   // Peso de la heurística con el que se encontró
+  double cota;        // Cota de subóptimo del camino
+  int expandidas;     // Celdas expandidas desde el principio de la búsqueda
+  qint64 tiempo_us;   // Tiempo desde el principio de la búsqueda
+};
+
+// ARA*: una serie de búsquedas A* con la heurística multiplicada por un peso
+// que va bajando hasta 1. Cada búsqueda reutiliza lo que calculó la anterior,
+// así que se obtiene enseguida un primer camino y luego se va mejorando. El
+// trabajo se puede interrumpir en cualquier momento y retomarse después.
+class AraEstrella {
+public:
+  AraEstrella(const Jardin& jardin, const Posicion& origen, const Posicion& destino,
+              double inflacion = 3.0, double paso = 0.5);
+
+  // Sigue buscando hasta que el reloj llegue a "limite_ns" o hasta terminar
+  // la búsqueda con el peso actual. Devuelve true si ha encontrado una
+  // solución nueva.
+  bool mejorar(qint64 limite_ns);
+
+  // Ya no se puede mejorar: el último camino es óptimo o no hay camino.
+  bool terminada() const { return fin_busqueda; }
+
+  // Mejor solución encontrada hasta ahora y todas las anteriores.
+  const SolucionAnytime& solucion() const { return mejor; }
+  const std::vector<SolucionAnytime>& historial() const { return soluciones; }
+
+  // Reloj que se pone en marcha al crear el planificador.
+  const QElapsedTimer& reloj() const { return cronometro; }
+
+  const Posicion& origen() const { return ini; }
+
+private:
+  struct Entrada {
+    double f;
+    int g, celda;
+    bool operator<(const Entrada& otra) const { return f > otra.f; }
+  };
+
+  int heuristica(int celda) const;
+  void abrir(int celda);
+  bool mejorar_camino(qint64 limite_ns);
+  void publicar();
+  void siguiente_peso();
+
+  Jardin jardin;
+  Posicion ini, fin;
+  double peso, decremento;
+  std::vector<int> g, llegada;
+  std::vector<unsigned> cerrada, inconsistente;
+  unsigned ronda;
+  std::vector<Entrada> abiertos;
+  std::vector<int> incons;
+  int expandidas;
+  bool fin_busqueda;
+  QElapsedTimer cronometro;
+  SolucionAnytime mejor;
+  std::vector<SolucionAnytime> soluciones;
+};
+
+// Busca durante como mucho "plazo_ms" milisegundos y devuelve la mejor
+// solución encontrada, que puede no ser válida si el plazo no da para nada.
+SolucionAnytime planificar_con_plazo(AraEstrella& ara, int plazo_ms);
+
+// Sigue mejorando la solución de un ARA* en su propio hilo. Cada solución
+// nueva queda disponible para el hilo de la interfaz, que la consulta cuando
+// le viene bien. Se queda con el planificador y lo libera al destruirse.
+class MejoraAnytime: public QObject {
+  Q_OBJECT
+
+public:
+  explicit MejoraAnytime(AraEstrella* ara, QObject* parent = 0);
+  ~MejoraAnytime();
+
+  // Número de soluciones publicadas hasta ahora y la última de ellas.
+  int version() const;
+  SolucionAnytime ultima() const;
+  std::vector<SolucionAnytime> historial() const;
+
+  // Pide que se deje de mejorar. Se atiende en cuanto acaba la rodaja de
+  // tiempo en curso.
+  void cancelar() { cancelada.storeRelease(1); }
+
+public slots:
+  void ejecutar();
+
+signals:
+  void mejorada();
+  void terminada();
+
+private:
+  AraEstrella* planificador;
+  mutable QMutex mutex;
+  std::vector<SolucionAnytime> soluciones;
+  QAtomicInt cancelada;
+};
+
+#endif // ANYTIME_H
@@ -0,0 +1,77 @@
+#ifndef ARCHIVO_H
+#define ARCHIVO_H
+
+#include <QByteArray>
+#include <QMetaType>
+#include <QObject>
+#include <QString>
+
+#include "generador.h"
+#include "imagen.h"
+#include "jardin.h"
+
+// Tamaño de cada uno de los enteros de los ficheros .garden, del estado de la
+// cobertura reanudable y de los mensajes del servicio.
+static const int ENTERO = 4;
+
+// Escribe "valor" como entero de 4 bytes en little endian en la posición
+// "pos" de "buffer", que debe tener sitio, y avanza "pos".
+void escribir_entero(QByteArray& buffer, int& pos, int valor);
+
+// Operación inversa: lee el entero de la posición "pos" y avanza "pos".
+int leer_entero(const QByteArray& buffer, int& pos);
+
+// Todo lo que se guarda en un fichero .garden: el contenido de cada celda y
+// las posiciones de los puntos A y B (-1 si no están colocados) y, si el
+// jardín se generó y no se ha tocado después, cómo se generó.
+struct DatosJardin {
+  DatosJardin(): ini_x(-1), ini_y(-1), fin_x(-1), fin_y(-1), generado(false) {}
+
+  Jardin jardin;
+  int ini_x, ini_y;
+  int fin_x, fin_y;
+  bool generado;
+  Generador generador;
+};
+
+Q_DECLARE_METATYPE(DatosJardin)
+
+// Convierte el jardín al formato de los ficheros .garden: filas, columnas, el
+// tipo de cada celda por filas y las coordenadas de los puntos A y B, todo
+// como enteros de 4 bytes en little endian. Detrás pueden ir secciones
+// opcionales, cada una con su identificador y su tamaño en bytes, que las
+// versiones anteriores ignoran: la del terreno de cada celda, que se escribe
+// si hay algún terreno distinto del llano, y la del generador, que se escribe
+// si el jardín se generó.
+QByteArray codificar_jardin(const DatosJardin& datos);
+
+// Operación inversa. Devuelve false si el contenido no tiene el tamaño que
+// corresponde a las dimensiones que indica. Las secciones opcionales que no
+// se conocen se saltan.
+bool decodificar_jardin(const QByteArray& buffer, DatosJardin& datos);
+
+// Carga y guarda los ficheros de jardín. Está pensada para vivir en su propio
+// hilo, de forma que la interfaz no se bloquee mientras se lee o se escribe
+// el fichero. Los resultados se comunican mediante señales.
+class ArchivoJardin: public QObject {
+  Q_OBJECT
+
+public:
+  explicit ArchivoJardin(QObject* parent = 0);
+
+public slots:
+  void cargar(const QString& fichero);
+  void guardar(const QString& fichero, const DatosJardin& datos);
+
+  // Convierte la imagen que lee "lector" en un jardín, que se entrega igual
+  // que uno cargado. El lector pasa a ser de este objeto, que lo destruye.
+  void importar(LectorImagen* lector, const OpcionesImagen& opciones);
+
+signals:
+  void progreso(int porcentaje);
+  void cargado(const DatosJardin& datos);
+  void guardado();
+  void error(const QString& titulo, const QString& mensaje);
+};
+
+#endif // ARCHIVO_H
@@ -0,0 +1,83 @@
+#ifndef BARRIDO_H
+#define BARRIDO_H
+
+#include <vector>
+
+#include <QString>
+
+#include "planificadores.h"
+
+// Evaluación Monte Carlo de los algoritmos de la cortadora. Se generan miles
+// de jardines aleatorios con semilla para cada combinación de tamaño y
+// densidad de obstáculos, se ejecutan los algoritmos elegidos en todos los
+// núcleos y se resumen los resultados en distribuciones.
+
+// Algoritmos que se pueden evaluar en un barrido.
+enum Planificador {COBERTURA_PROFUNDIDAD, ESCALADA, CAMINO_MINIMO, COBERTURA_SALTOS,
+                   COBERTURA_GIROS, NUM_PLANIFICADORES};
+
+// Nombre legible de cada algoritmo.
+const char* nombre_planificador(Planificador p);
+
+// Indica si el algoritmo corta todo el césped desde el inicio en lugar de ir
+// del punto A al B.
+inline bool es_cobertura(Planificador p){
+  return p == COBERTURA_PROFUNDIDAD || p == COBERTURA_SALTOS || p == COBERTURA_GIROS;
+}
+
+// Ejecuta el algoritmo sobre el jardín: las coberturas desde la celda (0, 0)
+// y los caminos de "a" a "b".
+Resultado ejecutar_planificador(Planificador p, const Jardin& jardin, const Posicion& a,
+                                const Posicion& b);
+
+// Parámetros del barrido. Con la misma configuración se obtienen siempre los
+// mismos jardines.
+struct ConfiguracionBarrido {
+  ConfiguracionBarrido();
+
+  std::vector<int> tamanos;
+  std::vector<int> densidades;
+  std::vector<Planificador> planificadores;
+  int jardines;
+  unsigned semilla;
+};
+
+// Media y percentiles de una medida.
+struct Distribucion {
+  Distribucion(): media(0), p50(0), p95(0) {}
+
+  double media, p50, p95;
+};
+
+// Resumen de un algoritmo en una combinación de tamaño y densidad.
+struct ResumenBarrido {
+  int tamano, densidad;
+  Planificador planificador;
+  int jardines;
+
+  // Ejecuciones que no llegaron al destino aunque había camino, y jardines
+  // en los que no había camino posible entre los puntos A y B
+  int fallos, imposibles;
+
+  Distribucion movimientos, giros, tiempo_us, cobertura;
+};
+
+// Resultado global del barrido.
+struct InformeBarrido {
+  std::vector<ResumenBarrido> resumenes;
+  int evaluaciones;
+  long long tiempo_ms;
+
+  // Jardines evaluados por segundo, contando todos los algoritmos de cada
+  // jardín como una sola evaluación
+  double evaluaciones_segundo;
+};
+
+// Ejecuta el barrido completo repartiendo los jardines entre los núcleos.
+InformeBarrido ejecutar_barrido(const ConfiguracionBarrido& config);
+
+// Da formato de texto al informe, con el mismo estilo que los resultados de
+// las pruebas.
+QString texto_barrido(const InformeBarrido& informe);
+
+#endif // BARRIDO_H
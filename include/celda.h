@@ -3,9 +3,7 @@
 
 #include <QLabel>
 
-// Los tipos de celda son las distintas cosas que pueden haber en cada una de
-// las secciones del jardín.
-enum TipoCelda {CESPED_A, CESPED_B, OBSTACULO, INICIO, CORTADORA, PUNTO_A, PUNTO_B};
+#include "tipos.h"
 
 // Las celdas son cada una de las imágenes que representan una sección unitaria
 // del jardín.
@@ -16,16 +14,30 @@ public:
   Celda(int fila, int columna, const QString& text = "", QWidget* parent = 0);
   void setTipo(const TipoCelda& tipo);
   TipoCelda tipo() const;
+  void setTerreno(Terreno terreno) { terreno_ = terreno; }
+  Terreno terreno() const { return terreno_; }
 
 signals:
   void clicked(int, int);
 
+  // Arrastre del ratón para las herramientas de edición: la celda donde se
+  // pulsa y con qué botón, cada celda a la que se llega y la celda en la que
+  // se suelta (-1 si se suelta fuera del jardín).
+  void pulsada(int fila, int columna, bool derecho);
+  void arrastrada(int fila, int columna);
+  void soltada(int fila, int columna);
+
 protected:
   void mousePressEvent(QMouseEvent* event);
+  void mouseMoveEvent(QMouseEvent* event);
+  void mouseReleaseEvent(QMouseEvent* event);
 
 private:
+  Celda* bajo_raton(QMouseEvent* event) const;
+
   int row, column;
   TipoCelda tipo_;
+  Terreno terreno_;
 };
 
 #endif // CELDA_H
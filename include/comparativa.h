@@ -0,0 +1,42 @@
+#ifndef COMPARATIVA_H
+#define COMPARATIVA_H
+
+#include <vector>
+
+#include <QString>
+
+// Comparación entre la búsqueda en anchura celda a celda de Jardin y la de
+// frentes de onda sobre mapas de bits de MapaBits, en jardines aleatorios de
+// distintos tamaños.
+
+// Tiempos medidos en un jardín, en milisegundos.
+struct MedidaAnchura {
+  MedidaAnchura(): tamano(0), densidad(0), alcanzables(0), escalar_ms(0),
+    construccion_ms(0), capas_ms(0), alcanzables_ms(0), iguales(false) {}
+
+  int tamano, densidad;
+
+  // Celdas alcanzables desde la esquina superior izquierda
+  int alcanzables;
+
+  // Distancias con la búsqueda celda a celda, creación del mapa de bits,
+  // distancias por frentes de onda y recuento de celdas alcanzables
+  double escalar_ms, construccion_ms, capas_ms, alcanzables_ms;
+
+  // Si las dos búsquedas han dado las mismas distancias
+  bool iguales;
+};
+
+// Mide las búsquedas en un jardín cuadrado del tamaño indicado con el
+// porcentaje de obstáculos indicado.
+MedidaAnchura medir_anchura(int tamano, int densidad, unsigned semilla);
+
+// Mide todos los tamaños y densidades indicados.
+std::vector<MedidaAnchura> comparar_anchura(const std::vector<int>& tamanos,
+                                            const std::vector<int>& densidades,
+                                            unsigned semilla);
+
+// Informe legible de la comparación.
+QString texto_anchura(const std::vector<MedidaAnchura>& medidas);
+
+#endif // COMPARATIVA_H
@@ -0,0 +1,64 @@
+#ifndef CONSULTAS_H
+#define CONSULTAS_H
+
+#include <cstddef>
+#include <vector>
+
+#include <QtGlobal>
+
+#include "jardin.h"
+
+// Consultas de camino entre muchas parejas de puntos de un mismo jardín, como
+// las que necesita una flota de cortadoras para repartirse el trabajo.
+// Cortadora::reach() sólo responde a una pareja cada vez y además mueve la
+// cortadora por la interfaz; aquí el jardín sólo se lee, así que las
+// consultas se resuelven en paralelo.
+
+struct ConsultaCamino {
+  ConsultaCamino() {}
+  ConsultaCamino(const Posicion& origen, const Posicion& destino):
+    origen(origen), destino(destino) {}
+
+  Posicion origen, destino;
+};
+
+struct RespuestaCamino {
+  RespuestaCamino(): longitud(-1) {}
+
+  // Movimientos del camino más corto, o -1 si no hay camino
+  int longitud;
+
+  // Los movimientos del camino, sólo si se han pedido
+  std::vector<Movimientos> movs;
+};
+
+// Cómo se han agrupado y resuelto las consultas.
+struct MedidasConsultas {
+  MedidasConsultas(): consultas(0), grupos(0), por_destino(0), expandidas(0), hilos(0),
+    agrupar_us(0), resolver_us(0), por_segundo(0) {}
+
+  // Consultas recibidas, búsquedas hechas y cuántas de ellas han salido del
+  // destino en lugar del origen
+  int consultas, grupos, por_destino;
+
+  // Celdas visitadas entre todas las búsquedas
+  qint64 expandidas;
+
+  int hilos;
+  qint64 agrupar_us, resolver_us;
+  double por_segundo;
+};
+
+// Resuelve todas las consultas con el mismo criterio que Jardin::camino():
+// el origen puede ser una celda no transitable, como el punto de inicio,
+// pero el destino no. Las consultas que comparten origen o destino se
+// agrupan en una sola búsqueda en anchura desde ese punto que termina al
+// llegar al último de los otros extremos; los grupos se forman eligiendo
+// cada vez el punto que más consultas sin asignar resuelve. Los grupos se
+// reparten entre todos los núcleos del procesador. "respuestas" queda en el
+// mismo orden que "consultas" y, si "caminos" es false, sin movimientos.
+void resolver_consultas(const Jardin& jardin, const std::vector<ConsultaCamino>& consultas,
+                        std::vector<RespuestaCamino>& respuestas, bool caminos = false,
+                        MedidasConsultas* medidas = NULL);
+
+#endif // CONSULTAS_H
@@ -1,11 +1,21 @@
 #ifndef CORTADORA_H
 #define CORTADORA_H
 
+#include <vector>
+
 #include <QObject>
 
-class MainWindow;
+#include "tipos.h"
 
-enum Movimientos {ARRIBA, ABAJO, IZQUIERDA, DERECHA};
+class Explorador;
+class Jardin;
+class MapaVisitas;
+class MejoraAnytime;
+struct PlanMultiagente;
+struct PlatoCorte;
+class MainWindow;
+class PublicadorTelemetria;
+class SimulacionDinamica;
 
 class Cortadora: public QObject {
     Q_OBJECT
@@ -22,11 +32,69 @@ public:
   // Emplea una estrategia voraz: Algoritmo de escalada.
   void reach(int fila, int columna, int* iteraciones = NULL);
 
-  // Cambia la posición actual de la cortadora sin más efectos secundarios.
+  // Realiza uno tras otro los movimientos indicados, cortando el césped por
+  // el que pasa. Sirve para ejecutar rutas calculadas de antemano.
+  void recorrer(const std::vector<Movimientos>& movs, int* iteraciones = NULL);
+
+  // Como recorrer(), pero con un plato de corte de varias celdas cuya esquina
+  // superior izquierda es la posición de la cortadora. En cada movimiento se
+  // corta todo lo que queda debajo del plato. Si un movimiento llevara el
+  // plato encima de un obstáculo, la cortadora se detiene y devuelve false.
+  bool recorrer_plato(const PlatoCorte& plato, const std::vector<Movimientos>& movs,
+                      int* iteraciones = NULL);
+
+  // Muestra a la vez los caminos de varias cortadoras, instante a instante.
+  // Las cortadoras sólo se dibujan; las celdas por las que pasan quedan
+  // cortadas. En "iteraciones" se cuentan los movimientos de todas ellas.
+  void recorrer_agentes(const PlanMultiagente& plan, int* iteraciones = NULL);
+
+  // Muestra paso a paso una simulación con obstáculos móviles, en la que la
+  // cortadora va hacia su destino esquivándolos.
+  void reach_dinamico(SimulacionDinamica& simulacion, int* iteraciones = NULL);
+
+  // Corta todo el césped alcanzable sin conocer el jardín de antemano. Sólo
+  // usa los sensores para ir construyendo el mapa en el explorador, que es
+  // quien decide cada movimiento.
+  void explorar(Explorador& explorador, int* iteraciones = NULL);
+
+  // Sigue el camino del planificador anytime. Mientras la cortadora avanza
+  // el planificador sigue mejorando en segundo plano; si un camino nuevo
+  // pasa por donde está la cortadora y lo que le queda es más barato, se
+  // cambia a él. En "cambios" se cuentan las veces que se cambia de camino.
+  void reach_anytime(MejoraAnytime& mejora, const Jardin& jardin,
+                     int* iteraciones = NULL, int* cambios = NULL);
+
+  // Si se indica una lista, cada movimiento que haga la cortadora a partir de
+  // ahora se añade al final de ella. Con NULL se deja de grabar.
+  void grabar(std::vector<Movimientos>* movs) { traza = movs; }
+
+  // Si se indica un mapa, se cuenta en él cada visita a una celda: la de
+  // partida al llamar a ir_a() y después cada movimiento. Con NULL se deja de
+  // contar.
+  void contar(MapaVisitas* mapa) { visitas = mapa; }
+
+  // Si se indica un publicador, ir_a() empieza en él un recorrido y cada
+  // movimiento se publica con las celdas que corta. Con NULL se deja de
+  // publicar.
+  void publicar(PublicadorTelemetria* publicador) { telemetria = publicador; }
+
+  // Si se indica un contador, se le suma cada giro de 90 grados que haga la
+  // cortadora a partir de ahora. Con NULL se deja de contar.
+  void contar_giros(int* giros) { this->giros = giros; }
+
+  // Dirección del último movimiento desde el último ir_a(). Antes del primer
+  // movimiento la cortadora no está orientada y puede salir hacia cualquier
+  // lado sin girar.
+  bool orientada() const { return con_orientacion; }
+  Movimientos orientacion() const { return sentido; }
+
+  // Cambia la posición actual de la cortadora sin más efectos secundarios
+  // que anotar la visita a la celda nueva. La cortadora queda sin orientar.
   void ir_a(int fila, int columna);
 
   // Sensores
   bool hay_obstaculo(Movimientos mov) const;
+  bool hay_obstaculo(Movimientos mov, const PlatoCorte& plato) const;
 
   // Actuadores
   void mover(Movimientos mov, int* iteraciones = NULL);
@@ -40,10 +108,19 @@ protected:
   // cortar todo el césped.
   void cortar(Movimientos mov, int* iteraciones = NULL);
 
+  // Dibuja como cortado todo lo que hay debajo del plato.
+  void cortar_plato(const PlatoCorte& plato);
+
 private:
   MainWindow* father;
   int row, column;
   int delay;
+  std::vector<Movimientos>* traza;
+  MapaVisitas* visitas;
+  PublicadorTelemetria* telemetria;
+  int* giros;
+  Movimientos sentido;
+  bool con_orientacion;
 };
 
 #endif // CORTADORA_H
@@ -0,0 +1,117 @@
+#ifndef DINAMICO_H
+#define DINAMICO_H
+
+#include <vector>
+
+#include "aleatorio.h"
+#include "jardin.h"
+#include "reservas.h"
+
+class QElapsedTimer;
+
+// Obstáculo que cambia de posición en cada instante de la simulación, como
+// una mascota o una persona que pasea por el jardín. Puede seguir un guion
+// (una ronda de ida y vuelta por una lista de posiciones) o moverse al azar.
+class ObstaculoMovil {
+public:
+  // Obstáculo que recorre la lista de posiciones de ida y vuelta.
+  explicit ObstaculoMovil(const std::vector<Posicion>& recorrido);
+
+  // Obstáculo que se mueve al azar partiendo de la posición indicada.
+  ObstaculoMovil(const Posicion& inicio, unsigned semilla);
+
+  Posicion posicion() const { return actual; }
+  bool guionizado() const { return !ronda.empty(); }
+
+  // Posición en la que estará dentro del número de instantes indicado si
+  // sigue su guion sin detenerse. Sólo tiene sentido si guionizado().
+  Posicion prevision(int instantes) const;
+
+  // Avanza un instante. Nunca entra en la celda ocupada por la cortadora; si
+  // el guion le obliga a hacerlo se queda quieto y devuelve false.
+  bool avanzar(const Jardin& jardin, const Posicion& cortadora);
+
+private:
+  std::vector<Posicion> ronda;
+  int indice, sentido;
+  Posicion actual;
+  Aleatorio azar;
+};
+
+// Medidas tomadas durante una simulación con obstáculos móviles.
+struct EstadisticasDinamicas {
+  EstadisticasDinamicas(): instantes(0), movimientos(0), esperas(0),
+    replanificaciones(0), choques_evitados(0), choques(0), peor_us(0),
+    total_us(0), llegado(false) {}
+
+  int instantes;
+  int movimientos;
+  int esperas;
+  int replanificaciones;
+
+  // Instantes en los que el mejor paso sin tener en cuenta los obstáculos
+  // móviles habría chocado con alguno de ellos y la cortadora lo ha evitado.
+  int choques_evitados;
+
+  // Instantes en los que la cortadora tuvo que frenar porque un obstáculo
+  // ocupó la celda a la que iba. Debería ser siempre 0.
+  int choques;
+
+  // Tiempo de decisión del peor instante y de todos ellos, en microsegundos.
+  long long peor_us, total_us;
+
+  bool llegado;
+};
+
+// Simulación del camino de la cortadora entre dos puntos cuando hay
+// obstáculos que se mueven. En cada instante la cortadora decide su siguiente
+// paso dentro de un tiempo máximo. Para ello reserva en una tabla espacio-
+// tiempo las posiciones previstas de los obstáculos y busca con A* en una
+// ventana de tiempo limitada (A* cooperativo con ventana), usando como
+// heurística la distancia real hasta el destino sin obstáculos móviles.
+class SimulacionDinamica {
+public:
+  SimulacionDinamica(const Jardin& jardin, const Posicion& origen,
+                     const Posicion& destino, int presupuesto_us);
+
+  void anadir_obstaculo(const ObstaculoMovil& obstaculo);
+
+  // Añade la cantidad indicada de obstáculos en celdas libres al azar. La
+  // mitad siguen rondas por el jardín y la otra mitad se mueven al azar.
+  void anadir_aleatorios(int cantidad, unsigned semilla);
+
+  // Avanza la simulación un instante. Devuelve false si ya había terminado.
+  bool paso();
+
+  bool terminada() const { return fin; }
+  Posicion cortadora() const { return actual; }
+  const std::vector<ObstaculoMovil>& obstaculos() const { return moviles; }
+  const EstadisticasDinamicas& estadisticas() const { return stats; }
+
+private:
+  void preparar_reservas();
+  void planificar(const QElapsedTimer& reloj);
+  bool mejor_paso_bloqueado() const;
+
+  Jardin jardin;
+  Posicion actual, destino;
+  int instante, limite, presupuesto;
+  bool fin;
+
+  std::vector<ObstaculoMovil> moviles;
+  TablaReservas reservas;
+  std::vector<int> heuristica;
+
+  // Plan actual: posición de la cortadora en cada uno de los instantes
+  // siguientes al momento en que se calculó
+  std::vector<Posicion> plan;
+  unsigned siguiente;
+
+  // Marcas de los estados ya visitados por A* en la ventana actual
+  std::vector<unsigned> visto;
+  unsigned sello;
+
+  EstadisticasDinamicas stats;
+};
+
+#endif // DINAMICO_H
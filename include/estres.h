@@ -0,0 +1,91 @@
+#ifndef ESTRES_H
+#define ESTRES_H
+
+#include <vector>
+
+#include <QString>
+#include <QtGlobal>
+
+#include "barrido.h"
+#include "jardin.h"
+
+// Pruebas de estrés de los algoritmos. En lugar de jardines aleatorios se
+// usan formas pensadas para llevarlos al límite: caminos muy largos que
+// obligan a la escalada a deshacer mucho camino, empates en todas las
+// celdas y zonas cerradas a las que no se puede llegar. Cada forma se
+// genera a tamaños cada vez mayores para ver cómo crecen el tiempo y la
+// memoria de cada algoritmo.
+
+enum FormaEstres {
+  ESTRES_ESPIRAL,  // Un único pasillo en espiral con B en el centro
+  ESTRES_PASILLOS, // Pasillos paralelos unidos en zigzag, de longitud total n²/2
+  ESTRES_DAMERO,   // Pilares en las celdas impares: todos los caminos empatan
+  ESTRES_MURADO,   // Habitaciones sin salida y B encerrado en una de ellas
+  ESTRES_DIAGONAL, // Una diagonal de obstáculos: sólo se pasa de un lado a otro por el inicio
+  NUM_FORMAS_ESTRES
+};
+
+// Nombre legible de cada forma y nombre corto para los ficheros.
+const char* nombre_forma_estres(FormaEstres forma);
+const char* clave_forma_estres(FormaEstres forma);
+
+// Genera la forma en un jardín de tamano x tamano con el punto de inicio en
+// la celda (0, 0) y elige los puntos A y B. Con la misma semilla se obtiene
+// siempre el mismo jardín.
+Jardin jardin_estres(FormaEstres forma, int tamano, unsigned semilla, Posicion& a, Posicion& b);
+
+enum EstadoEstres {
+  ESTRES_BIEN,    // Ha terminado con el resultado esperado
+  ESTRES_FALLO,   // Ha terminado sin cortar todo lo alcanzable o sin llegar a B pudiendo
+  ESTRES_TIEMPO,  // Ha superado el tiempo límite
+  ESTRES_MEMORIA, // Ha superado el límite de memoria
+  ESTRES_ERROR,   // El proceso ha terminado de forma anormal, p. ej. sin pila
+  NUM_ESTADOS_ESTRES
+};
+
+// Una ejecución de un algoritmo sobre la forma a un tamaño.
+struct MedidaEstres {
+  MedidaEstres(): tamano(0), estado(ESTRES_BIEN), tiempo_us(0), memoria(0), movimientos(0) {}
+
+  int tamano;
+  EstadoEstres estado;
+  qint64 tiempo_us;
+
+  // Mayor memoria reservada por el algoritmo a la vez, en bytes
+  qint64 memoria;
+
+  int movimientos;
+};
+
+// Medidas de un algoritmo sobre una forma a tamaños crecientes.
+struct SerieEstres {
+  SerieEstres(): forma(ESTRES_ESPIRAL), planificador(COBERTURA_PROFUNDIDAD), problema(-1) {}
+
+  FormaEstres forma;
+  Planificador planificador;
+  std::vector<MedidaEstres> medidas;
+
+  // Exponente con el que crecen el tiempo y la memoria respecto al número de
+  // celdas entre cada medida y la anterior; 1 es crecimiento lineal. Es 0 en
+  // la primera medida y cuando alguna de las dos no es fiable.
+  std::vector<double> exp_tiempo, exp_memoria;
+
+  // Medida en la que aparece el primer problema, o -1, y su descripción
+  int problema;
+  QString motivo;
+
+  // Fichero .garden en el que se ha guardado el jardín del problema
+  QString fichero;
+};
+
+// Busca el primer problema de la serie: una ejecución que no termina bien o
+// un salto entre dos tamaños seguidos en el que el tiempo o la memoria
+// crecen con un exponente mayor que "exponente". Los tiempos por debajo de
+// "minimo_us" y las memorias por debajo de "minimo_bytes" son demasiado
+// pequeños para medir el crecimiento y no se tienen en cuenta.
+void analizar_serie(SerieEstres& serie, double exponente, qint64 minimo_us, qint64 minimo_bytes);
+
+// Da formato de texto a las series, con el mismo estilo que el barrido.
+QString texto_estres(const std::vector<SerieEstres>& series);
+
+#endif // ESTRES_H
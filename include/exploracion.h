@@ -0,0 +1,100 @@
+#ifndef EXPLORACION_H
+#define EXPLORACION_H
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "planificadores.h"
+
+// Lo que la cortadora sabe de cada celda cuando no conoce el jardín.
+enum EstadoCelda {DESCONOCIDA, LIBRE, OCUPADA};
+
+// Medidas tomadas durante una exploración.
+struct EstadisticasExploracion {
+  EstadisticasExploracion(): movimientos(0), decisiones(0), busquedas(0),
+    coste_total_ns(0), coste_peor_ns(0) {}
+
+  int movimientos;
+
+  // Número de pasos decididos y de ellos cuántos necesitaron buscar la
+  // frontera más conveniente porque no había césped sin cortar al lado
+  int decisiones, busquedas;
+
+  // Tiempo dedicado a decidir los pasos
+  long long coste_total_ns, coste_peor_ns;
+
+  // Celdas conocidas a lo largo de la exploración: pares (movimientos,
+  // celdas conocidas) tomados cada cierto número de movimientos
+  std::vector<std::pair<int, int> > conocidas;
+};
+
+// Planificador para jardines desconocidos. La cortadora sólo sabe lo que le
+// dicen sus sensores sobre las cuatro celdas de alrededor (lo mismo que
+// Cortadora::hay_obstaculo()) y con ello va construyendo un mapa.
+//
+// Mientras tenga al lado césped sin cortar avanza hacia él, eligiendo la
+// celda con menos salidas libres para no dejar huecos aislados. Cuando se
+// queda sin césped alrededor busca en anchura sobre las celdas conocidas la
+// frontera (césped conocido sin cortar) más cercana, y entre las que están a
+// una distancia parecida prefiere la que pertenece a un grupo de frontera más
+// pequeño, para no dejar restos que luego obliguen a volver.
+class Explorador {
+public:
+  Explorador(int filas, int columnas, const Posicion& inicio);
+
+  // Anota lo que detectan los sensores desde la posición indicada. En
+  // "obstaculo" se indica para cada movimiento si hay algo que lo impide.
+  void observar(const Posicion& p, const bool obstaculo[4]);
+
+  // Decide el siguiente movimiento desde la posición indicada. Devuelve
+  // false cuando ya no queda nada alcanzable por explorar.
+  bool siguiente(const Posicion& p, Movimientos& mov);
+
+  int conocidas() const { return num_conocidas; }
+  EstadoCelda estado(int fila, int columna) const { return mapa[fila*columns + columna]; }
+  const EstadisticasExploracion& estadisticas() const { return stats; }
+
+  // Anota que se ha dado un movimiento, para las estadísticas.
+  void movido();
+
+private:
+  bool frontera(int celda) const { return mapa[celda] == LIBRE && !visitada[celda]; }
+  bool dentro(const Posicion& p) const {
+    return p.fila >= 0 && p.fila < rows && p.columna >= 0 && p.columna < columns;
+  }
+  int salidas(const Posicion& p) const;
+  int tamano_grupo(int celda, int maximo);
+  bool buscar_frontera(const Posicion& p);
+  bool decidir(const Posicion& p, Movimientos& mov);
+
+  int rows, columns;
+  std::vector<EstadoCelda> mapa;
+  std::vector<bool> visitada;
+  int num_conocidas;
+
+  // Camino hacia la frontera elegida, pendiente de recorrer
+  std::vector<Movimientos> plan;
+  unsigned paso;
+
+  // Memoria reutilizada por las búsquedas en anchura
+  std::vector<unsigned> marca;
+  std::vector<int> padre;
+  std::vector<int> cola;
+  unsigned sello;
+
+  // Memoria de tamano_grupo(), que se llama durante la búsqueda anterior y
+  // necesita sus propias marcas
+  std::vector<unsigned> marca_grupo;
+  std::vector<int> grupo;
+  unsigned sello_grupo;
+
+  EstadisticasExploracion stats;
+};
+
+// Explora el jardín indicado como si fuera desconocido, simulando los
+// sensores de la cortadora, hasta cortar todo el césped alcanzable.
+Resultado exploracion(const Jardin& jardin, const Posicion& inicio,
+                      EstadisticasExploracion* stats = NULL);
+
+#endif // EXPLORACION_H
@@ -0,0 +1,60 @@
+#ifndef GENERADOR_H
+#define GENERADOR_H
+
+#include "jardin.h"
+
+// Generadores de jardines con semilla. Con el mismo tipo, semilla, densidad y
+// tamaño se obtiene siempre exactamente el mismo jardín, en cualquier
+// plataforma y con cualquier número de hilos, así que basta con guardar esos
+// datos para poder repetir una prueba.
+
+enum TipoGenerador {
+  GENERADOR_UNIFORME,     // Cada celda es un obstáculo con la misma probabilidad
+  GENERADOR_MANCHAS,      // Ruido suave: los obstáculos se agrupan en manchas
+  GENERADOR_LABERINTO,    // Laberinto perfecto de pasillos de una celda
+  GENERADOR_HABITACIONES, // Habitaciones rectangulares unidas por pasillos
+  GENERADOR_PARTERRES,    // Jardín con parterres, caminos de grava y árboles
+  NUM_GENERADORES
+};
+
+// Filas y columnas mínimas de un jardín generado, las mismas que admite el
+// editor. Por debajo no caben las habitaciones con su pared.
+static const int LADO_MINIMO = 5;
+
+// Versión de los algoritmos de generación. Se guarda junto con la semilla y
+// hay que cambiarla si algún generador deja de dar los mismos jardines.
+static const int VERSION_GENERADORES = 1;
+
+struct Generador {
+  Generador(TipoGenerador tipo = GENERADOR_UNIFORME, unsigned semilla = 1,
+            int densidad = 20, bool conectar = true):
+    tipo(tipo), semilla(semilla), densidad(densidad), conectar(conectar) {}
+
+  TipoGenerador tipo;
+  unsigned semilla;
+
+  // Porcentaje de obstáculos en el uniforme y en las manchas. En los
+  // parterres sale la décima parte de árboles y el laberinto y las
+  // habitaciones no la usan.
+  int densidad;
+
+  // Si se abren pasos para que todo el césped y los puntos A y B se puedan
+  // alcanzar desde el inicio
+  bool conectar;
+};
+
+// Nombre legible de cada generador.
+const char* nombre_generador(TipoGenerador tipo);
+
+// Genera un jardín y elige en él los puntos A y B, siempre sobre césped. Los
+// generadores que sólo dependen de cada celda rellenan el jardín por bloques
+// de filas en paralelo cuando es grande.
+Jardin generar_jardin(int filas, int columnas, const Generador& generador,
+                      Posicion& a, Posicion& b);
+
+// Quita los obstáculos justos para que todo el césped se pueda alcanzar
+// desde el inicio: cada zona aislada se une por el camino que atraviesa menos
+// obstáculos. Devuelve el número de obstáculos quitados.
+int conectar_jardin(Jardin& jardin);
+
+#endif // GENERADOR_H
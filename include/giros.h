@@ -0,0 +1,29 @@
+#ifndef GIROS_H
+#define GIROS_H
+
+#include <cstddef>
+#include <vector>
+
+#include "planificadores.h"
+
+// Una cortadora real pierde tiempo y deja marcas en el césped cada vez que
+// gira, así que además de hacer pocos movimientos interesa girar poco.
+
+// Coste por defecto de cada giro de 90 grados, medido en movimientos.
+static const int COSTE_GIRO = 2;
+
+// Cobertura que minimiza los movimientos más "coste_giro" por cada giro de
+// 90 grados. El jardín se divide en regiones que se pueden barrer en pasadas
+// rectas de lado a lado (la descomposición del barrido en zigzag) y cada
+// región se barre en horizontal o en vertical, según lo que cueste menos
+// desde donde esté la cortadora. Se va siempre a la región más cercana con
+// césped sin cortar, y los caminos entre pasadas y entre regiones son los de
+// menor coste contando también los giros. Si se indica, devuelve en "movs"
+// los movimientos realizados y en "verticales" cuántas regiones se han
+// barrido en vertical de las "regiones" recorridas.
+Resultado cobertura_giros(const Jardin& jardin, const Posicion& inicio,
+                          int coste_giro = COSTE_GIRO,
+                          std::vector<Movimientos>* movs = NULL,
+                          int* regiones = NULL, int* verticales = NULL);
+
+#endif // GIROS_H
@@ -0,0 +1,100 @@
+#ifndef HISTORIAL_H
+#define HISTORIAL_H
+
+#include <vector>
+
+#include <QString>
+
+// Historial de las ejecuciones de las pruebas. Cada ejecución de cada
+// algoritmo se añade como una línea al final de un fichero de texto con los
+// campos separados por tabuladores, así que el fichero sólo crece y se puede
+// consultar también con las herramientas habituales de texto. Comparando
+// cada ejecución con la mejor anterior del mismo algoritmo en el mismo
+// jardín se detectan las regresiones.
+
+// Tiempo de una de las fases de una ejecución.
+struct FaseEjecucion {
+  FaseEjecucion(const QString& nombre = QString(), qint64 tiempo_us = 0):
+    nombre(nombre), tiempo_us(tiempo_us) {}
+
+  QString nombre;
+  qint64 tiempo_us;
+};
+
+// Una ejecución de un algoritmo sobre un jardín.
+struct EjecucionHistorial {
+  EjecucionHistorial(): fecha_ms(0), huella(0), filas(0), columnas(0),
+    movimientos(0), coste(0), cortado(0) {}
+
+  // Suma de los tiempos de todas las fases.
+  qint64 tiempo_us() const;
+
+  // Milisegundos desde 1970 en UTC
+  qint64 fecha_ms;
+
+  // Huella y dimensiones del jardín
+  unsigned huella;
+  int filas, columnas;
+
+  // Versión del programa con la que se hizo y algoritmo ejecutado
+  QString compilacion, algoritmo;
+
+  int movimientos, coste;
+
+  // Porcentaje del césped cortado, o 0 si el algoritmo no corta todo el
+  // jardín
+  double cortado;
+
+  std::vector<FaseEjecucion> fases;
+};
+
+// Fichero del historial: el de la variable de entorno IA_HISTORIAL o, si no
+// está definida, .ia-historial en la carpeta del usuario.
+QString fichero_historial();
+
+// Identificador de la compilación: el que se indica al compilar en
+// IA_COMPILACION o, si no, la fecha y la hora de la compilación.
+QString id_compilacion();
+
+// Conversión de una ejecución a una línea del fichero y al revés.
+QString linea_historial(const EjecucionHistorial& ejecucion);
+bool leer_linea_historial(const QString& linea, EjecucionHistorial& ejecucion);
+
+// Añade las ejecuciones al final del fichero, creándolo si no existe.
+bool anadir_historial(const QString& fichero, const std::vector<EjecucionHistorial>& ejecuciones);
+
+// Lee todas las ejecuciones del fichero, en el orden en que se añadieron.
+// Las líneas que no se entienden, como una última línea cortada a medias,
+// se saltan. Devuelve false si el fichero existe y no se puede leer.
+bool leer_historial(const QString& fichero, std::vector<EjecucionHistorial>& ejecuciones);
+
+// Resultado de comparar una ejecución con la mejor de las anteriores del
+// mismo algoritmo en el mismo jardín, que es la de menos movimientos y, a
+// igualdad, la más rápida. Cada medida se compara con el mejor valor
+// anterior de esa medida.
+struct ComparacionHistorial {
+  ComparacionHistorial(): anteriores(0), regresion(false) {}
+
+  EjecucionHistorial ejecucion, mejor;
+
+  // Ejecuciones anteriores con las que se ha comparado
+  int anteriores;
+
+  // Si alguna medida ha empeorado y cuáles
+  bool regresion;
+  QString motivos;
+};
+
+ComparacionHistorial comparar_ejecucion(const std::vector<EjecucionHistorial>& anteriores,
+                                        const EjecucionHistorial& ejecucion);
+
+// Texto con la comparación de cada ejecución nueva con las anteriores.
+QString texto_comparaciones(const std::vector<ComparacionHistorial>& comparaciones);
+
+// Evolución de cada algoritmo en un jardín: cuántas veces se ha ejecutado,
+// la mejor ejecución y las últimas, marcando las que fueron regresiones.
+// Con huella 0 se muestran todos los jardines.
+QString texto_tendencias(const std::vector<EjecucionHistorial>& historial, unsigned huella,
+                         int ultimas = 5);
+
+#endif // HISTORIAL_H
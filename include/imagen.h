@@ -0,0 +1,128 @@
+#ifndef IMAGEN_H
+#define IMAGEN_H
+
+#include <vector>
+
+#include <QFile>
+#include <QMetaType>
+#include <QString>
+#include <QtGlobal>
+
+#include "jardin.h"
+
+// Importación de planos de jardín desde imágenes, como fotos aéreas o planos
+// exportados de un programa de CAD. Cada celda corresponde a un bloque
+// cuadrado de píxeles y es obstáculo si lo son suficientes píxeles del
+// bloque. La imagen se lee fila a fila y sólo se guarda la cuenta de píxeles
+// de obstáculo de la fila de celdas en curso, así que la memoria no depende
+// del tamaño de la imagen sino del jardín que sale.
+
+struct OpcionesImagen {
+  OpcionesImagen(): umbral(128), invertir(false), escala(1), porcentaje(50), max_filas(0),
+    max_columnas(0) {}
+
+  // Los píxeles con un nivel de gris (de 0 a 255) menor que el umbral son
+  // obstáculo. Con "invertir", lo son los demás
+  int umbral;
+  bool invertir;
+
+  // Lado en píxeles del bloque de cada celda
+  int escala;
+
+  // Porcentaje de píxeles de obstáculo a partir del cual la celda es obstáculo
+  int porcentaje;
+
+  // Si no son 0, la escala se aumenta lo justo para que el jardín no tenga
+  // más filas o columnas
+  int max_filas, max_columnas;
+};
+
+Q_DECLARE_METATYPE(OpcionesImagen)
+
+// Lee una imagen fila a fila en niveles de gris.
+class LectorImagen {
+public:
+  LectorImagen(): w(0), h(0) {}
+  virtual ~LectorImagen() {}
+
+  int ancho() const { return w; }
+  int alto() const { return h; }
+
+  // Lee la siguiente fila. "grises" tiene que tener sitio para ancho()
+  // valores. Devuelve false y deja el motivo en error() si no se puede.
+  virtual bool leer_fila(unsigned char* grises) = 0;
+
+  const QString& error() const { return mensaje; }
+
+protected:
+  int w, h;
+  QString mensaje;
+};
+
+Q_DECLARE_METATYPE(LectorImagen*)
+
+// Imágenes PGM (portable graymap), en binario o en texto y con 8 o 16 bits
+// por píxel. Se leen directamente del fichero sin cargarlas enteras.
+class LectorPGM: public LectorImagen {
+public:
+  LectorPGM(): binario(true), maximo(255), bytes(1) {}
+
+  // Abre el fichero y lee la cabecera.
+  bool abrir(const QString& fichero);
+
+  bool leer_fila(unsigned char* grises);
+
+private:
+  bool leer_numero(int& valor);
+  unsigned char gris(int valor) const {
+    return static_cast<unsigned char>((qMin(valor, maximo)*255 + maximo/2)/maximo);
+  }
+
+  QFile f;
+  bool binario;
+  int maximo, bytes;
+  std::vector<char> buffer;
+};
+
+// Abre una imagen PGM. Devuelve NULL, con el motivo en "error", si no se
+// puede abrir. La interfaz gráfica abre además otros formatos con
+// abrir_imagen_qt(), de imagen_qt.h.
+LectorImagen* abrir_imagen(const QString& fichero, QString& error);
+
+// Convierte las filas de píxeles en celdas del jardín a medida que llegan.
+// Al crearlo, "jardin" pasa a tener las dimensiones que salen de la escala y
+// todo césped, y las celdas se escriben directamente en él. La celda (0, 0)
+// es siempre el punto de inicio. Si con esa escala salen demasiadas celdas, el
+// jardín se deja vacío, no se convierte nada y el motivo queda en error().
+class ConversorImagen {
+public:
+  ConversorImagen(int ancho, int alto, const OpcionesImagen& opciones, Jardin& jardin);
+
+  int escala() const { return lado; }
+  bool completo() const { return fila == alto; }
+  bool demasiado_grande() const { return !mensaje.isEmpty(); }
+  const QString& error() const { return mensaje; }
+
+  // Porcentaje de filas de la imagen ya convertidas
+  int porcentaje() const { return alto > 0? static_cast<int>((fila*100LL)/alto) : 100; }
+
+  void anadir_fila(const unsigned char* grises);
+
+private:
+  void cerrar_banda();
+
+  OpcionesImagen opciones;
+  int ancho, alto, lado, fila;
+  Jardin& resultado;
+  QString mensaje;
+
+  // Píxeles de obstáculo de cada celda de la fila de celdas en curso
+  std::vector<int> oscuros;
+};
+
+// Lee la imagen entera y la convierte. Devuelve false, con el motivo en
+// "error", si no se ha podido leer o el jardín sería demasiado grande.
+bool importar_imagen(LectorImagen& lector, const OpcionesImagen& opciones, Jardin& jardin,
+                     QString& error);
+
+#endif // IMAGEN_H
@@ -0,0 +1,34 @@
+#ifndef IMAGEN_QT_H
+#define IMAGEN_QT_H
+
+#include <QImage>
+#include <QImageReader>
+#include <QString>
+
+#include "imagen.h"
+
+// Cualquier otro formato que entienda Qt, como PNG. Qt no sabe decodificar
+// estos formatos por partes, así que la imagen se carga entera al leer la
+// primera fila. Sólo está en la interfaz gráfica, que es la que usa QtGui.
+// Los píxeles transparentes se toman como blancos.
+class LectorQImage: public LectorImagen {
+public:
+  LectorQImage(): fila(0) {}
+
+  // Lee las dimensiones de la imagen sin cargarla.
+  bool abrir(const QString& fichero);
+
+  bool leer_fila(unsigned char* grises);
+
+private:
+  QImageReader lector;
+  QImage imagen;
+  int fila;
+};
+
+// Abre la imagen con el lector que le corresponde según su contenido: las PGM
+// con abrir_imagen() y el resto con LectorQImage. Devuelve NULL, con el motivo
+// en "error", si no se puede abrir.
+LectorImagen* abrir_imagen_qt(const QString& fichero, QString& error);
+
+#endif // IMAGEN_QT_H
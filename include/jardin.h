@@ -0,0 +1,69 @@
+#ifndef JARDIN_H
+#define JARDIN_H
+
+#include <vector>
+
+#include "tipos.h"
+
+// El jardín es una copia del contenido de las celdas de la ventana principal
+// que no depende de la interfaz gráfica. Los algoritmos que necesitan
+// recorrer el jardín muchas veces trabajan sobre esta copia, que se puede leer
+// desde varios hilos a la vez sin problemas.
+class Jardin {
+public:
+  Jardin(int filas = 0, int columnas = 0, const TipoCelda& tipo = CESPED_A);
+
+  // Accesores
+  int filas() const { return rows; }
+  int columnas() const { return columns; }
+  int celdas() const { return rows*columns; }
+  int indice(int fila, int columna) const { return fila*columns + columna; }
+  Posicion posicion(int indice) const { return Posicion(indice/columns, indice%columns); }
+  bool dentro(int fila, int columna) const {
+    return fila >= 0 && fila < rows && columna >= 0 && columna < columns;
+  }
+  TipoCelda tipo(int fila, int columna) const { return tipos[indice(fila, columna)]; }
+  void set_tipo(int fila, int columna, const TipoCelda& tipo) { tipos[indice(fila, columna)] = tipo; }
+  Terreno terreno(int fila, int columna) const { return terrenos[indice(fila, columna)]; }
+  void set_terreno(int fila, int columna, Terreno terreno) { terrenos[indice(fila, columna)] = terreno; }
+
+  // Coste de entrar en la celda según su terreno.
+  int coste(int fila, int columna) const { return coste_terreno(terreno(fila, columna)); }
+
+  // Indica si hay alguna celda con un terreno distinto del llano.
+  bool ponderado() const;
+
+  // Resumen de las dimensiones y del contenido de todas las celdas. Dos
+  // jardines distintos casi nunca tienen la misma huella, así que sirve para
+  // comprobar que algo guardado corresponde a este jardín.
+  unsigned huella() const;
+
+  // Indica si los dos jardines tienen las mismas dimensiones y el mismo
+  // contenido en todas las celdas.
+  bool operator==(const Jardin& otro) const {
+    return rows == otro.rows && columns == otro.columns && tipos == otro.tipos &&
+           terrenos == otro.terrenos;
+  }
+
+  // Indica si la cortadora puede entrar en la celda. Sigue el mismo criterio
+  // que Cortadora::hay_obstaculo(): ni obstáculos, ni el punto de inicio ni
+  // posiciones fuera de los límites.
+  bool transitable(int fila, int columna) const;
+
+  // Calcula mediante una búsqueda en anchura el número de movimientos
+  // necesarios para llegar desde el origen a cada una de las celdas. Las
+  // celdas inalcanzables quedan con distancia -1.
+  void distancias(const Posicion& origen, std::vector<int>& dist) const;
+
+  // Busca el camino más corto entre dos puntos y lo devuelve como la lista de
+  // movimientos que hay que hacer. Devuelve false si no existe.
+  bool camino(const Posicion& origen, const Posicion& destino,
+              std::vector<Movimientos>& movs) const;
+
+private:
+  int rows, columns;
+  std::vector<TipoCelda> tipos;
+  std::vector<Terreno> terrenos;
+};
+
+#endif // JARDIN_H
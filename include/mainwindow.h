@@ -7,11 +7,19 @@
 #include <QPixmap>
 #include <QString>
 
+#include "archivo.h"
 #include "celda.h"
+#include "generador.h"
+#include "jardin.h"
+#include "trazo.h"
+#include "visitas.h"
 
 // Declaración adelantada de clases para no incluir aquí todas las cabeceras.
+class CoberturaReanudable;
 class Cortadora;
+class PublicadorTelemetria;
 class QProgressBar;
+class QThread;
 class QGraphicsScene;
 class QGraphicsRectItem;
 
@@ -34,8 +42,10 @@ public:
   void ImgMod(int fila, int columna, const TipoCelda& tipo);
   void resize(int filas, int columnas);
   void set_pos(int fila, int columna, const TipoCelda& tipo);
+  void set_terreno(int fila, int columna, Terreno terreno);
 
-  // Funciones de guardado y de carga
+  // Funciones de guardado y de carga. Ambas trabajan en segundo plano y
+  // terminan cuando el hilo de ficheros avisa de que ha acabado.
   void save();
   void load();
 
@@ -47,31 +57,78 @@ public:
   int get_fin_x() const { return fin_x; }
   int get_fin_y() const { return fin_y; }
   Celda* get_pos(int fila, int columna) const { return label_list[fila][columna]; }
+  const std::vector<Posicion>& get_puntos() const { return puntos; }
+
+  // Copia del contenido actual del jardín, independiente de la interfaz.
+  Jardin jardin() const;
 
 public slots:
   void on_bAleatorio_clicked();
 
+signals:
+  // Peticiones al hilo que lee y escribe los ficheros
+  void cargar_fichero(const QString& fichero);
+  void guardar_fichero(const QString& fichero, const DatosJardin& datos);
+  void importar_fichero(LectorImagen* lector, const OpcionesImagen& opciones);
+
 private slots:
   // Código ejecutado al pulsar botones
+  void on_bAgentes_clicked();
   void on_bCamino_clicked();
+  void on_bCoste_clicked();
+  void on_bDeshacer_clicked();
+  void on_bExplorar_clicked();
+  void on_bGiros_clicked();
+  void on_bHistorial_clicked();
+  void on_bMoviles_clicked();
+  void on_bPlato_clicked();
+  void on_bPlazo_clicked();
   void on_bPruebas_clicked();
+  void on_bPuntoControl_clicked();
+  void on_bPuntos_clicked();
+  void on_bReanudar_clicked();
   void on_bReset_clicked();
+  void on_bRuta_clicked();
+  void on_bSaltos_clicked();
   void on_bSimular_clicked();
+  void on_bVisitas_clicked();
   void on_cbEdicion_clicked(bool checked);
+  void on_cbTelemetria_clicked(bool checked);
+  void on_cbVisitas_clicked(bool checked);
   void on_Celda_clicked(int fila, int columna);
+  void on_Celda_pulsada(int fila, int columna, bool derecho);
+  void on_Celda_arrastrada(int fila, int columna);
+  void on_Celda_soltada(int fila, int columna);
   void on_sbColumnas_valueChanged(int columnas);
   void on_sbFilas_valueChanged(int filas);
 
   // Acciones
   void on_actionAbrir_triggered();
   void on_actionAcerca_de_triggered();
+  void on_actionAnchura_triggered();
+  void on_actionBarrido_triggered();
   void on_actionGuardar_triggered();
   void on_actionGuardar_como_triggered();
+  void on_actionImportar_triggered();
   void on_actionNuevo_triggered();
   void on_actionSalir_triggered();
+  void on_actionTemporada_triggered();
+
+  // Respuestas del hilo de ficheros
+  void archivo_cargado(const DatosJardin& datos);
+  void archivo_guardado();
+  void archivo_error(const QString& titulo, const QString& mensaje);
 
 private:
+  void aplicar(const DatosJardin& datos);
+  void aplicar_cambios(const std::vector<CambioCelda>& cambios, unsigned desde = 0);
+  void conectar_celda(Celda* celda);
+  void cortar_reanudable(CoberturaReanudable& cobertura);
+  QString fichero_punto_control() const;
+  Pintura pintura() const;
+  DatosJardin datos_guardables() const;
   void lock_interface(bool b);
+  void quitar_punto(int fila, int columna);
 
 private:
   // Atributos del programa principal
@@ -79,6 +136,8 @@ private:
   QString filename;
   QProgressBar* progressBar;
   QGraphicsScene* scene;
+  QThread* hilo_archivos;
+  ArchivoJardin* archivo;
 
   // Atributos del jardín
   int rows, columns;
@@ -86,6 +145,35 @@ private:
   int fin_x, fin_y;
   Cortadora* corta;
 
+  // Veces que la cortadora ha pasado por cada celda
+  MapaVisitas visitas;
+
+  // Telemetría de la cortadora para otros procesos, si está activada
+  PublicadorTelemetria* telemetria;
+
+  // Cómo se generó el jardín, mientras no se cambie a mano
+  bool generado;
+  Generador generador;
+
+  // Trazo en curso de las herramientas de edición: si se borra con el botón
+  // derecho, la copia del jardín sobre la que se pinta y las celdas donde
+  // empezó y hasta donde ha llegado
+  bool trazando, borrando;
+  Herramienta herramienta;
+  Jardin lienzo;
+  Trazo trazo;
+  Posicion inicio_trazo, fin_trazo;
+
+  // Trazos que se pueden deshacer, el más reciente al final
+  std::vector<Trazo> historial;
+
+  // Si hay un corte con puntos de control en marcha y si se ha pedido
+  // detenerlo
+  bool cortando, detener;
+
+  // Puntos intermedios por los que tiene que pasar la ruta
+  std::vector<Posicion> puntos;
+
   // Matriz que representa el jardín, compuesta por celdas y matriz con los
   // rectángulos que forman el minimapa, para poder eliminarlos al
   // redimensionar el jardín.
@@ -100,6 +188,14 @@ private:
   const QPixmap cortadora;
   const QPixmap punto_a;
   const QPixmap punto_b;
+  const QPixmap punto_ruta;
+
+  // Imágenes del césped alto y cortado para cada terreno, teñidas a partir de
+  // las anteriores
+  std::vector<QPixmap> terreno_a, terreno_b;
+
+  // Imágenes del césped cortado en el mapa de visitas, de menos a más visitas
+  std::vector<QPixmap> calor;
 };
 
 #endif // MAINWINDOW_H
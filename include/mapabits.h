@@ -0,0 +1,94 @@
+#ifndef MAPABITS_H
+#define MAPABITS_H
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include <QtGlobal>
+
+#include "jardin.h"
+
+// Jardín guardado como mapa de bits: cada fila es una secuencia de palabras de
+// 64 bits en la que cada bit indica si la celda correspondiente está activa
+// (por ejemplo, si la cortadora puede entrar en ella). Cada fila tiene una
+// palabra vacía a cada lado y hay una fila vacía encima y otra debajo del
+// jardín, de forma que los desplazamientos nunca se salen de la memoria.
+//
+// Las búsquedas en anchura se hacen por frentes de onda: el siguiente frente
+// se obtiene de una vez para 64 celdas desplazando las palabras del frente
+// actual a izquierda, derecha, arriba y abajo y quitando los bits de celdas
+// no transitables o ya visitadas. Si se compila con AVX2 se procesan cuatro
+// palabras a la vez.
+class MapaBits {
+public:
+  // Mapa vacío con las dimensiones indicadas.
+  MapaBits(int filas = 0, int columnas = 0);
+
+  // Mapa con las celdas transitables del jardín.
+  explicit MapaBits(const Jardin& jardin);
+
+  int filas() const { return rows; }
+  int columnas() const { return columns; }
+
+  bool activa(int fila, int columna) const {
+    return (bits[palabra(fila, columna/64)] >> (columna%64)) & 1;
+  }
+  void activar(int fila, int columna, bool valor = true) {
+    quint64 mascara = quint64(1) << (columna%64);
+    if(valor)
+      bits[palabra(fila, columna/64)] |= mascara;
+    else
+      bits[palabra(fila, columna/64)] &= ~mascara;
+  }
+
+  // Número de celdas activas.
+  int cuenta() const;
+
+  // Distancia desde el origen a cada celda, igual que Jardin::distancias():
+  // -1 en las celdas inalcanzables. El origen no tiene por qué estar activo.
+  void capas(const Posicion& origen, std::vector<int>& dist) const;
+
+  // Número de celdas activas alcanzables desde el origen. Como no necesita
+  // distancias, rellena fila a fila extendiendo los bits a lo largo de los
+  // tramos libres en lugar de avanzar de frente en frente.
+  int alcanzables(const Posicion& origen) const;
+
+  // Memoria de mas_cercana() que se reutiliza entre búsquedas sobre el mismo
+  // mapa, igual que en los planificadores. Cada búsqueda deja a cero sólo las
+  // palabras por las que ha pasado, así que cuesta lo que explora y no lo que
+  // mide el jardín.
+  struct Memoria {
+    std::vector<quint64> visitadas, bits[2];
+    std::vector<int> ini[2], fin[2], filas[2];
+    std::vector<std::vector<std::pair<int, quint64> > > niveles;
+  };
+
+  // Busca la celda de "objetivos" más cercana al origen y devuelve en "movs"
+  // el camino más corto hasta ella. Devuelve su distancia o -1 si no hay
+  // ninguna alcanzable. A igual distancia se queda con la de más arriba y,
+  // dentro de la fila, con la de más a la izquierda.
+  int mas_cercana(const Posicion& origen, const MapaBits& objetivos,
+                  std::vector<Movimientos>& movs, Memoria& mem) const;
+
+  // Indica si el programa se ha compilado con las instrucciones AVX2.
+  static bool avx2();
+
+private:
+  // Frente de onda de una búsqueda. Para cada fila se guarda el rango de
+  // palabras no vacías, para no recorrer las partes del jardín por las que
+  // no pasa el frente.
+  struct Frente;
+
+  int palabra(int fila, int indice) const { return (fila+1)*ancho + indice + 1; }
+  int expandir(Frente& frente, Frente& siguiente, std::vector<quint64>& visitadas,
+               std::vector<int>* dist = NULL, int d = 0) const;
+
+  int rows, columns;
+
+  // Palabras por fila sin contar las dos vacías de los lados y con ellas
+  int palabras, ancho;
+  std::vector<quint64> bits;
+};
+
+#endif // MAPABITS_H
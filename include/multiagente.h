@@ -0,0 +1,61 @@
+#ifndef MULTIAGENTE_H
+#define MULTIAGENTE_H
+
+#include <vector>
+
+#include "jardin.h"
+
+// Planificación conjunta de varias cortadoras, cada una con su punto de
+// partida y su destino, de forma que nunca haya dos en la misma celda ni dos
+// que se crucen intercambiando sus posiciones.
+
+struct Agente {
+  Agente(const Posicion& inicio = Posicion(), const Posicion& destino = Posicion()):
+    inicio(inicio), destino(destino) {}
+
+  Posicion inicio, destino;
+};
+
+struct PlanMultiagente {
+  PlanMultiagente(): suma_costes(0), makespan(0), suma_minimos(0), expandidos(0),
+    intentos(0), tiempo_us(0), exito(false) {}
+
+  // Posición de cada agente en cada instante, empezando por el 0. Al llegar
+  // al destino se queda allí, aunque su lista termine antes que las demás.
+  std::vector<std::vector<Posicion> > caminos;
+
+  // Suma de los instantes de llegada de todos los agentes y el mayor de ellos
+  int suma_costes, makespan;
+
+  // Suma de las distancias mínimas de cada agente ignorando a los demás, que
+  // es una cota inferior de la suma de costes
+  int suma_minimos;
+
+  int expandidos;
+
+  // Órdenes de prioridad probados hasta encontrar uno que funcione
+  int intentos;
+
+  long long tiempo_us;
+  bool exito;
+};
+
+// Planificación por prioridades: los agentes se planifican de uno en uno con
+// A* en espacio-tiempo, evitando lo que ya han reservado los anteriores en
+// una TablaReservas. Si alguno no encuentra camino se pasa al principio de la
+// lista y se vuelve a empezar, hasta "max_intentos" veces. Los caminos se
+// devuelven en el orden de "agentes".
+PlanMultiagente planificar_agentes(const Jardin& jardin,
+                                   const std::vector<Agente>& agentes,
+                                   int max_intentos = 10);
+
+// Comprueba que ningún par de agentes coincide en una celda ni se cruza. Un
+// plan fallido o con algún camino vacío no se da por bueno.
+bool sin_conflictos(const PlanMultiagente& plan);
+
+// Elige "cantidad" agentes con el inicio y el destino en celdas de césped
+// distintas y el destino alcanzable desde el inicio.
+std::vector<Agente> agentes_aleatorios(const Jardin& jardin, int cantidad,
+                                       unsigned semilla);
+
+#endif // MULTIAGENTE_H
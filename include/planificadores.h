@@ -0,0 +1,82 @@
+#ifndef PLANIFICADORES_H
+#define PLANIFICADORES_H
+
+#include <cstddef>
+#include <vector>
+
+#include "jardin.h"
+
+// Versiones de los algoritmos de la cortadora que trabajan sobre una copia del
+// jardín en lugar de sobre la interfaz. Hacen exactamente los mismos
+// movimientos que Cortadora::cortar_cesped() y Cortadora::reach(), pero sin
+// dibujar nada ni esperar, así que sirven para evaluarlos en miles de
+// jardines y desde varios hilos a la vez.
+
+// Resultado de ejecutar un algoritmo sobre un jardín.
+struct Resultado {
+  Resultado(): movimientos(0), giros(0), coste(0), cortadas(0), cesped(0), expandidas(0),
+    exito(false) {}
+
+  int movimientos;
+
+  // Giros de 90 grados entre un movimiento y el siguiente
+  int giros;
+
+  // Suma del coste del terreno de cada celda en la que se entra. Si todo el
+  // jardín es llano coincide con el número de movimientos.
+  int coste;
+
+  // Celdas de césped cortadas y total de celdas de césped del jardín
+  int cortadas, cesped;
+
+  // Celdas expandidas por los planificadores que buscan un camino
+  int expandidas;
+
+  // Si se ha llegado al destino o se ha cortado todo lo alcanzable
+  bool exito;
+};
+
+// Búsqueda en profundidad para cortar todo el césped, como
+// Cortadora::cortar_cesped(). Se hace con una pila explícita para no
+// depender del tamaño de la pila del programa.
+Resultado cobertura_profundidad(const Jardin& jardin, const Posicion& inicio);
+
+// Cobertura que, en lugar de deshacer el camino al llegar a un callejón sin
+// salida como la búsqueda en profundidad, salta por el camino más corto a la
+// celda sin cortar más cercana. Los saltos pueden pasar por la celda de
+// inicio. Si se indica, devuelve en "movs" los movimientos realizados.
+Resultado cobertura_saltos(const Jardin& jardin, const Posicion& inicio,
+                           std::vector<Movimientos>* movs = NULL);
+
+// Acorta un recorrido ya hecho desde "inicio": conserva el orden en el que
+// se cortó cada celda por primera vez pero va de una a otra por el camino
+// más corto, saltándose las que ya se hayan cortado al pasar. El resultado
+// corta lo mismo que el recorrido original con, como mucho, los mismos
+// movimientos. Ambos pueden pasar por la celda de inicio.
+Resultado acortar_recorrido(const Jardin& jardin, const Posicion& inicio,
+                            const std::vector<Movimientos>& movs,
+                            std::vector<Movimientos>& acortado);
+
+// Algoritmo de escalada con vuelta atrás para ir de un punto a otro, como
+// Cortadora::reach().
+Resultado escalada(const Jardin& jardin, const Posicion& origen,
+                   const Posicion& destino);
+
+// Camino más corto entre dos puntos mediante búsqueda en anchura. Sirve de
+// referencia para saber cuánto se aleja la escalada del óptimo.
+Resultado camino_minimo(const Jardin& jardin, const Posicion& origen,
+                        const Posicion& destino);
+
+// Número de celdas de césped, en las que puede entrar la cortadora, que hay
+// en el jardín.
+int celdas_cesped(const Jardin& jardin);
+
+// Coste del terreno de un recorrido que empieza en "inicio".
+int coste_recorrido(const Jardin& jardin, const Posicion& inicio,
+                    const std::vector<Movimientos>& movs);
+
+// Giros de 90 grados de un recorrido. El primer movimiento no cuenta como
+// giro porque la cortadora se coloca ya orientada.
+int giros_recorrido(const std::vector<Movimientos>& movs);
+
+#endif // PLANIFICADORES_H
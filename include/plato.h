@@ -0,0 +1,35 @@
+#ifndef PLATO_H
+#define PLATO_H
+
+#include <cstddef>
+#include <vector>
+
+#include "planificadores.h"
+
+// Plato de corte que ocupa varias celdas. La posición de la cortadora es la
+// esquina superior izquierda del plato y en cada movimiento se corta todo lo
+// que queda debajo de él.
+struct PlatoCorte {
+  PlatoCorte(int filas = 1, int columnas = 1): filas(filas), columnas(columnas) {}
+
+  int filas, columnas;
+};
+
+// Si el plato colocado en "p" queda dentro del jardín sin pisar ningún
+// obstáculo ni el punto de inicio. La posición "inicio" sí se permite cuando
+// coincide con "p", porque es donde empieza la cortadora.
+bool cabe_plato(const Jardin& jardin, const Posicion& p, const PlatoCorte& plato,
+                const Posicion& inicio);
+
+// Cobertura con el plato indicado. Primero barre el jardín en pasadas
+// horizontales separadas tanto como filas tiene el plato, alternando el
+// sentido, y después va a por lo que haya quedado sin cortar junto a los
+// obstáculos yendo cada vez al sitio más cercano desde el que se corta algo.
+// En "cubribles" se devuelven las celdas de césped que quedan debajo del plato
+// en alguna posición alcanzable, que es lo máximo que se puede cortar.
+Resultado cobertura_plato(const Jardin& jardin, const Posicion& inicio,
+                          const PlatoCorte& plato,
+                          std::vector<Movimientos>* movs = NULL,
+                          int* cubribles = NULL);
+
+#endif // PLATO_H
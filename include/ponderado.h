@@ -0,0 +1,34 @@
+#ifndef PONDERADO_H
+#define PONDERADO_H
+
+#include <cstddef>
+#include <vector>
+
+#include "planificadores.h"
+
+// Planificadores que tienen en cuenta el terreno de cada celda y buscan el
+// camino de menor coste, no el de menos movimientos.
+
+// Algoritmo de Dijkstra con una cola por cubos. Como los costes son enteros
+// pequeños basta con MAX_COSTE_TERRENO+1 cubos que se reutilizan de forma
+// circular, así que cada celda se inserta y se extrae en tiempo constante.
+// Si se indica, devuelve en "movs" los movimientos del camino.
+Resultado dijkstra(const Jardin& jardin, const Posicion& origen,
+                   const Posicion& destino, std::vector<Movimientos>* movs = NULL);
+
+// Caminos de menor coste desde un mismo origen a varios destinos con una sola
+// búsqueda, que termina al llegar al último de ellos. Cada camino coincide
+// con el que devuelve dijkstra() para ese destino.
+void dijkstra_destinos(const Jardin& jardin, const Posicion& origen,
+                       const std::vector<Posicion>& destinos,
+                       std::vector<Resultado>& resultados,
+                       std::vector<std::vector<Movimientos> >* movs = NULL);
+
+// A* con la heurística multiplicada por "peso". Con peso 1 encuentra el camino
+// de menor coste; con pesos mayores expande menos celdas y el coste del
+// camino encontrado es como mucho "peso" veces el óptimo.
+Resultado a_estrella_ponderado(const Jardin& jardin, const Posicion& origen,
+                               const Posicion& destino, double peso,
+                               std::vector<Movimientos>* movs = NULL);
+
+#endif // PONDERADO_H
@@ -0,0 +1,70 @@
+#ifndef REANUDABLE_H
+#define REANUDABLE_H
+
+#include <vector>
+
+#include <QByteArray>
+#include <QString>
+
+#include "jardin.h"
+#include "planificadores.h"
+
+// Búsqueda en profundidad para cortar todo el césped, con los mismos
+// movimientos que cobertura_profundidad() y Cortadora::cortar_cesped(), pero
+// con todo su estado en el objeto en lugar de en la pila de llamadas. Así se
+// puede avanzar a trozos, guardar el estado en cualquier momento y seguir más
+// tarde desde el mismo punto, incluso en otra ejecución del programa.
+class CoberturaReanudable {
+public:
+  CoberturaReanudable(const Jardin& jardin, const Posicion& inicio);
+
+  // Hace como mucho "pasos" movimientos y, si se indica, los añade al final
+  // de "movs". Devuelve los movimientos hechos, que sólo son menos de los
+  // pedidos si la cobertura termina.
+  int avanzar(int pasos, std::vector<Movimientos>* movs = NULL);
+
+  bool terminada() const { return pila.empty(); }
+  const Resultado& resultado() const { return res; }
+
+  // Posición actual de la cortadora y celdas que ya ha cortado.
+  Posicion posicion() const { return actual; }
+  bool cortada(int fila, int columna) const { return cortadas[jardin.indice(fila, columna)]; }
+
+  // Estado completo en binario. Ocupa un bit por celda del jardín y un byte
+  // por cada nivel de la pila.
+  QByteArray guardar() const;
+
+  // Recupera un estado guardado por guardar(). Si el estado está dañado o es
+  // de otro jardín devuelve false y deja el actual como estaba.
+  bool cargar(const QByteArray& estado);
+
+private:
+  // Cada nivel de la pila es una celda, el movimiento con el que se llegó a
+  // ella y el siguiente movimiento que queda por probar desde ella
+  struct Nivel {
+    Posicion pos;
+    int llegada, siguiente;
+  };
+
+  void girar(Movimientos mov);
+
+  Jardin jardin;
+  Posicion inicio, actual;
+  std::vector<char> cortadas;
+  std::vector<Nivel> pila;
+  Resultado res;
+
+  // Último movimiento hecho, para contar los giros, o -1 antes del primero
+  int anterior;
+};
+
+// Escribe un punto de control en disco. Se escribe primero en un fichero
+// temporal, se lleva al disco y después sustituye al anterior, de forma que
+// si el programa se interrumpe a medias sigue quedando el punto de control
+// anterior entero.
+bool guardar_punto_control(const QString& fichero, const QByteArray& estado);
+
+// Lee un punto de control. Devuelve false si no existe o no se puede leer.
+bool leer_punto_control(const QString& fichero, QByteArray& estado);
+
+#endif // REANUDABLE_H
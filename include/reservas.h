@@ -0,0 +1,62 @@
+#ifndef RESERVAS_H
+#define RESERVAS_H
+
+#include <utility>
+#include <vector>
+
+#include "jardin.h"
+
+// Tabla de reservas en espacio y tiempo. Guarda qué celdas van a estar
+// ocupadas en cada instante y qué pasos entre celdas se van a dar, para que
+// un planificador pueda evitar tanto coincidir en una celda con otro objeto
+// como cruzarse con él intercambiando las posiciones.
+//
+// Las reservas se guardan por celda en listas cortas sin ordenar, porque por
+// cada celda sólo pasan unos pocos objetos. Así reservar es inmediato y
+// vaciar la tabla sólo cuesta lo que se haya reservado, lo que permite
+// rehacerla en cada instante de una simulación.
+class TablaReservas {
+public:
+  explicit TablaReservas(const Jardin& jardin);
+
+  // Borra todas las reservas.
+  void limpiar();
+
+  // Reserva la celda en el instante indicado.
+  void reservar(const Posicion& p, int instante);
+
+  // Reserva el paso de "desde" a "hasta" que empieza en el instante indicado,
+  // incluida la celda de llegada en el instante siguiente.
+  void reservar_paso(const Posicion& desde, const Posicion& hasta, int instante);
+
+  // Reserva la celda para siempre a partir del instante indicado. Es lo que
+  // ocupa un objeto que se queda parado al final de su recorrido.
+  void reservar_desde(const Posicion& p, int instante);
+
+  // Indica si la celda está libre en el instante indicado.
+  bool libre(const Posicion& p, int instante) const;
+
+  // Indica si la celda está libre en el instante indicado y en todos los
+  // siguientes, que es lo que necesita un objeto para quedarse parado en ella.
+  bool libre_desde(const Posicion& p, int instante) const;
+
+  // Indica si se puede ir de "desde" a "hasta" empezando en el instante
+  // indicado: la celda de llegada tiene que estar libre en el instante
+  // siguiente y nadie puede estar haciendo el paso contrario a la vez.
+  bool paso_libre(const Posicion& desde, const Posicion& hasta, int instante) const;
+
+private:
+  int celda(const Posicion& p) const { return p.fila*columnas + p.columna; }
+  void tocar(int celda);
+
+  int columnas;
+  std::vector<std::vector<int> > vertices;
+  std::vector<std::vector<std::pair<int, int> > > aristas;
+  std::vector<int> permanentes;
+
+  // Celdas con alguna reserva, para poder vaciar la tabla rápidamente
+  std::vector<int> tocadas;
+  std::vector<bool> tocada;
+};
+
+#endif // RESERVAS_H
@@ -0,0 +1,37 @@
+#ifndef RUTA_H
+#define RUTA_H
+
+#include <cstddef>
+#include <vector>
+
+#include "jardin.h"
+
+// Funciones para planificar una ruta que pase por muchos puntos del jardín
+// dando el menor número de pasos posible. El primero de los puntos es siempre
+// la posición de salida de la cortadora.
+
+// Calcula la distancia entre cada par de puntos. Cada fila de la matriz es una
+// búsqueda en anchura independiente, así que se reparten entre todos los
+// núcleos del procesador. Las parejas sin camino quedan con distancia -1.
+void matriz_distancias(const Jardin& jardin, const std::vector<Posicion>& puntos,
+                       std::vector<std::vector<int> >& matriz);
+
+// Decide el orden de visita de los puntos a partir de la matriz de distancias.
+// Construye una ruta inicial con el vecino más cercano y la mejora con 2-opt
+// y Or-opt hasta que ninguno de los dos consigue acortarla. La ruta empieza
+// en el punto 0 y sólo contiene los puntos alcanzables desde él.
+// Si se indica, en "inicial" se devuelve la longitud de la ruta del vecino
+// más cercano antes de mejorarla.
+std::vector<int> ordenar_ruta(const std::vector<std::vector<int> >& matriz,
+                              int* inicial = NULL);
+
+// Número de movimientos total de la ruta indicada.
+int longitud_ruta(const std::vector<std::vector<int> >& matriz,
+                  const std::vector<int>& orden);
+
+// Traduce el orden de visita a la lista de movimientos que tiene que hacer la
+// cortadora, uniendo cada par de puntos consecutivos por el camino más corto.
+void movimientos_ruta(const Jardin& jardin, const std::vector<Posicion>& puntos,
+                      const std::vector<int>& orden, std::vector<Movimientos>& movs);
+
+#endif // RUTA_H
@@ -0,0 +1,187 @@
+#ifndef SERVICIO_H
+#define SERVICIO_H
+
+#include <map>
+#include <vector>
+
+#include <QByteArray>
+#include <QSharedPointer>
+#include <QString>
+#include <QWeakPointer>
+
+#include "jardin.h"
+#include "planificadores.h"
+
+// Parte del servicio de planificación que no depende de la comunicación: el
+// protocolo binario, la caché de jardines, el reparto de las peticiones en
+// lotes y las medidas de rendimiento. El servidor, que escucha en un socket
+// local, está en tools/servicio.
+//
+// Cada mensaje va precedido de su longitud en bytes y, como en los ficheros
+// .garden, todos los enteros ocupan 4 bytes en little endian.
+
+// Lo que se pide al servicio.
+enum OperacionPlan {
+  PLAN_COBERTURA,    // Cortar todo el césped desde el origen (con saltos)
+  PLAN_CAMINO,       // Camino de menor coste del origen al destino
+  PLAN_ESTADISTICAS, // Medidas del servicio; no necesita jardín
+  NUM_OPERACIONES_PLAN
+};
+
+// Cómo indica la petición el jardín sobre el que se planifica.
+enum FuenteJardin {
+  JARDIN_HUELLA,  // Huella de un jardín que el servicio ya tiene en la caché
+  JARDIN_DATOS,   // Contenido completo de un fichero .garden
+  JARDIN_FICHERO, // Ruta de un fichero .garden en la máquina del servicio
+  NUM_FUENTES_JARDIN
+};
+
+enum EstadoPlan {PLAN_HECHO, PLAN_JARDIN_DESCONOCIDO, PLAN_MAL_FORMADA};
+
+// Mayor mensaje que se acepta, para no reservar memoria sin límite si llega
+// una longitud dañada.
+static const int MAX_MENSAJE = 256*1024*1024;
+
+struct PeticionPlan {
+  PeticionPlan(): id(0), operacion(PLAN_CAMINO), fuente(JARDIN_HUELLA), huella(0) {}
+
+  // Lo elige el cliente y se devuelve en la respuesta, que puede llegar en
+  // otro orden que las peticiones
+  int id;
+  OperacionPlan operacion;
+  Posicion origen, destino;
+  FuenteJardin fuente;
+
+  // Con JARDIN_HUELLA, la huella del jardín. Con JARDIN_DATOS, el contenido
+  // del fichero, y con JARDIN_FICHERO, la ruta en UTF-8
+  unsigned huella;
+  QByteArray jardin;
+};
+
+// Medidas del servicio sobre las respuestas de los últimos segundos.
+struct MedidasServicio {
+  MedidasServicio(): atendidas(0), en_cola(0), jardines(0), p50_us(0), p99_us(0),
+    por_segundo(0) {}
+
+  // Planificaciones resueltas desde que arrancó el servicio, peticiones
+  // esperando o en proceso y jardines en la caché
+  int atendidas, en_cola, jardines;
+  double p50_us, p99_us, por_segundo;
+};
+
+struct RespuestaPlan {
+  RespuestaPlan(): id(0), operacion(PLAN_CAMINO), estado(PLAN_HECHO), huella(0) {}
+
+  int id;
+  OperacionPlan operacion;
+  EstadoPlan estado;
+
+  // Huella del jardín usado, para que el cliente lo pueda pedir por ella
+  // en las siguientes peticiones
+  unsigned huella;
+
+  Resultado resultado;
+  std::vector<Movimientos> movs;
+  MedidasServicio medidas;
+};
+
+// Codificación de los mensajes. Los movimientos de la respuesta ocupan dos
+// bits cada uno.
+QByteArray codificar_peticion(const PeticionPlan& peticion);
+bool decodificar_peticion(const QByteArray& mensaje, PeticionPlan& peticion);
+QByteArray codificar_respuesta(const RespuestaPlan& respuesta);
+bool decodificar_respuesta(const QByteArray& mensaje, RespuestaPlan& respuesta);
+
+// Añade la longitud delante del mensaje.
+QByteArray enmarcar(const QByteArray& mensaje);
+
+// Saca del principio de "buffer" el primer mensaje completo. Devuelve 1 si lo
+// ha sacado, 0 si todavía no ha llegado entero y -1 si la longitud no es
+// válida, en cuyo caso no se puede seguir leyendo de esa conexión.
+int extraer_mensaje(QByteArray& buffer, QByteArray& mensaje);
+
+// Jardines que ya ha recibido el servicio, por su huella. Cuando se llena se
+// descarta el que lleva más tiempo sin usarse. Los jardines se comparten con
+// los lotes en proceso, así que descartarlos nunca invalida un lote.
+class CacheJardines {
+public:
+  explicit CacheJardines(int capacidad = 16);
+
+  // Jardín sobre el que trabaja la petición. Los que llegan por su contenido
+  // o por su fichero se añaden a la caché; los ficheros sólo se vuelven a
+  // leer si han cambiado. Devuelve un puntero nulo si el jardín no está o no
+  // se puede leer.
+  QSharedPointer<const Jardin> jardin(const PeticionPlan& peticion, unsigned& huella);
+
+  int jardines() const { return entradas.size(); }
+
+private:
+  struct Entrada {
+    QSharedPointer<const Jardin> jardin;
+    qint64 uso;
+  };
+
+  // Huella, fecha de modificación y tamaño de un fichero ya leído, y el
+  // jardín que se leyó, por si otro con la misma huella lo ha sustituido
+  struct Fichero {
+    unsigned huella;
+    qint64 modificado, tamano;
+    QWeakPointer<const Jardin> jardin;
+  };
+
+  QSharedPointer<const Jardin> buscar(unsigned huella);
+  QSharedPointer<const Jardin> anadir(const Jardin& jardin, unsigned& huella);
+
+  int capacidad;
+  qint64 usos;
+  std::map<unsigned, Entrada> entradas;
+  std::map<QString, Fichero> ficheros;
+};
+
+// Peticiones sobre el mismo jardín con la misma operación y el mismo origen,
+// que se resuelven con una sola búsqueda. "etiquetas" no se usa aquí: sirve
+// a quien forma el lote para saber a quién va cada respuesta.
+struct LotePlan {
+  QSharedPointer<const Jardin> jardin;
+  unsigned huella;
+  std::vector<PeticionPlan> peticiones;
+  std::vector<int> etiquetas;
+  std::vector<RespuestaPlan> respuestas;
+};
+
+// Añade la petición al lote que le corresponde dentro de "lotes", o a uno
+// nuevo. "indices" guarda qué lote hay para cada clave y se debe vaciar al
+// empezar una nueva tanda de lotes.
+typedef std::map<std::vector<unsigned>, int> IndiceLotes;
+void agrupar_peticion(const PeticionPlan& peticion, int etiqueta,
+                      const QSharedPointer<const Jardin>& jardin, unsigned huella,
+                      std::vector<LotePlan>& lotes, IndiceLotes& indices);
+
+// Resuelve todas las peticiones del lote y rellena sus respuestas. Se puede
+// llamar desde varios hilos a la vez con lotes distintos.
+void atender_lote(LotePlan& lote);
+
+// Latencias y ritmo de las respuestas. Guarda las últimas MUESTRAS y calcula
+// las medidas con las de la ventana de los últimos segundos.
+class MedidorServicio {
+public:
+  MedidorServicio();
+
+  // Anota una respuesta: cuándo llegó la petición y cuándo se respondió,
+  // en nanosegundos desde cualquier origen común.
+  void anotar(qint64 llegada_ns, qint64 respuesta_ns);
+
+  MedidasServicio medidas(qint64 ahora_ns, int en_cola, int jardines) const;
+
+private:
+  struct Muestra {
+    qint64 instante, latencia;
+  };
+
+  std::vector<Muestra> muestras;
+  unsigned siguiente;
+  int atendidas;
+  qint64 primera;
+};
+
+#endif // SERVICIO_H
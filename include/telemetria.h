@@ -0,0 +1,133 @@
+#ifndef TELEMETRIA_H
+#define TELEMETRIA_H
+
+#include <vector>
+
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QSharedMemory>
+#include <QString>
+
+#include "tipos.h"
+
+// Telemetría de la cortadora para procesos externos. Cada muestra es un
+// registro de tamaño fijo que se escribe en un anillo en memoria compartida.
+// El publicador nunca espera a los consumidores: si uno se retrasa pierde
+// los registros más antiguos o, si así se elige, el publicador agrupa varias
+// muestras en una sola, de forma que la simulación no se frena nunca.
+
+enum EventoTelemetria {
+  TELEMETRIA_INICIO,     // La cortadora se coloca para empezar un recorrido
+  TELEMETRIA_MOVIMIENTO, // La cortadora se ha movido
+  TELEMETRIA_FIN,        // El recorrido ha terminado
+  NUM_EVENTOS_TELEMETRIA
+};
+
+// Qué hace el publicador cuando el consumidor no lee al ritmo al que se
+// escribe.
+enum PoliticaTelemetria {
+  TELEMETRIA_DESCARTAR, // Se escribe todo y el consumidor pierde lo más antiguo
+  TELEMETRIA_AGRUPAR    // Se escribe sólo de vez en cuando el último estado
+};
+
+// Muestra del estado de la cortadora. Los contadores son acumulados desde el
+// último inicio, así que un registro resume todos los anteriores.
+struct RegistroTelemetria {
+  RegistroTelemetria(): secuencia(0), evento(TELEMETRIA_MOVIMIENTO), tiempo_us(0),
+    movimientos(0), cortadas(0), paso_us(0), agrupados(0) {}
+
+  // Número del registro en el anillo, empezando por 1
+  unsigned secuencia;
+  EventoTelemetria evento;
+
+  // Tiempo desde el inicio del recorrido y desde la muestra anterior
+  qint64 tiempo_us;
+  Posicion pos;
+  int movimientos, cortadas;
+  int paso_us;
+
+  // Muestras que resume este registro: 1 salvo si se han agrupado
+  int agrupados;
+};
+
+// Formato de un registro: secuencia y evento, el tiempo en 8 bytes y el
+// resto de campos en 4 bytes cada uno, todo en little endian.
+static const int TAMANO_REGISTRO = 40;
+void codificar_registro(const RegistroTelemetria& registro, char* destino);
+RegistroTelemetria decodificar_registro(const char* origen);
+
+// Escribe la telemetría en el segmento de memoria compartida con la clave
+// indicada. La capacidad del anillo se redondea a una potencia de 2.
+class PublicadorTelemetria {
+public:
+  PublicadorTelemetria(const QString& clave, int capacidad = 4096,
+                       PoliticaTelemetria politica = TELEMETRIA_AGRUPAR);
+  ~PublicadorTelemetria();
+
+  // Si se ha podido crear el segmento y, si no, por qué.
+  bool activo() const { return datos != NULL; }
+  QString error() const { return memoria.errorString(); }
+  QString clave() const { return memoria.key(); }
+
+  // Empieza un recorrido en la posición indicada. Si el anterior no había
+  // terminado, antes se publica su fin.
+  void empezar(const Posicion& pos);
+
+  // Movimiento a una posición nueva, cortando en ella "cortadas" celdas.
+  void mover(const Posicion& pos, int cortadas);
+
+  // Celdas cortadas sin moverse, que se publican con el siguiente movimiento.
+  void cortar(int cortadas) { actual.cortadas += cortadas; }
+
+  // Publica el fin del recorrido con el último estado. No hace nada si no
+  // hay un recorrido en marcha.
+  void terminar();
+
+  // Registros escritos y muestras que se han agrupado con otras.
+  unsigned escritos() const { return secuencia; }
+  int agrupadas() const { return total_agrupadas; }
+
+private:
+  void muestra(EventoTelemetria evento, const Posicion& pos);
+  void escribir();
+
+  QSharedMemory memoria;
+  char* datos;
+  unsigned capacidad, secuencia;
+  PoliticaTelemetria politica;
+  QElapsedTimer reloj;
+  qint64 ultima_muestra_ns, ultimo_escrito_ns;
+  RegistroTelemetria actual;
+  bool en_marcha;
+  int total_agrupadas;
+};
+
+// Lee la telemetría de un publicador. Cada lector lleva su propia posición;
+// al leer la anota en el segmento para que el publicador sepa si se está
+// quedando atrás. Con varios lectores cuenta el último que la ha anotado.
+class LectorTelemetria {
+public:
+  explicit LectorTelemetria(const QString& clave);
+
+  // Se conecta al segmento. Devuelve false si todavía no existe o no es de
+  // un publicador de telemetría.
+  bool conectar();
+  bool conectado() const { return datos != NULL; }
+
+  // Añade a "registros" como mucho "maximo" registros nuevos y devuelve
+  // cuántos ha añadido. Al conectarse se empieza por el más antiguo que
+  // sigue en el anillo.
+  int leer(std::vector<RegistroTelemetria>& registros, int maximo = 1 << 30);
+
+  // Registros que se han perdido por leer demasiado tarde.
+  qint64 perdidos() const { return total_perdidos; }
+
+private:
+  QSharedMemory memoria;
+  char* datos;
+  unsigned capacidad, siguiente;
+  int sesion;
+  qint64 total_perdidos;
+};
+
+#endif // TELEMETRIA_H
@@ -0,0 +1,94 @@
+#ifndef TEMPORADA_H
+#define TEMPORADA_H
+
+#include <vector>
+
+#include <QString>
+
+#include "jardin.h"
+
+// Simulación de una temporada de cortes diarios. En lugar de una sola pasada
+// en la que el césped queda cortado para siempre, cada celda crece cada día
+// a su ritmo y vuelve a estar alta si no se corta. La cortadora sale de la
+// base, en la celda (0, 0), una vez al día con un límite de movimientos que
+// incluye la vuelta, y el planificador elige por dónde pasar para que la
+// hierba más alta del jardín sea lo más baja posible.
+
+enum EstrategiaTemporada {
+  TEMPORADA_ADAPTATIVA, // Como la cíclica, saltando lo que puede esperar a la siguiente vuelta
+  TEMPORADA_CICLICA,    // Siempre el mismo recorrido, siguiendo donde se dejó
+  NUM_ESTRATEGIAS_TEMPORADA
+};
+
+// Nombre legible de cada estrategia.
+const char* nombre_estrategia_temporada(EstrategiaTemporada estrategia);
+
+struct ConfiguracionTemporada {
+  ConfiguracionTemporada();
+
+  int dias;
+
+  // Movimientos por día, contando la vuelta a la base. Con 0 se usa lo
+  // necesario para recorrer todo el jardín en unos días
+  int presupuesto;
+
+  // Crecimiento diario en el terreno llano, en milímetros. En el resto de
+  // terrenos se multiplica por un factor: la hierba densa crece más deprisa
+  // y la de la grava más despacio
+  double crecimiento;
+
+  // Altura a la que deja la hierba la cortadora y altura al empezar la
+  // temporada, en milímetros
+  double altura_corte, altura_inicial;
+
+  EstrategiaTemporada estrategia;
+};
+
+// Estado del jardín al final de un día.
+struct DiaTemporada {
+  DiaTemporada(): movimientos(0), cortadas(0), altura_max(0), altura_media(0), dias_max(0),
+    dias_media(0) {}
+
+  int movimientos;
+
+  // Celdas distintas cortadas en el día
+  int cortadas;
+
+  // Altura de la hierba en milímetros y días desde el último corte, sobre
+  // las celdas a las que puede llegar la cortadora
+  double altura_max, altura_media;
+  int dias_max;
+  double dias_media;
+};
+
+struct InformeTemporada {
+  InformeTemporada(): alcanzables(0), inalcanzables(0), sin_recorrer(0), presupuesto(0),
+    recorrido(0), altura_max(0), dias_max(0), movimientos(0), tiempo_ms(0) {}
+
+  std::vector<DiaTemporada> dias;
+
+  // Celdas de césped a las que se puede llegar desde la base y a las que no
+  int alcanzables, inalcanzables;
+
+  // Celdas alcanzables por las que no pasa el recorrido completo, que nunca
+  // se cortan. Tiene que ser 0
+  int sin_recorrer;
+
+  // Movimientos por día usados y los que hacen falta para cortarlo todo
+  int presupuesto, recorrido;
+
+  // Peores valores de toda la temporada y total de movimientos
+  double altura_max;
+  int dias_max;
+  long long movimientos;
+
+  long long tiempo_ms;
+};
+
+// Simula la temporada completa sobre el jardín.
+InformeTemporada simular_temporada(const Jardin& jardin, const ConfiguracionTemporada& config);
+
+// Da formato de texto al informe, con un resumen y una línea por día.
+QString texto_temporada(const InformeTemporada& informe, const ConfiguracionTemporada& config);
+
+#endif // TEMPORADA_H
@@ -0,0 +1,88 @@
+#ifndef TIPOS_H
+#define TIPOS_H
+
+// Los tipos de celda son las distintas cosas que pueden haber en cada una de
+// las secciones del jardín.
+// Los tipos nuevos se añaden siempre al final para no cambiar el valor de los
+// que ya están guardados en los ficheros .garden.
+enum TipoCelda {CESPED_A, CESPED_B, OBSTACULO, INICIO, CORTADORA, PUNTO_A, PUNTO_B,
+                PUNTO_RUTA};
+
+// Tipos de terreno. Son independientes del tipo de celda, de forma que el
+// césped sigue siendo grava o pendiente después de cortarlo. Igual que con los
+// tipos de celda, los nuevos se añaden al final.
+enum Terreno {LLANO, DENSO, GRAVA, PENDIENTE, NUM_TERRENOS};
+
+// Coste de entrar en una celda con el terreno indicado. Son enteros pequeños
+// para que los planificadores puedan usar colas por cubos.
+inline int coste_terreno(Terreno terreno){
+  switch(terreno){
+  case DENSO:
+    return 2;
+  case GRAVA:
+    return 3;
+  case PENDIENTE:
+    return 5;
+  default:
+    return 1;
+  }
+}
+
+// Mayor coste que puede tener un movimiento.
+static const int MAX_COSTE_TERRENO = 5;
+
+// Movimientos que puede realizar la cortadora.
+enum Movimientos {ARRIBA, ABAJO, IZQUIERDA, DERECHA};
+
+// Los movimientos en el orden en el que los prueba la cortadora. Los
+// algoritmos que recorren las vecinas de una celda usan el mismo.
+static const Movimientos MOVIMIENTOS[4] = {ARRIBA, ABAJO, IZQUIERDA, DERECHA};
+
+// Posición de una celda dentro del jardín.
+struct Posicion {
+  Posicion(int f = 0, int c = 0): fila(f), columna(c) {}
+  bool operator==(const Posicion& p) const { return fila == p.fila && columna == p.columna; }
+  bool operator!=(const Posicion& p) const { return !(*this == p); }
+
+  int fila, columna;
+};
+
+// Devuelve el movimiento que deshace el movimiento indicado.
+inline Movimientos opuesto(Movimientos mov){
+  switch(mov){
+  case ARRIBA:
+    return ABAJO;
+  case ABAJO:
+    return ARRIBA;
+  case IZQUIERDA:
+    return DERECHA;
+  case DERECHA:
+    return IZQUIERDA;
+  }
+  return mov;
+}
+
+// Giros de 90 grados que hace la cortadora al pasar de moverse en una
+// dirección a moverse en otra: ninguno, uno o dos para dar la vuelta.
+inline int giros_entre(Movimientos antes, Movimientos despues){
+  if(antes == despues)
+    return 0;
+  return despues == opuesto(antes)? 2 : 1;
+}
+
+// Aplica un movimiento a una posición sin comprobar los límites del jardín.
+inline Posicion desplazar(const Posicion& p, Movimientos mov){
+  switch(mov){
+  case ARRIBA:
+    return Posicion(p.fila-1, p.columna);
+  case ABAJO:
+    return Posicion(p.fila+1, p.columna);
+  case IZQUIERDA:
+    return Posicion(p.fila, p.columna-1);
+  case DERECHA:
+    return Posicion(p.fila, p.columna+1);
+  }
+  return p;
+}
+
+#endif // TIPOS_H
@@ -0,0 +1,71 @@
+#ifndef TRAZO_H
+#define TRAZO_H
+
+#include <vector>
+
+#include "jardin.h"
+
+// Herramientas de edición del jardín. Salvo la primera, que cambia el tipo de
+// una celda con cada pulsación, todas pintan de una vez muchas celdas con la
+// misma pintura y se pueden deshacer trazo a trazo.
+enum Herramienta {
+  HERRAMIENTA_CELDA,      // Cada pulsación pasa la celda al tipo siguiente
+  HERRAMIENTA_PINCEL,     // Pinta las celdas por las que se arrastra el ratón
+  HERRAMIENTA_RECTANGULO, // Rectángulo relleno entre la pulsación y la suelta
+  HERRAMIENTA_LINEA,      // Línea entre la pulsación y la suelta
+  HERRAMIENTA_RELLENO,    // Zona de celdas iguales a la pulsada
+  NUM_HERRAMIENTAS
+};
+
+// Lo que se pinta: un tipo de celda o, sin cambiar el tipo, un terreno.
+struct Pintura {
+  Pintura(TipoCelda tipo = OBSTACULO): es_terreno(false), tipo(tipo), terreno(LLANO) {}
+  Pintura(Terreno terreno): es_terreno(true), tipo(CESPED_A), terreno(terreno) {}
+
+  bool es_terreno;
+  TipoCelda tipo;
+  Terreno terreno;
+};
+
+// Cambio de una celda, con lo que había antes para poder deshacerlo.
+struct CambioCelda {
+  Posicion pos;
+  TipoCelda tipo_antes, tipo;
+  Terreno terreno_antes, terreno;
+};
+
+// Cambios hechos por un trazo completo, desde que se pulsa el ratón hasta
+// que se suelta.
+class Trazo {
+public:
+  // Pinta las celdas sobre el jardín y apunta los cambios. Las celdas que ya
+  // tienen la pintura y las que no se pueden pintar se saltan: el inicio, la
+  // cortadora y los puntos A, B e intermedios no cambian de tipo, y los
+  // obstáculos y el inicio no tienen terreno. Devuelve las celdas cambiadas.
+  int pintar(Jardin& jardin, const std::vector<Posicion>& celdas, const Pintura& pintura);
+
+  // Deshace el trazo en el jardín y devuelve los cambios que lo deshacen.
+  // Las celdas que se han vuelto a tocar después del trazo se dejan como
+  // están.
+  Trazo deshacer(Jardin& jardin) const;
+
+  const std::vector<CambioCelda>& cambios() const { return cambios_; }
+  bool vacio() const { return cambios_.empty(); }
+
+private:
+  std::vector<CambioCelda> cambios_;
+};
+
+// Celdas de una línea entre dos posiciones, unidas por lados y no por
+// esquinas, para que una valla de obstáculos no deje pasar a la cortadora.
+void celdas_linea(const Posicion& a, const Posicion& b, std::vector<Posicion>& celdas);
+
+// Celdas del rectángulo con esquinas opuestas en a y b.
+void celdas_rectangulo(const Posicion& a, const Posicion& b, std::vector<Posicion>& celdas);
+
+// Zona de celdas unidas por lados con el mismo tipo que el origen y, si se
+// pinta terreno, también el mismo terreno.
+void celdas_relleno(const Jardin& jardin, const Posicion& origen, const Pintura& pintura,
+                    std::vector<Posicion>& celdas);
+
+#endif // TRAZO_H
@@ -0,0 +1,56 @@
+#ifndef VISITAS_H
+#define VISITAS_H
+
+#include <vector>
+
+#include <QString>
+
+#include "tipos.h"
+
+// Resumen de cuántas veces se ha pasado por cada celda durante un recorrido.
+struct HistogramaVisitas {
+  HistogramaVisitas(): una(0), dos(0), mas(0), repetidas(0), maximo(0) {}
+
+  // Celdas visitadas una vez, dos veces y tres o más
+  int una, dos, mas;
+
+  // Visitas que sobran: todas las que no son la primera a cada celda
+  int repetidas;
+
+  // Mayor número de visitas a una misma celda
+  int maximo;
+};
+
+// Contador de visitas por celda. Anotar una visita es sólo incrementar un
+// entero, así que se puede dejar activado incluso en las ejecuciones sin
+// retardo que se usan para medir.
+class MapaVisitas {
+public:
+  MapaVisitas(int filas = 0, int columnas = 0);
+
+  // Cambia el tamaño y pone todos los contadores a cero.
+  void reiniciar(int filas, int columnas);
+
+  void anotar(int fila, int columna) { ++cuentas[fila*columnas + columna]; }
+
+  // Anota la celda de inicio y todas aquellas por las que pasa el recorrido.
+  void anotar_recorrido(const Posicion& inicio, const std::vector<Movimientos>& movs);
+
+  // Visitas a una celda. Fuera del mapa siempre es 0.
+  int visitas(int fila, int columna) const {
+    if(fila < 0 || columna < 0 || fila >= filas || columna >= columnas)
+      return 0;
+    return cuentas[fila*columnas + columna];
+  }
+
+  HistogramaVisitas histograma() const;
+
+private:
+  int filas, columnas;
+  std::vector<int> cuentas;
+};
+
+// Histograma legible, con una barra proporcional para cada grupo.
+QString texto_visitas(const HistogramaVisitas& histograma);
+
+#endif // VISITAS_H
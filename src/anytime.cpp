@@ -0,0 +1,213 @@
+#include "anytime.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include <QMutexLocker>
+
+#include "planificadores.h"
+
+// Cada cuántas expansiones se consulta el reloj.
+static const int COMPROBAR_RELOJ = 64;
+
+// Duración de cada rodaja de trabajo en segundo plano. Entre rodaja y rodaja
+// se comprueba si se ha pedido parar.
+static const qint64 RODAJA_NS = 10000000;
+
+AraEstrella::AraEstrella(const Jardin& jardin, const Posicion& origen,
+                         const Posicion& destino, double inflacion, double paso):
+  jardin(jardin), ini(origen), fin(destino), peso(std::max(1.0, inflacion)),
+  decremento(paso), g(jardin.celdas(), -1), llegada(jardin.celdas(), -1),
+  cerrada(jardin.celdas(), 0), inconsistente(jardin.celdas(), 0), ronda(1),
+  expandidas(0), fin_busqueda(false)
+{
+  cronometro.start();
+
+  int inicio = jardin.indice(origen.fila, origen.columna);
+  g[inicio] = 0;
+  abrir(inicio);
+}
+
+int AraEstrella::heuristica(int celda) const {
+  Posicion p = jardin.posicion(celda);
+  return std::abs(fin.fila - p.fila) + std::abs(fin.columna - p.columna);
+}
+
+// La lista de abiertos es un montículo sobre un vector para poder recorrerla
+// al calcular la cota. Cuando mejora la g de una celda se inserta otra
+// entrada y la vieja se descarta al sacarla, porque su g ya no coincide.
+void AraEstrella::abrir(int celda){
+  Entrada e;
+  e.g = g[celda];
+  e.f = e.g + peso*heuristica(celda);
+  e.celda = celda;
+  abiertos.push_back(e);
+  std::push_heap(abiertos.begin(), abiertos.end());
+}
+
+// Búsqueda A* con el peso actual. Termina cuando ninguna celda abierta puede
+// mejorar el camino hasta el destino. Las celdas que mejoran después de
+// cerrarse no se vuelven a abrir en esta ronda: se guardan como
+// inconsistentes para la siguiente. Devuelve false si se agota el tiempo.
+bool AraEstrella::mejorar_camino(qint64 limite_ns){
+  int objetivo = jardin.indice(fin.fila, fin.columna);
+  int cuenta = 0;
+
+  while(!abiertos.empty()){
+    const Entrada& e = abiertos.front();
+    if(e.g != g[e.celda] || cerrada[e.celda] == ronda){
+      std::pop_heap(abiertos.begin(), abiertos.end());
+      abiertos.pop_back();
+      continue;
+    }
+    if(g[objetivo] >= 0 && g[objetivo] <= e.f)
+      break;
+
+    if(++cuenta % COMPROBAR_RELOJ == 0 && cronometro.nsecsElapsed() >= limite_ns)
+      return false;
+
+    int c = e.celda;
+    std::pop_heap(abiertos.begin(), abiertos.end());
+    abiertos.pop_back();
+    cerrada[c] = ronda;
+    ++expandidas;
+
+    Posicion p = jardin.posicion(c);
+    for(int k = 0; k < 4; ++k){
+      Posicion q = desplazar(p, MOVIMIENTOS[k]);
+      if(!jardin.transitable(q.fila, q.columna))
+        continue;
+      int v = jardin.indice(q.fila, q.columna);
+      int ng = g[c] + jardin.coste(q.fila, q.columna);
+      if(g[v] >= 0 && ng >= g[v])
+        continue;
+
+      g[v] = ng;
+      llegada[v] = k;
+      if(cerrada[v] != ronda)
+        abrir(v);
+      else if(inconsistente[v] != ronda){
+        inconsistente[v] = ronda;
+        incons.push_back(v);
+      }
+    }
+  }
+
+  return true;
+}
+
+// Guarda el camino de la ronda que acaba de terminar y prepara la siguiente.
+// La cota es el mínimo entre el peso y g(destino) dividido entre el menor
+// g + h de las celdas abiertas o inconsistentes, que es una cota inferior
+// del coste óptimo.
+void AraEstrella::publicar(){
+  int objetivo = jardin.indice(fin.fila, fin.columna);
+  if(g[objetivo] < 0 && ini != fin){
+    fin_busqueda = true;
+    return;
+  }
+
+  int minimo = g[objetivo];
+  for(unsigned i = 0; i < abiertos.size(); ++i){
+    const Entrada& e = abiertos[i];
+    if(e.g == g[e.celda] && cerrada[e.celda] != ronda)
+      minimo = std::min(minimo, e.g + heuristica(e.celda));
+  }
+  for(unsigned i = 0; i < incons.size(); ++i)
+    minimo = std::min(minimo, g[incons[i]] + heuristica(incons[i]));
+
+  SolucionAnytime sol;
+  for(Posicion p = fin; p != ini; ){
+    Movimientos mov = MOVIMIENTOS[llegada[jardin.indice(p.fila, p.columna)]];
+    sol.movimientos.push_back(mov);
+    p = desplazar(p, opuesto(mov));
+  }
+  std::reverse(sol.movimientos.begin(), sol.movimientos.end());
+  sol.coste = coste_recorrido(jardin, ini, sol.movimientos);
+  sol.inflacion = peso;
+  sol.cota = minimo > 0? std::min(peso, double(g[objetivo])/minimo) : 1.0;
+  sol.cota = std::max(1.0, sol.cota);
+  sol.expandidas = expandidas;
+  sol.tiempo_us = cronometro.nsecsElapsed()/1000;
+
+  mejor = sol;
+  soluciones.push_back(sol);
+
+  if(sol.cota <= 1.0 || peso <= 1.0)
+    fin_busqueda = true;
+  else
+    siguiente_peso();
+}
+
+// Baja el peso y junta las celdas abiertas con las inconsistentes en una
+// lista nueva ordenada con el peso nuevo. Al cambiar de ronda quedan todas
+// las celdas sin cerrar.
+void AraEstrella::siguiente_peso(){
+  peso = std::max(1.0, peso - decremento);
+
+  std::vector<Entrada> anteriores;
+  anteriores.swap(abiertos);
+  for(unsigned i = 0; i < anteriores.size(); ++i){
+    const Entrada& e = anteriores[i];
+    if(e.g == g[e.celda] && cerrada[e.celda] != ronda)
+      incons.push_back(e.celda);
+  }
+
+  ++ronda;
+  for(unsigned i = 0; i < incons.size(); ++i)
+    abrir(incons[i]);
+  incons.clear();
+}
+
+bool AraEstrella::mejorar(qint64 limite_ns){
+  if(fin_busqueda || !mejorar_camino(limite_ns))
+    return false;
+
+  unsigned antes = soluciones.size();
+  publicar();
+  return soluciones.size() > antes;
+}
+
+SolucionAnytime planificar_con_plazo(AraEstrella& ara, int plazo_ms){
+  qint64 limite = ara.reloj().nsecsElapsed() + qint64(plazo_ms)*1000000;
+  while(!ara.terminada() && ara.mejorar(limite)) {}
+  return ara.solucion();
+}
+
+MejoraAnytime::MejoraAnytime(AraEstrella* ara, QObject* parent): QObject(parent),
+  planificador(ara), soluciones(ara->historial()), cancelada(0)
+{
+}
+
+MejoraAnytime::~MejoraAnytime(){
+  delete planificador;
+}
+
+int MejoraAnytime::version() const {
+  QMutexLocker bloqueo(&mutex);
+  return soluciones.size();
+}
+
+SolucionAnytime MejoraAnytime::ultima() const {
+  QMutexLocker bloqueo(&mutex);
+  return soluciones.empty()? SolucionAnytime() : soluciones.back();
+}
+
+std::vector<SolucionAnytime> MejoraAnytime::historial() const {
+  QMutexLocker bloqueo(&mutex);
+  return soluciones;
+}
+
+// Trabaja por rodajas hasta que el camino es óptimo o se pide parar.
+void MejoraAnytime::ejecutar(){
+  while(!cancelada.loadAcquire() && !planificador->terminada()){
+    qint64 limite = planificador->reloj().nsecsElapsed() + RODAJA_NS;
+    if(planificador->mejorar(limite)){
+      QMutexLocker bloqueo(&mutex);
+      soluciones.push_back(planificador->solucion());
+      bloqueo.unlock();
+      emit mejorada();
+    }
+  }
+  emit terminada();
+}
@@ -0,0 +1,214 @@
+#include "archivo.h"
+
+#include <QFile>
+#include <QtEndian>
+
+// Los ficheros se leen y se escriben en bloques de este tamaño, informando del
+// progreso después de cada uno.
+static const int BLOQUE = 64*1024;
+
+// Identificadores de las secciones opcionales del final del fichero.
+static const int SECCION_TERRENO = 0x52524554; // "TERR"
+static const int SECCION_GENERADOR = 0x524E4547; // "GENR"
+
+// Enteros de la sección del generador: versión, tipo, semilla, densidad y si
+// se conectó el jardín.
+static const int ENTEROS_GENERADOR = 5;
+
+void escribir_entero(QByteArray& buffer, int& pos, int valor){
+  qToLittleEndian<qint32>(valor, reinterpret_cast<uchar*>(buffer.data() + pos));
+  pos += ENTERO;
+}
+
+int leer_entero(const QByteArray& buffer, int& pos){
+  int valor = qFromLittleEndian<qint32>(reinterpret_cast<const uchar*>(buffer.constData() + pos));
+  pos += ENTERO;
+  return valor;
+}
+
+QByteArray codificar_jardin(const DatosJardin& datos){
+  const Jardin& jardin = datos.jardin;
+  bool terreno = jardin.ponderado();
+  QByteArray buffer((2 + jardin.celdas() + 4)*ENTERO +
+                    (terreno? 2*ENTERO + jardin.celdas() : 0) +
+                    (datos.generado? (2 + ENTEROS_GENERADOR)*ENTERO : 0), 0);
+  int pos = 0;
+
+  escribir_entero(buffer, pos, jardin.filas());
+  escribir_entero(buffer, pos, jardin.columnas());
+  for(int i = 0; i < jardin.filas(); ++i)
+    for(int j = 0; j < jardin.columnas(); ++j)
+      escribir_entero(buffer, pos, jardin.tipo(i, j));
+  escribir_entero(buffer, pos, datos.ini_x);
+  escribir_entero(buffer, pos, datos.ini_y);
+  escribir_entero(buffer, pos, datos.fin_x);
+  escribir_entero(buffer, pos, datos.fin_y);
+
+  // El terreno ocupa un byte por celda
+  if(terreno){
+    escribir_entero(buffer, pos, SECCION_TERRENO);
+    escribir_entero(buffer, pos, jardin.celdas());
+    for(int i = 0; i < jardin.filas(); ++i)
+      for(int j = 0; j < jardin.columnas(); ++j)
+        buffer.data()[pos++] = static_cast<char>(jardin.terreno(i, j));
+  }
+
+  // Con la semilla y la versión de los generadores el jardín se puede volver
+  // a generar exactamente igual
+  if(datos.generado){
+    escribir_entero(buffer, pos, SECCION_GENERADOR);
+    escribir_entero(buffer, pos, ENTEROS_GENERADOR*ENTERO);
+    escribir_entero(buffer, pos, VERSION_GENERADORES);
+    escribir_entero(buffer, pos, datos.generador.tipo);
+    escribir_entero(buffer, pos, static_cast<int>(datos.generador.semilla));
+    escribir_entero(buffer, pos, datos.generador.densidad);
+    escribir_entero(buffer, pos, datos.generador.conectar);
+  }
+
+  return buffer;
+}
+
+bool decodificar_jardin(const QByteArray& buffer, DatosJardin& datos){
+  int pos = 0;
+
+  if(buffer.size() < 2*ENTERO)
+    return false;
+  int filas = leer_entero(buffer, pos);
+  int columnas = leer_entero(buffer, pos);
+
+  // Se comprueba el tamaño antes de reservar memoria para el jardín para no
+  // fiarse de las dimensiones de un fichero dañado
+  if(filas <= 0 || columnas <= 0 ||
+     (buffer.size()/ENTERO - 6)/columnas < filas)
+    return false;
+
+  datos.jardin = Jardin(filas, columnas);
+  for(int i = 0; i < filas; ++i)
+    for(int j = 0; j < columnas; ++j)
+      datos.jardin.set_tipo(i, j, static_cast<TipoCelda>(leer_entero(buffer, pos)));
+  datos.ini_x = leer_entero(buffer, pos);
+  datos.ini_y = leer_entero(buffer, pos);
+  datos.fin_x = leer_entero(buffer, pos);
+  datos.fin_y = leer_entero(buffer, pos);
+
+  while(buffer.size() - pos >= 2*ENTERO){
+    int seccion = leer_entero(buffer, pos);
+    int tam = leer_entero(buffer, pos);
+    if(tam < 0 || tam > buffer.size() - pos)
+      return false;
+
+    if(seccion == SECCION_TERRENO && tam == filas*columnas){
+      for(int i = 0; i < filas; ++i){
+        for(int j = 0; j < columnas; ++j){
+          int terreno = static_cast<unsigned char>(buffer[pos + i*columnas + j]);
+          datos.jardin.set_terreno(i, j, terreno < NUM_TERRENOS?
+                                     static_cast<Terreno>(terreno) : LLANO);
+        }
+      }
+    }
+    else if(seccion == SECCION_GENERADOR && tam == ENTEROS_GENERADOR*ENTERO){
+      int p = pos;
+      int version = leer_entero(buffer, p);
+      int tipo = leer_entero(buffer, p);
+      datos.generador.semilla = static_cast<unsigned>(leer_entero(buffer, p));
+      datos.generador.densidad = leer_entero(buffer, p);
+      datos.generador.conectar = leer_entero(buffer, p) != 0;
+      datos.generado = version == VERSION_GENERADORES && tipo >= 0 && tipo < NUM_GENERADORES;
+      datos.generador.tipo = datos.generado? static_cast<TipoGenerador>(tipo) : GENERADOR_UNIFORME;
+    }
+    pos += tam;
+  }
+
+  return true;
+}
+
+ArchivoJardin::ArchivoJardin(QObject* parent): QObject(parent)
+{
+}
+
+// Se lee el fichero entero por bloques y luego se interpreta de una vez.
+void ArchivoJardin::cargar(const QString& fichero){
+  QFile in(fichero);
+
+  if(!in.open(QIODevice::ReadOnly)){
+    emit error("Error al cargar",
+               "No se ha podido abrir el fichero para cargar. Compruebe sus permisos.");
+    return;
+  }
+
+  QByteArray buffer;
+  qint64 total = in.size();
+  buffer.reserve(total);
+  while(!in.atEnd()){
+    QByteArray bloque = in.read(BLOQUE);
+    if(bloque.isEmpty())
+      break;
+    buffer.append(bloque);
+    emit progreso(total > 0? static_cast<int>(static_cast<qint64>(buffer.size())*100/total) : 100);
+  }
+  in.close();
+
+  DatosJardin datos;
+  if(!decodificar_jardin(buffer, datos)){
+    emit error("Error de lectura",
+               "El archivo especificado parece estar dañado o ser de otra aplicación. Imposible abrir.");
+    return;
+  }
+  emit cargado(datos);
+}
+
+// Las filas de la imagen se convierten a medida que se leen, informando del
+// progreso cada vez que avanza un uno por ciento.
+void ArchivoJardin::importar(LectorImagen* lector, const OpcionesImagen& opciones){
+  DatosJardin datos;
+  ConversorImagen conversor(lector->ancho(), lector->alto(), opciones, datos.jardin);
+  if(conversor.demasiado_grande()){
+    emit error("Error al importar", conversor.error());
+    delete lector;
+    return;
+  }
+  std::vector<unsigned char> grises(lector->ancho());
+  int avisado = 0;
+
+  while(!conversor.completo()){
+    if(!lector->leer_fila(&grises[0])){
+      emit error("Error al importar", lector->error());
+      delete lector;
+      return;
+    }
+    conversor.anadir_fila(&grises[0]);
+    if(conversor.porcentaje() > avisado){
+      avisado = conversor.porcentaje();
+      emit progreso(avisado);
+    }
+  }
+  delete lector;
+  emit cargado(datos);
+}
+
+// Se prepara el contenido completo en memoria y se escribe por bloques.
+void ArchivoJardin::guardar(const QString& fichero, const DatosJardin& datos){
+  QFile out(fichero);
+
+  if(!out.open(QIODevice::WriteOnly)){
+    emit error("Error al guardar",
+               "No se ha podido abrir el fichero para guardar. Compruebe sus permisos.");
+    return;
+  }
+
+  QByteArray buffer = codificar_jardin(datos);
+  for(int pos = 0; pos < buffer.size(); pos += BLOQUE){
+    int tam = qMin(BLOQUE, buffer.size() - pos);
+    if(out.write(buffer.constData() + pos, tam) != tam){
+      out.close();
+      emit error("Error al guardar",
+                 "No se ha podido escribir el fichero. Compruebe el espacio disponible.");
+      return;
+    }
+    emit progreso(static_cast<int>(static_cast<qint64>(pos + tam)*100/buffer.size()));
+  }
+  out.flush();
+  out.close();
+
+  emit guardado();
+}
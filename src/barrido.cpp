@@ -0,0 +1,220 @@
+#include "barrido.h"
+
+#include <algorithm>
+
+#include <QElapsedTimer>
+#include <QtConcurrentMap>
+
+#include "generador.h"
+#include "giros.h"
+#include "planificadores.h"
+
+// Configuración por defecto: los tamaños y densidades de los mapas de prueba
+// y alrededores.
+static const int TAMANOS[] = {25, 50, 100, 150};
+static const int DENSIDADES[] = {0, 10, 20, 30, 40};
+static const int JARDINES = 200;
+static const unsigned SEMILLA = 1;
+
+const char* nombre_planificador(Planificador p){
+  switch(p){
+  case COBERTURA_PROFUNDIDAD:
+    return "Cortar todo el césped (profundidad)";
+  case ESCALADA:
+    return "Camino entre 2 puntos (escalada)";
+  case CAMINO_MINIMO:
+    return "Camino entre 2 puntos (anchura)";
+  case COBERTURA_SALTOS:
+    return "Cortar todo el césped (con saltos)";
+  case COBERTURA_GIROS:
+    return "Cortar todo el césped (minimizando giros)";
+  default:
+    return "";
+  }
+}
+
+Resultado ejecutar_planificador(Planificador p, const Jardin& jardin, const Posicion& a,
+                                const Posicion& b){
+  switch(p){
+  case COBERTURA_PROFUNDIDAD:
+    return cobertura_profundidad(jardin, Posicion(0, 0));
+  case ESCALADA:
+    return escalada(jardin, a, b);
+  case CAMINO_MINIMO:
+    return camino_minimo(jardin, a, b);
+  case COBERTURA_SALTOS:
+    return cobertura_saltos(jardin, Posicion(0, 0));
+  case COBERTURA_GIROS:
+    return cobertura_giros(jardin, Posicion(0, 0));
+  default:
+    return Resultado();
+  }
+}
+
+ConfiguracionBarrido::ConfiguracionBarrido():
+  tamanos(TAMANOS, TAMANOS + sizeof(TAMANOS)/sizeof(int)),
+  densidades(DENSIDADES, DENSIDADES + sizeof(DENSIDADES)/sizeof(int)),
+  jardines(JARDINES), semilla(SEMILLA)
+{
+  for(int i = 0; i < NUM_PLANIFICADORES; ++i)
+    planificadores.push_back(static_cast<Planificador>(i));
+}
+
+// Cada tarea genera un jardín y ejecuta sobre él todos los algoritmos.
+struct TareaBarrido {
+  const ConfiguracionBarrido* config;
+  int tamano, densidad;
+  unsigned semilla;
+  bool posible;
+  std::vector<Resultado> resultados;
+  std::vector<long long> tiempos_ns;
+};
+
+// Mezcla los parámetros de un jardín para obtener su semilla. Así cada
+// jardín es siempre el mismo sin importar el hilo que lo genere.
+static unsigned mezclar(unsigned a, unsigned b){
+  unsigned h = a ^ (b + 0x9E3779B9u + (a << 6) + (a >> 2));
+  h ^= h >> 16;
+  h *= 0x85EBCA6Bu;
+  h ^= h >> 13;
+  return h;
+}
+
+// Los jardines son de obstáculos uniformes y no se conectan, para que el
+// barrido también mida los casos en que B no se alcanza.
+static void evaluar(TareaBarrido& tarea){
+  Posicion a, b;
+  Jardin jardin = generar_jardin(tarea.tamano, tarea.tamano,
+                                 Generador(GENERADOR_UNIFORME, tarea.semilla, tarea.densidad, false),
+                                 a, b);
+  std::vector<int> dist;
+  QElapsedTimer reloj;
+
+  jardin.distancias(a, dist);
+  tarea.posible = dist[jardin.indice(b.fila, b.columna)] >= 0;
+
+  for(unsigned i = 0; i < tarea.config->planificadores.size(); ++i){
+    reloj.start();
+    Resultado res = ejecutar_planificador(tarea.config->planificadores[i], jardin, a, b);
+    tarea.tiempos_ns.push_back(reloj.nsecsElapsed());
+    tarea.resultados.push_back(res);
+  }
+}
+
+static Distribucion distribucion(std::vector<double>& valores){
+  Distribucion d;
+  if(valores.empty())
+    return d;
+
+  std::sort(valores.begin(), valores.end());
+  for(unsigned i = 0; i < valores.size(); ++i)
+    d.media += valores[i];
+  d.media /= valores.size();
+  d.p50 = valores[valores.size()*50/100];
+  d.p95 = valores[std::min(valores.size()-1, valores.size()*95/100)];
+  return d;
+}
+
+InformeBarrido ejecutar_barrido(const ConfiguracionBarrido& config){
+  InformeBarrido informe;
+  std::vector<TareaBarrido> tareas;
+  QElapsedTimer reloj;
+
+  for(unsigned t = 0; t < config.tamanos.size(); ++t){
+    for(unsigned d = 0; d < config.densidades.size(); ++d){
+      for(int n = 0; n < config.jardines; ++n){
+        TareaBarrido tarea;
+        tarea.config = &config;
+        tarea.tamano = config.tamanos[t];
+        tarea.densidad = config.densidades[d];
+        tarea.semilla = mezclar(mezclar(mezclar(config.semilla, tarea.tamano),
+                                        tarea.densidad), n);
+        tarea.posible = false;
+        tareas.push_back(tarea);
+      }
+    }
+  }
+
+  reloj.start();
+  QtConcurrent::blockingMap(tareas, evaluar);
+  informe.tiempo_ms = reloj.elapsed();
+  informe.evaluaciones = tareas.size();
+  informe.evaluaciones_segundo = informe.evaluaciones*1000.0 /
+                                 std::max(informe.tiempo_ms, 1LL);
+
+  // Las tareas están ordenadas por tamaño y densidad, así que cada grupo de
+  // "jardines" tareas consecutivas forma una combinación
+  for(unsigned inicio = 0; inicio < tareas.size(); inicio += config.jardines){
+    for(unsigned p = 0; p < config.planificadores.size(); ++p){
+      ResumenBarrido resumen;
+      std::vector<double> movimientos, giros, tiempos, cobertura;
+
+      resumen.tamano = tareas[inicio].tamano;
+      resumen.densidad = tareas[inicio].densidad;
+      resumen.planificador = config.planificadores[p];
+      resumen.jardines = config.jardines;
+      resumen.fallos = resumen.imposibles = 0;
+
+      for(int n = 0; n < config.jardines; ++n){
+        const TareaBarrido& tarea = tareas[inicio+n];
+        const Resultado& res = tarea.resultados[p];
+        if(!tarea.posible && !es_cobertura(resumen.planificador)){
+          ++resumen.imposibles;
+          continue;
+        }
+        if(!res.exito)
+          ++resumen.fallos;
+        movimientos.push_back(res.movimientos);
+        giros.push_back(res.giros);
+        tiempos.push_back(tarea.tiempos_ns[p]/1000.0);
+        cobertura.push_back(res.cesped > 0? res.cortadas*100.0/res.cesped : 100.0);
+      }
+
+      resumen.movimientos = distribucion(movimientos);
+      resumen.giros = distribucion(giros);
+      resumen.tiempo_us = distribucion(tiempos);
+      resumen.cobertura = distribucion(cobertura);
+      informe.resumenes.push_back(resumen);
+    }
+  }
+
+  return informe;
+}
+
+static QString texto_distribucion(const Distribucion& d){
+  return QString("media %1, p50 %2, p95 %3").arg(d.media, 0, 'f', 1)
+                                             .arg(d.p50, 0, 'f', 1)
+                                             .arg(d.p95, 0, 'f', 1);
+}
+
+QString texto_barrido(const InformeBarrido& informe){
+  QString texto = "---===RESULTADOS DEL BARRIDO===---\n\n";
+
+  texto += "Jardines evaluados: " + QString::number(informe.evaluaciones) + "\n";
+  texto += "Tiempo transcurrido: " + QString::number(informe.tiempo_ms) + "ms\n";
+  texto += "Jardines evaluados por segundo: " +
+           QString::number(informe.evaluaciones_segundo, 'f', 1) + "\n";
+
+  for(unsigned i = 0; i < informe.resumenes.size(); ++i){
+    const ResumenBarrido& r = informe.resumenes[i];
+    if(i == 0 || r.tamano != informe.resumenes[i-1].tamano ||
+       r.densidad != informe.resumenes[i-1].densidad)
+      texto += QString("\nJardín de %1x%1 con %2% de obstáculos:\n")
+               .arg(r.tamano).arg(r.densidad);
+
+    int validos = r.jardines - r.imposibles;
+    texto += "-" + QString(nombre_planificador(r.planificador)) + "\n";
+    texto += "  Fallos: " + QString::number(r.fallos) + " de " +
+             QString::number(validos) + " (" +
+             QString::number(validos > 0? r.fallos*100.0/validos : 0.0, 'f', 1) + "%)";
+    if(r.imposibles > 0)
+      texto += ", sin camino posible: " + QString::number(r.imposibles);
+    texto += "\n";
+    texto += "  Iteraciones: " + texto_distribucion(r.movimientos) + "\n";
+    texto += "  Giros: " + texto_distribucion(r.giros) + "\n";
+    texto += "  Tiempo (us): " + texto_distribucion(r.tiempo_us) + "\n";
+    texto += "  Césped cortado (%): " + texto_distribucion(r.cobertura) + "\n";
+  }
+
+  return texto;
+}
@@ -2,7 +2,8 @@
 #include <QMouseEvent>
 
 Celda::Celda(int fila, int columna, const QString &text, QWidget* parent):
-    QLabel(text, parent), row(fila), column(columna), tipo_(CESPED_A)
+    QLabel(text, parent), row(fila), column(columna), tipo_(CESPED_A),
+    terreno_(LLANO)
 {
 }
 
@@ -20,4 +21,30 @@ TipoCelda Celda::tipo() const {
 void Celda::mousePressEvent(QMouseEvent* event){
   if(event->button() & Qt::LeftButton)
     emit clicked(row, column);
+  if(event->button() & (Qt::LeftButton | Qt::RightButton))
+    emit pulsada(row, column, event->button() == Qt::RightButton);
+}
+
+// Mientras se arrastra, la celda pulsada recibe todos los eventos del ratón,
+// así que hay que buscar la celda que está debajo para avisar de ella.
+Celda* Celda::bajo_raton(QMouseEvent* event) const {
+  if(!parentWidget())
+    return NULL;
+  return qobject_cast<Celda*>(parentWidget()->childAt(mapToParent(event->pos())));
+}
+
+void Celda::mouseMoveEvent(QMouseEvent* event){
+  Celda* celda = bajo_raton(event);
+  if(celda && (event->buttons() & (Qt::LeftButton | Qt::RightButton)))
+    emit arrastrada(celda->row, celda->column);
+}
+
+void Celda::mouseReleaseEvent(QMouseEvent* event){
+  if(!(event->button() & (Qt::LeftButton | Qt::RightButton)))
+    return;
+  Celda* celda = bajo_raton(event);
+  if(celda)
+    emit soltada(celda->row, celda->column);
+  else
+    emit soltada(-1, -1);
 }
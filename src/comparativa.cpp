@@ -0,0 +1,77 @@
+#include "comparativa.h"
+
+#include <QElapsedTimer>
+
+#include "aleatorio.h"
+#include "mapabits.h"
+
+// Los tiempos se toman en nanosegundos y se muestran en milisegundos.
+static double milisegundos(const QElapsedTimer& reloj){
+  return reloj.nsecsElapsed()/1e6;
+}
+
+MedidaAnchura medir_anchura(int tamano, int densidad, unsigned semilla){
+  MedidaAnchura medida;
+  Aleatorio aleatorio(semilla);
+  Jardin jardin(tamano, tamano);
+  std::vector<int> escalar, capas;
+  QElapsedTimer reloj;
+
+  for(int i = 0; i < tamano; ++i)
+    for(int j = 0; j < tamano; ++j)
+      if(aleatorio.porcentaje(densidad))
+        jardin.set_tipo(i, j, OBSTACULO);
+  jardin.set_tipo(0, 0, INICIO);
+
+  medida.tamano = tamano;
+  medida.densidad = densidad;
+
+  reloj.start();
+  jardin.distancias(Posicion(0, 0), escalar);
+  medida.escalar_ms = milisegundos(reloj);
+
+  reloj.start();
+  MapaBits mapa(jardin);
+  medida.construccion_ms = milisegundos(reloj);
+
+  reloj.start();
+  mapa.capas(Posicion(0, 0), capas);
+  medida.capas_ms = milisegundos(reloj);
+
+  reloj.start();
+  medida.alcanzables = mapa.alcanzables(Posicion(0, 0));
+  medida.alcanzables_ms = milisegundos(reloj);
+
+  medida.iguales = escalar == capas;
+  return medida;
+}
+
+std::vector<MedidaAnchura> comparar_anchura(const std::vector<int>& tamanos,
+                                            const std::vector<int>& densidades,
+                                            unsigned semilla){
+  std::vector<MedidaAnchura> medidas;
+  for(unsigned i = 0; i < tamanos.size(); ++i)
+    for(unsigned j = 0; j < densidades.size(); ++j)
+      medidas.push_back(medir_anchura(tamanos[i], densidades[j], semilla + i*31 + j));
+  return medidas;
+}
+
+QString texto_anchura(const std::vector<MedidaAnchura>& medidas){
+  QString texto = "---===BÚSQUEDA EN ANCHURA: CELDAS Y MAPAS DE BITS===---\n\n";
+  texto += QString("Instrucciones AVX2: ") + (MapaBits::avx2()? "sí" : "no") + "\n";
+
+  for(unsigned i = 0; i < medidas.size(); ++i){
+    const MedidaAnchura& m = medidas[i];
+    texto += QString("\nJardín de %1x%1 con %2% de obstáculos (%3 celdas alcanzables):\n")
+             .arg(m.tamano).arg(m.densidad).arg(m.alcanzables);
+    texto += "-Distancias celda a celda: " + QString::number(m.escalar_ms, 'f', 2) + "ms\n";
+    texto += "-Distancias por frentes de onda: " + QString::number(m.capas_ms, 'f', 2) +
+             "ms (" + QString::number(m.escalar_ms/qMax(m.capas_ms, 0.001), 'f', 1) + "x)" +
+             (m.iguales? "" : " ¡DISTINTAS!") + "\n";
+    texto += "-Celdas alcanzables por filas: " + QString::number(m.alcanzables_ms, 'f', 2) +
+             "ms (" + QString::number(m.escalar_ms/qMax(m.alcanzables_ms, 0.001), 'f', 1) + "x)\n";
+    texto += "-Creación del mapa de bits: " + QString::number(m.construccion_ms, 'f', 2) + "ms\n";
+  }
+
+  return texto;
+}
@@ -0,0 +1,246 @@
+#include "consultas.h"
+
+#include <algorithm>
+#include <map>
+#include <queue>
+
+#include <QElapsedTimer>
+#include <QThreadPool>
+#include <QtConcurrentMap>
+
+// Bloques en los que se reparten los grupos por cada hilo. Con varios por
+// hilo, los que terminan antes toman otro bloque y el trabajo queda
+// equilibrado aunque unas búsquedas sean mucho más largas que otras.
+static const int BLOQUES_POR_HILO = 4;
+
+// Consultas que se resuelven con una sola búsqueda desde "centro", que es el
+// origen de todas ellas o, si "inverso", el destino.
+struct GrupoConsultas {
+  int centro;
+  bool inverso;
+  std::vector<int> consultas;
+};
+
+static bool valida(const Jardin& jardin, const ConsultaCamino& consulta){
+  return jardin.dentro(consulta.origen.fila, consulta.origen.columna) &&
+         jardin.dentro(consulta.destino.fila, consulta.destino.columna);
+}
+
+// Cada extremo se identifica con 2*celda si es un origen y 2*celda + 1 si es
+// un destino. Se elige siempre el extremo con más consultas sin asignar; la
+// cola guarda cuántas tenía al meterlo y, si al sacarlo ya tiene menos, se
+// vuelve a meter con las que le quedan.
+static void agrupar(const Jardin& jardin, const std::vector<ConsultaCamino>& consultas,
+                    std::vector<GrupoConsultas>& grupos){
+  std::map<int, std::vector<int> > extremos;
+  for(unsigned i = 0; i < consultas.size(); ++i){
+    if(!valida(jardin, consultas[i]))
+      continue;
+    const Posicion& o = consultas[i].origen;
+    const Posicion& d = consultas[i].destino;
+    extremos[2*jardin.indice(o.fila, o.columna)].push_back(i);
+    extremos[2*jardin.indice(d.fila, d.columna) + 1].push_back(i);
+  }
+
+  std::priority_queue<std::pair<int, int> > cola;
+  for(std::map<int, std::vector<int> >::iterator it = extremos.begin(); it != extremos.end(); ++it)
+    cola.push(std::make_pair(static_cast<int>(it->second.size()), it->first));
+
+  std::vector<char> asignada(consultas.size(), 0);
+  while(!cola.empty()){
+    std::pair<int, int> mejor = cola.top();
+    cola.pop();
+
+    std::vector<int>& lista = extremos[mejor.second];
+    std::vector<int> libres;
+    for(unsigned i = 0; i < lista.size(); ++i)
+      if(!asignada[lista[i]])
+        libres.push_back(lista[i]);
+    lista.swap(libres);
+    if(lista.empty())
+      continue;
+    if(static_cast<int>(lista.size()) < mejor.first){
+      cola.push(std::make_pair(static_cast<int>(lista.size()), mejor.second));
+      continue;
+    }
+
+    GrupoConsultas grupo;
+    grupo.centro = mejor.second/2;
+    grupo.inverso = mejor.second%2 == 1;
+    grupo.consultas = lista;
+    for(unsigned i = 0; i < lista.size(); ++i)
+      asignada[lista[i]] = 1;
+    grupos.push_back(grupo);
+  }
+}
+
+// Memoria de las búsquedas que se reutiliza entre los grupos de un mismo
+// bloque. Como en las demás búsquedas en anchura, cada una usa un sello
+// distinto para saber qué celdas ha visitado y cuáles son sus objetivos.
+struct MemoriaConsultas {
+  MemoriaConsultas(int celdas): marca(celdas, 0), objetivo(celdas, 0), dist(celdas, 0),
+    llegada(celdas, 0), sello(0) {}
+
+  std::vector<unsigned> marca, objetivo;
+  std::vector<int> dist, cola;
+  std::vector<char> llegada;
+  unsigned sello;
+};
+
+// Celda del otro extremo de la consulta respecto al centro del grupo.
+static int extremo(const Jardin& jardin, const ConsultaCamino& consulta, bool inverso){
+  const Posicion& p = inverso? consulta.origen : consulta.destino;
+  return jardin.indice(p.fila, p.columna);
+}
+
+// Búsqueda en anchura desde el centro del grupo hasta que se han alcanzado
+// todos los otros extremos. Hacia delante sólo se entra en celdas
+// transitables. Hacia atrás, desde el destino, cada paso de q a p es el
+// movimiento de p a q, así que hace falta poder entrar en p: sólo se sigue
+// desde celdas transitables, pero se llega a cualquiera, porque puede ser un
+// origen como el punto de inicio. Devuelve las celdas visitadas.
+static int buscar(const Jardin& jardin, const std::vector<ConsultaCamino>& consultas,
+                  const GrupoConsultas& grupo, MemoriaConsultas& mem){
+  if(++mem.sello == 0){
+    std::fill(mem.marca.begin(), mem.marca.end(), 0);
+    std::fill(mem.objetivo.begin(), mem.objetivo.end(), 0);
+    mem.sello = 1;
+  }
+
+  int pendientes = 0, expandidas = 0;
+  for(unsigned i = 0; i < grupo.consultas.size(); ++i){
+    int c = extremo(jardin, consultas[grupo.consultas[i]], grupo.inverso);
+    if(mem.objetivo[c] != mem.sello){
+      mem.objetivo[c] = mem.sello;
+      ++pendientes;
+    }
+  }
+
+  mem.marca[grupo.centro] = mem.sello;
+  mem.dist[grupo.centro] = 0;
+  if(mem.objetivo[grupo.centro] == mem.sello)
+    --pendientes;
+
+  // A un destino en el que no se puede entrar sólo se llega desde él mismo
+  Posicion centro = jardin.posicion(grupo.centro);
+  if(grupo.inverso && !jardin.transitable(centro.fila, centro.columna))
+    pendientes = 0;
+
+  mem.cola.clear();
+  mem.cola.push_back(grupo.centro);
+  for(unsigned i = 0; i < mem.cola.size() && pendientes > 0; ++i){
+    Posicion p = jardin.posicion(mem.cola[i]);
+    for(int k = 0; k < 4; ++k){
+      Posicion q = desplazar(p, MOVIMIENTOS[k]);
+      if(!jardin.dentro(q.fila, q.columna))
+        continue;
+      int c = jardin.indice(q.fila, q.columna);
+      if(mem.marca[c] == mem.sello)
+        continue;
+      bool entra = jardin.transitable(q.fila, q.columna);
+      if(!grupo.inverso && !entra)
+        continue;
+
+      mem.marca[c] = mem.sello;
+      mem.dist[c] = mem.dist[mem.cola[i]] + 1;
+      mem.llegada[c] = k;
+      ++expandidas;
+      if(mem.objetivo[c] == mem.sello && --pendientes == 0)
+        break;
+      if(entra)
+        mem.cola.push_back(c);
+    }
+  }
+  return expandidas;
+}
+
+// Sube por las llegadas desde el otro extremo hasta el centro. Hacia delante
+// se obtiene el camino al revés; hacia atrás, cada llegada es el movimiento
+// contrario al que hay que hacer.
+static void reconstruir(const Jardin& jardin, const GrupoConsultas& grupo, int c,
+                        const MemoriaConsultas& mem, std::vector<Movimientos>& movs){
+  movs.clear();
+  while(c != grupo.centro){
+    Movimientos mov = MOVIMIENTOS[static_cast<int>(mem.llegada[c])];
+    if(grupo.inverso)
+      mov = opuesto(mov);
+    movs.push_back(mov);
+    Posicion p = desplazar(jardin.posicion(c), grupo.inverso? mov : opuesto(mov));
+    c = jardin.indice(p.fila, p.columna);
+  }
+  if(!grupo.inverso)
+    std::reverse(movs.begin(), movs.end());
+}
+
+// Cada bloque resuelve los grupos primero, primero + paso, ... Los grupos
+// están ordenados de mayor a menor, así que todos los bloques reciben grupos
+// de todos los tamaños.
+struct BloqueConsultas {
+  const Jardin* jardin;
+  const std::vector<ConsultaCamino>* consultas;
+  const std::vector<GrupoConsultas>* grupos;
+  std::vector<RespuestaCamino>* respuestas;
+  bool caminos;
+  int primero, paso;
+  qint64 expandidas;
+};
+
+static void resolver_bloque(BloqueConsultas& bloque){
+  const Jardin& jardin = *bloque.jardin;
+  MemoriaConsultas mem(jardin.celdas());
+
+  for(unsigned g = bloque.primero; g < bloque.grupos->size(); g += bloque.paso){
+    const GrupoConsultas& grupo = (*bloque.grupos)[g];
+    bloque.expandidas += buscar(jardin, *bloque.consultas, grupo, mem);
+
+    for(unsigned i = 0; i < grupo.consultas.size(); ++i){
+      int n = grupo.consultas[i];
+      int c = extremo(jardin, (*bloque.consultas)[n], grupo.inverso);
+      RespuestaCamino& respuesta = (*bloque.respuestas)[n];
+      if(mem.marca[c] != mem.sello)
+        continue;
+      respuesta.longitud = mem.dist[c];
+      if(bloque.caminos)
+        reconstruir(jardin, grupo, c, mem, respuesta.movs);
+    }
+  }
+}
+
+void resolver_consultas(const Jardin& jardin, const std::vector<ConsultaCamino>& consultas,
+                        std::vector<RespuestaCamino>& respuestas, bool caminos,
+                        MedidasConsultas* medidas){
+  QElapsedTimer reloj;
+  MedidasConsultas propias;
+  MedidasConsultas& m = medidas? *medidas : propias;
+
+  m = MedidasConsultas();
+  m.consultas = consultas.size();
+  m.hilos = QThreadPool::globalInstance()->maxThreadCount();
+  respuestas.assign(consultas.size(), RespuestaCamino());
+
+  reloj.start();
+  std::vector<GrupoConsultas> grupos;
+  agrupar(jardin, consultas, grupos);
+  m.agrupar_us = reloj.nsecsElapsed()/1000;
+  m.grupos = grupos.size();
+  for(unsigned g = 0; g < grupos.size(); ++g)
+    m.por_destino += grupos[g].inverso;
+
+  reloj.start();
+  int num = std::min(static_cast<int>(grupos.size()), std::max(1, m.hilos)*BLOQUES_POR_HILO);
+  std::vector<BloqueConsultas> bloques(num);
+  for(int b = 0; b < num; ++b){
+    BloqueConsultas bloque = {&jardin, &consultas, &grupos, &respuestas, caminos, b, num, 0};
+    bloques[b] = bloque;
+  }
+  if(num > 1)
+    QtConcurrent::blockingMap(bloques, resolver_bloque);
+  else if(num == 1)
+    resolver_bloque(bloques[0]);
+  m.resolver_us = reloj.nsecsElapsed()/1000;
+
+  for(int b = 0; b < num; ++b)
+    m.expandidas += bloques[b].expandidas;
+  qint64 total_us = m.agrupar_us + m.resolver_us;
+  m.por_segundo = total_us > 0? m.consultas*1e6/total_us : 0;
+}
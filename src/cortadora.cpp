@@ -7,7 +7,14 @@
 #include <QMessageBox>
 #include <QTime>
 
+#include "anytime.h"
+#include "dinamico.h"
+#include "exploracion.h"
 #include "mainwindow.h"
+#include "multiagente.h"
+#include "plato.h"
+#include "telemetria.h"
+#include "visitas.h"
 
 // Hace una espera ocupada procesando eventos durante el tiempo especificado.
 void qSleep(int ms){
@@ -19,7 +26,8 @@ void qSleep(int ms){
 // El constructor inicializa la posición inicial de la cortadora y asigna una
 // velocidad de movimiento por defecto.
 Cortadora::Cortadora(MainWindow* padre, int fila, int columna): QObject(padre),
-  father(padre), row(fila), column(columna), delay(500)
+  father(padre), row(fila), column(columna), delay(500), traza(NULL),
+  visitas(NULL), telemetria(NULL), giros(NULL), sentido(ARRIBA), con_orientacion(false)
 {
 }
 
@@ -172,10 +180,209 @@ void Cortadora::reach(int fila, int columna, int* iteraciones){
   }
 }
 
+// Ejecuta una lista de movimientos calculada de antemano. Cada celda que la
+// cortadora abandona queda cortada, salvo el punto de inicio, que se vuelve a
+// dibujar como tal.
+void Cortadora::recorrer(const std::vector<Movimientos>& movs, int* iteraciones){
+  father->set_pos(row, column, CORTADORA);
+
+  for(unsigned i = 0; i < movs.size(); ++i){
+    qSleep(delay);
+    if(row == 0 && column == 0)
+      father->set_pos(row, column, INICIO);
+    else
+      father->set_pos(row, column, CESPED_B);
+    mover(movs[i], iteraciones);
+    father->set_pos(row, column, CORTADORA);
+  }
+}
+
+bool Cortadora::recorrer_plato(const PlatoCorte& plato,
+                               const std::vector<Movimientos>& movs, int* iteraciones){
+  cortar_plato(plato);
+  father->set_pos(row, column, CORTADORA);
+
+  for(unsigned i = 0; i < movs.size(); ++i){
+    if(hay_obstaculo(movs[i], plato))
+      return false;
+    qSleep(delay);
+    if(row == 0 && column == 0)
+      father->set_pos(row, column, INICIO);
+    else
+      father->set_pos(row, column, CESPED_B);
+    mover(movs[i], iteraciones);
+    cortar_plato(plato);
+    father->set_pos(row, column, CORTADORA);
+  }
+  return true;
+}
+
+void Cortadora::recorrer_agentes(const PlanMultiagente& plan, int* iteraciones){
+  const std::vector<std::vector<Posicion> >& caminos = plan.caminos;
+
+  for(unsigned i = 0; i < caminos.size(); ++i){
+    Posicion p = caminos[i][0];
+    father->set_pos(p.fila, p.columna, CESPED_B);
+    father->ImgMod(p.fila, p.columna, CORTADORA);
+  }
+
+  for(int t = 1; t <= plan.makespan; ++t){
+    qSleep(delay);
+
+    // Primero se borran todas y luego se dibujan en su nueva posición, para
+    // no borrar una cortadora que acaba de entrar donde estaba otra
+    for(unsigned i = 0; i < caminos.size(); ++i)
+      if(t < (int)caminos[i].size()){
+        Posicion p = caminos[i][t-1];
+        father->ImgMod(p.fila, p.columna, father->get_pos(p.fila, p.columna)->tipo());
+      }
+    for(unsigned i = 0; i < caminos.size(); ++i)
+      if(t < (int)caminos[i].size()){
+        Posicion p = caminos[i][t];
+        if(p != caminos[i][t-1] && iteraciones)
+          ++(*iteraciones);
+        father->set_pos(p.fila, p.columna, CESPED_B);
+        father->ImgMod(p.fila, p.columna, CORTADORA);
+      }
+  }
+}
+
+// En cada paso se mira si el planificador ha publicado un camino nuevo. Se
+// busca en él la posición actual de la cortadora recorriéndolo desde el
+// origen y restando al coste total lo ya recorrido.
+void Cortadora::reach_anytime(MejoraAnytime& mejora, const Jardin& jardin,
+                              int* iteraciones, int* cambios){
+  Posicion origen(row, column);
+  SolucionAnytime actual = mejora.ultima();
+  int version = mejora.version();
+  int restante = actual.coste;
+  unsigned paso = 0;
+
+  father->set_pos(row, column, CORTADORA);
+
+  while(paso < actual.movimientos.size()){
+    qSleep(delay);
+
+    if(mejora.version() != version){
+      version = mejora.version();
+      SolucionAnytime nueva = mejora.ultima();
+      Posicion p = origen;
+      int coste = nueva.coste;
+      for(unsigned k = 0; k <= nueva.movimientos.size(); ++k){
+        if(p == Posicion(row, column)){
+          if(coste < restante){
+            actual = nueva;
+            paso = k;
+            restante = coste;
+            if(cambios)
+              ++(*cambios);
+          }
+          break;
+        }
+        if(k < nueva.movimientos.size()){
+          p = desplazar(p, nueva.movimientos[k]);
+          coste -= jardin.coste(p.fila, p.columna);
+        }
+      }
+    }
+
+    if(row == 0 && column == 0)
+      father->set_pos(row, column, INICIO);
+    else
+      father->set_pos(row, column, CESPED_B);
+    mover(actual.movimientos[paso++], iteraciones);
+    restante -= jardin.coste(row, column);
+    father->set_pos(row, column, CORTADORA);
+  }
+}
+
+// En cada instante se borran los obstáculos móviles de su posición anterior,
+// se mueve la cortadora según lo que haya decidido la simulación y se dibujan
+// los obstáculos en su nueva posición. Los obstáculos móviles sólo se
+// dibujan; las celdas del jardín conservan su tipo.
+void Cortadora::reach_dinamico(SimulacionDinamica& simulacion, int* iteraciones){
+  const std::vector<ObstaculoMovil>& moviles = simulacion.obstaculos();
+  Posicion p;
+
+  father->set_pos(row, column, CORTADORA);
+  for(unsigned i = 0; i < moviles.size(); ++i){
+    p = moviles[i].posicion();
+    father->ImgMod(p.fila, p.columna, OBSTACULO);
+  }
+
+  while(!simulacion.terminada()){
+    qSleep(delay);
+
+    for(unsigned i = 0; i < moviles.size(); ++i){
+      p = moviles[i].posicion();
+      father->ImgMod(p.fila, p.columna, father->get_pos(p.fila, p.columna)->tipo());
+    }
+
+    simulacion.paso();
+    p = simulacion.cortadora();
+    if(p != Posicion(row, column)){
+      if(row == 0 && column == 0)
+        father->set_pos(row, column, INICIO);
+      else
+        father->set_pos(row, column, CESPED_B);
+
+      if(p.fila < row)
+        mover(ARRIBA, iteraciones);
+      else if(p.fila > row)
+        mover(ABAJO, iteraciones);
+      else if(p.columna < column)
+        mover(IZQUIERDA, iteraciones);
+      else
+        mover(DERECHA, iteraciones);
+      father->set_pos(row, column, CORTADORA);
+    }
+
+    for(unsigned i = 0; i < moviles.size(); ++i){
+      p = moviles[i].posicion();
+      father->ImgMod(p.fila, p.columna, OBSTACULO);
+    }
+  }
+
+  for(unsigned i = 0; i < moviles.size(); ++i){
+    p = moviles[i].posicion();
+    father->ImgMod(p.fila, p.columna, father->get_pos(p.fila, p.columna)->tipo());
+  }
+}
+
+// En cada paso se consulta a los sensores en las cuatro direcciones, se le
+// pasa al explorador lo que han detectado y se hace el movimiento que decida.
+void Cortadora::explorar(Explorador& explorador, int* iteraciones){
+  static const Movimientos MOVS[4] = {ARRIBA, ABAJO, IZQUIERDA, DERECHA};
+  bool obstaculo[4];
+  Movimientos mov;
+
+  father->set_pos(row, column, CORTADORA);
+  for(;;){
+    for(int k = 0; k < 4; ++k)
+      obstaculo[k] = hay_obstaculo(MOVS[k]);
+    explorador.observar(Posicion(row, column), obstaculo);
+
+    if(!explorador.siguiente(Posicion(row, column), mov))
+      break;
+
+    qSleep(delay);
+    if(row == 0 && column == 0)
+      father->set_pos(row, column, INICIO);
+    else
+      father->set_pos(row, column, CESPED_B);
+    mover(mov, iteraciones);
+    explorador.movido();
+    father->set_pos(row, column, CORTADORA);
+  }
+}
+
 // Coloca la cortadora en otra posición.
 void Cortadora::ir_a(int fila, int columna){
   row = fila;
   column = columna;
+  con_orientacion = false;
+  if(visitas) visitas->anotar(row, column);
+  if(telemetria) telemetria->empezar(Posicion(row, column));
 }
 
 bool Cortadora::hay_obstaculo(Movimientos mov) const {
@@ -203,6 +410,49 @@ bool Cortadora::hay_obstaculo(Movimientos mov) const {
   return false;
 }
 
+// Con el plato sólo hay que mirar la fila o la columna de celdas en la que va
+// a entrar. Igual que en cabe_plato(), el plato puede volver a ponerse sobre
+// el punto de inicio, pero sólo con la esquina en él, que es donde empieza.
+bool Cortadora::hay_obstaculo(Movimientos mov, const PlatoCorte& plato) const {
+  int fila, columna, largo;
+  bool en_fila = mov == ARRIBA || mov == ABAJO;
+
+  switch(mov){
+  case ARRIBA:
+    fila = row - 1;
+    columna = column;
+    break;
+  case ABAJO:
+    fila = row + plato.filas;
+    columna = column;
+    break;
+  case IZQUIERDA:
+    fila = row;
+    columna = column - 1;
+    break;
+  case DERECHA:
+  default:
+    fila = row;
+    columna = column + plato.columnas;
+    break;
+  }
+  largo = en_fila? plato.columnas : plato.filas;
+
+  if(fila < 0 || columna < 0 ||
+     fila + (en_fila? 1 : largo) > father->filas() ||
+     columna + (en_fila? largo : 1) > father->columnas())
+    return true;
+
+  Posicion esquina = desplazar(Posicion(row, column), mov);
+  for(int k = 0; k < largo; ++k){
+    TipoCelda tipo = en_fila? father->get_pos(fila, columna + k)->tipo() :
+                                 father->get_pos(fila + k, columna)->tipo();
+    if(tipo == OBSTACULO || (tipo == INICIO && esquina != Posicion(0, 0)))
+      return true;
+  }
+  return false;
+}
+
 void Cortadora::mover(Movimientos mov, int* iteraciones){
   switch(mov){
   case ARRIBA:
@@ -219,12 +469,35 @@ void Cortadora::mover(Movimientos mov, int* iteraciones){
     break;
   }
   if(iteraciones) ++(*iteraciones);
+  if(giros && con_orientacion) *giros += giros_entre(sentido, mov);
+  sentido = mov;
+  con_orientacion = true;
+  if(traza) traza->push_back(mov);
+  if(visitas) visitas->anotar(row, column);
+
+  // La celda nueva todavía no se ha dibujado como cortada
+  if(telemetria)
+    telemetria->mover(Posicion(row, column), father->get_pos(row, column)->tipo() == CESPED_A);
 }
 
 void Cortadora::on_delay_changed(int value){
   delay = value;
 }
 
+// La celda de la cortadora ya se ha contado para la telemetría al moverse.
+void Cortadora::cortar_plato(const PlatoCorte& plato){
+  int cortadas = 0;
+  for(int i = row; i < row + plato.filas && i < father->filas(); ++i)
+    for(int j = column; j < column + plato.columnas && j < father->columnas(); ++j){
+      TipoCelda tipo = father->get_pos(i, j)->tipo();
+      if(tipo == CESPED_A && (i != row || j != column))
+        ++cortadas;
+      if(tipo != OBSTACULO && tipo != INICIO && tipo != CORTADORA)
+        father->set_pos(i, j, CESPED_B);
+    }
+  if(telemetria) telemetria->cortar(cortadas);
+}
+
 // Función recursiva que realiza un recorrido en profundidad del jardín.
 void Cortadora::cortar(Movimientos mov, int* iteraciones){
 
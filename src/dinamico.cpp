@@ -0,0 +1,345 @@
+#include "dinamico.h"
+
+#include <cstdlib>
+#include <queue>
+
+#include <QElapsedTimer>
+
+// Número de instantes hacia delante que tiene en cuenta cada planificación.
+static const int VENTANA = 32;
+
+// Número de instantes que la cortadora sigue un plan antes de recalcularlo,
+// aunque siga siendo válido, para no acercarse al final de la ventana.
+static const int REPLANIFICAR = VENTANA/2;
+
+// Instantes hacia delante que se reservan alrededor de los obstáculos que se
+// mueven al azar: todas las celdas a las que podrían llegar en ese tiempo.
+static const int CONO = 2;
+
+// Cada cuántos nodos expandidos se mira el reloj.
+static const int COMPROBAR_RELOJ = 64;
+
+// Longitud máxima de las rondas de los obstáculos aleatorios.
+static const int MAX_RONDA = 15;
+
+// Los cuatro movimientos más quedarse quieto.
+static const int OPCIONES = 5;
+
+/*
+ * OBSTÁCULOS MÓVILES
+ */
+
+ObstaculoMovil::ObstaculoMovil(const std::vector<Posicion>& recorrido):
+  ronda(recorrido), indice(0), sentido(1), actual(recorrido[0])
+{
+}
+
+ObstaculoMovil::ObstaculoMovil(const Posicion& inicio, unsigned semilla):
+  indice(0), sentido(1), actual(inicio), azar(semilla)
+{
+}
+
+// La ronda de ida y vuelta es periódica, así que basta con llevar la cuenta
+// de la fase dentro del periodo.
+Posicion ObstaculoMovil::prevision(int instantes) const {
+  int n = ronda.size();
+  if(n == 1)
+    return ronda[0];
+
+  int periodo = 2*(n-1);
+  int fase = (sentido > 0? indice : periodo - indice);
+  fase = (fase + instantes) % periodo;
+  return ronda[fase < n? fase : periodo - fase];
+}
+
+bool ObstaculoMovil::avanzar(const Jardin& jardin, const Posicion& cortadora){
+  if(guionizado()){
+    if(ronda.size() == 1)
+      return true;
+    Posicion p = prevision(1);
+    if(p == cortadora)
+      return false;
+
+    if(indice + sentido < 0 || indice + sentido >= (int) ronda.size())
+      sentido = -sentido;
+    indice += sentido;
+    actual = p;
+    return true;
+  }
+
+  // Se elige al azar entre quedarse quieto y las celdas vecinas libres
+  Posicion opciones[OPCIONES];
+  int n = 0;
+  opciones[n++] = actual;
+  for(int k = 0; k < 4; ++k){
+    Posicion q = desplazar(actual, MOVIMIENTOS[k]);
+    if(jardin.transitable(q.fila, q.columna) && q != cortadora)
+      opciones[n++] = q;
+  }
+  actual = opciones[azar.entero(n)];
+  return true;
+}
+
+/*
+ * SIMULACIÓN
+ */
+
+SimulacionDinamica::SimulacionDinamica(const Jardin& jardin, const Posicion& origen,
+                                       const Posicion& destino, int presupuesto_us):
+  jardin(jardin), actual(origen), destino(destino), instante(0),
+  limite(4*jardin.celdas()), presupuesto(presupuesto_us), fin(false),
+  reservas(jardin), siguiente(0), visto(jardin.celdas()*VENTANA, 0), sello(0)
+{
+  jardin.distancias(destino, heuristica);
+
+  // Aunque el origen no sea transitable, como el punto de inicio, se puede
+  // salir de él hacia cualquiera de sus vecinas
+  int& h = heuristica[jardin.indice(origen.fila, origen.columna)];
+  for(int k = 0; k < 4 && origen != destino; ++k){
+    Posicion q = desplazar(origen, MOVIMIENTOS[k]);
+    if(!jardin.dentro(q.fila, q.columna))
+      continue;
+    int hq = heuristica[jardin.indice(q.fila, q.columna)];
+    if(hq >= 0 && (h < 0 || hq+1 < h))
+      h = hq+1;
+  }
+
+  if(origen == destino){
+    fin = true;
+    stats.llegado = true;
+  }
+  else if(h < 0)
+    fin = true;
+}
+
+void SimulacionDinamica::anadir_obstaculo(const ObstaculoMovil& obstaculo){
+  moviles.push_back(obstaculo);
+}
+
+void SimulacionDinamica::anadir_aleatorios(int cantidad, unsigned semilla){
+  Aleatorio azar(semilla);
+  std::vector<int> libres;
+
+  for(int i = 0; i < jardin.celdas(); ++i){
+    Posicion p = jardin.posicion(i);
+    if(jardin.transitable(p.fila, p.columna) && p != actual && p != destino)
+      libres.push_back(i);
+  }
+
+  for(int i = 0; i < cantidad && !libres.empty(); ++i){
+    int elegida = azar.entero(libres.size());
+    Posicion p = jardin.posicion(libres[elegida]);
+    libres[elegida] = libres.back();
+    libres.pop_back();
+
+    if(i%2 == 0){
+      // La ronda avanza en línea recta mientras puede, girando al azar cuando
+      // se encuentra un obstáculo
+      std::vector<Posicion> recorrido(1, p);
+      Movimientos mov = MOVIMIENTOS[azar.entero(4)];
+      int intentos = 0;
+      while((int) recorrido.size() < MAX_RONDA && intentos < 4){
+        Posicion q = desplazar(recorrido.back(), mov);
+        if(jardin.transitable(q.fila, q.columna) && q != destino &&
+           (recorrido.size() < 2 || q != recorrido[recorrido.size()-2])){
+          recorrido.push_back(q);
+          intentos = 0;
+        }
+        else {
+          mov = MOVIMIENTOS[azar.entero(4)];
+          ++intentos;
+        }
+      }
+      anadir_obstaculo(ObstaculoMovil(recorrido));
+    }
+    else
+      anadir_obstaculo(ObstaculoMovil(p, azar.siguiente()));
+  }
+}
+
+// Reserva las posiciones previstas de todos los obstáculos en la ventana de
+// planificación. Los que siguen un guion reservan exactamente su recorrido;
+// de los que se mueven al azar sólo se sabe a dónde podrían llegar en los
+// próximos instantes.
+void SimulacionDinamica::preparar_reservas(){
+  reservas.limpiar();
+
+  for(unsigned i = 0; i < moviles.size(); ++i){
+    const ObstaculoMovil& o = moviles[i];
+    if(o.guionizado()){
+      reservas.reservar(o.posicion(), instante);
+      for(int k = 0; k < VENTANA; ++k)
+        reservas.reservar_paso(o.prevision(k), o.prevision(k+1), instante+k);
+    }
+    else {
+      Posicion p = o.posicion();
+      reservas.reservar(p, instante);
+      for(int k = 1; k <= CONO; ++k)
+        for(int df = -k; df <= k; ++df)
+          for(int dc = -k; dc <= k; ++dc)
+            if(std::abs(df) + std::abs(dc) <= k &&
+               jardin.transitable(p.fila+df, p.columna+dc))
+              reservas.reservar(Posicion(p.fila+df, p.columna+dc), instante+k);
+    }
+  }
+}
+
+// Un nodo de la búsqueda en espacio-tiempo. El coste acumulado es siempre el
+// número de instantes transcurridos, así que no hace falta guardarlo.
+struct NodoEspacioTiempo {
+  Posicion pos;
+  int t, padre;
+};
+
+struct Abierto {
+  Abierto(int f, int t, int n): f(f), t(t), nodo(n) {}
+
+  // Los de menor f primero y, a igualdad, los más avanzados en el tiempo
+  bool operator<(const Abierto& o) const {
+    return f > o.f || (f == o.f && t < o.t);
+  }
+
+  int f, t, nodo;
+};
+
+void SimulacionDinamica::planificar(const QElapsedTimer& reloj){
+  std::vector<NodoEspacioTiempo> nodos;
+  std::priority_queue<Abierto> abiertos;
+  int mejor = 0, elegido = -1, expandidos = 0;
+
+  plan.clear();
+  siguiente = 0;
+  if(++sello == 0){
+    visto.assign(visto.size(), 0);
+    sello = 1;
+  }
+
+  NodoEspacioTiempo inicio = {actual, instante, -1};
+  nodos.push_back(inicio);
+  abiertos.push(Abierto(0, instante, 0));
+
+  while(!abiertos.empty()){
+    if(++expandidos % COMPROBAR_RELOJ == 0 &&
+       reloj.nsecsElapsed() > presupuesto*1000LL)
+      break;
+
+    int n = abiertos.top().nodo;
+    abiertos.pop();
+    NodoEspacioTiempo actual_n = nodos[n];
+    int h = heuristica[jardin.indice(actual_n.pos.fila, actual_n.pos.columna)];
+
+    // Se llega al destino o al final de la ventana: como se sacan por orden
+    // de f, éste es el mejor plan posible
+    if(actual_n.pos == destino || actual_n.t - instante >= VENTANA-1){
+      elegido = n;
+      break;
+    }
+
+    // Por si se acaba el tiempo se recuerda el nodo más cercano al destino
+    if(h < heuristica[jardin.indice(nodos[mejor].pos.fila, nodos[mejor].pos.columna)])
+      mejor = n;
+
+    for(int k = 0; k < OPCIONES; ++k){
+      Posicion q = k < 4? desplazar(actual_n.pos, MOVIMIENTOS[k]) : actual_n.pos;
+      if(k < 4 && !jardin.transitable(q.fila, q.columna))
+        continue;
+      if(!reservas.paso_libre(actual_n.pos, q, actual_n.t))
+        continue;
+
+      int hq = heuristica[jardin.indice(q.fila, q.columna)];
+      if(hq < 0)
+        continue;
+
+      unsigned& marca = visto[jardin.indice(q.fila, q.columna)*VENTANA + (actual_n.t+1 - instante)];
+      if(marca == sello)
+        continue;
+      marca = sello;
+
+      NodoEspacioTiempo hijo = {q, actual_n.t+1, n};
+      nodos.push_back(hijo);
+      abiertos.push(Abierto(actual_n.t+1 - instante + hq, actual_n.t+1,
+                            nodos.size()-1));
+    }
+  }
+
+  if(elegido < 0)
+    elegido = mejor;
+
+  // El plan se reconstruye hacia atrás desde el nodo elegido. Si no se ha
+  // encontrado nada mejor que quedarse donde está, se espera un instante.
+  for(int n = elegido; nodos[n].padre >= 0; n = nodos[n].padre)
+    plan.insert(plan.begin(), nodos[n].pos);
+  if(plan.empty())
+    plan.push_back(actual);
+}
+
+// Comprueba si todos los pasos que acercan la cortadora al destino en el
+// jardín sin obstáculos móviles están ocupados en el instante siguiente.
+bool SimulacionDinamica::mejor_paso_bloqueado() const {
+  int h = heuristica[jardin.indice(actual.fila, actual.columna)];
+  bool hay_paso = false;
+
+  for(int k = 0; k < 4; ++k){
+    Posicion q = desplazar(actual, MOVIMIENTOS[k]);
+    if(!jardin.transitable(q.fila, q.columna))
+      continue;
+    int hq = heuristica[jardin.indice(q.fila, q.columna)];
+    if(hq >= 0 && hq == h-1){
+      if(reservas.paso_libre(actual, q, instante))
+        return false;
+      hay_paso = true;
+    }
+  }
+  return hay_paso;
+}
+
+bool SimulacionDinamica::paso(){
+  if(fin)
+    return false;
+
+  QElapsedTimer reloj;
+  reloj.start();
+
+  // Se decide el siguiente paso, recalculando el plan si ya no es válido
+  preparar_reservas();
+  if(siguiente >= plan.size() || siguiente >= (unsigned) REPLANIFICAR ||
+     !reservas.paso_libre(actual, plan[siguiente], instante)){
+    planificar(reloj);
+    ++stats.replanificaciones;
+  }
+  Posicion nueva = plan[siguiente++];
+  if(mejor_paso_bloqueado())
+    ++stats.choques_evitados;
+
+  long long us = reloj.nsecsElapsed()/1000;
+  stats.total_us += us;
+  if(us > stats.peor_us)
+    stats.peor_us = us;
+
+  // Se mueven los obstáculos. Si alguno acaba en la celda a la que iba la
+  // cortadora, ésta se queda donde está.
+  for(unsigned i = 0; i < moviles.size(); ++i){
+    moviles[i].avanzar(jardin, actual);
+    if(moviles[i].posicion() == nueva && nueva != actual){
+      nueva = actual;
+      plan.clear();
+      ++stats.choques;
+    }
+  }
+
+  if(nueva == actual)
+    ++stats.esperas;
+  else
+    ++stats.movimientos;
+  actual = nueva;
+  ++instante;
+  ++stats.instantes;
+
+  if(actual == destino){
+    stats.llegado = true;
+    fin = true;
+  }
+  else if(instante >= limite)
+    fin = true;
+  return true;
+}
@@ -0,0 +1,316 @@
+#include "estres.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "aleatorio.h"
+
+// Lado de las habitaciones del jardín murado, contando una de sus paredes.
+static const int LADO_HABITACION = 8;
+
+// Tamaño mínimo de las formas, para que quepan los puntos A y B.
+static const int MIN_TAMANO = 4;
+
+const char* nombre_forma_estres(FormaEstres forma){
+  switch(forma){
+  case ESTRES_ESPIRAL:
+    return "Espiral";
+  case ESTRES_PASILLOS:
+    return "Pasillos en zigzag";
+  case ESTRES_DAMERO:
+    return "Damero de pilares";
+  case ESTRES_MURADO:
+    return "Habitaciones muradas";
+  case ESTRES_DIAGONAL:
+    return "Diagonal por el inicio";
+  default:
+    return "";
+  }
+}
+
+const char* clave_forma_estres(FormaEstres forma){
+  switch(forma){
+  case ESTRES_ESPIRAL:
+    return "espiral";
+  case ESTRES_PASILLOS:
+    return "pasillos";
+  case ESTRES_DAMERO:
+    return "damero";
+  case ESTRES_MURADO:
+    return "murado";
+  case ESTRES_DIAGONAL:
+    return "diagonal";
+  default:
+    return "";
+  }
+}
+
+static const char* texto_estado(EstadoEstres estado){
+  switch(estado){
+  case ESTRES_FALLO:
+    return "FALLO";
+  case ESTRES_TIEMPO:
+    return "TIEMPO LÍMITE SUPERADO";
+  case ESTRES_MEMORIA:
+    return "MEMORIA LÍMITE SUPERADA";
+  case ESTRES_ERROR:
+    return "TERMINACIÓN ANORMAL";
+  default:
+    return "bien";
+  }
+}
+
+/*
+ * FORMAS
+ */
+
+// Se excava un pasillo de una celda en espiral hacia dentro, dejando una
+// pared de una celda entre cada vuelta y la siguiente.
+static void espiral(Jardin& jardin){
+  int n = jardin.filas();
+  int arriba = 0, izquierda = 0, abajo = n - 1, derecha = n - 1;
+
+  for(int i = 0; i < n; ++i)
+    for(int j = 0; j < n; ++j)
+      jardin.set_tipo(i, j, OBSTACULO);
+
+  while(arriba <= abajo && izquierda <= derecha){
+    for(int j = izquierda; j <= derecha; ++j)
+      jardin.set_tipo(arriba, j, CESPED_A);
+    for(int i = arriba + 1; i <= abajo; ++i)
+      jardin.set_tipo(i, derecha, CESPED_A);
+    if(abajo > arriba)
+      for(int j = derecha - 1; j >= izquierda; --j)
+        jardin.set_tipo(abajo, j, CESPED_A);
+    if(derecha > izquierda)
+      for(int i = abajo - 1; i >= arriba + 2; --i)
+        jardin.set_tipo(i, izquierda, CESPED_A);
+
+    // Paso hacia la siguiente vuelta, si la hay
+    if(arriba + 2 <= abajo - 2 && izquierda + 2 <= derecha - 2)
+      jardin.set_tipo(arriba + 2, izquierda + 1, CESPED_A);
+    arriba += 2;
+    izquierda += 2;
+    abajo -= 2;
+    derecha -= 2;
+  }
+}
+
+// Las filas impares son paredes con un hueco que alterna entre los dos
+// extremos.
+static void pasillos(Jardin& jardin){
+  int n = jardin.filas();
+  for(int i = 1; i < n - 1; i += 2){
+    int hueco = (i/2)%2 == 0? n - 1 : 0;
+    for(int j = 0; j < n; ++j)
+      if(j != hueco)
+        jardin.set_tipo(i, j, OBSTACULO);
+  }
+}
+
+static void damero(Jardin& jardin){
+  for(int i = 1; i < jardin.filas(); i += 2)
+    for(int j = 1; j < jardin.columnas(); j += 2)
+      jardin.set_tipo(i, j, OBSTACULO);
+}
+
+// Habitaciones separadas por paredes y unidas por puertas formando un árbol,
+// de forma que cada una es un callejón sin salida. La habitación del centro
+// no tiene ninguna puerta y B queda dentro de ella.
+static void murado(Jardin& jardin, unsigned semilla, Posicion& b){
+  int n = jardin.filas();
+  int m = (n + LADO_HABITACION - 1)/LADO_HABITACION;
+  int cerrada = m >= 2? (m/2)*m + m/2 : -1;
+  Aleatorio aleatorio(semilla);
+
+  for(int i = 0; i < n; ++i)
+    for(int j = 0; j < n; ++j)
+      if(i%LADO_HABITACION == LADO_HABITACION - 1 || j%LADO_HABITACION == LADO_HABITACION - 1)
+        jardin.set_tipo(i, j, OBSTACULO);
+
+  // Recorrido en profundidad aleatorio por las habitaciones. Cada vez que se
+  // pasa a una nueva se abre una puerta en la pared que las separa.
+  std::vector<bool> visitada(m*m, false);
+  std::vector<int> pila(1, 0);
+  visitada[0] = true;
+  if(cerrada >= 0)
+    visitada[cerrada] = true;
+  while(!pila.empty()){
+    int h = pila.back();
+    int vecinas[4], num = 0;
+    for(int k = 0; k < 4; ++k){
+      Posicion q = desplazar(Posicion(h/m, h%m), MOVIMIENTOS[k]);
+      if(q.fila >= 0 && q.fila < m && q.columna >= 0 && q.columna < m &&
+         !visitada[q.fila*m + q.columna])
+        vecinas[num++] = k;
+    }
+    if(num == 0){
+      pila.pop_back();
+      continue;
+    }
+
+    Movimientos mov = MOVIMIENTOS[vecinas[aleatorio.entero(num)]];
+    Posicion p(h/m, h%m), q = desplazar(p, mov);
+    Posicion menor = q.fila < p.fila || q.columna < p.columna? q : p;
+    int desde = (mov == ARRIBA || mov == ABAJO? menor.columna : menor.fila)*LADO_HABITACION;
+    int hueco = desde + aleatorio.entero(std::min(LADO_HABITACION - 1, n - desde));
+    if(mov == ARRIBA || mov == ABAJO)
+      jardin.set_tipo((menor.fila + 1)*LADO_HABITACION - 1, hueco, CESPED_A);
+    else
+      jardin.set_tipo(hueco, (menor.columna + 1)*LADO_HABITACION - 1, CESPED_A);
+
+    visitada[q.fila*m + q.columna] = true;
+    pila.push_back(q.fila*m + q.columna);
+  }
+
+  if(cerrada >= 0)
+    b = Posicion((cerrada/m)*LADO_HABITACION + LADO_HABITACION/2 - 1,
+                 (cerrada%m)*LADO_HABITACION + LADO_HABITACION/2 - 1);
+}
+
+// Obstáculos en la diagonal principal salvo en el inicio, de forma que las
+// dos mitades del jardín sólo se tocan a través de él. Los algoritmos de
+// cobertura tienen que volver a pasar por el inicio para cortar la segunda.
+static void diagonal(Jardin& jardin){
+  for(int i = 1; i < jardin.filas(); ++i)
+    jardin.set_tipo(i, i, OBSTACULO);
+}
+
+Jardin jardin_estres(FormaEstres forma, int tamano, unsigned semilla, Posicion& a, Posicion& b){
+  tamano = std::max(tamano, MIN_TAMANO);
+  Jardin jardin(tamano, tamano);
+  a = Posicion(0, 1);
+  b = Posicion(-1, -1);
+
+  switch(forma){
+  case ESTRES_ESPIRAL:
+    espiral(jardin);
+    break;
+  case ESTRES_PASILLOS:
+    pasillos(jardin);
+    break;
+  case ESTRES_DAMERO:
+    damero(jardin);
+    break;
+  case ESTRES_MURADO:
+    murado(jardin, semilla, b);
+    break;
+  case ESTRES_DIAGONAL:
+    diagonal(jardin);
+    break;
+  default:
+    break;
+  }
+  jardin.set_tipo(0, 0, INICIO);
+
+  // Si la forma no lo ha elegido, B es la celda más alejada de A
+  if(b.fila < 0){
+    std::vector<int> dist;
+    jardin.distancias(a, dist);
+    int lejana = jardin.indice(a.fila, a.columna);
+    for(int c = 0; c < jardin.celdas(); ++c)
+      if(dist[c] > dist[lejana])
+        lejana = c;
+    b = jardin.posicion(lejana);
+  }
+  jardin.set_tipo(a.fila, a.columna, PUNTO_A);
+  jardin.set_tipo(b.fila, b.columna, PUNTO_B);
+  return jardin;
+}
+
+/*
+ * ANÁLISIS
+ */
+
+// Exponente de "despues" respecto a "antes" cuando el número de celdas pasa
+// de "celdas_antes" a "celdas_despues".
+static double exponente_crecimiento(double antes, double despues, double celdas_antes,
+                                    double celdas_despues){
+  return std::log(despues/antes)/std::log(celdas_despues/celdas_antes);
+}
+
+void analizar_serie(SerieEstres& serie, double exponente, qint64 minimo_us, qint64 minimo_bytes){
+  const std::vector<MedidaEstres>& medidas = serie.medidas;
+  serie.exp_tiempo.assign(medidas.size(), 0);
+  serie.exp_memoria.assign(medidas.size(), 0);
+  serie.problema = -1;
+  serie.motivo.clear();
+
+  for(unsigned i = 0; i < medidas.size(); ++i){
+    const MedidaEstres& m = medidas[i];
+    if(m.estado != ESTRES_BIEN){
+      if(serie.problema < 0){
+        serie.problema = i;
+        serie.motivo = QString("%1 con %2x%2").arg(texto_estado(m.estado)).arg(m.tamano);
+      }
+      continue;
+    }
+    if(i == 0 || medidas[i-1].estado != ESTRES_BIEN || medidas[i-1].tamano >= m.tamano)
+      continue;
+
+    const MedidaEstres& antes = medidas[i-1];
+    double celdas_antes = static_cast<double>(antes.tamano)*antes.tamano;
+    double celdas = static_cast<double>(m.tamano)*m.tamano;
+    if(antes.tiempo_us >= minimo_us && m.tiempo_us >= minimo_us)
+      serie.exp_tiempo[i] = exponente_crecimiento(antes.tiempo_us, m.tiempo_us, celdas_antes,
+                                                  celdas);
+    if(antes.memoria >= minimo_bytes && m.memoria >= minimo_bytes)
+      serie.exp_memoria[i] = exponente_crecimiento(antes.memoria, m.memoria, celdas_antes, celdas);
+
+    if(serie.problema >= 0)
+      continue;
+    if(serie.exp_tiempo[i] > exponente){
+      serie.problema = i;
+      serie.motivo = QString("el tiempo crece con exponente %1 entre %2x%2 y %3x%3 (%4ms a %5ms)")
+                     .arg(serie.exp_tiempo[i], 0, 'f', 2).arg(antes.tamano).arg(m.tamano)
+                     .arg(antes.tiempo_us/1000.0, 0, 'f', 1).arg(m.tiempo_us/1000.0, 0, 'f', 1);
+    }
+    else if(serie.exp_memoria[i] > exponente){
+      serie.problema = i;
+      serie.motivo = QString("la memoria crece con exponente %1 entre %2x%2 y %3x%3 (%4KB a %5KB)")
+                     .arg(serie.exp_memoria[i], 0, 'f', 2).arg(antes.tamano).arg(m.tamano)
+                     .arg(antes.memoria/1024.0, 0, 'f', 1).arg(m.memoria/1024.0, 0, 'f', 1);
+    }
+  }
+}
+
+QString texto_estres(const std::vector<SerieEstres>& series){
+  QString texto = "---===PRUEBAS DE ESTRÉS===---\n";
+  int problemas = 0;
+  for(unsigned s = 0; s < series.size(); ++s)
+    problemas += series[s].problema >= 0;
+  texto += QString("Series con problemas: %1 de %2\n")
+           .arg(problemas).arg(static_cast<int>(series.size()));
+
+  for(unsigned s = 0; s < series.size(); ++s){
+    const SerieEstres& serie = series[s];
+    if(s == 0 || series[s-1].forma != serie.forma)
+      texto += QString("\n%1:\n").arg(nombre_forma_estres(serie.forma));
+    texto += QString("-%1\n").arg(nombre_planificador(serie.planificador));
+
+    for(unsigned i = 0; i < serie.medidas.size(); ++i){
+      const MedidaEstres& m = serie.medidas[i];
+      texto += QString("  %1x%1: ").arg(m.tamano);
+      if(m.estado != ESTRES_BIEN && m.estado != ESTRES_FALLO){
+        texto += QString(texto_estado(m.estado)) + "\n";
+        continue;
+      }
+      texto += QString("%1ms, %2KB, %3 movimientos").arg(m.tiempo_us/1000.0, 0, 'f', 1)
+               .arg(m.memoria/1024.0, 0, 'f', 1).arg(m.movimientos);
+      if(i < serie.exp_tiempo.size() && serie.exp_tiempo[i] > 0)
+        texto += QString(", tiempo ^%1").arg(serie.exp_tiempo[i], 0, 'f', 2);
+      if(i < serie.exp_memoria.size() && serie.exp_memoria[i] > 0)
+        texto += QString(", memoria ^%1").arg(serie.exp_memoria[i], 0, 'f', 2);
+      if(m.estado == ESTRES_FALLO)
+        texto += QString(" ") + texto_estado(m.estado);
+      texto += "\n";
+    }
+
+    if(serie.problema >= 0){
+      texto += "  PROBLEMA: " + serie.motivo + "\n";
+      if(!serie.fichero.isEmpty())
+        texto += "  Jardín guardado en " + serie.fichero + "\n";
+    }
+  }
+  return texto;
+}
@@ -0,0 +1,247 @@
+#include "exploracion.h"
+
+#include <algorithm>
+
+#include <QElapsedTimer>
+
+// Las fronteras que están como mucho a esta distancia más que la más cercana
+// también se tienen en cuenta al elegir.
+static const int MARGEN_FRONTERA = 2;
+
+// Los grupos de frontera se miden hasta este tamaño; a partir de ahí todos
+// se consideran igual de grandes.
+static const int MAX_GRUPO = 64;
+
+// Cada cuántos movimientos se anota el número de celdas conocidas.
+static const int MUESTREO = 50;
+
+Explorador::Explorador(int filas, int columnas, const Posicion& inicio):
+  rows(filas), columns(columnas), mapa(filas*columnas, DESCONOCIDA),
+  visitada(filas*columnas, false), num_conocidas(1), paso(0),
+  marca(filas*columnas, 0), padre(filas*columnas, -1), sello(0),
+  marca_grupo(filas*columnas, 0), sello_grupo(0)
+{
+  // La cortadora conoce la celda en la que empieza
+  mapa[inicio.fila*columns + inicio.columna] = LIBRE;
+  visitada[inicio.fila*columns + inicio.columna] = true;
+  stats.conocidas.push_back(std::make_pair(0, num_conocidas));
+}
+
+void Explorador::observar(const Posicion& p, const bool obstaculo[4]){
+  for(int k = 0; k < 4; ++k){
+    Posicion q = desplazar(p, MOVIMIENTOS[k]);
+    if(!dentro(q))
+      continue;
+    EstadoCelda& e = mapa[q.fila*columns + q.columna];
+    if(e == DESCONOCIDA){
+      e = obstaculo[k]? OCUPADA : LIBRE;
+      ++num_conocidas;
+    }
+  }
+}
+
+void Explorador::movido(){
+  ++stats.movimientos;
+  if(stats.movimientos % MUESTREO == 0)
+    stats.conocidas.push_back(std::make_pair(stats.movimientos, num_conocidas));
+}
+
+// Número de vecinas de una celda por las que todavía podría interesar pasar:
+// césped sin cortar o celdas desconocidas.
+int Explorador::salidas(const Posicion& p) const {
+  int n = 0;
+  for(int k = 0; k < 4; ++k){
+    Posicion q = desplazar(p, MOVIMIENTOS[k]);
+    if(dentro(q)){
+      int c = q.fila*columns + q.columna;
+      if(mapa[c] == DESCONOCIDA || frontera(c))
+        ++n;
+    }
+  }
+  return n;
+}
+
+// Tamaño del grupo de celdas de frontera conectadas al que pertenece la
+// celda, contando como mucho hasta "maximo".
+int Explorador::tamano_grupo(int celda, int maximo){
+  if(++sello_grupo == 0){
+    std::fill(marca_grupo.begin(), marca_grupo.end(), 0);
+    sello_grupo = 1;
+  }
+
+  grupo.assign(1, celda);
+  marca_grupo[celda] = sello_grupo;
+
+  for(unsigned i = 0; i < grupo.size() && (int) grupo.size() < maximo; ++i){
+    Posicion p(grupo[i]/columns, grupo[i]%columns);
+    for(int k = 0; k < 4; ++k){
+      Posicion q = desplazar(p, MOVIMIENTOS[k]);
+      if(!dentro(q))
+        continue;
+      int c = q.fila*columns + q.columna;
+      if(frontera(c) && marca_grupo[c] != sello_grupo){
+        marca_grupo[c] = sello_grupo;
+        grupo.push_back(c);
+      }
+    }
+  }
+  return std::min<int>(grupo.size(), maximo);
+}
+
+// Búsqueda en anchura por las celdas libres conocidas. Se detiene cuando se
+// ha alejado MARGEN_FRONTERA más allá de la primera frontera encontrada y
+// elige entre las fronteras vistas la del grupo más pequeño.
+bool Explorador::buscar_frontera(const Posicion& p){
+  if(++sello == 0){
+    std::fill(marca.begin(), marca.end(), 0);
+    sello = 1;
+  }
+
+  std::vector<int> dist_cola;
+  int origen = p.fila*columns + p.columna;
+  int limite = -1, elegida = -1, mejor_grupo = 0;
+
+  cola.clear();
+  cola.push_back(origen);
+  dist_cola.push_back(0);
+  marca[origen] = sello;
+  padre[origen] = -1;
+
+  for(unsigned i = 0; i < cola.size(); ++i){
+    int c = cola[i], d = dist_cola[i];
+    if(limite >= 0 && d > limite)
+      break;
+
+    if(frontera(c)){
+      int grupo = tamano_grupo(c, MAX_GRUPO);
+      if(elegida < 0 || grupo < mejor_grupo){
+        elegida = c;
+        mejor_grupo = grupo;
+      }
+      if(limite < 0)
+        limite = d + MARGEN_FRONTERA;
+      continue;
+    }
+
+    Posicion q0(c/columns, c%columns);
+    for(int k = 0; k < 4; ++k){
+      Posicion q = desplazar(q0, MOVIMIENTOS[k]);
+      if(!dentro(q))
+        continue;
+      int v = q.fila*columns + q.columna;
+      if(mapa[v] == LIBRE && marca[v] != sello){
+        marca[v] = sello;
+        padre[v] = c;
+        cola.push_back(v);
+        dist_cola.push_back(d+1);
+      }
+    }
+  }
+
+  if(elegida < 0)
+    return false;
+
+  // Se reconstruye el camino desde la frontera elegida hacia atrás
+  plan.clear();
+  paso = 0;
+  for(int c = elegida; padre[c] >= 0; c = padre[c]){
+    int a = padre[c];
+    if(c == a - columns)
+      plan.push_back(ARRIBA);
+    else if(c == a + columns)
+      plan.push_back(ABAJO);
+    else if(c == a - 1)
+      plan.push_back(IZQUIERDA);
+    else
+      plan.push_back(DERECHA);
+  }
+  std::reverse(plan.begin(), plan.end());
+  return true;
+}
+
+bool Explorador::decidir(const Posicion& p, Movimientos& mov){
+  visitada[p.fila*columns + p.columna] = true;
+
+  // Si se está yendo hacia una frontera se sigue el camino, que sólo pasa
+  // por celdas libres conocidas
+  if(paso < plan.size()){
+    mov = plan[paso++];
+    return true;
+  }
+
+  // Si hay césped sin cortar al lado se va a la celda con menos salidas
+  int mejor = -1, menos_salidas = 5;
+  for(int k = 0; k < 4; ++k){
+    Posicion q = desplazar(p, MOVIMIENTOS[k]);
+    if(dentro(q) && frontera(q.fila*columns + q.columna)){
+      int s = salidas(q);
+      if(s < menos_salidas){
+        menos_salidas = s;
+        mejor = k;
+      }
+    }
+  }
+  if(mejor >= 0){
+    mov = MOVIMIENTOS[mejor];
+    return true;
+  }
+
+  // Si no, se busca la frontera más conveniente
+  ++stats.busquedas;
+  if(!buscar_frontera(p))
+    return false;
+  mov = plan[paso++];
+  return true;
+}
+
+bool Explorador::siguiente(const Posicion& p, Movimientos& mov){
+  QElapsedTimer reloj;
+  reloj.start();
+
+  bool hay = decidir(p, mov);
+
+  long long ns = reloj.nsecsElapsed();
+  ++stats.decisiones;
+  stats.coste_total_ns += ns;
+  if(ns > stats.coste_peor_ns)
+    stats.coste_peor_ns = ns;
+  if(!hay)
+    stats.conocidas.push_back(std::make_pair(stats.movimientos, num_conocidas));
+  return hay;
+}
+
+Resultado exploracion(const Jardin& jardin, const Posicion& inicio,
+                      EstadisticasExploracion* stats){
+  Resultado res;
+  Explorador explorador(jardin.filas(), jardin.columnas(), inicio);
+  Posicion p = inicio;
+  Movimientos mov;
+  std::vector<bool> cortada(jardin.celdas(), false);
+
+  res.cesped = celdas_cesped(jardin);
+  for(;;){
+    if(jardin.transitable(p.fila, p.columna) && !cortada[jardin.indice(p.fila, p.columna)]){
+      cortada[jardin.indice(p.fila, p.columna)] = true;
+      ++res.cortadas;
+    }
+
+    bool obstaculo[4];
+    for(int k = 0; k < 4; ++k){
+      Posicion q = desplazar(p, MOVIMIENTOS[k]);
+      obstaculo[k] = !jardin.transitable(q.fila, q.columna);
+    }
+    explorador.observar(p, obstaculo);
+
+    if(!explorador.siguiente(p, mov))
+      break;
+    p = desplazar(p, mov);
+    explorador.movido();
+    ++res.movimientos;
+    res.coste += jardin.coste(p.fila, p.columna);
+  }
+
+  res.exito = true;
+  if(stats)
+    *stats = explorador.estadisticas();
+  return res;
+}
@@ -0,0 +1,452 @@
+#include "generador.h"
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <utility>
+
+#include <QtConcurrentMap>
+
+#include "aleatorio.h"
+
+// A partir de este número de celdas el relleno se reparte entre hilos, en
+// bloques de este número de filas.
+static const int UMBRAL_PARALELO = 512*512;
+static const int FILAS_POR_BLOQUE = 64;
+
+// Tamaño en celdas de las manchas más grandes y número de octavas de ruido
+// que se suman, cada una con la mitad de tamaño y de peso que la anterior.
+static const float ESCALA_MANCHAS = 12.0f;
+static const int OCTAVAS = 3;
+
+// Lado de los sectores en los que se reparten las habitaciones, una por
+// sector, y probabilidad de unir cada una también con la de arriba.
+static const int LADO_SECTOR = 12;
+static const int PORCENTAJE_CICLOS = 25;
+
+// Separación entre parterres, probabilidad de que haya uno en cada hueco y
+// fracción de filas del borde inferior que está en pendiente.
+static const int PERIODO_FILAS_PARTERRE = 7;
+static const int PERIODO_COLUMNAS_PARTERRE = 10;
+static const int PORCENTAJE_PARTERRES = 70;
+static const int FRACCION_TALUD = 10;
+
+const char* nombre_generador(TipoGenerador tipo){
+  switch(tipo){
+  case GENERADOR_UNIFORME:
+    return "Obstáculos uniformes";
+  case GENERADOR_MANCHAS:
+    return "Manchas de obstáculos";
+  case GENERADOR_LABERINTO:
+    return "Laberinto";
+  case GENERADOR_HABITACIONES:
+    return "Habitaciones y pasillos";
+  case GENERADOR_PARTERRES:
+    return "Parterres";
+  default:
+    return "";
+  }
+}
+
+// Número pseudoaleatorio que sólo depende de la semilla y de la celda, para
+// que el resultado no dependa del orden en que se rellenan las celdas.
+static unsigned mezclar(unsigned semilla, int fila, int columna){
+  unsigned h = semilla + static_cast<unsigned>(fila)*0x9E3779B1u;
+  h ^= h >> 15;
+  h *= 0x2C1B3C6Du;
+  h ^= static_cast<unsigned>(columna)*0x85EBCA77u;
+  h ^= h >> 12;
+  h *= 0x297A2D39u;
+  h ^= h >> 15;
+  return h;
+}
+
+/*
+ * RUIDO
+ */
+
+static float valor_red(unsigned semilla, int fila, int columna){
+  return (mezclar(semilla, fila, columna) & 0xFFFFFF)/16777216.0f;
+}
+
+static float suavizar(float t){
+  return t*t*(3 - 2*t);
+}
+
+// Ruido de valores: números al azar en los puntos de una red interpolados
+// suavemente entre ellos.
+static float ruido(unsigned semilla, float fila, float columna){
+  int f0 = static_cast<int>(std::floor(fila)), c0 = static_cast<int>(std::floor(columna));
+  float tf = suavizar(fila - f0), tc = suavizar(columna - c0);
+
+  float arriba = valor_red(semilla, f0, c0) +
+                 tc*(valor_red(semilla, f0, c0 + 1) - valor_red(semilla, f0, c0));
+  float abajo = valor_red(semilla, f0 + 1, c0) +
+                tc*(valor_red(semilla, f0 + 1, c0 + 1) - valor_red(semilla, f0 + 1, c0));
+  return arriba + tf*(abajo - arriba);
+}
+
+static float manchas(unsigned semilla, int fila, int columna){
+  float total = 0, peso = 1, escala = ESCALA_MANCHAS;
+  for(int o = 0; o < OCTAVAS; ++o){
+    total += peso*ruido(semilla + o*0x68E31DA4u, fila/escala, columna/escala);
+    peso *= 0.5f;
+    escala *= 0.5f;
+  }
+  return total;
+}
+
+/*
+ * RELLENO POR BLOQUES DE FILAS
+ */
+
+// Cada bloque escribe sólo en sus filas, así que varios bloques se pueden
+// rellenar a la vez sobre el mismo jardín.
+struct BloqueFilas {
+  const Generador* generador;
+  Jardin* jardin;
+  std::vector<float>* valores;
+  int desde, hasta;
+};
+
+static void rellenar_uniforme(BloqueFilas& bloque){
+  for(int i = bloque.desde; i < bloque.hasta; ++i)
+    for(int j = 0; j < bloque.jardin->columnas(); ++j)
+      if(static_cast<int>(mezclar(bloque.generador->semilla, i, j) % 100) <
+         bloque.generador->densidad)
+        bloque.jardin->set_tipo(i, j, OBSTACULO);
+}
+
+static void rellenar_manchas(BloqueFilas& bloque){
+  for(int i = bloque.desde; i < bloque.hasta; ++i)
+    for(int j = 0; j < bloque.jardin->columnas(); ++j)
+      (*bloque.valores)[bloque.jardin->indice(i, j)] = manchas(bloque.generador->semilla, i, j);
+}
+
+static void por_bloques(Jardin& jardin, const Generador& generador,
+                        std::vector<float>* valores, void (*rellenar)(BloqueFilas&)){
+  std::vector<BloqueFilas> bloques;
+  for(int i = 0; i < jardin.filas(); i += FILAS_POR_BLOQUE){
+    BloqueFilas bloque = {&generador, &jardin, valores, i,
+                          std::min(i + FILAS_POR_BLOQUE, jardin.filas())};
+    bloques.push_back(bloque);
+  }
+
+  if(jardin.celdas() >= UMBRAL_PARALELO)
+    QtConcurrent::blockingMap(bloques, rellenar);
+  else
+    for(unsigned i = 0; i < bloques.size(); ++i)
+      rellenar(bloques[i]);
+}
+
+/*
+ * GENERADORES
+ */
+
+// Las celdas con el ruido más alto son obstáculos. El umbral se elige para
+// que haya exactamente el porcentaje de obstáculos pedido.
+static void generar_manchas(Jardin& jardin, const Generador& generador){
+  std::vector<float> valores(jardin.celdas());
+  por_bloques(jardin, generador, &valores, rellenar_manchas);
+
+  int obstaculos = jardin.celdas()*generador.densidad/100;
+  if(obstaculos <= 0)
+    return;
+
+  std::vector<std::pair<float, int> > orden(jardin.celdas());
+  for(int i = 0; i < jardin.celdas(); ++i)
+    orden[i] = std::make_pair(-valores[i], i);
+  std::nth_element(orden.begin(), orden.begin() + obstaculos - 1, orden.end());
+  for(int i = 0; i < obstaculos; ++i){
+    Posicion p = jardin.posicion(orden[i].second);
+    jardin.set_tipo(p.fila, p.columna, OBSTACULO);
+  }
+}
+
+// Laberinto perfecto por búsqueda en profundidad aleatoria. Las celdas de
+// coordenadas impares son los pasillos y el resto las paredes que se van
+// abriendo.
+static void generar_laberinto(Jardin& jardin, Aleatorio& azar){
+  for(int i = 0; i < jardin.filas(); ++i)
+    for(int j = 0; j < jardin.columnas(); ++j)
+      jardin.set_tipo(i, j, OBSTACULO);
+
+  int filas = jardin.filas()/2, columnas = jardin.columnas()/2;
+  if(filas == 0 || columnas == 0)
+    return;
+
+  std::vector<char> visitada(filas*columnas, 0);
+  std::vector<Posicion> pila(1, Posicion(0, 0));
+  visitada[0] = 1;
+  jardin.set_tipo(1, 1, CESPED_A);
+
+  while(!pila.empty()){
+    Posicion p = pila.back();
+    Movimientos opciones[4];
+    int n = 0;
+    for(int k = 0; k < 4; ++k){
+      Posicion q = desplazar(p, MOVIMIENTOS[k]);
+      if(q.fila >= 0 && q.columna >= 0 && q.fila < filas && q.columna < columnas &&
+         !visitada[q.fila*columnas + q.columna])
+        opciones[n++] = MOVIMIENTOS[k];
+    }
+    if(n == 0){
+      pila.pop_back();
+      continue;
+    }
+
+    Posicion q = desplazar(p, opciones[azar.entero(n)]);
+    visitada[q.fila*columnas + q.columna] = 1;
+    jardin.set_tipo(p.fila + q.fila + 1, p.columna + q.columna + 1, CESPED_A);
+    jardin.set_tipo(2*q.fila + 1, 2*q.columna + 1, CESPED_A);
+    pila.push_back(q);
+  }
+}
+
+// Abre un pasillo recto entre dos celdas de la misma fila o columna.
+static void abrir_pasillo(Jardin& jardin, const Posicion& desde, const Posicion& hasta){
+  for(int i = std::min(desde.fila, hasta.fila); i <= std::max(desde.fila, hasta.fila); ++i)
+    for(int j = std::min(desde.columna, hasta.columna); j <= std::max(desde.columna, hasta.columna); ++j)
+      jardin.set_tipo(i, j, CESPED_A);
+}
+
+// Habitaciones rectangulares, una en cada sector de una rejilla, unidas por
+// pasillos en forma de L con la del sector de la izquierda y, de vez en
+// cuando, con la de arriba. La primera columna siempre se une hacia arriba,
+// así que todas las habitaciones quedan unidas entre sí.
+static void generar_habitaciones(Jardin& jardin, Aleatorio& azar){
+  // Si no cabe ni una habitación con su pared, todo el jardín es una
+  if(jardin.filas() < LADO_MINIMO || jardin.columnas() < LADO_MINIMO)
+    return;
+
+  for(int i = 0; i < jardin.filas(); ++i)
+    for(int j = 0; j < jardin.columnas(); ++j)
+      jardin.set_tipo(i, j, OBSTACULO);
+
+  // Cada habitación necesita al menos 3x3 celdas y una pared alrededor
+  int sectores_f = (jardin.filas() - LADO_MINIMO)/LADO_SECTOR + 1;
+  int sectores_c = (jardin.columnas() - LADO_MINIMO)/LADO_SECTOR + 1;
+  std::vector<Posicion> centros(sectores_f*sectores_c);
+
+  for(int sf = 0; sf < sectores_f; ++sf)
+    for(int sc = 0; sc < sectores_c; ++sc){
+      int f = 1 + sf*LADO_SECTOR, c = 1 + sc*LADO_SECTOR;
+      int alto_max = std::min(LADO_SECTOR - 1, jardin.filas() - 1 - f);
+      int ancho_max = std::min(LADO_SECTOR - 1, jardin.columnas() - 1 - c);
+      int alto = std::min(alto_max, 3 + azar.entero(alto_max - 2));
+      int ancho = std::min(ancho_max, 3 + azar.entero(ancho_max - 2));
+      f += azar.entero(alto_max - alto + 1);
+      c += azar.entero(ancho_max - ancho + 1);
+
+      for(int i = f; i < f + alto; ++i)
+        for(int j = c; j < c + ancho; ++j)
+          jardin.set_tipo(i, j, CESPED_A);
+      centros[sf*sectores_c + sc] = Posicion(f + alto/2, c + ancho/2);
+    }
+
+  for(int sf = 0; sf < sectores_f; ++sf)
+    for(int sc = 0; sc < sectores_c; ++sc){
+      const Posicion& b = centros[sf*sectores_c + sc];
+      std::vector<Posicion> vecinas;
+      if(sc > 0)
+        vecinas.push_back(centros[sf*sectores_c + sc - 1]);
+      if(sf > 0 && (sc == 0 || azar.porcentaje(PORCENTAJE_CICLOS)))
+        vecinas.push_back(centros[(sf - 1)*sectores_c + sc]);
+
+      for(unsigned k = 0; k < vecinas.size(); ++k){
+        const Posicion& a = vecinas[k];
+        Posicion esquina = azar.porcentaje(50)? Posicion(a.fila, b.columna) :
+                                                Posicion(b.fila, a.columna);
+        abrir_pasillo(jardin, a, esquina);
+        abrir_pasillo(jardin, esquina, b);
+      }
+    }
+}
+
+// Césped con un camino de grava en cruz, parterres rectangulares rodeados de
+// césped denso, un talud en pendiente en el borde inferior y árboles sueltos.
+static void generar_parterres(Jardin& jardin, const Generador& generador, Aleatorio& azar){
+  int camino_f = jardin.filas()/2, camino_c = jardin.columnas()/2;
+  int talud = jardin.filas() - jardin.filas()/FRACCION_TALUD;
+
+  for(int i = 0; i < jardin.filas(); ++i)
+    for(int j = 0; j < jardin.columnas(); ++j){
+      if(i == camino_f || j == camino_c)
+        jardin.set_terreno(i, j, GRAVA);
+      else if(i >= talud)
+        jardin.set_terreno(i, j, PENDIENTE);
+    }
+
+  for(int f = 2; f + 3 < talud; f += PERIODO_FILAS_PARTERRE)
+    for(int c = 2; c + 4 < jardin.columnas(); c += PERIODO_COLUMNAS_PARTERRE){
+      if(!azar.porcentaje(PORCENTAJE_PARTERRES))
+        continue;
+      int alto = 2 + azar.entero(3), ancho = 3 + azar.entero(5);
+      int fin_f = std::min(f + alto, talud - 1), fin_c = std::min(c + ancho, jardin.columnas() - 1);
+      if((f - 1 <= camino_f && camino_f <= fin_f) || (c - 1 <= camino_c && camino_c <= fin_c))
+        continue;
+
+      for(int i = f - 1; i <= fin_f; ++i)
+        for(int j = c - 1; j <= fin_c; ++j){
+          if(i >= f && i < fin_f && j >= c && j < fin_c)
+            jardin.set_tipo(i, j, OBSTACULO);
+          else
+            jardin.set_terreno(i, j, DENSO);
+        }
+    }
+
+  // Los árboles salen con una décima parte de la densidad
+  for(int i = 0; i < jardin.filas(); ++i)
+    for(int j = 0; j < jardin.columnas(); ++j)
+      if(jardin.terreno(i, j) == LLANO &&
+         static_cast<int>(mezclar(generador.semilla, i, j) % 1000) < generador.densidad)
+        jardin.set_tipo(i, j, OBSTACULO);
+}
+
+/*
+ * CONECTIVIDAD
+ */
+
+// Marca como conectadas todas las celdas transitables a las que se llega
+// desde las de la cola sin atravesar obstáculos.
+static void inundar(const Jardin& jardin, std::vector<int>& cola, std::vector<char>& conectada){
+  for(unsigned i = 0; i < cola.size(); ++i){
+    Posicion p = jardin.posicion(cola[i]);
+    for(int k = 0; k < 4; ++k){
+      Posicion q = desplazar(p, MOVIMIENTOS[k]);
+      if(!jardin.transitable(q.fila, q.columna))
+        continue;
+      int c = jardin.indice(q.fila, q.columna);
+      if(!conectada[c]){
+        conectada[c] = 1;
+        cola.push_back(c);
+      }
+    }
+  }
+  cola.clear();
+}
+
+// Búsqueda 0-1 en anchura desde el inicio en la que entrar en un obstáculo
+// cuesta 1 y en cualquier otra celda 0. Después se recorren las celdas en el
+// orden en que se alcanzaron y cada zona de césped aislada se une con la
+// primera de sus celdas, quitando los obstáculos de su camino hasta el
+// inicio. Así cada zona se abre una sola vez y por donde menos obstáculos hay.
+int conectar_jardin(Jardin& jardin){
+  if(jardin.celdas() == 0)
+    return 0;
+
+  std::vector<int> dist(jardin.celdas(), -1), padre(jardin.celdas(), -1), orden;
+  std::vector<char> cerrada(jardin.celdas(), 0);
+  std::deque<int> cola;
+  dist[0] = 0;
+  cola.push_back(0);
+
+  while(!cola.empty()){
+    int c = cola.front();
+    cola.pop_front();
+    if(cerrada[c])
+      continue;
+    cerrada[c] = 1;
+    orden.push_back(c);
+
+    Posicion p = jardin.posicion(c);
+    for(int k = 0; k < 4; ++k){
+      Posicion q = desplazar(p, MOVIMIENTOS[k]);
+      if(!jardin.dentro(q.fila, q.columna))
+        continue;
+      int v = jardin.indice(q.fila, q.columna);
+      int coste = jardin.tipo(q.fila, q.columna) == OBSTACULO? 1 : 0;
+      if(v == 0 || cerrada[v] || (dist[v] >= 0 && dist[v] <= dist[c] + coste))
+        continue;
+      dist[v] = dist[c] + coste;
+      padre[v] = c;
+      if(coste == 0)
+        cola.push_front(v);
+      else
+        cola.push_back(v);
+    }
+  }
+
+  std::vector<char> conectada(jardin.celdas(), 0);
+  std::vector<int> pendientes(1, 0);
+  conectada[0] = 1;
+  inundar(jardin, pendientes, conectada);
+
+  int quitados = 0;
+  for(unsigned i = 0; i < orden.size(); ++i){
+    Posicion p = jardin.posicion(orden[i]);
+    if(conectada[orden[i]] || !jardin.transitable(p.fila, p.columna))
+      continue;
+
+    for(int c = orden[i]; !conectada[c]; c = padre[c]){
+      Posicion q = jardin.posicion(c);
+      if(jardin.tipo(q.fila, q.columna) == OBSTACULO){
+        jardin.set_tipo(q.fila, q.columna, CESPED_A);
+        ++quitados;
+      }
+      conectada[c] = 1;
+      pendientes.push_back(c);
+    }
+    inundar(jardin, pendientes, conectada);
+  }
+
+  return quitados;
+}
+
+Jardin generar_jardin(int filas, int columnas, const Generador& generador,
+                      Posicion& a, Posicion& b){
+  Jardin jardin(filas, columnas);
+  Aleatorio azar(mezclar(generador.semilla, filas, columnas));
+
+  switch(generador.tipo){
+  case GENERADOR_MANCHAS:
+    generar_manchas(jardin, generador);
+    break;
+  case GENERADOR_LABERINTO:
+    generar_laberinto(jardin, azar);
+    break;
+  case GENERADOR_HABITACIONES:
+    generar_habitaciones(jardin, azar);
+    break;
+  case GENERADOR_PARTERRES:
+    generar_parterres(jardin, generador, azar);
+    break;
+  case GENERADOR_UNIFORME:
+  default:
+    por_bloques(jardin, generador, NULL, rellenar_uniforme);
+    break;
+  }
+
+  jardin.set_tipo(0, 0, INICIO);
+  jardin.set_terreno(0, 0, LLANO);
+  if(generador.conectar)
+    conectar_jardin(jardin);
+
+  // Los obstáculos no tienen terreno
+  for(int i = 0; i < filas; ++i)
+    for(int j = 0; j < columnas; ++j)
+      if(jardin.tipo(i, j) == OBSTACULO)
+        jardin.set_terreno(i, j, LLANO);
+
+  // Los puntos A y B se eligen entre las celdas de césped
+  std::vector<int> cesped;
+  for(int i = 0; i < jardin.celdas(); ++i){
+    Posicion p = jardin.posicion(i);
+    if(jardin.transitable(p.fila, p.columna))
+      cesped.push_back(i);
+  }
+
+  a = b = Posicion(-1, -1);
+  if(cesped.size() >= 2){
+    int i = azar.entero(cesped.size());
+    int j = azar.entero(cesped.size() - 1);
+    if(j >= i)
+      ++j;
+    a = jardin.posicion(cesped[i]);
+    b = jardin.posicion(cesped[j]);
+    jardin.set_tipo(a.fila, a.columna, PUNTO_A);
+    jardin.set_tipo(b.fila, b.columna, PUNTO_B);
+  }
+
+  return jardin;
+}
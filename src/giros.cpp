@@ -0,0 +1,406 @@
+#include "giros.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+
+// Orientación de la cortadora antes de su primer movimiento, en el que puede
+// salir hacia cualquier lado sin girar.
+static const int SIN_ORIENTACION = -1;
+
+// Pasada recta entre dos celdas de la misma fila o columna, con "a" a la
+// izquierda o encima de "b".
+struct Pasada {
+  Pasada(const Posicion& a, const Posicion& b): a(a), b(b) {}
+
+  Posicion a, b;
+};
+
+// Las dos formas de barrer una región, ordenadas de arriba abajo y de
+// izquierda a derecha.
+struct Region {
+  std::vector<Pasada> horizontales, verticales;
+};
+
+// Estado de la cobertura. Las celdas cortadas se apuntan en orden para poder
+// deshacer un barrido y probar el otro. La celda de inicio no es transitable
+// pero la cortadora puede volver a pasar por ella, así que las búsquedas
+// también la atraviesan.
+struct EstadoGiros {
+  Posicion pos, inicio;
+  int orientacion;
+  int coste, cortadas;
+  std::vector<char> pendiente;
+  std::vector<Movimientos> movs;
+  std::vector<int> cortadas_orden;
+};
+
+// Punto al que se puede volver con deshacer().
+struct MarcaGiros {
+  MarcaGiros(const EstadoGiros& e): pos(e.pos), orientacion(e.orientacion),
+    coste(e.coste), movs(e.movs.size()), cortadas(e.cortadas_orden.size()) {}
+
+  Posicion pos;
+  int orientacion, coste;
+  unsigned movs, cortadas;
+};
+
+// Memoria de las búsquedas que se reutiliza entre ellas, igual que en los
+// planificadores. Los estados de la búsqueda con giros son celda*4 más la
+// orientación con la que se ha llegado a ella.
+struct MemoriaGiros {
+  MemoriaGiros(int celdas): marca(4*celdas, 0), coste(4*celdas, 0), padre(4*celdas, -1),
+    marca_celda(celdas, 0), sello(0) {}
+
+  void nuevo_sello(){
+    if(++sello == 0){
+      std::fill(marca.begin(), marca.end(), 0);
+      std::fill(marca_celda.begin(), marca_celda.end(), 0);
+      sello = 1;
+    }
+  }
+
+  std::vector<unsigned> marca;
+  std::vector<int> coste, padre;
+  std::vector<unsigned> marca_celda;
+  std::vector<int> cola;
+  std::vector<std::vector<int> > cubos;
+  unsigned sello;
+};
+
+static int distancia(const Posicion& a, const Posicion& b){
+  return std::abs(a.fila - b.fila) + std::abs(a.columna - b.columna);
+}
+
+static int distancia(const Posicion& p, const Pasada& pasada){
+  return std::min(distancia(p, pasada.a), distancia(p, pasada.b));
+}
+
+static void avanzar(const Jardin& jardin, EstadoGiros& e, Movimientos mov, int coste_giro){
+  if(e.orientacion != SIN_ORIENTACION)
+    e.coste += coste_giro*giros_entre(static_cast<Movimientos>(e.orientacion), mov);
+  ++e.coste;
+  e.orientacion = mov;
+  e.pos = desplazar(e.pos, mov);
+  e.movs.push_back(mov);
+
+  int c = jardin.indice(e.pos.fila, e.pos.columna);
+  if(e.pendiente[c]){
+    e.pendiente[c] = false;
+    e.cortadas_orden.push_back(c);
+    ++e.cortadas;
+  }
+}
+
+static void deshacer(EstadoGiros& e, const MarcaGiros& marca){
+  while(e.cortadas_orden.size() > marca.cortadas){
+    e.pendiente[e.cortadas_orden.back()] = true;
+    e.cortadas_orden.pop_back();
+    --e.cortadas;
+  }
+  e.movs.resize(marca.movs);
+  e.pos = marca.pos;
+  e.orientacion = marca.orientacion;
+  e.coste = marca.coste;
+}
+
+// Celdas de césped a las que se puede llegar desde el inicio, que es lo
+// único que se puede cortar.
+static std::vector<char> alcanzables(const Jardin& jardin, const Posicion& inicio){
+  std::vector<char> alcanzable(jardin.celdas(), false);
+  std::vector<Posicion> cola(1, inicio);
+  if(jardin.transitable(inicio.fila, inicio.columna))
+    alcanzable[jardin.indice(inicio.fila, inicio.columna)] = true;
+
+  for(unsigned i = 0; i < cola.size(); ++i){
+    for(int k = 0; k < 4; ++k){
+      Posicion q = desplazar(cola[i], static_cast<Movimientos>(k));
+      if(jardin.transitable(q.fila, q.columna) &&
+         !alcanzable[jardin.indice(q.fila, q.columna)]){
+        alcanzable[jardin.indice(q.fila, q.columna)] = true;
+        cola.push_back(q);
+      }
+    }
+  }
+  return alcanzable;
+}
+
+// Descomposición del barrido en zigzag sobre la cuadrícula. Las pasadas
+// horizontales de dos filas seguidas son de la misma región mientras cada una
+// sólo toque a la otra. Cuando una pasada toca a dos de la fila siguiente, o
+// dos tocan a la misma, hay un obstáculo en medio y empiezan regiones nuevas.
+// Las pasadas verticales de cada región son los trozos de cada columna que
+// caen dentro de ella.
+static void descomponer(const Jardin& jardin, const std::vector<char>& alcanzable,
+                        std::vector<Region>& regiones, std::vector<int>& region){
+  int filas = jardin.filas(), columnas = jardin.columnas();
+  std::vector<int> pasada(jardin.celdas(), -1);
+  std::vector<Pasada> pasadas;
+
+  for(int i = 0; i < filas; ++i){
+    for(int j = 0; j < columnas; ++j){
+      if(!alcanzable[jardin.indice(i, j)])
+        continue;
+      int k = j;
+      while(k + 1 < columnas && alcanzable[jardin.indice(i, k + 1)])
+        ++k;
+      for(int c = j; c <= k; ++c)
+        pasada[jardin.indice(i, c)] = pasadas.size();
+      pasadas.push_back(Pasada(Posicion(i, j), Posicion(i, k)));
+      j = k;
+    }
+  }
+
+  // Cuántas pasadas toca cada una en la fila de abajo y en la de arriba
+  std::vector<int> abajo(pasadas.size(), 0), arriba(pasadas.size(), 0);
+  std::vector<int> encima(pasadas.size(), -1);
+  for(unsigned p = 0; p < pasadas.size(); ++p){
+    int i = pasadas[p].a.fila, anterior = -1;
+    if(i + 1 >= filas)
+      continue;
+    for(int c = pasadas[p].a.columna; c <= pasadas[p].b.columna; ++c){
+      int q = pasada[jardin.indice(i + 1, c)];
+      if(q >= 0 && q != anterior){
+        ++abajo[p];
+        ++arriba[q];
+        encima[q] = p;
+        anterior = q;
+      }
+    }
+  }
+
+  // Las pasadas están en orden de filas, así que la de encima ya tiene región
+  std::vector<int> region_pasada(pasadas.size());
+  regiones.clear();
+  for(unsigned p = 0; p < pasadas.size(); ++p){
+    if(arriba[p] == 1 && abajo[encima[p]] == 1)
+      region_pasada[p] = region_pasada[encima[p]];
+    else {
+      region_pasada[p] = regiones.size();
+      regiones.push_back(Region());
+    }
+    regiones[region_pasada[p]].horizontales.push_back(pasadas[p]);
+  }
+
+  region.assign(jardin.celdas(), -1);
+  for(int c = 0; c < jardin.celdas(); ++c)
+    if(pasada[c] >= 0)
+      region[c] = region_pasada[pasada[c]];
+
+  for(int j = 0; j < columnas; ++j){
+    for(int i = 0; i < filas; ++i){
+      int r = region[jardin.indice(i, j)];
+      if(r < 0)
+        continue;
+      int k = i;
+      while(k + 1 < filas && region[jardin.indice(k + 1, j)] == r)
+        ++k;
+      regiones[r].verticales.push_back(Pasada(Posicion(i, j), Posicion(k, j)));
+      i = k;
+    }
+  }
+}
+
+// Si la cortadora puede pasar por la celda: las transitables y el inicio.
+static bool se_puede_pasar(const Jardin& jardin, const EstadoGiros& e, const Posicion& q){
+  return q == e.inicio || jardin.transitable(q.fila, q.columna);
+}
+
+// Celda pendiente más cercana a la cortadora mediante búsqueda en anchura,
+// o -1 si no queda ninguna.
+static int pendiente_cercana(const Jardin& jardin, const EstadoGiros& e, MemoriaGiros& mem){
+  int inicio = jardin.indice(e.pos.fila, e.pos.columna);
+  if(e.pendiente[inicio])
+    return inicio;
+
+  mem.nuevo_sello();
+  mem.cola.clear();
+  mem.cola.push_back(inicio);
+  mem.marca_celda[inicio] = mem.sello;
+  for(unsigned i = 0; i < mem.cola.size(); ++i){
+    Posicion p = jardin.posicion(mem.cola[i]);
+    for(int k = 0; k < 4; ++k){
+      Posicion q = desplazar(p, static_cast<Movimientos>(k));
+      if(!se_puede_pasar(jardin, e, q))
+        continue;
+      int c = jardin.indice(q.fila, q.columna);
+      if(mem.marca_celda[c] == mem.sello)
+        continue;
+      if(e.pendiente[c])
+        return c;
+      mem.marca_celda[c] = mem.sello;
+      mem.cola.push_back(c);
+    }
+  }
+  return -1;
+}
+
+// Lleva la cortadora a uno de los extremos de la pasada y la recorre hasta el
+// otro. Primero se recorta la pasada a lo que queda sin cortar. El extremo se
+// elige con una búsqueda de menor coste sobre celda y orientación en la que
+// cada movimiento cuesta 1 más coste_giro por giro, contando también el giro
+// para seguir por la pasada al llegar. Como en dijkstra(), los costes son
+// enteros pequeños y la cola es de cubos: cada movimiento cuesta como mucho
+// 1 + 2*coste_giro, así que basta con 2*coste_giro + 2 cubos.
+static void recorrer_pasada(const Jardin& jardin, EstadoGiros& e, const Pasada& pasada,
+                            int coste_giro, MemoriaGiros& mem){
+  Movimientos sentido = pasada.a.fila == pasada.b.fila? DERECHA : ABAJO;
+  Posicion a = pasada.a, b = pasada.b;
+  while(a != b && !e.pendiente[jardin.indice(a.fila, a.columna)])
+    a = desplazar(a, sentido);
+  while(a != b && !e.pendiente[jardin.indice(b.fila, b.columna)])
+    b = desplazar(b, opuesto(sentido));
+  if(!e.pendiente[jardin.indice(a.fila, a.columna)])
+    return;
+
+  Posicion extremos[2] = {a, b};
+  Movimientos salidas[2] = {sentido, opuesto(sentido)};
+  int mejor = INT_MAX, llegada = -1, extremo = 0, pendientes = 0;
+
+  mem.nuevo_sello();
+  mem.cubos.resize(2*coste_giro + 2);
+  for(unsigned i = 0; i < mem.cubos.size(); ++i)
+    mem.cubos[i].clear();
+
+  int origen = jardin.indice(e.pos.fila, e.pos.columna);
+  for(int k = 0; k < 4; ++k){
+    if(e.orientacion != SIN_ORIENTACION && e.orientacion != k)
+      continue;
+    mem.marca[4*origen + k] = mem.sello;
+    mem.coste[4*origen + k] = 0;
+    mem.padre[4*origen + k] = -1;
+    mem.cubos[0].push_back(4*origen + k);
+    ++pendientes;
+  }
+
+  // Al llegar a un extremo todavía puede haber un camino más barato si
+  // necesita menos giros para seguir por la pasada, así que se sigue
+  // buscando mientras el coste sea menor que el del mejor encontrado.
+  for(int d = 0; pendientes > 0 && d < mejor; ++d){
+    std::vector<int>& cubo = mem.cubos[d % mem.cubos.size()];
+    while(!cubo.empty()){
+      int estado = cubo.back();
+      cubo.pop_back();
+      --pendientes;
+      if(mem.coste[estado] != d)
+        continue;
+
+      Movimientos k = static_cast<Movimientos>(estado % 4);
+      Posicion p = jardin.posicion(estado / 4);
+      for(int t = 0; t < 2; ++t){
+        if(p != extremos[t])
+          continue;
+        int giro = a == b || (estado / 4 == origen && e.orientacion == SIN_ORIENTACION)?
+                   0 : coste_giro*giros_entre(k, salidas[t]);
+        if(d + giro < mejor){
+          mejor = d + giro;
+          llegada = estado;
+          extremo = t;
+        }
+      }
+
+      for(int m = 0; m < 4; ++m){
+        Movimientos mov = static_cast<Movimientos>(m);
+        Posicion q = desplazar(p, mov);
+        if(!se_puede_pasar(jardin, e, q))
+          continue;
+        int s = 4*jardin.indice(q.fila, q.columna) + m;
+        int coste = d + 1 + coste_giro*giros_entre(k, mov);
+        if(mem.marca[s] != mem.sello || coste < mem.coste[s]){
+          mem.marca[s] = mem.sello;
+          mem.coste[s] = coste;
+          mem.padre[s] = estado;
+          mem.cubos[coste % mem.cubos.size()].push_back(s);
+          ++pendientes;
+        }
+      }
+    }
+  }
+  if(llegada < 0)
+    return;
+
+  // El camino se reconstruye desde el final y se recorre al derecho
+  std::vector<Movimientos> camino;
+  for(int s = llegada; mem.padre[s] >= 0; s = mem.padre[s])
+    camino.push_back(static_cast<Movimientos>(s % 4));
+  for(int i = camino.size() - 1; i >= 0; --i)
+    avanzar(jardin, e, camino[i], coste_giro);
+  for(int i = distancia(a, b); i > 0; --i)
+    avanzar(jardin, e, salidas[extremo], coste_giro);
+}
+
+// Barre las pasadas en orden, empezando por el lado de la región más
+// cercano a la cortadora. De cada pasada se entra por el extremo que cueste
+// menos, así que las pasadas seguidas se recorren en zigzag.
+static void barrer(const Jardin& jardin, EstadoGiros& e, const std::vector<Pasada>& pasadas,
+                   int coste_giro, MemoriaGiros& mem){
+  if(pasadas.empty())
+    return;
+
+  bool al_reves = distancia(e.pos, pasadas.back()) < distancia(e.pos, pasadas.front());
+  for(unsigned i = 0; i < pasadas.size(); ++i)
+    recorrer_pasada(jardin, e, pasadas[al_reves? pasadas.size() - 1 - i : i], coste_giro, mem);
+}
+
+Resultado cobertura_giros(const Jardin& jardin, const Posicion& inicio, int coste_giro,
+                          std::vector<Movimientos>* movs, int* regiones, int* verticales){
+  Resultado res;
+  coste_giro = std::max(coste_giro, 0);
+  std::vector<Region> partes;
+  std::vector<int> region;
+  MemoriaGiros mem(jardin.celdas());
+  EstadoGiros e;
+
+  e.pos = e.inicio = inicio;
+  e.orientacion = SIN_ORIENTACION;
+  e.coste = e.cortadas = 0;
+  e.pendiente = alcanzables(jardin, inicio);
+  int alcanzables_total = std::count(e.pendiente.begin(), e.pendiente.end(), static_cast<char>(true));
+  descomponer(jardin, e.pendiente, partes, region);
+  if(regiones)
+    *regiones = 0;
+  if(verticales)
+    *verticales = 0;
+
+  // La celda de inicio se corta al empezar, si es césped
+  int c = jardin.indice(inicio.fila, inicio.columna);
+  if(e.pendiente[c]){
+    e.pendiente[c] = false;
+    ++e.cortadas;
+  }
+
+  // Cada región se barre de las dos formas y se queda la más barata; a
+  // igualdad, en horizontal como el resto de barridos
+  while((c = pendiente_cercana(jardin, e, mem)) >= 0){
+    const Region& r = partes[region[c]];
+    MarcaGiros marca(e);
+
+    barrer(jardin, e, r.horizontales, coste_giro, mem);
+    int coste_horizontal = e.coste;
+    std::vector<Movimientos> horizontal(e.movs.begin() + marca.movs, e.movs.end());
+    deshacer(e, marca);
+
+    barrer(jardin, e, r.verticales, coste_giro, mem);
+    bool vertical = e.coste < coste_horizontal;
+    if(!vertical){
+      deshacer(e, marca);
+      for(unsigned i = 0; i < horizontal.size(); ++i)
+        avanzar(jardin, e, horizontal[i], coste_giro);
+    }
+
+    if(regiones)
+      ++*regiones;
+    if(verticales && vertical)
+      ++*verticales;
+  }
+
+  res.cesped = celdas_cesped(jardin);
+  res.cortadas = e.cortadas;
+  res.movimientos = e.movs.size();
+  res.giros = giros_recorrido(e.movs);
+  res.coste = coste_recorrido(jardin, inicio, e.movs);
+  res.exito = e.cortadas == alcanzables_total;
+  if(movs)
+    movs->swap(e.movs);
+  return res;
+}
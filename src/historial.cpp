@@ -0,0 +1,280 @@
+#include "historial.h"
+
+#include <map>
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QStringList>
+
+// Un tiempo empeora si supera al mejor anterior en más de esta proporción y
+// este margen, para no marcar como regresión el ruido de la medida.
+static const double TOLERANCIA_TIEMPO = 0.2;
+static const qint64 MARGEN_TIEMPO_US = 1000;
+
+static const char* CABECERA = "# fecha_ms\thuella\tdimensiones\tcompilacion\talgoritmo\t"
+                              "movimientos\tcoste\tcortado\tfases\n";
+static const int CAMPOS = 9;
+
+qint64 EjecucionHistorial::tiempo_us() const {
+  qint64 total = 0;
+  for(unsigned i = 0; i < fases.size(); ++i)
+    total += fases[i].tiempo_us;
+  return total;
+}
+
+QString fichero_historial(){
+  QString entorno = QString::fromLocal8Bit(qgetenv("IA_HISTORIAL"));
+  if(!entorno.isEmpty())
+    return entorno;
+  return QDir(QDir::homePath()).filePath(".ia-historial");
+}
+
+QString id_compilacion(){
+#ifdef IA_COMPILACION
+  return IA_COMPILACION;
+#else
+  return QString(__DATE__) + " " + __TIME__;
+#endif
+}
+
+// Los textos no pueden llevar los separadores del fichero.
+static QString limpiar(QString texto){
+  return texto.replace("\t", " ").replace("\n", " ").replace(",", " ").replace("=", " ");
+}
+
+QString linea_historial(const EjecucionHistorial& e){
+  QStringList fases;
+  for(unsigned i = 0; i < e.fases.size(); ++i)
+    fases << limpiar(e.fases[i].nombre) + "=" + QString::number(e.fases[i].tiempo_us);
+
+  QStringList campos;
+  campos << QString::number(e.fecha_ms)
+         << QString("%1").arg(e.huella, 8, 16, QChar('0'))
+         << QString("%1x%2").arg(e.filas).arg(e.columnas)
+         << limpiar(e.compilacion)
+         << limpiar(e.algoritmo)
+         << QString::number(e.movimientos)
+         << QString::number(e.coste)
+         << QString::number(e.cortado, 'f', 4)
+         << fases.join(",");
+  return campos.join("\t");
+}
+
+bool leer_linea_historial(const QString& linea, EjecucionHistorial& ejecucion){
+  QStringList campos = linea.split("\t");
+  if(campos.size() != CAMPOS)
+    return false;
+
+  EjecucionHistorial e;
+  bool ok[7];
+  QStringList dimensiones = campos[2].split("x");
+  e.fecha_ms = campos[0].toLongLong(&ok[0]);
+  e.huella = campos[1].toUInt(&ok[1], 16);
+  e.filas = dimensiones.size() == 2? dimensiones[0].toInt(&ok[2]) : 0;
+  e.columnas = dimensiones.size() == 2? dimensiones[1].toInt(&ok[3]) : 0;
+  e.compilacion = campos[3];
+  e.algoritmo = campos[4];
+  e.movimientos = campos[5].toInt(&ok[4]);
+  e.coste = campos[6].toInt(&ok[5]);
+  e.cortado = campos[7].toDouble(&ok[6]);
+  if(dimensiones.size() != 2)
+    return false;
+  for(int i = 0; i < 7; ++i)
+    if(!ok[i])
+      return false;
+
+  QStringList fases = campos[8].split(",");
+  for(int i = 0; i < fases.size(); ++i){
+    if(fases[i].isEmpty())
+      continue;
+    QStringList partes = fases[i].split("=");
+    bool bien;
+    if(partes.size() != 2)
+      return false;
+    e.fases.push_back(FaseEjecucion(partes[0], partes[1].toLongLong(&bien)));
+    if(!bien)
+      return false;
+  }
+
+  ejecucion = e;
+  return true;
+}
+
+// Todas las líneas se escriben de una vez para que dos programas que
+// añaden a la vez no mezclen sus líneas.
+bool anadir_historial(const QString& fichero, const std::vector<EjecucionHistorial>& ejecuciones){
+  QFile f(fichero);
+  if(!f.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text))
+    return false;
+
+  QString texto = f.size() == 0? CABECERA : "";
+  for(unsigned i = 0; i < ejecuciones.size(); ++i)
+    texto += linea_historial(ejecuciones[i]) + "\n";
+  QByteArray datos = texto.toUtf8();
+  bool escrito = f.write(datos) == datos.size();
+  f.close();
+  return escrito;
+}
+
+bool leer_historial(const QString& fichero, std::vector<EjecucionHistorial>& ejecuciones){
+  QFile f(fichero);
+  if(!f.exists())
+    return true;
+  if(!f.open(QIODevice::ReadOnly | QIODevice::Text))
+    return false;
+
+  QStringList lineas = QString::fromUtf8(f.readAll()).split("\n");
+  for(int i = 0; i < lineas.size(); ++i){
+    EjecucionHistorial e;
+    if(!lineas[i].startsWith("#") && leer_linea_historial(lineas[i], e))
+      ejecuciones.push_back(e);
+  }
+  return true;
+}
+
+// Mejores valores de las ejecuciones de un algoritmo en un jardín hasta un
+// momento dado.
+struct Mejores {
+  Mejores(): ejecuciones(0), cortado(0), tiempo_us(0) {}
+
+  void anotar(const EjecucionHistorial& e){
+    if(ejecuciones == 0 || e.movimientos < mejor.movimientos ||
+       (e.movimientos == mejor.movimientos && e.tiempo_us() < mejor.tiempo_us()))
+      mejor = e;
+    if(ejecuciones == 0 || e.cortado > cortado)
+      cortado = e.cortado;
+    if(ejecuciones == 0 || e.tiempo_us() < tiempo_us)
+      tiempo_us = e.tiempo_us();
+    for(unsigned i = 0; i < e.fases.size(); ++i){
+      std::map<QString, qint64>::iterator f = fases.find(e.fases[i].nombre);
+      if(f == fases.end() || e.fases[i].tiempo_us < f->second)
+        fases[e.fases[i].nombre] = e.fases[i].tiempo_us;
+    }
+    ++ejecuciones;
+  }
+
+  ComparacionHistorial comparar(const EjecucionHistorial& e) const {
+    ComparacionHistorial c;
+    QStringList motivos;
+    c.ejecucion = e;
+    c.mejor = mejor;
+    c.anteriores = ejecuciones;
+    if(ejecuciones == 0)
+      return c;
+
+    if(e.movimientos > mejor.movimientos)
+      motivos << QString("movimientos %1 (mejor %2)").arg(e.movimientos).arg(mejor.movimientos);
+    if(e.cortado < cortado - 1e-4)
+      motivos << QString("césped cortado %1% (mejor %2%)").arg(e.cortado).arg(cortado);
+    if(peor(e.tiempo_us(), tiempo_us))
+      motivos << QString("tiempo %1ms (mejor %2ms)").arg(e.tiempo_us()/1000.0)
+                                                    .arg(tiempo_us/1000.0);
+    for(unsigned i = 0; i < e.fases.size(); ++i){
+      std::map<QString, qint64>::const_iterator f = fases.find(e.fases[i].nombre);
+      if(e.fases.size() > 1 && f != fases.end() && peor(e.fases[i].tiempo_us, f->second))
+        motivos << QString("fase %1 %2ms (mejor %3ms)").arg(e.fases[i].nombre)
+                   .arg(e.fases[i].tiempo_us/1000.0).arg(f->second/1000.0);
+    }
+
+    c.regresion = !motivos.isEmpty();
+    c.motivos = motivos.join(", ");
+    return c;
+  }
+
+  static bool peor(qint64 tiempo, qint64 mejor){
+    return tiempo > mejor*(1 + TOLERANCIA_TIEMPO) + MARGEN_TIEMPO_US;
+  }
+
+  int ejecuciones;
+  EjecucionHistorial mejor;
+  double cortado;
+  qint64 tiempo_us;
+  std::map<QString, qint64> fases;
+};
+
+ComparacionHistorial comparar_ejecucion(const std::vector<EjecucionHistorial>& anteriores,
+                                        const EjecucionHistorial& ejecucion){
+  Mejores mejores;
+  for(unsigned i = 0; i < anteriores.size(); ++i)
+    if(anteriores[i].huella == ejecucion.huella &&
+       anteriores[i].algoritmo == ejecucion.algoritmo)
+      mejores.anotar(anteriores[i]);
+  return mejores.comparar(ejecucion);
+}
+
+static QString texto_fecha(qint64 fecha_ms){
+  return QDateTime::fromMSecsSinceEpoch(fecha_ms).toString("yyyy-MM-dd hh:mm:ss");
+}
+
+static QString texto_ejecucion(const EjecucionHistorial& e){
+  return QString("%1 [%2]: %3 movimientos, coste %4, %5% cortado, %6ms")
+         .arg(texto_fecha(e.fecha_ms)).arg(e.compilacion).arg(e.movimientos).arg(e.coste)
+         .arg(e.cortado, 0, 'f', 2).arg(e.tiempo_us()/1000.0, 0, 'f', 1);
+}
+
+QString texto_comparaciones(const std::vector<ComparacionHistorial>& comparaciones){
+  QString texto;
+  for(unsigned i = 0; i < comparaciones.size(); ++i){
+    const ComparacionHistorial& c = comparaciones[i];
+    texto += "-" + c.ejecucion.algoritmo + ": ";
+    if(c.anteriores == 0)
+      texto += "primera ejecución en este jardín\n";
+    else if(c.regresion)
+      texto += "REGRESIÓN en " + c.motivos + "\n";
+    else
+      texto += QString("sin regresiones frente a %1 ejecuciones anteriores\n").arg(c.anteriores);
+  }
+  return texto;
+}
+
+// Las ejecuciones se agrupan por jardín y algoritmo en el orden en el que
+// aparecen por primera vez.
+QString texto_tendencias(const std::vector<EjecucionHistorial>& historial, unsigned huella,
+                         int ultimas){
+  std::vector<std::vector<int> > grupos;
+  std::map<std::pair<unsigned, QString>, int> indices;
+  for(unsigned i = 0; i < historial.size(); ++i){
+    const EjecucionHistorial& e = historial[i];
+    if(huella != 0 && e.huella != huella)
+      continue;
+    std::pair<unsigned, QString> clave(e.huella, e.algoritmo);
+    if(indices.find(clave) == indices.end()){
+      indices[clave] = grupos.size();
+      grupos.push_back(std::vector<int>());
+    }
+    grupos[indices[clave]].push_back(i);
+  }
+
+  QString texto = "---===HISTORIAL DE LAS PRUEBAS===---\n";
+  if(grupos.empty())
+    return texto + "\nNo hay ejecuciones anteriores.\n";
+
+  for(unsigned g = 0; g < grupos.size(); ++g){
+    const std::vector<int>& grupo = grupos[g];
+    const EjecucionHistorial& primera = historial[grupo[0]];
+    Mejores mejores;
+    std::vector<ComparacionHistorial> comparaciones;
+    int regresiones = 0;
+    for(unsigned i = 0; i < grupo.size(); ++i){
+      comparaciones.push_back(mejores.comparar(historial[grupo[i]]));
+      regresiones += comparaciones.back().regresion;
+      mejores.anotar(historial[grupo[i]]);
+    }
+
+    texto += QString("\nJardín %1 de %2x%3, %4:\n").arg(primera.huella, 8, 16, QChar('0'))
+             .arg(primera.filas).arg(primera.columnas).arg(primera.algoritmo);
+    texto += QString("  Ejecuciones: %1, regresiones: %2\n")
+             .arg(static_cast<int>(grupo.size())).arg(regresiones);
+    texto += "  Mejor: " + texto_ejecucion(mejores.mejor) + "\n";
+    texto += "  Últimas:\n";
+    for(unsigned i = grupo.size() > static_cast<unsigned>(ultimas)? grupo.size() - ultimas : 0;
+        i < grupo.size(); ++i){
+      texto += "    " + texto_ejecucion(historial[grupo[i]]);
+      if(comparaciones[i].regresion)
+        texto += " REGRESIÓN: " + comparaciones[i].motivos;
+      texto += "\n";
+    }
+  }
+  return texto;
+}
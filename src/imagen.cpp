@@ -0,0 +1,182 @@
+#include "imagen.h"
+
+#include <algorithm>
+
+// Mayor nivel de gris que admite el formato PGM.
+static const int MAX_GRIS_PGM = 65535;
+
+// Celdas que puede tener como mucho el jardín importado, para que celdas() y
+// el contenido de su fichero .garden, de 5 bytes por celda con el terreno,
+// quepan en un int.
+static const long long MAX_CELDAS_IMAGEN = 256*1024*1024;
+
+/*
+ * LECTURA DE PGM
+ */
+
+bool LectorPGM::abrir(const QString& fichero){
+  f.setFileName(fichero);
+  if(!f.open(QIODevice::ReadOnly)){
+    mensaje = "No se ha podido abrir la imagen. Compruebe sus permisos.";
+    return false;
+  }
+
+  QByteArray magia = f.read(2);
+  binario = magia == "P5";
+  if(!binario && magia != "P2"){
+    mensaje = "La imagen no es un fichero PGM.";
+    return false;
+  }
+  if(!leer_numero(w) || !leer_numero(h) || !leer_numero(maximo) ||
+     w <= 0 || h <= 0 || maximo <= 0 || maximo > MAX_GRIS_PGM){
+    mensaje = "La cabecera de la imagen PGM está dañada.";
+    return false;
+  }
+
+  bytes = maximo < 256? 1 : 2;
+  if(binario)
+    buffer.resize(static_cast<size_t>(w)*bytes);
+  return true;
+}
+
+// Salta los espacios y los comentarios, que van de "#" al final de la línea,
+// y lee un número. También se consume el carácter que lo termina, que en la
+// cabecera de un PGM binario es el único separador antes de los píxeles.
+bool LectorPGM::leer_numero(int& valor){
+  char c;
+  do{
+    if(!f.getChar(&c))
+      return false;
+    if(c == '#')
+      while(c != '\n' && c != '\r')
+        if(!f.getChar(&c))
+          return false;
+  } while(c == ' ' || c == '\t' || c == '\n' || c == '\r');
+
+  if(c < '0' || c > '9')
+    return false;
+  valor = 0;
+  while(c >= '0' && c <= '9'){
+    if(valor > MAX_GRIS_PGM*1000)
+      return false;
+    valor = valor*10 + (c - '0');
+    if(!f.getChar(&c))
+      return true;
+  }
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+bool LectorPGM::leer_fila(unsigned char* grises){
+  if(!binario){
+    for(int j = 0; j < w; ++j){
+      int valor;
+      if(!leer_numero(valor)){
+        mensaje = "La imagen PGM está incompleta o dañada.";
+        return false;
+      }
+      grises[j] = gris(valor);
+    }
+    return true;
+  }
+
+  if(f.read(&buffer[0], buffer.size()) != static_cast<qint64>(buffer.size())){
+    mensaje = "La imagen PGM está incompleta.";
+    return false;
+  }
+  const unsigned char* datos = reinterpret_cast<const unsigned char*>(&buffer[0]);
+  if(bytes == 1 && maximo == 255)
+    std::copy(datos, datos + w, grises);
+  else if(bytes == 1)
+    for(int j = 0; j < w; ++j)
+      grises[j] = gris(datos[j]);
+  else
+    for(int j = 0; j < w; ++j)
+      grises[j] = gris(datos[2*j] << 8 | datos[2*j + 1]);
+  return true;
+}
+
+LectorImagen* abrir_imagen(const QString& fichero, QString& error){
+  LectorPGM* pgm = new LectorPGM;
+  if(pgm->abrir(fichero))
+    return pgm;
+  error = pgm->error();
+  delete pgm;
+  return NULL;
+}
+
+/*
+ * CONVERSIÓN EN CELDAS
+ */
+
+ConversorImagen::ConversorImagen(int ancho, int alto, const OpcionesImagen& opciones,
+                                 Jardin& jardin):
+  opciones(opciones), ancho(std::max(ancho, 0)), alto(std::max(alto, 0)),
+  lado(std::max(opciones.escala, 1)), fila(0), resultado(jardin)
+{
+  if(opciones.max_filas > 0)
+    lado = std::max(lado, (this->alto + opciones.max_filas - 1)/opciones.max_filas);
+  if(opciones.max_columnas > 0)
+    lado = std::max(lado, (this->ancho + opciones.max_columnas - 1)/opciones.max_columnas);
+  this->opciones.porcentaje = std::min(std::max(opciones.porcentaje, 1), 100);
+
+  int filas = (this->alto + lado - 1)/lado, columnas = (this->ancho + lado - 1)/lado;
+  if(static_cast<long long>(filas)*columnas > MAX_CELDAS_IMAGEN){
+    mensaje = "La imagen daría un jardín de demasiadas celdas. Aumente la escala o "
+              "limite las filas y las columnas.";
+    fila = this->alto;
+    resultado = Jardin();
+    return;
+  }
+  resultado = Jardin(filas, columnas);
+  oscuros.assign(resultado.columnas(), 0);
+}
+
+void ConversorImagen::anadir_fila(const unsigned char* grises){
+  if(completo())
+    return;
+
+  for(int c = 0, j = 0; c < resultado.columnas(); ++c){
+    int fin = std::min(j + lado, ancho), n = 0;
+    for(; j < fin; ++j)
+      n += (grises[j] < opciones.umbral) != opciones.invertir;
+    oscuros[c] += n;
+  }
+
+  ++fila;
+  if(fila%lado == 0 || fila == alto)
+    cerrar_banda();
+}
+
+// Los bloques del borde derecho y de la última fila de celdas pueden ser más
+// pequeños, así que el porcentaje se calcula sobre los píxeles que tienen.
+void ConversorImagen::cerrar_banda(){
+  int f = (fila - 1)/lado;
+  int alto_banda = fila - f*lado;
+  for(int c = 0; c < resultado.columnas(); ++c){
+    int pixeles = alto_banda*(std::min((c + 1)*lado, ancho) - c*lado);
+    if(oscuros[c]*100LL >= static_cast<long long>(opciones.porcentaje)*pixeles)
+      resultado.set_tipo(f, c, OBSTACULO);
+    oscuros[c] = 0;
+  }
+  if(f == 0)
+    resultado.set_tipo(0, 0, INICIO);
+}
+
+bool importar_imagen(LectorImagen& lector, const OpcionesImagen& opciones, Jardin& jardin,
+                     QString& error){
+  ConversorImagen conversor(lector.ancho(), lector.alto(), opciones, jardin);
+  if(conversor.demasiado_grande()){
+    error = conversor.error();
+    return false;
+  }
+  std::vector<unsigned char> grises(lector.ancho());
+
+  while(!conversor.completo()){
+    if(!lector.leer_fila(&grises[0])){
+      error = lector.error();
+      return false;
+    }
+    conversor.anadir_fila(&grises[0]);
+  }
+  return true;
+}
@@ -0,0 +1,57 @@
+#include "imagen_qt.h"
+
+#include <QFile>
+
+bool LectorQImage::abrir(const QString& fichero){
+  lector.setFileName(fichero);
+  QSize tam = lector.size();
+  if(!tam.isValid()){
+    mensaje = lector.errorString();
+    return false;
+  }
+  w = tam.width();
+  h = tam.height();
+  return true;
+}
+
+bool LectorQImage::leer_fila(unsigned char* grises){
+  if(imagen.isNull()){
+    imagen = lector.read();
+    if(imagen.isNull() || imagen.width() != w || imagen.height() != h){
+      mensaje = lector.errorString();
+      return false;
+    }
+    imagen = imagen.convertToFormat(QImage::Format_ARGB32);
+  }
+  if(fila >= h){
+    mensaje = "La imagen no tiene más filas";
+    return false;
+  }
+
+  const QRgb* linea = reinterpret_cast<const QRgb*>(imagen.constScanLine(fila++));
+  for(int j = 0; j < w; ++j)
+    grises[j] = qAlpha(linea[j]) < 128? 255 : qGray(linea[j]);
+  if(fila == h)
+    imagen = QImage();
+  return true;
+}
+
+LectorImagen* abrir_imagen_qt(const QString& fichero, QString& error){
+  QFile f(fichero);
+  if(!f.open(QIODevice::ReadOnly)){
+    error = "No se ha podido abrir la imagen. Compruebe sus permisos.";
+    return NULL;
+  }
+  QByteArray magia = f.read(2);
+  f.close();
+
+  if(magia == "P5" || magia == "P2")
+    return abrir_imagen(fichero, error);
+
+  LectorQImage* otra = new LectorQImage;
+  if(otra->abrir(fichero))
+    return otra;
+  error = otra->error();
+  delete otra;
+  return NULL;
+}
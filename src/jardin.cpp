@@ -0,0 +1,91 @@
+#include "jardin.h"
+
+#include <algorithm>
+
+Jardin::Jardin(int filas, int columnas, const TipoCelda& tipo):
+  rows(filas), columns(columnas), tipos(filas*columnas, tipo),
+  terrenos(filas*columnas, LLANO)
+{
+}
+
+bool Jardin::ponderado() const {
+  for(unsigned i = 0; i < terrenos.size(); ++i)
+    if(terrenos[i] != LLANO)
+      return true;
+  return false;
+}
+
+// FNV-1a de 32 bits sobre las dimensiones, los tipos y los terrenos.
+unsigned Jardin::huella() const {
+  unsigned h = 2166136261u;
+  h = (h ^ static_cast<unsigned>(rows))*16777619u;
+  h = (h ^ static_cast<unsigned>(columns))*16777619u;
+  for(unsigned i = 0; i < tipos.size(); ++i){
+    h = (h ^ static_cast<unsigned>(tipos[i]))*16777619u;
+    h = (h ^ static_cast<unsigned>(terrenos[i]))*16777619u;
+  }
+  return h;
+}
+
+bool Jardin::transitable(int fila, int columna) const {
+  if(!dentro(fila, columna))
+    return false;
+
+  TipoCelda t = tipo(fila, columna);
+  return t != OBSTACULO && t != INICIO;
+}
+
+// Búsqueda en anchura clásica. La cola se guarda en un vector que se recorre
+// con un índice, de forma que no hace falta reservar memoria por cada celda.
+void Jardin::distancias(const Posicion& origen, std::vector<int>& dist) const {
+  dist.assign(celdas(), -1);
+  if(!dentro(origen.fila, origen.columna))
+    return;
+
+  std::vector<int> cola;
+  cola.reserve(celdas());
+  cola.push_back(indice(origen.fila, origen.columna));
+  dist[cola[0]] = 0;
+
+  for(unsigned i = 0; i < cola.size(); ++i){
+    Posicion p = posicion(cola[i]);
+    for(int k = 0; k < 4; ++k){
+      Posicion q = desplazar(p, MOVIMIENTOS[k]);
+      if(transitable(q.fila, q.columna) && dist[indice(q.fila, q.columna)] < 0){
+        dist[indice(q.fila, q.columna)] = dist[cola[i]] + 1;
+        cola.push_back(indice(q.fila, q.columna));
+      }
+    }
+  }
+}
+
+// Se calculan las distancias desde el origen y luego se sube por ellas desde
+// el destino, de manera que no hace falta guardar el padre de cada celda. Así
+// además el origen puede ser una celda no transitable, como el punto de
+// inicio, porque la cortadora ya está en ella.
+bool Jardin::camino(const Posicion& origen, const Posicion& destino,
+                    std::vector<Movimientos>& movs) const {
+  std::vector<int> dist;
+  movs.clear();
+
+  distancias(origen, dist);
+  if(!dentro(destino.fila, destino.columna) ||
+     dist[indice(destino.fila, destino.columna)] < 0)
+    return false;
+
+  Posicion p = destino;
+  while(p != origen){
+    int d = dist[indice(p.fila, p.columna)];
+    for(int k = 0; k < 4; ++k){
+      Posicion q = desplazar(p, MOVIMIENTOS[k]);
+      if(dentro(q.fila, q.columna) && dist[indice(q.fila, q.columna)] == d-1){
+        // Se avanza desde q hasta p, que es el movimiento contrario
+        movs.push_back(opuesto(MOVIMIENTOS[k]));
+        p = q;
+        break;
+      }
+    }
+  }
+  std::reverse(movs.begin(), movs.end());
+  return true;
+}
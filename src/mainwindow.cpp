@@ -1,20 +1,47 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
 
+#include <algorithm>
 #include <cmath>
 #include <ctime>
 
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
 #include <QFile>
 #include <QFileDialog>
 #include <QGraphicsRectItem>
 #include <QGraphicsScene>
+#include <QElapsedTimer>
+#include <QInputDialog>
 #include <QMessageBox>
+#include <QPainter>
 #include <QProgressBar>
 #include <QString>
+#include <QThread>
 #include <QTime>
 
+#include "anytime.h"
+#include "barrido.h"
+#include "comparativa.h"
 #include "celda.h"
 #include "cortadora.h"
+#include "dinamico.h"
+#include "exploracion.h"
+#include "generador.h"
+#include "giros.h"
+#include "historial.h"
+#include "imagen_qt.h"
+#include "mapabits.h"
+#include "multiagente.h"
+#include "plato.h"
+#include "ponderado.h"
+#include "reanudable.h"
+#include "ruta.h"
+#include "telemetria.h"
+#include "temporada.h"
+#include "trazo.h"
+#include "visitas.h"
 
 // Tamaño por defecto del jardín.
 static const int ROWS = 50;
@@ -32,6 +59,81 @@ static const int MINIMAP_CELL_HEIGHT = 5;
 // aleatoriamente.
 static const int PORCENTAJE_OBSTACULOS = 20;
 
+// Número máximo de puntos intermedios que se pueden colocar de una vez.
+static const int MAX_PUNTOS = 500;
+
+// Trazos de las herramientas de edición que se pueden deshacer.
+static const unsigned MAX_DESHACER = 100;
+
+// Movimientos entre dos puntos de control del corte reanudable.
+static const int PASOS_PUNTO_CONTROL = 2000;
+
+// Obstáculos móviles por defecto y máximos en la simulación dinámica, y
+// tiempo máximo que tiene la cortadora para decidir cada paso.
+static const int OBSTACULOS_MOVILES = 20;
+static const int MAX_OBSTACULOS_MOVILES = 500;
+static const int PRESUPUESTO_US = 1000;
+
+// Peso de la heurística del A* ponderado con el que se compara el camino de
+// menor coste.
+static const double PESO_A_ESTRELLA = 2.0;
+
+// Plazo por defecto y máximo, en milisegundos, para el primer camino del
+// planificador anytime.
+static const int PLAZO_MS = 5;
+static const int MAX_PLAZO_MS = 10000;
+
+// Cortadoras por defecto y máximas en la planificación conjunta, y grupos
+// con los que se mide cómo crece el coste al aumentar el número.
+static const int AGENTES = 10;
+static const int MAX_AGENTES = 100;
+static const int GRUPOS_AGENTES[] = {10, 20, 30, 40, 50};
+
+// Tamaño máximo del plato de corte y mayor plato cuadrado con el que se
+// compara el elegido.
+static const int MAX_PLATO = 10;
+static const int PLATOS_COMPARADOS = 5;
+
+// Mayor coste de un giro que se puede pedir al cortar minimizando giros.
+static const int MAX_COSTE_GIRO = 100;
+
+// Nivel de gris por defecto por debajo del cual un píxel de una imagen
+// importada es obstáculo.
+static const int UMBRAL_IMAGEN = 128;
+
+// Niveles del mapa de visitas: de una visita hasta NIVELES_CALOR o más.
+static const int NIVELES_CALOR = 5;
+
+// Color con el que se tiñe el césped de cada tipo de terreno.
+static QColor color_terreno(Terreno terreno){
+  switch(terreno){
+  case DENSO:
+    return QColor(0, 70, 0, 110);
+  case GRAVA:
+    return QColor(150, 150, 150, 140);
+  case PENDIENTE:
+    return QColor(200, 150, 40, 120);
+  default:
+    return QColor(0, 0, 0, 0);
+  }
+}
+
+// Color del mapa de visitas para una celda visitada "visitas" veces: amarillo
+// si sólo se ha pasado una vez y cada vez más rojo cuantas más veces se pasa.
+static QColor color_calor(int visitas){
+  int nivel = qMin(visitas, NIVELES_CALOR) - 1;
+  return QColor(255, 255 - nivel*255/(NIVELES_CALOR - 1), 0, 150);
+}
+
+// Copia de una imagen con un color semitransparente por encima.
+static QPixmap tenir(const QPixmap& imagen, const QColor& color){
+  QPixmap resultado(imagen);
+  QPainter painter(&resultado);
+  painter.fillRect(0, 0, resultado.width(), resultado.height(), color);
+  painter.end();
+  return resultado;
+}
+
 /*
  * CONSTRUCTOR Y DESTRUCTOR
  */
@@ -43,11 +145,13 @@ static const int PORCENTAJE_OBSTACULOS = 20;
 // cundo sea necesario sin ocupar memoria adicional.
 MainWindow::MainWindow(QWidget *parent): QMainWindow(parent),
     ui(new Ui::MainWindow), filename(""), progressBar(NULL), scene(NULL),
-    rows(0), columns(0), ini_x(-1), ini_y(-1), fin_x(-1), fin_y(-1),
-    corta(NULL), cesped_a(":/resources/cesped_a.png"),
+    hilo_archivos(NULL), archivo(NULL), rows(0), columns(0), ini_x(-1), ini_y(-1), fin_x(-1), fin_y(-1),
+    corta(NULL), telemetria(NULL), generado(false), trazando(false), borrando(false),
+    herramienta(HERRAMIENTA_CELDA), cortando(false), detener(false), cesped_a(":/resources/cesped_a.png"),
     cesped_b(":/resources/cesped_b.png"), obstaculo(":/resources/obstaculo.png"),
     inicio(":/resources/inicio.png"), cortadora(":/resources/cortadora.jpg"),
-    punto_a(":/resources/A.png"), punto_b(":/resources/B.png") {
+    punto_a(":/resources/A.png"), punto_b(":/resources/B.png"),
+    punto_ruta(":/resources/R.png") {
 
   srand(time(NULL));
   ui->setupUi(this);
@@ -71,6 +175,20 @@ MainWindow::MainWindow(QWidget *parent): QMainWindow(parent),
   ui->sbFilas->setMaximum(MAX_ROWS);
   ui->sbColumnas->setMinimum(MIN_COLUMNS);
   ui->sbColumnas->setMaximum(MAX_COLUMNS);
+  ui->sbPuntos->setMinimum(1);
+  ui->sbPuntos->setMaximum(MAX_PUNTOS);
+
+  // Imágenes del césped de cada terreno
+  for(int i = 0; i < NUM_TERRENOS; ++i){
+    terreno_a.push_back(tenir(cesped_a, color_terreno(static_cast<Terreno>(i))));
+    terreno_b.push_back(tenir(cesped_b, color_terreno(static_cast<Terreno>(i))));
+  }
+
+  // Imágenes del césped cortado para cada nivel del mapa de visitas. La
+  // cortadora cuenta las visitas de todas las ejecuciones.
+  for(int i = 1; i <= NIVELES_CALOR; ++i)
+    calor.push_back(tenir(cesped_b, color_calor(i)));
+  corta->contar(&visitas);
 
   showMaximized();
 
@@ -79,11 +197,36 @@ MainWindow::MainWindow(QWidget *parent): QMainWindow(parent),
   connect(ui->timeSlider, SIGNAL(sliderMoved(int)),
           corta, SLOT(on_delay_changed(int)));
 
+  // Los ficheros se leen y se escriben en un hilo aparte que se comunica con
+  // la ventana mediante señales
+  qRegisterMetaType<DatosJardin>("DatosJardin");
+  qRegisterMetaType<LectorImagen*>("LectorImagen*");
+  qRegisterMetaType<OpcionesImagen>("OpcionesImagen");
+  hilo_archivos = new QThread(this);
+  archivo = new ArchivoJardin;
+  archivo->moveToThread(hilo_archivos);
+  connect(hilo_archivos, SIGNAL(finished()), archivo, SLOT(deleteLater()));
+  connect(this, SIGNAL(cargar_fichero(QString)), archivo, SLOT(cargar(QString)));
+  connect(this, SIGNAL(guardar_fichero(QString, DatosJardin)),
+          archivo, SLOT(guardar(QString, DatosJardin)));
+  connect(this, SIGNAL(importar_fichero(LectorImagen*, OpcionesImagen)),
+          archivo, SLOT(importar(LectorImagen*, OpcionesImagen)));
+  connect(archivo, SIGNAL(progreso(int)), progressBar, SLOT(setValue(int)));
+  connect(archivo, SIGNAL(cargado(DatosJardin)),
+          this, SLOT(archivo_cargado(DatosJardin)));
+  connect(archivo, SIGNAL(guardado()), this, SLOT(archivo_guardado()));
+  connect(archivo, SIGNAL(error(QString, QString)),
+          this, SLOT(archivo_error(QString, QString)));
+  hilo_archivos->start();
+
   // Creamos el jardín con el tamaño inicial por defecto
   resize(ROWS, COLUMNS);
 }
 
 MainWindow::~MainWindow(){
+  hilo_archivos->quit();
+  hilo_archivos->wait();
+
   for(int i = 0; i < rows; ++i){
     for(int j = 0; j < columns; ++j){
       delete label_list[i][j];
@@ -93,6 +236,7 @@ MainWindow::~MainWindow(){
 
   delete progressBar;
   delete corta;
+  delete telemetria;
   delete scene;
   delete ui;
 }
@@ -114,15 +258,23 @@ void MainWindow::ImgMod(int fila, int columna, const TipoCelda& tipo){
              MINIMAP_CELL_WIDTH,
              MINIMAP_CELL_HEIGHT);
   QColor color;
+  Terreno terreno = label_list[fila][columna]->terreno();
 
   switch(tipo){
   case CESPED_A:
-    label_list[fila][columna]->setPixmap(cesped_a);
+    label_list[fila][columna]->setPixmap(terreno_a[terreno]);
     color.setRgb(0, 128, 0);
     break;
   case CESPED_B:
-    label_list[fila][columna]->setPixmap(cesped_b);
+    label_list[fila][columna]->setPixmap(terreno_b[terreno]);
     color.setRgb(0, 187, 0);
+    if(ui->cbVisitas->isChecked() && visitas.visitas(fila, columna) > 0){
+      int n = visitas.visitas(fila, columna);
+      label_list[fila][columna]->setPixmap(calor[qMin(n, NIVELES_CALOR) - 1]);
+      color = color_calor(n);
+      color.setAlpha(255);
+      terreno = LLANO;  // El mapa de visitas sustituye al tinte del terreno
+    }
     break;
   case OBSTACULO:
     label_list[fila][columna]->setPixmap(obstaculo);
@@ -144,11 +296,26 @@ void MainWindow::ImgMod(int fila, int columna, const TipoCelda& tipo){
     label_list[fila][columna]->setPixmap(punto_b);
     color.setRgb(255, 32, 64);
     break;
+  case PUNTO_RUTA:
+    label_list[fila][columna]->setPixmap(punto_ruta);
+    color.setRgb(240, 170, 0);
+    break;
   }
 
+  // En el minimapa el terreno se mezcla con el color del césped
+  if((tipo == CESPED_A || tipo == CESPED_B) && terreno != LLANO){
+    QColor tinte = color_terreno(terreno);
+    color.setRgb((color.red() + tinte.red())/2, (color.green() + tinte.green())/2,
+                 (color.blue() + tinte.blue())/2);
+  }
+
+  // El rectángulo de cada celda se crea una sola vez y después sólo se cambia
+  // su color, que es mucho más barato que sacarlo de la escena y volverlo a
+  // meter
   if(rect_list[fila][columna])
-    delete rect_list[fila][columna];
-  rect_list[fila][columna] = scene->addRect(rect, QPen(Qt::NoPen), QBrush(color));
+    rect_list[fila][columna]->setBrush(QBrush(color));
+  else
+    rect_list[fila][columna] = scene->addRect(rect, QPen(Qt::NoPen), QBrush(color));
 }
 
 // Este método redimensiona el jardín.
@@ -162,6 +329,11 @@ void MainWindow::ImgMod(int fila, int columna, const TipoCelda& tipo){
 // cuando un usuario pulsa sobre alguna de las celdas, la ventana principal lo
 // sepa y pueda cambiar su contenido.
 void MainWindow::resize(int filas, int columnas){
+  visitas.reiniciar(filas, columnas);
+  if(filas != rows || columnas != columns){
+    generado = false;
+    historial.clear();
+  }
 
   // Redimensionamos el minimapa para que aproveche todo el espacio posible
   ui->graphicsView->setMaximumHeight(MINIMAP_CELL_HEIGHT*(filas+1));
@@ -190,8 +362,7 @@ void MainWindow::resize(int filas, int columnas){
       label_list.push_back(aux);
       rect_list.push_back(std::vector<QGraphicsRectItem*>(columns, static_cast<QGraphicsRectItem*>(NULL)));
       for(int j = 0; j < columns; ++j){
-        connect(label_list[label_list.size()-1][j], SIGNAL(clicked(int, int)),
-                this, SLOT(on_Celda_clicked(int, int)));
+        conectar_celda(label_list[label_list.size()-1][j]);
         ui->gridLayout->addWidget(label_list[label_list.size()-1][j], label_list.size()-1, j);
         ImgMod(label_list.size()-1, j, label_list[label_list.size()-1][j]->tipo());
         ++donemods;
@@ -227,7 +398,7 @@ void MainWindow::resize(int filas, int columnas){
         label_list[i].push_back(new Celda(i, label_list[i].size(), "", this));
         rect_list[i].push_back(NULL);
 
-        connect(label_list[i][label_list[i].size()-1],SIGNAL(clicked(int, int)), this, SLOT(on_Celda_clicked(int, int)));
+        conectar_celda(label_list[i][label_list[i].size()-1]);
         ui->gridLayout->addWidget(label_list[i][label_list[i].size()-1], i, label_list[i].size()-1);
         ImgMod(i, label_list[i].size()-1, label_list[i][label_list[i].size()-1]->tipo());
         donemods += 2;
@@ -263,6 +434,14 @@ void MainWindow::resize(int filas, int columnas){
   ui->sbFilas->setValue(filas);
   ui->sbColumnas->setValue(columnas);
 
+  // Los puntos intermedios que han quedado fuera del jardín se descartan
+  for(unsigned i = 0; i < puntos.size(); ){
+    if(puntos[i].fila >= filas || puntos[i].columna >= columnas)
+      puntos.erase(puntos.begin()+i);
+    else
+      ++i;
+  }
+
   if(ini_x >= 0)
     ImgMod(ini_y, ini_x, PUNTO_A);
   if(fin_x >= 0)
@@ -279,142 +458,328 @@ void MainWindow::set_pos(int fila, int columna, const TipoCelda& tipo){
   ImgMod(fila, columna, tipo);
 }
 
+// Cambia el terreno de una celda y la vuelve a dibujar.
+void MainWindow::set_terreno(int fila, int columna, Terreno terreno){
+  label_list[fila][columna]->setTerreno(terreno);
+  ImgMod(fila, columna, label_list[fila][columna]->tipo());
+}
+
+// Crea una copia del jardín con el tipo de cada una de las celdas para que los
+// algoritmos que no necesitan mostrar nada trabajen sin tocar la interfaz.
+Jardin MainWindow::jardin() const {
+  Jardin copia(rows, columns);
+  for(int i = 0; i < rows; ++i){
+    for(int j = 0; j < columns; ++j){
+      copia.set_tipo(i, j, label_list[i][j]->tipo());
+      copia.set_terreno(i, j, label_list[i][j]->terreno());
+    }
+  }
+  return copia;
+}
+
 /*
  * FUNCIONES DE GUARDADO Y DE CARGA
  */
 
-// Guarda el contenido del jardín en el fichero indicado por "filename".
+// Guarda el contenido del jardín en el fichero indicado por "filename". Se
+// toma una copia del jardín tal y como se va a guardar y la escritura se hace
+// en el hilo de ficheros, sin bloquear la interfaz.
 void MainWindow::save(){
-  on_bReset_clicked();
-
-  QFile out(filename);
+  progressBar->setValue(0);
+  progressBar->setHidden(false);
+  emit guardar_fichero(filename, datos_guardables());
+}
 
-  if(out.open(QIODevice::WriteOnly)){
-    TipoCelda aux;
-    int donewrites = 0;
+// Carga el contenido del jardín desde el fichero indicado por "filename". La
+// lectura se hace en el hilo de ficheros y el resultado se aplica al jardín
+// de una vez cuando llega. Mientras tanto se bloquea la interfaz para que no
+// se modifique un jardín que va a ser sustituido.
+void MainWindow::load(){
+  progressBar->setValue(0);
+  progressBar->setHidden(false);
+  lock_interface(true);
+  emit cargar_fichero(filename);
+}
 
-    progressBar->setEnabled(true);
+// Copia del jardín tal y como se guarda en los ficheros: sin césped cortado
+// ni cortadora y con todos los puntos en su sitio. Es lo mismo que quedaría
+// tras pulsar "Reset", pero sin tener que redibujar ninguna celda.
+DatosJardin MainWindow::datos_guardables() const {
+  DatosJardin datos;
 
-    out.write((char*)&rows, sizeof(int));
-    out.write((char*)&columns, sizeof(int));
-    for(int i = 0; i < rows; ++i){
-      for(int j = 0; j < columns; ++j){
-        ++donewrites;
-        aux = label_list[i][j]->tipo();
-        out.write((char*)&aux, sizeof(TipoCelda));
-      }
-      progressBar->setValue((donewrites*100)/(rows*columns));
+  datos.jardin = jardin();
+  for(int i = 0; i < rows; ++i){
+    for(int j = 0; j < columns; ++j){
+      TipoCelda tipo = datos.jardin.tipo(i, j);
+      if(tipo == CESPED_B || tipo == CORTADORA)
+        datos.jardin.set_tipo(i, j, CESPED_A);
     }
-    out.write((char*)&ini_x, sizeof(int));
-    out.write((char*)&ini_y, sizeof(int));
-    out.write((char*)&fin_x, sizeof(int));
-    out.write((char*)&fin_y, sizeof(int));
-    out.flush();
-    out.close();
-
-    progressBar->setEnabled(false);
-    setWindowTitle(QString("IA - Búsqueda: <") + filename + QString(">"));
   }
-  else
-    QMessageBox::critical(this, "Error al guardar",
-                          "No se ha podido abrir el fichero para guardar. Compruebe sus permisos.");
-}
-
-// Carga el contenido del jardín desde el fichero indicado por "filename".
-void MainWindow::load(){
-  QFile in(filename);
+  datos.jardin.set_tipo(0, 0, INICIO);
 
-  if(in.open(QIODevice::ReadOnly)){
-    int filas, columnas, donereads = 0;
-    TipoCelda aux;
+  for(unsigned i = 0; i < puntos.size(); ++i)
+    datos.jardin.set_tipo(puntos[i].fila, puntos[i].columna, PUNTO_RUTA);
+  if(ini_x != -1)
+    datos.jardin.set_tipo(ini_y, ini_x, PUNTO_A);
+  if(fin_x != -1)
+    datos.jardin.set_tipo(fin_y, fin_x, PUNTO_B);
+
+  datos.ini_x = ini_x;
+  datos.ini_y = ini_y;
+  datos.fin_x = fin_x;
+  datos.fin_y = fin_y;
+  datos.generado = generado;
+  datos.generador = generador;
+  return datos;
+}
 
-    progressBar->setEnabled(true);
+// Sustituye el jardín por el indicado. Se desactiva el redibujado mientras
+// se cambian las celdas para que la pantalla se actualice una sola vez, y
+// sólo se tocan las celdas cuyo tipo cambia.
+void MainWindow::aplicar(const DatosJardin& datos){
+  const Jardin& nuevo = datos.jardin;
 
-    in.read((char*)&filas, sizeof(int));
-    in.read((char*)&columnas, sizeof(int));
+  ui->scrollAreaWidgetContents->setUpdatesEnabled(false);
+  ui->graphicsView->setUpdatesEnabled(false);
 
-    if(filas < MIN_ROWS || filas > MAX_ROWS || columnas < MIN_COLUMNS ||
-       columnas > MAX_COLUMNS){
-      QMessageBox::critical(this, "Error de lectura",
-                            "El archivo especificado parece estar dañado o ser de otra aplicación. Imposible abrir.");
-      in.close();
-      return;
-    }
+  ini_x = fin_x = -1;
+  puntos.clear();
+  resize(nuevo.filas(), nuevo.columnas());
 
-    resize(filas, columnas);
-
-    for(int i = 0; i < filas; ++i){
-      for(int j = 0; j < columnas; ++j){
-        ++donereads;
-        if(in.read((char*)&aux, sizeof(TipoCelda)) == -1){
-          QMessageBox::critical(this, "Error de lectura",
-                                "El archivo especificado parece estar dañado o ser de otra aplicación. Imposible abrir.");
-          in.close();
-          progressBar->setEnabled(false);
-          return;
-        }
-        set_pos(i, j, aux);
+  for(int i = 0; i < rows; ++i){
+    for(int j = 0; j < columns; ++j){
+      TipoCelda tipo = nuevo.tipo(i, j);
+      if(label_list[i][j]->terreno() != nuevo.terreno(i, j)){
+        label_list[i][j]->setTerreno(nuevo.terreno(i, j));
+        set_pos(i, j, tipo);
       }
-      progressBar->setValue((donereads*100)/(filas*columnas));
+      else if(label_list[i][j]->tipo() != tipo)
+        set_pos(i, j, tipo);
+      if(tipo == PUNTO_RUTA)
+        puntos.push_back(Posicion(i, j));
     }
-    in.read((char*)&ini_x, sizeof(int));
-    in.read((char*)&ini_y, sizeof(int));
-    in.read((char*)&fin_x, sizeof(int));
-    in.read((char*)&fin_y, sizeof(int));
-    in.close();
+  }
 
-    progressBar->setEnabled(false);
+  ini_x = datos.ini_x;
+  ini_y = datos.ini_y;
+  fin_x = datos.fin_x;
+  fin_y = datos.fin_y;
+  generado = datos.generado;
+  generador = datos.generador;
+  historial.clear();
+  if(ini_x >= 0)
+    set_pos(ini_y, ini_x, PUNTO_A);
+  if(fin_x >= 0)
+    set_pos(fin_y, fin_x, PUNTO_B);
 
-    if(ini_x >= 0)
-      set_pos(ini_y, ini_x, PUNTO_A);
-    if(fin_x >= 0)
-      set_pos(fin_y, fin_x, PUNTO_B);
+  ui->graphicsView->setUpdatesEnabled(true);
+  ui->scrollAreaWidgetContents->setUpdatesEnabled(true);
+}
 
-    setWindowTitle(QString("IA - Búsqueda: <") + filename + QString(">"));
+// Aplica los cambios de un trazo a partir del indicado con el redibujado
+// desactivado, de forma que la pantalla se actualiza una sola vez aunque
+// cambien miles de celdas.
+void MainWindow::aplicar_cambios(const std::vector<CambioCelda>& cambios, unsigned desde){
+  if(desde >= cambios.size())
+    return;
+
+  ui->scrollAreaWidgetContents->setUpdatesEnabled(false);
+  ui->graphicsView->setUpdatesEnabled(false);
+
+  for(unsigned i = desde; i < cambios.size(); ++i){
+    const CambioCelda& c = cambios[i];
+    label_list[c.pos.fila][c.pos.columna]->setTerreno(c.terreno);
+    set_pos(c.pos.fila, c.pos.columna, c.tipo);
   }
-  else
-    QMessageBox::critical(NULL, "Error al cargar",
-                          "No se ha podido abrir el fichero para cargar. Compruebe sus permisos.");
+
+  ui->graphicsView->setUpdatesEnabled(true);
+  ui->scrollAreaWidgetContents->setUpdatesEnabled(true);
 }
 
-// Recorre todo el jardín colocando aleatoriamente obstáculos y luego sitúa
-// también aleatoriamente los puntos inicial y final.
-void MainWindow::on_bAleatorio_clicked(){
-  progressBar->setHidden(false);
+// Pintura de las herramientas de edición: el terreno elegido o, si no hay
+// ninguno, obstáculos. Con el botón derecho se borra, dejando el terreno
+// llano o el césped libre.
+Pintura MainWindow::pintura() const {
+  if(ui->cbTerreno->currentIndex() > 0)
+    return borrando? Pintura(LLANO) : Pintura(static_cast<Terreno>(ui->cbTerreno->currentIndex()-1));
+  return borrando? Pintura(CESPED_A) : Pintura(OBSTACULO);
+}
 
-  int iteraciones = 0;
-  for(int i = 0; i < rows; ++i){
-    for(int j = 0; j < columns; ++j){
-      if(!(i == 0 && j == 0)){
-        if(rand()%100 < PORCENTAJE_OBSTACULOS)
-          set_pos(i, j, OBSTACULO);
-        else
-          set_pos(i, j, CESPED_A);
-      }
-      ++iteraciones;
+// Conecta las señales del ratón de una celda nueva con la ventana.
+void MainWindow::conectar_celda(Celda* celda){
+  connect(celda, SIGNAL(clicked(int, int)), this, SLOT(on_Celda_clicked(int, int)));
+  connect(celda, SIGNAL(pulsada(int, int, bool)), this, SLOT(on_Celda_pulsada(int, int, bool)));
+  connect(celda, SIGNAL(arrastrada(int, int)), this, SLOT(on_Celda_arrastrada(int, int)));
+  connect(celda, SIGNAL(soltada(int, int)), this, SLOT(on_Celda_soltada(int, int)));
+}
+
+// Fichero del punto de control: junto al jardín si está guardado y en la
+// carpeta temporal si no.
+QString MainWindow::fichero_punto_control() const {
+  if(!filename.isEmpty())
+    return filename + ".ckpt";
+  return QDir(QDir::tempPath()).filePath("IA-cobertura.ckpt");
+}
+
+// Anima la cobertura reanudable movimiento a movimiento. Cada
+// PASOS_PUNTO_CONTROL movimientos, y al detenerla, se guarda su estado en el
+// punto de control; si termina, el punto de control se borra. Al final se
+// muestra cuánto ocupa y cuánto cuesta guardar cada punto de control.
+void MainWindow::cortar_reanudable(CoberturaReanudable& cobertura){
+  QString fichero = fichero_punto_control();
+  std::vector<Movimientos> movs;
+  QElapsedTimer reloj;
+  int iteraciones = 0, pendientes = 0, guardados = 0, tamano = 0;
+  qint64 tiempo_ns = 0;
+  bool escrito = true;
+
+  cortando = true;
+  detener = false;
+  lock_interface(true);
+  ui->bPuntoControl->setText("Detener corte");
+  corta->on_delay_changed(ui->timeSlider->value());
+
+  while(!cobertura.terminada()){
+    if(!detener){
+      movs.clear();
+      cobertura.avanzar(1, &movs);
+      corta->recorrer(movs, &iteraciones);
+      ++pendientes;
     }
-    progressBar->setValue(iteraciones*100/(rows*columns));
+    if(cobertura.terminada())
+      break;
+    if(pendientes >= PASOS_PUNTO_CONTROL || detener){
+      reloj.start();
+      QByteArray estado = cobertura.guardar();
+      escrito = guardar_punto_control(fichero, estado) && escrito;
+      tiempo_ns += reloj.nsecsElapsed();
+      tamano = estado.size();
+      ++guardados;
+      pendientes = 0;
+    }
+    if(detener)
+      break;
+  }
+  if(cobertura.terminada()){
+    QFile::remove(fichero);
+    QFile::remove(fichero + ".tmp");
   }
 
-  do {
-    ini_x = rand() % columns;
-    ini_y = rand() % rows;
-  } while(ini_x == 0 && ini_y == 0);
-  do {
-  fin_x = rand() % columns;
-  fin_y = rand() % rows;
-  } while(fin_x == 0 && fin_y == 0);
+  cortando = false;
+  ui->bPuntoControl->setText("Cortar con puntos de control");
+  lock_interface(false);
 
-  set_pos(ini_y, ini_x, PUNTO_A);
-  set_pos(fin_y, fin_x, PUNTO_B);
+  if(!escrito)
+    QMessageBox::warning(this, "Punto de control",
+                         "No se ha podido escribir el punto de control en " + fichero);
+
+  const Resultado& res = cobertura.resultado();
+  QMessageBox::information(this, "Resultados",
+                           QString(cobertura.terminada()? "Corte terminado." :
+                                   "Corte detenido. Se puede continuar con \"Reanudar corte\".") +
+                           "\n\n"
+                           "-Movimientos realizados en total: " + QString::number(res.movimientos) + "\n"
+                           "-Movimientos en esta ejecución: " + QString::number(iteraciones) + "\n"
+                           "-Giros: " + QString::number(res.giros) + "\n"
+                           "-Celdas cortadas: " + QString::number(res.cortadas) + " de " +
+                           QString::number(res.cesped) + "\n"
+                           "-Puntos de control guardados: " + QString::number(guardados) + "\n"
+                           "-Tamaño del punto de control: " + QString::number(tamano) + " bytes\n"
+                           "-Tiempo medio por punto de control: " +
+                           QString::number(guardados? tiempo_ns/guardados/1000 : 0) + "us");
+}
 
-  progressBar->setHidden(true);
+// Genera un jardín nuevo del tamaño actual con el generador elegido y lo
+// muestra de una vez. Con la semilla a 0 se elige una al azar. La semilla
+// usada se muestra en la barra de estado y se guarda con el jardín, de forma
+// que el mismo jardín se puede volver a generar exactamente.
+void MainWindow::on_bAleatorio_clicked(){
+  unsigned semilla = ui->sbSemilla->value();
+  while(semilla == 0)
+    semilla = ((static_cast<unsigned>(rand()) << 16) ^ rand()) & 0x7FFFFFFF;
+
+  DatosJardin datos;
+  Posicion a, b;
+  datos.generado = true;
+  datos.generador = Generador(static_cast<TipoGenerador>(ui->cbGenerador->currentIndex()),
+                              semilla, PORCENTAJE_OBSTACULOS, ui->cbConectar->isChecked());
+  datos.jardin = generar_jardin(rows, columns, datos.generador, a, b);
+  datos.ini_x = a.columna;
+  datos.ini_y = a.fila;
+  datos.fin_x = b.columna;
+  datos.fin_y = b.fila;
+
+  aplicar(datos);
+  ui->statusBar->showMessage(QString("%1, semilla %2")
+                             .arg(nombre_generador(datos.generador.tipo))
+                             .arg(semilla));
 }
 
 /*
  * CÓDIGO EJECUTADO AL PULSAR BOTONES
  */
 
+// Planifica a la vez los caminos de varias cortadoras con puntos de partida y
+// destinos al azar, sin que coincidan nunca en una celda ni se crucen, y los
+// muestra todos juntos. Después se mide la planificación con distintos
+// números de cortadoras en el mismo jardín.
+void MainWindow::on_bAgentes_clicked(){
+  bool ok;
+  int cantidad = QInputDialog::getInt(this, "Varias cortadoras",
+                                      "Número de cortadoras:",
+                                      AGENTES, 1, MAX_AGENTES, 1, &ok);
+  if(!ok)
+    return;
+
+  on_bReset_clicked();
+
+  Jardin copia = jardin();
+  copia.set_tipo(0, 0, INICIO);
+  std::vector<Agente> agentes = agentes_aleatorios(copia, cantidad, rand());
+  PlanMultiagente plan = planificar_agentes(copia, agentes);
+
+  if(!plan.exito){
+    QMessageBox::critical(this, "Error",
+                          "No se ha encontrado un plan sin conflictos para " +
+                          QString::number(agentes.size()) + " cortadoras.");
+    return;
+  }
+
+  int iteraciones = 0;
+  lock_interface(true);
+  corta->on_delay_changed(ui->timeSlider->value());
+  corta->recorrer_agentes(plan, &iteraciones);
+  lock_interface(false);
+
+  QString texto = "Planificación por prioridades con reservas en espacio-tiempo:\n"
+                  "-Cortadoras: " + QString::number(agentes.size()) + "\n"
+                  "-Suma de costes: " + QString::number(plan.suma_costes) +
+                  " (mínimo sin conflictos: " + QString::number(plan.suma_minimos) + ")\n"
+                  "-Makespan: " + QString::number(plan.makespan) + "\n"
+                  "-Movimientos realizados: " + QString::number(iteraciones) + "\n"
+                  "-Órdenes de prioridad probados: " + QString::number(plan.intentos) + "\n"
+                  "-Nodos expandidos: " + QString::number(plan.expandidos) + "\n"
+                  "-Tiempo: " + QString::number(plan.tiempo_us/1000.0, 'f', 1) + "ms\n"
+                  "-Sin conflictos: " + (sin_conflictos(plan)? "sí" : "NO") + "\n\n"
+                  "Con más cortadoras:\n";
+
+  for(unsigned i = 0; i < sizeof(GRUPOS_AGENTES)/sizeof(GRUPOS_AGENTES[0]); ++i){
+    std::vector<Agente> grupo = agentes_aleatorios(copia, GRUPOS_AGENTES[i], rand());
+    PlanMultiagente p = planificar_agentes(copia, grupo);
+    texto += "-" + QString::number(grupo.size()) + ": ";
+    if(p.exito)
+      texto += "suma de costes " + QString::number(p.suma_costes) +
+               " (mínimo " + QString::number(p.suma_minimos) + "), makespan " +
+               QString::number(p.makespan) + ", " +
+               QString::number(p.tiempo_us/1000.0, 'f', 1) + "ms\n";
+    else
+      texto += "sin plan tras " + QString::number(p.intentos) + " intentos, " +
+               QString::number(p.tiempo_us/1000.0, 'f', 1) + "ms\n";
+  }
+
+  QMessageBox::information(this, "Resultados", texto);
+}
+
 // Prepara la interfaz y la cortadora y, si es posible, ejecuta la simulación
 // de ir del punto de inicio al punto final.
 void MainWindow::on_bCamino_clicked(){
@@ -436,6 +801,325 @@ void MainWindow::on_bCamino_clicked(){
   lock_interface(false);
 }
 
+// Busca el camino de menor coste entre los puntos A y B teniendo en cuenta el
+// terreno y hace que la cortadora lo recorra. Al terminar se compara con el
+// A* ponderado, con el camino de menos movimientos y con la escalada.
+void MainWindow::on_bCoste_clicked(){
+  if(ini_x < 0 || fin_x < 0){
+    QMessageBox::critical(this, "Error",
+                          "Falta el punto de inicio o de fin del recorrido.",
+                          QMessageBox::Ok);
+    return;
+  }
+
+  on_bReset_clicked();
+
+  Jardin copia = jardin();
+  copia.set_tipo(0, 0, INICIO);
+  Posicion a(ini_y, ini_x), b(fin_y, fin_x);
+  std::vector<Movimientos> movs;
+  QElapsedTimer reloj;
+
+  reloj.start();
+  Resultado menor = dijkstra(copia, a, b, &movs);
+  qint64 dij_us = reloj.nsecsElapsed()/1000;
+
+  reloj.start();
+  Resultado estrella = a_estrella_ponderado(copia, a, b, PESO_A_ESTRELLA);
+  qint64 est_us = reloj.nsecsElapsed()/1000;
+
+  Resultado minimo = camino_minimo(copia, a, b);
+  Resultado voraz = escalada(copia, a, b);
+
+  if(!menor.exito){
+    QMessageBox::critical(this, "Error",
+                          "No se ha podido llegar al punto de destino.");
+    return;
+  }
+
+  set_pos(0, 0, INICIO);
+  corta->ir_a(ini_y, ini_x);
+  lock_interface(true);
+  corta->on_delay_changed(ui->timeSlider->value());
+  corta->recorrer(movs);
+  lock_interface(false);
+
+  QMessageBox::information(this, "Resultados",
+                           "Camino de menor coste (Dijkstra):\n"
+                           "-Movimientos: " + QString::number(menor.movimientos) + "\n"
+                           "-Coste: " + QString::number(menor.coste) + "\n"
+                           "-Celdas expandidas: " + QString::number(menor.expandidas) + "\n"
+                           "-Tiempo: " + QString::number(dij_us) + "us\n\n"
+                           "A* ponderado (peso " + QString::number(PESO_A_ESTRELLA) + "):\n"
+                           "-Movimientos: " + QString::number(estrella.movimientos) + "\n"
+                           "-Coste: " + QString::number(estrella.coste) + "\n"
+                           "-Celdas expandidas: " + QString::number(estrella.expandidas) + "\n"
+                           "-Tiempo: " + QString::number(est_us) + "us\n\n"
+                           "Camino de menos movimientos:\n"
+                           "-Movimientos: " + QString::number(minimo.movimientos) + "\n"
+                           "-Coste: " + QString::number(minimo.coste) + "\n\n"
+                           "Escalada:\n"
+                           "-Movimientos: " + QString::number(voraz.movimientos) + "\n"
+                           "-Coste: " + QString::number(voraz.coste));
+}
+
+// Corta el jardín con un plato de corte del tamaño que se pida y compara los
+// movimientos y el césped cortado con los de platos cuadrados de distintos
+// tamaños.
+void MainWindow::on_bPlato_clicked(){
+  bool ok;
+  int alto = QInputDialog::getInt(this, "Plato de corte",
+                                  "Filas que ocupa el plato:",
+                                  2, 1, MAX_PLATO, 1, &ok);
+  if(!ok)
+    return;
+  int ancho = QInputDialog::getInt(this, "Plato de corte",
+                                   "Columnas que ocupa el plato:",
+                                   alto, 1, MAX_PLATO, 1, &ok);
+  if(!ok)
+    return;
+
+  on_bReset_clicked();
+
+  Jardin copia = jardin();
+  copia.set_tipo(0, 0, INICIO);
+  PlatoCorte plato(alto, ancho);
+  std::vector<Movimientos> movs;
+  int cubribles;
+  Resultado elegido = cobertura_plato(copia, Posicion(0, 0), plato, &movs, &cubribles);
+
+  if(cubribles == 0){
+    QMessageBox::critical(this, "Error",
+                          "El plato no cabe en el punto de inicio.");
+    return;
+  }
+
+  int iteraciones = 0;
+  corta->ir_a(0, 0);
+  lock_interface(true);
+  corta->on_delay_changed(ui->timeSlider->value());
+  bool completo = corta->recorrer_plato(plato, movs, &iteraciones);
+  lock_interface(false);
+
+  // El corte se mide en el jardín tal y como ha quedado y no en el plan. La
+  // cortadora está sobre césped cortado salvo si ha vuelto al inicio
+  int cortadas = 0;
+  for(int i = 0; i < rows; ++i)
+    for(int j = 0; j < columns; ++j){
+      TipoCelda tipo = label_list[i][j]->tipo();
+      if(tipo == CESPED_B || (tipo == CORTADORA && (i != 0 || j != 0)))
+        ++cortadas;
+    }
+
+  QString texto = "Plato de " + QString::number(alto) + "x" + QString::number(ancho) + ":\n"
+                  "-Movimientos: " + QString::number(iteraciones) + "\n"
+                  "-Césped cortado: " + QString::number(cortadas*100.0/qMax(elegido.cesped, 1), 'f', 1) + "%\n"
+                  "-Césped al alcance del plato cortado: " + QString::number(cortadas*100.0/cubribles, 'f', 1) + "%\n";
+  if(!completo)
+    texto += "-La cortadora se ha detenido tras " + QString::number(iteraciones) + " de " +
+             QString::number(static_cast<int>(movs.size())) + " movimientos\n";
+  texto += "\nComparación entre platos cuadrados:\n";
+
+  for(int lado = 1; lado <= PLATOS_COMPARADOS; ++lado){
+    QElapsedTimer reloj;
+    reloj.start();
+    Resultado res = cobertura_plato(copia, Posicion(0, 0), PlatoCorte(lado, lado), NULL, &cubribles);
+    qint64 us = reloj.nsecsElapsed()/1000;
+
+    texto += "-" + QString::number(lado) + "x" + QString::number(lado) + ": ";
+    if(cubribles == 0)
+      texto += "no cabe en el inicio\n";
+    else
+      texto += QString::number(res.movimientos) + " movimientos, " +
+               QString::number(res.cortadas*100.0/qMax(res.cesped, 1), 'f', 1) + "% cortado, " +
+               QString::number(us) + "us\n";
+  }
+
+  QMessageBox::information(this, "Resultados", texto);
+}
+
+// Pide un plazo y busca con ARA* el mejor camino que dé tiempo a encontrar.
+// La cortadora sale en cuanto se cumple el plazo y el planificador sigue
+// mejorando el camino en otro hilo mientras ella avanza. Al final se muestran
+// todas las soluciones que se han ido encontrando con su cota de subóptimo.
+void MainWindow::on_bPlazo_clicked(){
+  if(ini_x < 0 || fin_x < 0){
+    QMessageBox::critical(this, "Error",
+                          "Falta el punto de inicio o de fin del recorrido.",
+                          QMessageBox::Ok);
+    return;
+  }
+
+  bool ok;
+  int plazo = QInputDialog::getInt(this, "Camino con plazo",
+                                   "Tiempo para el primer camino (ms):",
+                                   PLAZO_MS, 1, MAX_PLAZO_MS, 1, &ok);
+  if(!ok)
+    return;
+
+  on_bReset_clicked();
+
+  Jardin copia = jardin();
+  copia.set_tipo(0, 0, INICIO);
+  Posicion a(ini_y, ini_x), b(fin_y, fin_x);
+
+  AraEstrella* ara = new AraEstrella(copia, a, b);
+  SolucionAnytime primera = planificar_con_plazo(*ara, plazo);
+  if(!primera.valida()){
+    QMessageBox::critical(this, "Error", ara->terminada()?
+                          "No se ha podido llegar al punto de destino." :
+                          "No se ha encontrado ningún camino en el plazo indicado.");
+    delete ara;
+    return;
+  }
+
+  MejoraAnytime* mejora = new MejoraAnytime(ara);
+  QThread hilo;
+  mejora->moveToThread(&hilo);
+  connect(&hilo, SIGNAL(started()), mejora, SLOT(ejecutar()));
+  hilo.start();
+
+  int iteraciones = 0, cambios = 0;
+  set_pos(0, 0, INICIO);
+  corta->ir_a(ini_y, ini_x);
+  lock_interface(true);
+  corta->on_delay_changed(ui->timeSlider->value());
+  corta->reach_anytime(*mejora, copia, &iteraciones, &cambios);
+  lock_interface(false);
+
+  mejora->cancelar();
+  hilo.quit();
+  hilo.wait();
+
+  std::vector<SolucionAnytime> soluciones = mejora->historial();
+  delete mejora;
+
+  QString texto = "Soluciones encontradas (ARA*):\n";
+  for(unsigned i = 0; i < soluciones.size(); ++i)
+    texto += "-Peso " + QString::number(soluciones[i].inflacion) +
+             ": coste " + QString::number(soluciones[i].coste) +
+             ", cota " + QString::number(soluciones[i].cota, 'f', 3) +
+             ", " + QString::number(soluciones[i].expandidas) + " expandidas, " +
+             QString::number(soluciones[i].tiempo_us) + "us\n";
+
+  QMessageBox::information(this, "Resultados",
+                           texto + "\n"
+                           "Camino seguido:\n"
+                           "-Plazo: " + QString::number(plazo) + "ms\n"
+                           "-Coste al cumplirse el plazo: " + QString::number(primera.coste) + "\n"
+                           "-Cota al cumplirse el plazo: " + QString::number(primera.cota, 'f', 3) + "\n"
+                           "-Movimientos realizados: " + QString::number(iteraciones) + "\n"
+                           "-Cambios de camino: " + QString::number(cambios));
+}
+
+// Deshace el último trazo de las herramientas de edición. Las celdas que se
+// han vuelto a cambiar después del trazo se quedan como están.
+void MainWindow::on_bDeshacer_clicked(){
+  if(historial.empty()){
+    ui->statusBar->showMessage("No hay ningún trazo que deshacer");
+    return;
+  }
+
+  Jardin actual = jardin();
+  Trazo vuelta = historial.back().deshacer(actual);
+  historial.pop_back();
+  aplicar_cambios(vuelta.cambios());
+  generado = false;
+  ui->statusBar->showMessage(QString("Celdas restauradas: %1").arg(static_cast<int>(vuelta.cambios().size())));
+}
+
+// Corta el césped sin que la cortadora conozca el jardín: sólo sabe lo que le
+// dicen sus sensores. Al terminar se compara con la búsqueda en profundidad,
+// que conoce el jardín completo, y se muestra cómo ha ido creciendo el mapa.
+void MainWindow::on_bExplorar_clicked(){
+  on_bReset_clicked();
+
+  Jardin copia = jardin();
+  copia.set_tipo(0, 0, INICIO);
+  Resultado profundidad = cobertura_profundidad(copia, Posicion(0, 0));
+
+  int iteraciones = 0;
+  Explorador explorador(rows, columns, Posicion(0, 0));
+
+  corta->ir_a(0, 0);
+  lock_interface(true);
+  corta->on_delay_changed(ui->timeSlider->value());
+  corta->explorar(explorador, &iteraciones);
+  lock_interface(false);
+
+  const EstadisticasExploracion& stats = explorador.estadisticas();
+
+  // Celdas conocidas en cuatro momentos de la exploración
+  QString evolucion;
+  for(int i = 1; i <= 4; ++i){
+    const std::pair<int, int>& muestra =
+        stats.conocidas[(stats.conocidas.size()-1)*i/4];
+    evolucion += "-" + QString::number(muestra.first) + " movimientos: " +
+                 QString::number(muestra.second) + " celdas\n";
+  }
+
+  QMessageBox::information(this, "Resultados",
+                           "Número de movimientos:\n"
+                           "-Explorando: " + QString::number(iteraciones) + "\n"
+                           "-En profundidad con el mapa completo: " +
+                           QString::number(profundidad.movimientos) + "\n"
+                           "-Mínimo posible: " +
+                           QString::number(MapaBits(copia).alcanzables(Posicion(0, 0))) + "\n\n"
+                           "Celdas conocidas:\n" + evolucion + "\n"
+                           "Tiempo de decisión por paso:\n"
+                           "-Medio: " + QString::number(stats.coste_total_ns/std::max(stats.decisiones, 1)) + "ns\n"
+                           "-Peor: " + QString::number(stats.coste_peor_ns/1000) + "us\n"
+                           "-Búsquedas de frontera: " + QString::number(stats.busquedas));
+}
+
+// Simula el camino entre los puntos A y B con obstáculos que se mueven por el
+// jardín. La cortadora tiene un tiempo máximo por paso para decidir cómo
+// esquivarlos. Al terminar se muestran las medidas de la simulación.
+void MainWindow::on_bMoviles_clicked(){
+  if(ini_x < 0 || fin_x < 0){
+    QMessageBox::critical(this, "Error",
+                          "Falta el punto de inicio o de fin del recorrido.",
+                          QMessageBox::Ok);
+    return;
+  }
+
+  bool ok;
+  int cantidad = QInputDialog::getInt(this, "Obstáculos móviles",
+                                      "Número de obstáculos móviles:",
+                                      OBSTACULOS_MOVILES, 1,
+                                      MAX_OBSTACULOS_MOVILES, 1, &ok);
+  if(!ok)
+    return;
+
+  on_bReset_clicked();
+
+  int iteraciones = 0;
+  SimulacionDinamica simulacion(jardin(), Posicion(ini_y, ini_x),
+                                Posicion(fin_y, fin_x), PRESUPUESTO_US);
+  simulacion.anadir_aleatorios(cantidad, rand());
+
+  corta->ir_a(ini_y, ini_x);
+  lock_interface(true);
+  corta->on_delay_changed(ui->timeSlider->value());
+  corta->reach_dinamico(simulacion, &iteraciones);
+  lock_interface(false);
+
+  const EstadisticasDinamicas& stats = simulacion.estadisticas();
+  QMessageBox::information(this, "Resultados",
+                           QString(stats.llegado? "Se ha llegado al destino.\n\n" :
+                                                  "No se ha podido llegar al destino.\n\n") +
+                           "Instantes: " + QString::number(stats.instantes) + "\n"
+                           "-Movimientos: " + QString::number(iteraciones) + "\n"
+                           "-Esperas: " + QString::number(stats.esperas) + "\n\n"
+                           "Replanificaciones: " + QString::number(stats.replanificaciones) + "\n"
+                           "Choques evitados: " + QString::number(stats.choques_evitados) + "\n"
+                           "Choques: " + QString::number(stats.choques) + "\n\n"
+                           "Tiempo de decisión por instante (máximo " +
+                           QString::number(PRESUPUESTO_US) + "us):\n"
+                           "-Medio: " + QString::number(stats.total_us/std::max(stats.instantes, 1)) + "us\n"
+                           "-Peor: " + QString::number(stats.peor_us) + "us");
+}
+
 // Ejecuta el algoritmo de corte de todo el céspedy del camino entre dos puntos
 // y calcula para cada uno el número de pasos que dio la cortadora y el tiempo
 // que tardó. Para el corte de todo el césped mide el porcentaje de césped
@@ -448,15 +1132,54 @@ void MainWindow::on_bPruebas_clicked(){
   QTime time;
   int sim_iter = 0, cam_iter = 0;
   int sim_time, cam_time = 0;
+  int sim_coste, cam_coste = 0;
   int cesped_total = 0, cesped_cortado = 0;
+  std::vector<Movimientos> traza, acortado, con_saltos;
   on_bReset_clicked();
 
+  Jardin copia = jardin();
+  copia.set_tipo(0, 0, INICIO);
+
   corta->ir_a(0, 0);
   corta->on_delay_changed(0);
+  corta->grabar(&traza);
 
   time.start();
   corta->cortar_cesped(&sim_iter);
   sim_time = time.elapsed();
+  corta->grabar(NULL);
+
+  // El mismo recorrido acortado y la cobertura con saltos
+  QElapsedTimer fase;
+  sim_coste = coste_recorrido(copia, Posicion(0, 0), traza);
+  fase.start();
+  Resultado acortada = acortar_recorrido(copia, Posicion(0, 0), traza, acortado);
+  qint64 aco_us = fase.nsecsElapsed()/1000;
+  fase.start();
+  Resultado saltos = cobertura_saltos(copia, Posicion(0, 0), &con_saltos);
+  qint64 sal_us = fase.nsecsElapsed()/1000;
+  fase.start();
+  Resultado con_giros = cobertura_giros(copia, Posicion(0, 0));
+  qint64 gir_us = fase.nsecsElapsed()/1000;
+  int aco_iter = acortada.movimientos;
+  int sal_iter = saltos.movimientos;
+  int gir_iter = con_giros.movimientos;
+  int sim_giros = giros_recorrido(traza);
+
+  // Celdas por las que se pasa más de una vez en cada recorrido
+  MapaVisitas mapa(rows, columns);
+  mapa.anotar_recorrido(Posicion(0, 0), traza);
+  int sim_repetidas = mapa.histograma().repetidas;
+  mapa.reiniciar(rows, columns);
+  mapa.anotar_recorrido(Posicion(0, 0), acortado);
+  int aco_repetidas = mapa.histograma().repetidas;
+  mapa.reiniciar(rows, columns);
+  mapa.anotar_recorrido(Posicion(0, 0), con_saltos);
+  int sal_repetidas = mapa.histograma().repetidas;
+
+  // Césped al que se puede llegar desde el inicio, que es el que se puede
+  // cortar
+  int cesped_alcanzable = MapaBits(copia).alcanzables(Posicion(0, 0));
 
   for(int i = 0; i < rows; ++i){
     for(int j = 0; j < columns; ++j){
@@ -483,19 +1206,93 @@ void MainWindow::on_bPruebas_clicked(){
     set_pos(0, 0, INICIO);
     corta->on_delay_changed(0);
 
+    traza.clear();
+    corta->grabar(&traza);
     time.start();
     corta->reach(fin_y, fin_x, &cam_iter);
     cam_time = time.elapsed();
+    corta->grabar(NULL);
+    cam_coste = coste_recorrido(copia, Posicion(ini_y, ini_x), traza);
+  }
+
+  // Se añaden las ejecuciones al historial y se comparan con las anteriores
+  // en el mismo jardín
+  double porcentaje = (cesped_cortado*100)/static_cast<double>(qMax(cesped_total, 1));
+  EjecucionHistorial base;
+  base.fecha_ms = QDateTime::currentMSecsSinceEpoch();
+  base.huella = copia.huella();
+  base.filas = rows;
+  base.columnas = columns;
+  base.compilacion = id_compilacion();
+
+  std::vector<EjecucionHistorial> ejecuciones(3, base);
+  ejecuciones[0].algoritmo = "simulacion";
+  ejecuciones[0].movimientos = sim_iter;
+  ejecuciones[0].coste = sim_coste;
+  ejecuciones[0].cortado = porcentaje;
+  ejecuciones[0].fases.push_back(FaseEjecucion("recorrer", sim_time*1000LL));
+  ejecuciones[1].algoritmo = "acortado";
+  ejecuciones[1].movimientos = aco_iter;
+  ejecuciones[1].coste = acortada.coste;
+  ejecuciones[1].cortado = porcentaje;
+  ejecuciones[1].fases.push_back(FaseEjecucion("recorrer", sim_time*1000LL));
+  ejecuciones[1].fases.push_back(FaseEjecucion("acortar", aco_us));
+  ejecuciones[2].algoritmo = "saltos";
+  ejecuciones[2].movimientos = sal_iter;
+  ejecuciones[2].coste = saltos.coste;
+  ejecuciones[2].cortado = (saltos.cortadas*100)/static_cast<double>(qMax(cesped_total, 1));
+  ejecuciones[2].fases.push_back(FaseEjecucion("planificar", sal_us));
+  ejecuciones.push_back(base);
+  ejecuciones.back().algoritmo = "giros";
+  ejecuciones.back().movimientos = gir_iter;
+  ejecuciones.back().coste = con_giros.coste;
+  ejecuciones.back().cortado = (con_giros.cortadas*100)/static_cast<double>(qMax(cesped_total, 1));
+  ejecuciones.back().fases.push_back(FaseEjecucion("planificar", gir_us));
+  if(ini_x >= 0 && fin_x >= 0){
+    ejecuciones.push_back(base);
+    ejecuciones.back().algoritmo = "camino";
+    ejecuciones.back().movimientos = cam_iter;
+    ejecuciones.back().coste = cam_coste;
+    ejecuciones.back().fases.push_back(FaseEjecucion("recorrer", cam_time*1000LL));
   }
 
+  std::vector<EjecucionHistorial> historial;
+  std::vector<ComparacionHistorial> comparaciones;
+  leer_historial(fichero_historial(), historial);
+  for(unsigned i = 0; i < ejecuciones.size(); ++i)
+    comparaciones.push_back(comparar_ejecucion(historial, ejecuciones[i]));
+  QString texto_historial = texto_comparaciones(comparaciones);
+  if(!anadir_historial(fichero_historial(), ejecuciones))
+    texto_historial += "No se ha podido guardar en " + fichero_historial() + "\n";
+
   switch(QMessageBox::information(this, "Resultados",
-                                  "Porcentaje de césped cortado: " + QString::number((cesped_cortado*100)/static_cast<double>(cesped_total)) + "%\n\n"
+                                  "Porcentaje de césped cortado: " + QString::number((cesped_cortado*100)/static_cast<double>(cesped_total)) + "%\n"
+                                  "Porcentaje del césped alcanzable cortado: " + QString::number((cesped_cortado*100)/static_cast<double>(qMax(cesped_alcanzable, 1))) + "%\n\n"
                                   "Número de iteraciones realizadas:\n"
                                   "-Cortar todo el césped: " + QString::number(sim_iter) + "\n"
+                                  "-Cortar todo el césped (recorrido acortado): " + QString::number(aco_iter) + "\n"
+                                  "-Cortar todo el césped (con saltos): " + QString::number(sal_iter) + "\n"
+                                  "-Cortar todo el césped (minimizando giros): " + QString::number(gir_iter) + "\n"
                                   "-Cortar camino: " + QString::number(cam_iter) + "\n\n"
+                                  "Coste según el terreno:\n"
+                                  "-Cortar todo el césped: " + QString::number(sim_coste) + "\n"
+                                  "-Cortar todo el césped (recorrido acortado): " + QString::number(acortada.coste) + "\n"
+                                  "-Cortar todo el césped (con saltos): " + QString::number(saltos.coste) + "\n"
+                                  "-Cortar todo el césped (minimizando giros): " + QString::number(con_giros.coste) + "\n"
+                                  "-Cortar camino: " + QString::number(cam_coste) + "\n\n"
+                                  "Giros:\n"
+                                  "-Cortar todo el césped: " + QString::number(sim_giros) + "\n"
+                                  "-Cortar todo el césped (recorrido acortado): " + QString::number(acortada.giros) + "\n"
+                                  "-Cortar todo el césped (con saltos): " + QString::number(saltos.giros) + "\n"
+                                  "-Cortar todo el césped (minimizando giros): " + QString::number(con_giros.giros) + "\n\n"
+                                  "Visitas repetidas:\n"
+                                  "-Cortar todo el césped: " + QString::number(sim_repetidas) + "\n"
+                                  "-Cortar todo el césped (recorrido acortado): " + QString::number(aco_repetidas) + "\n"
+                                  "-Cortar todo el césped (con saltos): " + QString::number(sal_repetidas) + "\n\n"
                                   "Tiempo transcurrido:\n"
                                   "-Cortar todo el césped: " + QString::number(sim_time) + "ms\n"
                                   "-Cortar camino: " + QString::number(cam_time) + "ms\n\n"
+                                  "Historial:\n" + texto_historial + "\n"
                                   "¿Deseas exportar los resultados a un fichero de texto?",
                                   QMessageBox::Yes | QMessageBox::No, QMessageBox::Yes)){
   case QMessageBox::Yes:
@@ -507,12 +1304,34 @@ void MainWindow::on_bPruebas_clicked(){
         out.write("---===RESULTADOS DE LAS PRUEBAS===---\n\n");
         out.write(QString("Porcentaje de césped cortado: " +
                           QString::number((cesped_cortado*100)/static_cast<double>(cesped_total)) + "%\n").toStdString().c_str());
+        out.write(QString("Porcentaje del césped alcanzable cortado: " +
+                          QString::number((cesped_cortado*100)/static_cast<double>(qMax(cesped_alcanzable, 1))) + "%\n").toStdString().c_str());
         out.write("Número de iteraciones realizadas:\n");
         out.write(QString("-Cortar todo el césped: " + QString::number(sim_iter) + "\n").toStdString().c_str());
+        out.write(QString("-Cortar todo el césped (recorrido acortado): " + QString::number(aco_iter) + "\n").toStdString().c_str());
+        out.write(QString("-Cortar todo el césped (con saltos): " + QString::number(sal_iter) + "\n").toStdString().c_str());
+        out.write(QString("-Cortar todo el césped (minimizando giros): " + QString::number(gir_iter) + "\n").toStdString().c_str());
         out.write(QString("-Corte camino entre 2 puntos: " + QString::number(cam_iter) + "\n").toStdString().c_str());
+        out.write("Coste según el terreno:\n");
+        out.write(QString("-Cortar todo el césped: " + QString::number(sim_coste) + "\n").toStdString().c_str());
+        out.write(QString("-Cortar todo el césped (recorrido acortado): " + QString::number(acortada.coste) + "\n").toStdString().c_str());
+        out.write(QString("-Cortar todo el césped (con saltos): " + QString::number(saltos.coste) + "\n").toStdString().c_str());
+        out.write(QString("-Cortar todo el césped (minimizando giros): " + QString::number(con_giros.coste) + "\n").toStdString().c_str());
+        out.write(QString("-Corte camino entre 2 puntos: " + QString::number(cam_coste) + "\n").toStdString().c_str());
+        out.write("Giros:\n");
+        out.write(QString("-Cortar todo el césped: " + QString::number(sim_giros) + "\n").toStdString().c_str());
+        out.write(QString("-Cortar todo el césped (recorrido acortado): " + QString::number(acortada.giros) + "\n").toStdString().c_str());
+        out.write(QString("-Cortar todo el césped (con saltos): " + QString::number(saltos.giros) + "\n").toStdString().c_str());
+        out.write(QString("-Cortar todo el césped (minimizando giros): " + QString::number(con_giros.giros) + "\n").toStdString().c_str());
+        out.write("Visitas repetidas:\n");
+        out.write(QString("-Cortar todo el césped: " + QString::number(sim_repetidas) + "\n").toStdString().c_str());
+        out.write(QString("-Cortar todo el césped (recorrido acortado): " + QString::number(aco_repetidas) + "\n").toStdString().c_str());
+        out.write(QString("-Cortar todo el césped (con saltos): " + QString::number(sal_repetidas) + "\n").toStdString().c_str());
         out.write("Tiempo transcurrido:\n");
         out.write(QString("-Cortar todo el césped: " + QString::number(sim_time) + "ms\n").toStdString().c_str());
         out.write(QString("-Corte camino entre 2 puntos: " + QString::number(cam_time) + "ms\n").toStdString().c_str());
+        out.write("Historial:\n");
+        out.write(texto_historial.toUtf8());
         out.flush();
         out.close();
       }
@@ -532,11 +1351,154 @@ void MainWindow::on_bPruebas_clicked(){
   on_bReset_clicked();
 }
 
+// Evolución de las pruebas hechas con el jardín actual según el historial. El
+// jardín se deja como al empezar las pruebas para que tenga la misma huella.
+void MainWindow::on_bHistorial_clicked(){
+  on_bReset_clicked();
+  std::vector<EjecucionHistorial> historial;
+  if(!leer_historial(fichero_historial(), historial)){
+    QMessageBox::critical(this, "Error", "No se ha podido leer el historial de " +
+                          fichero_historial() + ".");
+    return;
+  }
+
+  Jardin actual = jardin();
+  actual.set_tipo(0, 0, INICIO);
+  QMessageBox::information(this, "Historial de pruebas",
+                           texto_tendencias(historial, actual.huella()));
+}
+
+// Corta todo el césped girando lo menos posible según el coste de cada giro
+// que indique el usuario, y compara el resultado con la cobertura con saltos.
+void MainWindow::on_bGiros_clicked(){
+  bool ok;
+  int coste_giro = QInputDialog::getInt(this, "Cortar minimizando giros",
+                                        "Coste de cada giro, en movimientos:",
+                                        COSTE_GIRO, 0, MAX_COSTE_GIRO, 1, &ok);
+  if(!ok)
+    return;
+
+  on_bReset_clicked();
+
+  Jardin copia = jardin();
+  copia.set_tipo(0, 0, INICIO);
+  std::vector<Movimientos> movs;
+  int regiones, verticales;
+  QElapsedTimer reloj;
+  reloj.start();
+  cobertura_giros(copia, Posicion(0, 0), coste_giro, &movs, &regiones, &verticales);
+  qint64 us = reloj.nsecsElapsed()/1000;
+  Resultado saltos = cobertura_saltos(copia, Posicion(0, 0));
+
+  int iteraciones = 0, giros = 0;
+  corta->ir_a(0, 0);
+  lock_interface(true);
+  corta->on_delay_changed(ui->timeSlider->value());
+  corta->contar_giros(&giros);
+  corta->recorrer(movs, &iteraciones);
+  corta->contar_giros(NULL);
+  lock_interface(false);
+
+  QMessageBox::information(this, "Cortar minimizando giros",
+                           "Coste de cada giro: " + QString::number(coste_giro) + "\n\n"
+                           "Minimizando giros:\n"
+                           "-Iteraciones: " + QString::number(iteraciones) + "\n"
+                           "-Giros: " + QString::number(giros) + "\n"
+                           "-Coste con giros: " + QString::number(iteraciones + coste_giro*giros) + "\n"
+                           "-Regiones: " + QString::number(regiones) + ", " +
+                           QString::number(verticales) + " barridas en vertical\n"
+                           "-Tiempo de planificación: " + QString::number(us) + "us\n\n"
+                           "Con saltos:\n"
+                           "-Iteraciones: " + QString::number(saltos.movimientos) + "\n"
+                           "-Giros: " + QString::number(saltos.giros) + "\n"
+                           "-Coste con giros: " + QString::number(saltos.movimientos + coste_giro*saltos.giros));
+}
+
+// Sustituye los puntos intermedios que hubiera por tantos puntos nuevos como
+// indique el usuario, colocados al azar sobre el césped libre.
+void MainWindow::on_bPuntos_clicked(){
+  on_bReset_clicked();
+  generado = false;
+
+  for(unsigned i = 0; i < puntos.size(); ++i)
+    set_pos(puntos[i].fila, puntos[i].columna, CESPED_A);
+  puntos.clear();
+
+  std::vector<Posicion> libres;
+  for(int i = 0; i < rows; ++i)
+    for(int j = 0; j < columns; ++j)
+      if(label_list[i][j]->tipo() == CESPED_A)
+        libres.push_back(Posicion(i, j));
+
+  int cantidad = std::min(ui->sbPuntos->value(), static_cast<int>(libres.size()));
+  for(int i = 0; i < cantidad; ++i){
+    std::swap(libres[i], libres[i + rand()%(libres.size()-i)]);
+    puntos.push_back(libres[i]);
+    set_pos(libres[i].fila, libres[i].columna, PUNTO_RUTA);
+  }
+}
+
+// Calcula la ruta más corta que encuentra para pasar por todos los puntos
+// intermedios, partiendo del punto A si está colocado o del punto de inicio
+// si no, y hace que la cortadora la recorra. Al terminar muestra la longitud
+// de la ruta y el tiempo que ha llevado calcularla.
+void MainWindow::on_bRuta_clicked(){
+  if(puntos.empty()){
+    QMessageBox::critical(this, "Error",
+                          "No hay ningún punto intermedio en el jardín.",
+                          QMessageBox::Ok);
+    return;
+  }
+
+  on_bReset_clicked();
+
+  std::vector<Posicion> ruta;
+  if(ini_x >= 0)
+    ruta.push_back(Posicion(ini_y, ini_x));
+  else
+    ruta.push_back(Posicion(0, 0));
+  ruta.insert(ruta.end(), puntos.begin(), puntos.end());
+
+  QTime time;
+  int mat_time, ord_time, inicial, iteraciones = 0;
+  std::vector<std::vector<int> > matriz;
+  std::vector<Movimientos> movs;
+  Jardin copia = jardin();
+
+  time.start();
+  matriz_distancias(copia, ruta, matriz);
+  mat_time = time.elapsed();
+
+  time.start();
+  std::vector<int> orden = ordenar_ruta(matriz, &inicial);
+  ord_time = time.elapsed();
+
+  movimientos_ruta(copia, ruta, orden, movs);
+
+  corta->ir_a(ruta[0].fila, ruta[0].columna);
+  lock_interface(true);
+  corta->on_delay_changed(ui->timeSlider->value());
+  corta->recorrer(movs, &iteraciones);
+  lock_interface(false);
+
+  QMessageBox::information(this, "Resultados",
+                           "Puntos visitados: " + QString::number(orden.size()-1) +
+                           " de " + QString::number(puntos.size()) + "\n\n"
+                           "Número de iteraciones realizadas:\n"
+                           "-Vecino más cercano: " + QString::number(inicial) + "\n"
+                           "-Ruta mejorada: " + QString::number(iteraciones) + "\n\n"
+                           "Tiempo transcurrido:\n"
+                           "-Matriz de distancias: " + QString::number(mat_time) + "ms\n"
+                           "-Orden de visita: " + QString::number(ord_time) + "ms");
+}
+
 // Convierte el césped cortado en césped alto y sitúa los puntos de inicio y
 // fin para preparar al jardín para otra simulación.
 void MainWindow::on_bReset_clicked(){
   int iteraciones = 0;
 
+  visitas.reiniciar(rows, columns);
+
   progressBar->setHidden(false);
 
   for(int i = 0; i < rows; ++i){
@@ -552,10 +1514,76 @@ void MainWindow::on_bReset_clicked(){
     set_pos(ini_y, ini_x, PUNTO_A);
   if(fin_x != -1)
     set_pos(fin_y, fin_x, PUNTO_B);
+  for(unsigned i = 0; i < puntos.size(); ++i)
+    set_pos(puntos[i].fila, puntos[i].columna, PUNTO_RUTA);
 
   progressBar->setHidden(true);
 }
 
+// Corta todo el césped como la búsqueda en profundidad, pero al llegar a un
+// callejón sin salida salta a la celda sin cortar más cercana en lugar de
+// deshacer el camino.
+void MainWindow::on_bSaltos_clicked(){
+  on_bReset_clicked();
+
+  Jardin copia = jardin();
+  copia.set_tipo(0, 0, INICIO);
+  std::vector<Movimientos> movs;
+  cobertura_saltos(copia, Posicion(0, 0), &movs);
+
+  corta->ir_a(0, 0);
+  lock_interface(true);
+  corta->on_delay_changed(ui->timeSlider->value());
+  corta->recorrer(movs);
+  lock_interface(false);
+}
+
+// Corta todo el césped con la búsqueda en profundidad reanudable. Mientras
+// corta, el mismo botón sirve para detener el corte, que después se puede
+// continuar desde el último punto de control, incluso tras cerrar el
+// programa.
+void MainWindow::on_bPuntoControl_clicked(){
+  if(cortando){
+    detener = true;
+    return;
+  }
+
+  on_bReset_clicked();
+  CoberturaReanudable cobertura(datos_guardables().jardin, Posicion(0, 0));
+  corta->ir_a(0, 0);
+  cortar_reanudable(cobertura);
+}
+
+// Continúa el corte desde el punto de control guardado para este jardín.
+// Primero se dibuja de una vez todo lo que ya estaba cortado.
+void MainWindow::on_bReanudar_clicked(){
+  CoberturaReanudable cobertura(datos_guardables().jardin, Posicion(0, 0));
+  QByteArray estado;
+
+  if(!leer_punto_control(fichero_punto_control(), estado)){
+    QMessageBox::warning(this, "Reanudar corte", "No hay ningún corte guardado para este jardín.");
+    return;
+  }
+  if(!cobertura.cargar(estado)){
+    QMessageBox::warning(this, "Reanudar corte",
+                         "El punto de control está dañado o es de un jardín distinto del actual.");
+    return;
+  }
+
+  on_bReset_clicked();
+  ui->scrollAreaWidgetContents->setUpdatesEnabled(false);
+  ui->graphicsView->setUpdatesEnabled(false);
+  for(int i = 0; i < rows; ++i)
+    for(int j = 0; j < columns; ++j)
+      if(cobertura.cortada(i, j) && label_list[i][j]->tipo() != INICIO)
+        set_pos(i, j, CESPED_B);
+  ui->graphicsView->setUpdatesEnabled(true);
+  ui->scrollAreaWidgetContents->setUpdatesEnabled(true);
+
+  corta->ir_a(cobertura.posicion().fila, cobertura.posicion().columna);
+  cortar_reanudable(cobertura);
+}
+
 // Ejecuta el algoritmo de cortar todo el jardín
 void MainWindow::on_bSimular_clicked(){
   on_bReset_clicked();
@@ -568,6 +1596,45 @@ void MainWindow::on_bSimular_clicked(){
   lock_interface(false);
 }
 
+// Muestra u oculta el mapa de visitas volviendo a dibujar todas las celdas.
+void MainWindow::on_cbVisitas_clicked(bool){
+  for(int i = 0; i < rows; ++i)
+    for(int j = 0; j < columns; ++j)
+      ImgMod(i, j, label_list[i][j]->tipo());
+}
+
+// Publica la telemetría de la cortadora en un segmento de memoria compartida
+// cuya clave lleva el identificador del proceso, para poder observar a la vez
+// varias simulaciones.
+void MainWindow::on_cbTelemetria_clicked(bool checked){
+  corta->publicar(NULL);
+  delete telemetria;
+  telemetria = NULL;
+  if(!checked){
+    ui->statusBar->clearMessage();
+    return;
+  }
+
+  telemetria = new PublicadorTelemetria(QString("ia-telemetria-%1")
+                                        .arg(QCoreApplication::applicationPid()));
+  if(!telemetria->activo()){
+    QMessageBox::warning(this, "Telemetría",
+                         "No se ha podido crear la memoria compartida: " + telemetria->error());
+    delete telemetria;
+    telemetria = NULL;
+    ui->cbTelemetria->setChecked(false);
+    return;
+  }
+  corta->publicar(telemetria);
+  ui->statusBar->showMessage("Telemetría en " + telemetria->clave());
+}
+
+// Resumen de las visitas de la última ejecución, o de todas las que se han
+// hecho desde que se reinició el jardín.
+void MainWindow::on_bVisitas_clicked(){
+  QMessageBox::information(this, "Visitas", texto_visitas(visitas.histograma()));
+}
+
 // Alterna entre el modo edición y el modo simulación
 void MainWindow::on_cbEdicion_clicked(bool checked){
   if(!checked)
@@ -580,11 +1647,22 @@ void MainWindow::on_cbEdicion_clicked(bool checked){
 
 // Decide qué tipo de celda debe ser la celda especificada tras ser pulsada por
 // el usuario. El orden es el siguiente:
-// CESPED_A --> OBSTACULO --> PUNTO_A --> PUNTO_B --> CESPED_A...
-// Sólo permite un punto A y un punto B en todo el jardín.
+// CESPED_A --> OBSTACULO --> PUNTO_A --> PUNTO_B --> PUNTO_RUTA --> CESPED_A...
+// Sólo permite un punto A y un punto B en todo el jardín, pero tantos puntos
+// intermedios como se quiera.
 void MainWindow::on_Celda_clicked(int fila, int columna){
-  if(ui->cbEdicion->isChecked()){
+  if(ui->cbEdicion->isChecked() && ui->cbHerramienta->currentIndex() == HERRAMIENTA_CELDA){
     TipoCelda tipo = label_list[fila][columna]->tipo();
+    generado = false;
+
+    // Con un terreno seleccionado se pinta el terreno de la celda en lugar de
+    // cambiar su tipo
+    if(ui->cbTerreno->currentIndex() > 0){
+      if(tipo != INICIO && tipo != OBSTACULO)
+        set_terreno(fila, columna, static_cast<Terreno>(ui->cbTerreno->currentIndex()-1));
+      return;
+    }
+
     if(tipo != INICIO){
       if(tipo == CESPED_A)
         set_pos(fila, columna, OBSTACULO);
@@ -600,8 +1678,10 @@ void MainWindow::on_Celda_clicked(int fila, int columna){
             fin_x = columna;
             fin_y = fila;
           }
-          else
-            set_pos(fila, columna, CESPED_A);
+          else {
+            set_pos(fila, columna, PUNTO_RUTA);
+            puntos.push_back(Posicion(fila, columna));
+          }
         }
       }
       else if(tipo == PUNTO_A){
@@ -611,11 +1691,18 @@ void MainWindow::on_Celda_clicked(int fila, int columna){
           fin_x = columna;
           fin_y = fila;
         }
-        else
-          set_pos(fila, columna, CESPED_A);
+        else {
+          set_pos(fila, columna, PUNTO_RUTA);
+          puntos.push_back(Posicion(fila, columna));
+        }
       }
-      else {
+      else if(tipo == PUNTO_B){
         fin_x = -1;
+        set_pos(fila, columna, PUNTO_RUTA);
+        puntos.push_back(Posicion(fila, columna));
+      }
+      else {
+        quitar_punto(fila, columna);
         set_pos(fila, columna, CESPED_A);
       }
     }
@@ -634,6 +1721,74 @@ void MainWindow::on_sbFilas_valueChanged(int filas){
   resize(filas, columns);
 }
 
+// Empieza un trazo con la herramienta de edición elegida. Se pinta sobre una
+// copia del jardín que se mantiene hasta que se suelta el ratón. El pincel y
+// el relleno pintan ya al pulsar; el rectángulo y la línea esperan a que se
+// suelte para saber dónde terminan.
+void MainWindow::on_Celda_pulsada(int fila, int columna, bool derecho){
+  herramienta = static_cast<Herramienta>(ui->cbHerramienta->currentIndex());
+  if(!ui->cbEdicion->isChecked() || herramienta == HERRAMIENTA_CELDA)
+    return;
+
+  trazando = true;
+  borrando = derecho;
+  lienzo = jardin();
+  trazo = Trazo();
+  inicio_trazo = fin_trazo = Posicion(fila, columna);
+
+  std::vector<Posicion> celdas;
+  if(herramienta == HERRAMIENTA_PINCEL)
+    celdas.push_back(inicio_trazo);
+  else if(herramienta == HERRAMIENTA_RELLENO)
+    celdas_relleno(lienzo, inicio_trazo, pintura(), celdas);
+  trazo.pintar(lienzo, celdas, pintura());
+  aplicar_cambios(trazo.cambios());
+}
+
+// El pincel pinta la línea que va desde la última celda por la que pasó,
+// para no dejar huecos si el ratón se mueve deprisa.
+void MainWindow::on_Celda_arrastrada(int fila, int columna){
+  Posicion p(fila, columna);
+  if(!trazando || p == fin_trazo)
+    return;
+
+  if(herramienta == HERRAMIENTA_PINCEL){
+    std::vector<Posicion> celdas;
+    unsigned antes = trazo.cambios().size();
+    celdas_linea(fin_trazo, p, celdas);
+    trazo.pintar(lienzo, celdas, pintura());
+    aplicar_cambios(trazo.cambios(), antes);
+  }
+  fin_trazo = p;
+}
+
+// Termina el trazo y lo guarda para poder deshacerlo entero de una vez.
+void MainWindow::on_Celda_soltada(int fila, int columna){
+  if(!trazando)
+    return;
+  trazando = false;
+  if(fila >= 0)
+    fin_trazo = Posicion(fila, columna);
+
+  std::vector<Posicion> celdas;
+  unsigned antes = trazo.cambios().size();
+  if(herramienta == HERRAMIENTA_RECTANGULO)
+    celdas_rectangulo(inicio_trazo, fin_trazo, celdas);
+  else if(herramienta == HERRAMIENTA_LINEA)
+    celdas_linea(inicio_trazo, fin_trazo, celdas);
+  trazo.pintar(lienzo, celdas, pintura());
+  aplicar_cambios(trazo.cambios(), antes);
+
+  if(!trazo.vacio()){
+    generado = false;
+    historial.push_back(trazo);
+    if(historial.size() > MAX_DESHACER)
+      historial.erase(historial.begin());
+    ui->statusBar->showMessage(QString("Celdas cambiadas: %1").arg(static_cast<int>(trazo.cambios().size())));
+  }
+  lienzo = Jardin();
+}
+
 /*
  * ACCIONES
  */
@@ -644,11 +1799,8 @@ void MainWindow::on_actionAbrir_triggered()
 {
   filename = QFileDialog::getOpenFileName(this, "Abrir fichero...", "",
                                           "Archivos de jardín (*.garden)");
-  if(filename.length() > 0){
+  if(filename.length() > 0)
     load();
-    on_cbEdicion_clicked(true);
-    ui->cbEdicion->setChecked(true);
-  }
 }
 
 // Menú con los nombres de los autores.
@@ -662,6 +1814,152 @@ void MainWindow::on_actionAcerca_de_triggered(){
                      "Sawan J. Kapai Harpalani");
 }
 
+// Evalúa los algoritmos sobre miles de jardines aleatorios de distintos
+// tamaños y densidades de obstáculos. Como el informe es largo, sólo se
+// muestra el resumen y se ofrece guardarlo completo en un fichero de texto.
+void MainWindow::on_actionBarrido_triggered(){
+  ConfiguracionBarrido config;
+  bool ok;
+
+  config.jardines = QInputDialog::getInt(this, "Barrido Monte Carlo",
+                                         "Jardines por cada tamaño y densidad:",
+                                         config.jardines, 1, 100000, 1, &ok);
+  if(!ok)
+    return;
+  config.semilla = rand();
+
+  lock_interface(true);
+  InformeBarrido informe = ejecutar_barrido(config);
+  lock_interface(false);
+
+  switch(QMessageBox::information(this, "Resultados",
+                                 "Jardines evaluados: " + QString::number(informe.evaluaciones) + "\n"
+                                 "Tiempo transcurrido: " + QString::number(informe.tiempo_ms) + "ms\n"
+                                 "Jardines evaluados por segundo: " +
+                                 QString::number(informe.evaluaciones_segundo, 'f', 1) + "\n\n"
+                                 "Semilla: " + QString::number(config.semilla) + "\n\n"
+                                 "¿Deseas exportar el informe completo a un fichero de texto?",
+                                 QMessageBox::Yes | QMessageBox::No, QMessageBox::Yes)){
+  case QMessageBox::Yes:
+  {
+    QString dir = QFileDialog::getSaveFileName(this, "Archivo de destino", "", "Archivos de texto (*.txt)");
+    if(dir.length() > 0){
+      QFile out(dir);
+      if(out.open(QIODevice::WriteOnly | QIODevice::Text)){
+        out.write(texto_barrido(informe).toUtf8());
+        out.write(QString("\nSemilla: " + QString::number(config.semilla) + "\n").toUtf8());
+        out.flush();
+        out.close();
+      }
+      else
+        QMessageBox::critical(NULL, "Error al guardar",
+                              "No se ha podido abrir el fichero para guardar. Compruebe sus permisos.");
+    }
+    break;
+  }
+  case QMessageBox::No:
+  default:
+    break;
+  }
+}
+
+// Compara la búsqueda en anchura celda a celda con la de mapas de bits en
+// jardines aleatorios desde 150x150 hasta 4000x4000.
+void MainWindow::on_actionAnchura_triggered(){
+  static const int TAMANOS[] = {150, 500, 1000, 2000, 4000};
+  static const int DENSIDADES[] = {0, PORCENTAJE_OBSTACULOS};
+
+  lock_interface(true);
+  std::vector<MedidaAnchura> medidas =
+      comparar_anchura(std::vector<int>(TAMANOS, TAMANOS + 5),
+                       std::vector<int>(DENSIDADES, DENSIDADES + 2), rand());
+  lock_interface(false);
+
+  QString texto = texto_anchura(medidas);
+  switch(QMessageBox::information(this, "Resultados",
+                                  texto + "\n¿Deseas exportar los resultados a un fichero de texto?",
+                                  QMessageBox::Yes | QMessageBox::No, QMessageBox::Yes)){
+  case QMessageBox::Yes:
+  {
+    QString dir = QFileDialog::getSaveFileName(this, "Archivo de destino", "", "Archivos de texto (*.txt)");
+    if(dir.length() > 0){
+      QFile out(dir);
+      if(out.open(QIODevice::WriteOnly | QIODevice::Text)){
+        out.write(texto.toUtf8());
+        out.flush();
+        out.close();
+      }
+      else
+        QMessageBox::critical(NULL, "Error al guardar",
+                              "No se ha podido abrir el fichero para guardar. Compruebe sus permisos.");
+    }
+    break;
+  }
+  case QMessageBox::No:
+  default:
+    break;
+  }
+}
+
+// Simula una temporada de cortes diarios sobre el jardín actual, en la que
+// el césped vuelve a crecer, con cada estrategia del planificador. Se
+// muestra el resumen de cada una y se ofrece guardar el informe día a día.
+void MainWindow::on_actionTemporada_triggered(){
+  ConfiguracionTemporada config;
+  bool ok;
+
+  config.dias = QInputDialog::getInt(this, "Temporada de cortes", "Días de la temporada:",
+                                     config.dias, 1, 3650, 1, &ok);
+  if(!ok)
+    return;
+  config.presupuesto = QInputDialog::getInt(this, "Temporada de cortes",
+                                            "Movimientos por día (0 para calcularlos):",
+                                            config.presupuesto, 0, 100000000, 100, &ok);
+  if(!ok)
+    return;
+
+  Jardin copia = jardin();
+  copia.set_tipo(0, 0, INICIO);
+
+  lock_interface(true);
+  QString resumen, texto;
+  for(int e = 0; e < NUM_ESTRATEGIAS_TEMPORADA; ++e){
+    config.estrategia = static_cast<EstrategiaTemporada>(e);
+    InformeTemporada informe = simular_temporada(copia, config);
+    resumen += QString(nombre_estrategia_temporada(config.estrategia)) + ":\n"
+               "  Altura máxima: " + QString::number(informe.altura_max, 'f', 1) + "mm\n"
+               "  Días máximos sin cortar: " + QString::number(informe.dias_max) + "\n"
+               "  Movimientos: " + QString::number(informe.movimientos) + "\n"
+               "  Tiempo: " + QString::number(informe.tiempo_ms) + "ms\n\n";
+    texto += texto_temporada(informe, config) + "\n";
+  }
+  lock_interface(false);
+
+  switch(QMessageBox::information(this, "Resultados",
+                                  resumen + "¿Deseas exportar el informe día a día a un fichero de texto?",
+                                  QMessageBox::Yes | QMessageBox::No, QMessageBox::Yes)){
+  case QMessageBox::Yes:
+  {
+    QString dir = QFileDialog::getSaveFileName(this, "Archivo de destino", "", "Archivos de texto (*.txt)");
+    if(dir.length() > 0){
+      QFile out(dir);
+      if(out.open(QIODevice::WriteOnly | QIODevice::Text)){
+        out.write(texto.toUtf8());
+        out.flush();
+        out.close();
+      }
+      else
+        QMessageBox::critical(NULL, "Error al guardar",
+                              "No se ha podido abrir el fichero para guardar. Compruebe sus permisos.");
+    }
+    break;
+  }
+  case QMessageBox::No:
+  default:
+    break;
+  }
+}
+
 // Si se pulsa guardar y se ha guardado previamente o se ha abierto algún
 // fichero, se guarda directamente. Si no, se llama a la acción "Guardar
 // como...".
@@ -673,6 +1971,43 @@ void MainWindow::on_actionGuardar_triggered()
     save();
 }
 
+// Importa el plano del jardín desde una imagen. Se pide el nivel de gris
+// por debajo del cual un píxel es obstáculo y la imagen se reduce lo justo
+// para que quepa en el tamaño máximo del jardín. La conversión se hace en el
+// hilo de ficheros y el jardín se dibuja una sola vez al terminar. Como el
+// jardín no sale de ningún fichero .garden, al guardarlo se pide el nombre.
+void MainWindow::on_actionImportar_triggered(){
+  QString imagen = QFileDialog::getOpenFileName(this, "Importar imagen...", "",
+                                                "Imágenes (*.pgm *.png)");
+  if(imagen.isEmpty())
+    return;
+
+  bool ok;
+  int umbral = QInputDialog::getInt(this, "Importar imagen",
+                                    "Nivel de gris (0-255) por debajo del cual un píxel es obstáculo:",
+                                    UMBRAL_IMAGEN, 0, 255, 1, &ok);
+  if(!ok)
+    return;
+
+  QString error;
+  LectorImagen* lector = abrir_imagen_qt(imagen, error);
+  if(!lector){
+    QMessageBox::critical(this, "Error al importar", error);
+    return;
+  }
+
+  OpcionesImagen opciones;
+  opciones.umbral = umbral;
+  opciones.max_filas = MAX_ROWS;
+  opciones.max_columnas = MAX_COLUMNS;
+
+  filename.clear();
+  progressBar->setValue(0);
+  progressBar->setHidden(false);
+  lock_interface(true);
+  emit importar_fichero(lector, opciones);
+}
+
 // Pide al usuario un nombre de archivo antes de realizar el guardado.
 void MainWindow::on_actionGuardar_como_triggered()
 {
@@ -703,9 +2038,13 @@ void MainWindow::on_actionNuevo_triggered(){
 
   int iteraciones = 0;
   progressBar->setEnabled(true);
+  puntos.clear();
+  generado = false;
+  historial.clear();
 
   for(int i = 0; i < rows; ++i){
     for(int j = 0; j < columns; ++j){
+      label_list[i][j]->setTerreno(LLANO);
       set_pos(i, j, CESPED_A);
       ++iteraciones;
     }
@@ -725,6 +2064,50 @@ void MainWindow::on_actionSalir_triggered(){
   close();
 }
 
+/*
+ * RESPUESTAS DEL HILO DE FICHEROS
+ */
+
+// El fichero se ha leído correctamente. Si sus dimensiones son válidas se
+// sustituye el jardín actual por el leído y se pasa al modo edición.
+void MainWindow::archivo_cargado(const DatosJardin& datos){
+  const Jardin& nuevo = datos.jardin;
+
+  if(nuevo.filas() < MIN_ROWS || nuevo.filas() > MAX_ROWS ||
+     nuevo.columnas() < MIN_COLUMNS || nuevo.columnas() > MAX_COLUMNS){
+    archivo_error("Error de lectura",
+                  "El archivo especificado parece estar dañado o ser de otra aplicación. Imposible abrir.");
+    return;
+  }
+
+  aplicar(datos);
+  lock_interface(false);
+  progressBar->setHidden(true);
+
+  // Si el jardín se generó, se deja elegido su generador para repetirlo
+  if(datos.generado){
+    ui->cbGenerador->setCurrentIndex(datos.generador.tipo);
+    if(datos.generador.semilla <= static_cast<unsigned>(ui->sbSemilla->maximum()))
+      ui->sbSemilla->setValue(datos.generador.semilla);
+    ui->cbConectar->setChecked(datos.generador.conectar);
+  }
+
+  on_cbEdicion_clicked(true);
+  ui->cbEdicion->setChecked(true);
+  setWindowTitle(QString("IA - Búsqueda: <") + filename + QString(">"));
+}
+
+void MainWindow::archivo_guardado(){
+  progressBar->setHidden(true);
+  setWindowTitle(QString("IA - Búsqueda: <") + filename + QString(">"));
+}
+
+void MainWindow::archivo_error(const QString& titulo, const QString& mensaje){
+  lock_interface(false);
+  progressBar->setHidden(true);
+  QMessageBox::critical(this, titulo, mensaje);
+}
+
 // Bloquea todos los controles de la interfaz que causan o pueden causar un
 // cambio en el contenido del jardín para que no sucedan hechos extraños
 // producidos por el usuario cuando se está simulando.
@@ -734,8 +2117,40 @@ void MainWindow::lock_interface(bool b){
   ui->bSimular->setDisabled(b);
   ui->bReset->setDisabled(b);
   ui->bPruebas->setDisabled(b);
+  ui->bRuta->setDisabled(b);
+  ui->bMoviles->setDisabled(b);
+  ui->bExplorar->setDisabled(b);
+  ui->bSaltos->setDisabled(b);
+  ui->bCoste->setDisabled(b);
+  ui->bPlazo->setDisabled(b);
+  ui->bPlato->setDisabled(b);
+  ui->bAgentes->setDisabled(b);
+  ui->bVisitas->setDisabled(b);
+  ui->bPuntos->setDisabled(b);
+  ui->bDeshacer->setDisabled(b);
+  ui->bReanudar->setDisabled(b);
+  ui->bPuntoControl->setDisabled(b && !cortando);
+  ui->cbTelemetria->setDisabled(b);
+  ui->bHistorial->setDisabled(b);
+  ui->bGiros->setDisabled(b);
   ui->actionAbrir->setDisabled(b);
+  ui->actionImportar->setDisabled(b);
   ui->actionGuardar->setDisabled(b);
   ui->actionGuardar_como->setDisabled(b);
   ui->actionSalir->setDisabled(b);
+
+  // Al desbloquear la interfaz ha terminado el recorrido que se publicaba
+  if(!b && telemetria)
+    telemetria->terminar();
+}
+
+// Elimina de la lista de puntos intermedios el que está en la posición
+// indicada, si lo hay.
+void MainWindow::quitar_punto(int fila, int columna){
+  for(unsigned i = 0; i < puntos.size(); ++i){
+    if(puntos[i] == Posicion(fila, columna)){
+      puntos.erase(puntos.begin()+i);
+      return;
+    }
+  }
 }
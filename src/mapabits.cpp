@@ -0,0 +1,433 @@
+#include "mapabits.h"
+
+#include <algorithm>
+#include <climits>
+#include <utility>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+// Número de bits activos de una palabra.
+static inline int contar_bits(quint64 x){
+#if defined(__GNUC__)
+  return __builtin_popcountll(x);
+#else
+  int n = 0;
+  for(; x; x &= x-1)
+    ++n;
+  return n;
+#endif
+}
+
+// Posición del bit activo de menor peso. La palabra no puede ser cero.
+static inline int menor_bit(quint64 x){
+#if defined(__GNUC__)
+  return __builtin_ctzll(x);
+#else
+  int n = 0;
+  for(; !(x & 1); x >>= 1)
+    ++n;
+  return n;
+#endif
+}
+
+// Los rangos de palabras se guardan desplazados una fila, igual que las
+// palabras, para poder consultar la fila de encima de la primera y la de
+// debajo de la última sin comprobaciones. Las filas con bits se guardan
+// además en una lista en orden, para no tener que recorrer las vacías que
+// quedan entre ellas, como pasa en los pasillos de los laberintos.
+struct MapaBits::Frente {
+  Frente(int filas, int tam): bits(tam, 0), ini(filas+2, INT_MAX), fin(filas+2, -1) {}
+
+  // Frente sin memoria propia, que luego toma la de una Memoria con usar().
+  Frente() {}
+
+  // Intercambia la memoria del frente con la indicada, que tiene que estar
+  // vacía. Llamándolo otra vez se devuelve.
+  void usar(std::vector<quint64>& b, std::vector<int>& i, std::vector<int>& f,
+            std::vector<int>& l){
+    bits.swap(b);
+    ini.swap(i);
+    fin.swap(f);
+    lista.swap(l);
+  }
+
+  bool vacio() const { return lista.empty(); }
+
+  // Anota una palabra con bits. Las filas nuevas tienen que llegar en orden.
+  void anotar(int fila, int w){
+    if(fin[fila+1] < 0)
+      lista.push_back(fila);
+    ini[fila+1] = std::min(ini[fila+1], w);
+    fin[fila+1] = std::max(fin[fila+1], w);
+  }
+
+  // Deja el frente vacío poniendo a cero sólo las palabras que ha usado.
+  void vaciar(const MapaBits& mapa){
+    for(unsigned k = 0; k < lista.size(); ++k){
+      int r = lista[k];
+      for(int w = ini[r+1]; w <= fin[r+1]; ++w)
+        bits[mapa.palabra(r, w)] = 0;
+      ini[r+1] = INT_MAX;
+      fin[r+1] = -1;
+    }
+    lista.clear();
+  }
+
+  void intercambiar(Frente& otro){
+    bits.swap(otro.bits);
+    ini.swap(otro.ini);
+    fin.swap(otro.fin);
+    lista.swap(otro.lista);
+  }
+
+  std::vector<quint64> bits;
+  std::vector<int> ini, fin, lista;
+};
+
+// Se reservan palabras de más al final para que las lecturas de cuatro en
+// cuatro de la última fila no se salgan del vector.
+MapaBits::MapaBits(int filas, int columnas): rows(filas), columns(columnas),
+  palabras((columnas+63)/64), ancho(palabras+2), bits((filas+2)*ancho + 4, 0)
+{
+}
+
+MapaBits::MapaBits(const Jardin& jardin): rows(jardin.filas()),
+  columns(jardin.columnas()), palabras((columns+63)/64), ancho(palabras+2),
+  bits((rows+2)*ancho + 4, 0)
+{
+  for(int i = 0; i < rows; ++i)
+    for(int j = 0; j < columns; ++j)
+      if(jardin.transitable(i, j))
+        activar(i, j);
+}
+
+int MapaBits::cuenta() const {
+  int total = 0;
+  for(unsigned i = 0; i < bits.size(); ++i)
+    total += contar_bits(bits[i]);
+  return total;
+}
+
+bool MapaBits::avx2(){
+#ifdef __AVX2__
+  return true;
+#else
+  return false;
+#endif
+}
+
+// Calcula el siguiente frente a partir del actual. Una celda entra en el
+// siguiente frente si es transitable, no se ha visitado y alguna de sus
+// vecinas está en el frente actual. Sólo se recorren las filas vecinas de las
+// del frente y, en cada una, las palabras vecinas de las que tienen bits. Las
+// celdas del nuevo frente se marcan como visitadas sobre la marcha, ya que
+// cada palabra nueva sólo depende de la misma palabra de "visitadas", y si se
+// indica "dist" se les asigna la distancia "d".
+// Devuelve el número de celdas del nuevo frente.
+int MapaBits::expandir(Frente& frente, Frente& siguiente, std::vector<quint64>& visitadas,
+                       std::vector<int>* dist, int d) const {
+  const quint64* f = &frente.bits[0];
+  const quint64* libres = &bits[0];
+  quint64* s = &siguiente.bits[0];
+  quint64* v = &visitadas[0];
+  int total = 0;
+
+  // La lista del frente está en orden, así que cada fila se visita una vez y
+  // las del siguiente frente también quedan en orden
+  int hecha = -1;
+  for(unsigned i = 0; i < frente.lista.size(); ++i){
+    int ultima = std::min(frente.lista[i]+1, rows-1);
+    for(int r = std::max(frente.lista[i]-1, hecha+1); r <= ultima; ++r){
+      hecha = r;
+      int l = std::min(frente.ini[r], std::min(frente.ini[r+1], frente.ini[r+2]));
+      int h = std::max(frente.fin[r], std::max(frente.fin[r+1], frente.fin[r+2]));
+      if(h < l)
+        continue;
+      l = std::max(l-1, 0);
+      h = std::min(h+1, palabras-1);
+
+      int base = palabra(r, 0), lo = INT_MAX, hi = -1;
+      int w = l;
+#ifdef __AVX2__
+      for(; w + 3 <= h; w += 4){
+        int p = base + w;
+        __m256i actual = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(f + p));
+        __m256i izquierda = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(f + p - 1));
+        __m256i derecha = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(f + p + 1));
+        __m256i arriba = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(f + p - ancho));
+        __m256i abajo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(f + p + ancho));
+        __m256i libre = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(libres + p));
+        __m256i vistas = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(v + p));
+
+        __m256i n = _mm256_or_si256(_mm256_or_si256(arriba, abajo),
+                    _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi64(actual, 1),
+                                                    _mm256_srli_epi64(izquierda, 63)),
+                                    _mm256_or_si256(_mm256_srli_epi64(actual, 1),
+                                                    _mm256_slli_epi64(derecha, 63))));
+        n = _mm256_andnot_si256(vistas, _mm256_and_si256(n, libre));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(s + p), n);
+        if(_mm256_testz_si256(n, n))
+          continue;
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(v + p), _mm256_or_si256(vistas, n));
+
+        for(int k = 0; k < 4; ++k){
+          quint64 x = s[p+k];
+          if(!x)
+            continue;
+          lo = std::min(lo, w+k);
+          hi = w+k;
+          total += contar_bits(x);
+          if(dist)
+            for(int c = r*columns + (w+k)*64; x; x &= x-1)
+              (*dist)[c + menor_bit(x)] = d;
+        }
+      }
+#endif
+      for(; w <= h; ++w){
+        int p = base + w;
+        quint64 actual = f[p];
+        quint64 n = f[p - ancho] | f[p + ancho] |
+                    (actual << 1) | (f[p-1] >> 63) |
+                    (actual >> 1) | (f[p+1] << 63);
+        n &= libres[p] & ~v[p];
+        s[p] = n;
+        if(!n)
+          continue;
+        v[p] |= n;
+        lo = std::min(lo, w);
+        hi = w;
+        total += contar_bits(n);
+        if(dist)
+          for(int c = r*columns + w*64; n; n &= n-1)
+            (*dist)[c + menor_bit(n)] = d;
+      }
+
+      if(hi >= 0){
+        siguiente.ini[r+1] = lo;
+        siguiente.fin[r+1] = hi;
+        siguiente.lista.push_back(r);
+      }
+    }
+  }
+  return total;
+}
+
+void MapaBits::capas(const Posicion& origen, std::vector<int>& dist) const {
+  dist.assign(rows*columns, -1);
+  if(origen.fila < 0 || origen.fila >= rows || origen.columna < 0 || origen.columna >= columns)
+    return;
+
+  std::vector<quint64> visitadas(bits.size(), 0);
+  Frente frente(rows, bits.size()), siguiente(rows, bits.size());
+  int p = palabra(origen.fila, origen.columna/64);
+
+  frente.bits[p] = visitadas[p] = quint64(1) << (origen.columna%64);
+  frente.anotar(origen.fila, origen.columna/64);
+  dist[origen.fila*columns + origen.columna] = 0;
+
+  for(int d = 1; !frente.vacio(); ++d){
+    expandir(frente, siguiente, visitadas, &dist, d);
+    frente.vaciar(*this);
+    frente.intercambiar(siguiente);
+  }
+}
+
+// Extiende los bits de "fila" por los tramos de celdas activas consecutivas
+// de "libres" en los que están, en los dos sentidos y cruzando de una palabra
+// a otra. Dentro de cada palabra se hace en seis pasos desplazando 1, 2, 4, 8,
+// 16 y 32 posiciones (Kogge-Stone). Sólo han cambiado las palabras entre "lo"
+// y "hi" y el resto ya estaba extendido, así que fuera de ese rango sólo se
+// sigue mientras el tramo continúe en una celda que aún no estaba marcada.
+static void extender(quint64* fila, const quint64* libres, int palabras, int lo, int hi){
+  quint64 acarreo = 0;
+  int w;
+  for(w = lo; w < palabras && (w <= hi || acarreo); ++w){
+    quint64 m = libres[w], x = (fila[w] | acarreo) & m;
+    x |= (x << 1) & m;  m &= m << 1;
+    x |= (x << 2) & m;  m &= m << 2;
+    x |= (x << 4) & m;  m &= m << 4;
+    x |= (x << 8) & m;  m &= m << 8;
+    x |= (x << 16) & m; m &= m << 16;
+    x |= (x << 32) & m;
+    acarreo = (x >> 63) & (w+1 < palabras? libres[w+1] & ~fila[w+1] : 0);
+    fila[w] = x;
+  }
+  acarreo = 0;
+  for(w = w-1; w >= 0 && (w >= lo || acarreo); --w){
+    quint64 m = libres[w], x = (fila[w] | (acarreo << 63)) & m;
+    x |= (x >> 1) & m;  m &= m >> 1;
+    x |= (x >> 2) & m;  m &= m >> 2;
+    x |= (x >> 4) & m;  m &= m >> 4;
+    x |= (x >> 8) & m;  m &= m >> 8;
+    x |= (x >> 16) & m; m &= m >> 16;
+    x |= (x >> 32) & m;
+    acarreo = x & (w > 0? (libres[w-1] & ~fila[w-1]) >> 63 : 0);
+    fila[w] = x;
+  }
+}
+
+// Para contar las celdas alcanzables no hacen falta las distancias, así que
+// en lugar de avanzar de frente en frente se rellena fila a fila: cada fila
+// pendiente toma lo que le llega de las filas de encima y de debajo y lo
+// extiende a lo largo de sus tramos libres de una vez. Si la fila cambia, sus
+// vecinas pasan a estar pendientes. En jardines abiertos cada fila se procesa
+// muy pocas veces.
+int MapaBits::alcanzables(const Posicion& origen) const {
+  if(origen.fila < 0 || origen.fila >= rows || origen.columna < 0 || origen.columna >= columns)
+    return 0;
+
+  std::vector<quint64> visitadas(bits.size(), 0), semillas(bits.size(), 0), fila(palabras);
+  std::vector<int> pendientes;
+  std::vector<bool> en_lista(rows+2, false);
+
+  // Se empieza por el origen y sus vecinas, porque el origen puede no ser
+  // transitable
+  for(int k = 0; k < 4; ++k){
+    Posicion q = desplazar(origen, MOVIMIENTOS[k]);
+    if(q.fila >= 0 && q.fila < rows && q.columna >= 0 && q.columna < columns &&
+       activa(q.fila, q.columna)){
+      semillas[palabra(q.fila, q.columna/64)] |= quint64(1) << (q.columna%64);
+      if(!en_lista[q.fila+1]){
+        en_lista[q.fila+1] = true;
+        pendientes.push_back(q.fila);
+      }
+    }
+  }
+  if(activa(origen.fila, origen.columna)){
+    semillas[palabra(origen.fila, origen.columna/64)] |= quint64(1) << (origen.columna%64);
+    if(!en_lista[origen.fila+1]){
+      en_lista[origen.fila+1] = true;
+      pendientes.push_back(origen.fila);
+    }
+  }
+
+  while(!pendientes.empty()){
+    int r = pendientes.back();
+    pendientes.pop_back();
+    en_lista[r+1] = false;
+
+    quint64* v = &visitadas[palabra(r, 0)];
+    const quint64* semilla = &semillas[palabra(r, 0)];
+    const quint64* libres = &bits[palabra(r, 0)];
+    int lo = palabras, hi = -1;
+    for(int w = 0; w < palabras; ++w){
+      fila[w] = v[w] | semilla[w] | ((v[w - ancho] | v[w + ancho]) & libres[w]);
+      if(fila[w] != v[w]){
+        lo = std::min(lo, w);
+        hi = w;
+      }
+    }
+    if(hi < 0)
+      continue;
+
+    extender(&fila[0], libres, palabras, lo, hi);
+    for(int w = 0; w < palabras; ++w)
+      v[w] = fila[w];
+
+    for(int vecina = r-1; vecina <= r+1; vecina += 2){
+      if(vecina >= 0 && vecina < rows && !en_lista[vecina+1]){
+        en_lista[vecina+1] = true;
+        pendientes.push_back(vecina);
+      }
+    }
+  }
+
+  int total = 0;
+  for(unsigned i = 0; i < visitadas.size(); ++i)
+    total += contar_bits(visitadas[i]);
+  return total;
+}
+
+// Se guardan las palabras no vacías de cada frente, ordenadas por su
+// posición, para poder reconstruir el camino desde la celda encontrada
+// buscando en cada frente anterior una vecina de la celda actual. Esas mismas
+// listas dicen qué palabras de "visitadas" hay que poner a cero al terminar.
+int MapaBits::mas_cercana(const Posicion& origen, const MapaBits& objetivos,
+                          std::vector<Movimientos>& movs, Memoria& mem) const {
+  typedef std::vector<std::pair<int, quint64> > Nivel;
+  movs.clear();
+  if(origen.fila < 0 || origen.fila >= rows || origen.columna < 0 || origen.columna >= columns)
+    return -1;
+  if(objetivos.activa(origen.fila, origen.columna))
+    return 0;
+
+  if(mem.visitadas.size() != bits.size() || mem.ini[0].size() != unsigned(rows+2)){
+    mem.visitadas.assign(bits.size(), 0);
+    for(int k = 0; k < 2; ++k){
+      mem.bits[k].assign(bits.size(), 0);
+      mem.ini[k].assign(rows+2, INT_MAX);
+      mem.fin[k].assign(rows+2, -1);
+    }
+  }
+  std::vector<quint64>& visitadas = mem.visitadas;
+  std::vector<Nivel>& niveles = mem.niveles;
+  Frente frente, siguiente;
+  frente.usar(mem.bits[0], mem.ini[0], mem.fin[0], mem.filas[0]);
+  siguiente.usar(mem.bits[1], mem.ini[1], mem.fin[1], mem.filas[1]);
+
+  int p = palabra(origen.fila, origen.columna/64);
+  unsigned num_niveles = 1;
+  Posicion encontrada(-1, -1);
+
+  frente.bits[p] = visitadas[p] = quint64(1) << (origen.columna%64);
+  frente.anotar(origen.fila, origen.columna/64);
+  if(niveles.empty())
+    niveles.resize(1);
+  niveles[0].assign(1, std::make_pair(p, frente.bits[p]));
+
+  while(!frente.vacio() && encontrada.fila < 0){
+    expandir(frente, siguiente, visitadas);
+
+    if(num_niveles == niveles.size())
+      niveles.push_back(Nivel());
+    Nivel& nivel = niveles[num_niveles++];
+    nivel.clear();
+    for(unsigned k = 0; k < siguiente.lista.size(); ++k){
+      int r = siguiente.lista[k];
+      for(int w = siguiente.ini[r+1]; w <= siguiente.fin[r+1]; ++w){
+        int q = palabra(r, w);
+        quint64 n = siguiente.bits[q];
+        if(!n)
+          continue;
+        nivel.push_back(std::make_pair(q, n));
+        if(encontrada.fila < 0 && (n & objetivos.bits[q]))
+          encontrada = Posicion(r, w*64 + menor_bit(n & objetivos.bits[q]));
+      }
+    }
+
+    frente.vaciar(*this);
+    frente.intercambiar(siguiente);
+  }
+
+  // Desde la celda encontrada se retrocede nivel a nivel
+  Posicion actual = encontrada;
+  for(int k = static_cast<int>(num_niveles)-2; k >= 0 && encontrada.fila >= 0; --k){
+    const Nivel& nivel = niveles[k];
+    for(int m = 0; m < 4; ++m){
+      Posicion q = desplazar(actual, MOVIMIENTOS[m]);
+      if(q.fila < 0 || q.fila >= rows || q.columna < 0 || q.columna >= columns)
+        continue;
+      int w = palabra(q.fila, q.columna/64);
+      Nivel::const_iterator it = std::lower_bound(nivel.begin(), nivel.end(),
+                                                  std::make_pair(w, quint64(0)));
+      if(it != nivel.end() && it->first == w && ((it->second >> (q.columna%64)) & 1)){
+        movs.push_back(opuesto(MOVIMIENTOS[m]));
+        actual = q;
+        break;
+      }
+    }
+  }
+  std::reverse(movs.begin(), movs.end());
+
+  // La memoria se devuelve vacía para la siguiente búsqueda
+  for(unsigned k = 0; k < num_niveles; ++k)
+    for(unsigned i = 0; i < niveles[k].size(); ++i)
+      visitadas[niveles[k][i].first] = 0;
+  frente.vaciar(*this);
+  frente.usar(mem.bits[0], mem.ini[0], mem.fin[0], mem.filas[0]);
+  siguiente.usar(mem.bits[1], mem.ini[1], mem.fin[1], mem.filas[1]);
+
+  return encontrada.fila < 0? -1 : static_cast<int>(movs.size());
+}
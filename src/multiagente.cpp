@@ -0,0 +1,259 @@
+#include "multiagente.h"
+
+#include <algorithm>
+#include <queue>
+
+#include <QElapsedTimer>
+
+#include "aleatorio.h"
+#include "reservas.h"
+
+// Instantes de espera que se permiten a cada agente sobre su distancia
+// mínima, en función del tamaño del jardín.
+static const int ESPERA_POR_LADO = 1;
+
+// Nodos que puede expandir cada agente antes de darse por vencido.
+static const int MAX_EXPANDIDOS = 200000;
+
+// Los cuatro movimientos más quedarse quieto.
+static const int OPCIONES = 5;
+
+namespace {
+
+struct Nodo {
+  Posicion pos;
+  int t, padre;
+};
+
+struct Abierto {
+  Abierto(int f, int t, int n): f(f), t(t), nodo(n) {}
+
+  // Los de menor f primero y, a igualdad, los más avanzados en el tiempo
+  bool operator<(const Abierto& o) const {
+    return f > o.f || (f == o.f && t < o.t);
+  }
+
+  int f, t, nodo;
+};
+
+// Estados (celda, instante) ya vistos. Por cada celda pasan pocos instantes,
+// así que se guardan en listas cortas, como en TablaReservas, y se vacían
+// recorriendo sólo las celdas tocadas.
+class Vistos {
+public:
+  explicit Vistos(int celdas): instantes(celdas) {}
+
+  bool marcar(int celda, int t){
+    std::vector<int>& v = instantes[celda];
+    for(unsigned i = 0; i < v.size(); ++i)
+      if(v[i] == t)
+        return false;
+    if(v.empty())
+      tocadas.push_back(celda);
+    v.push_back(t);
+    return true;
+  }
+
+  void limpiar(){
+    for(unsigned i = 0; i < tocadas.size(); ++i)
+      instantes[tocadas[i]].clear();
+    tocadas.clear();
+  }
+
+private:
+  std::vector<std::vector<int> > instantes;
+  std::vector<int> tocadas;
+};
+
+}
+
+// A* en espacio-tiempo para un agente. La heurística es la distancia real
+// hasta el destino sin tener en cuenta a los demás. Sólo se acepta llegar al
+// destino si nadie más va a pasar por él después, porque el agente se queda
+// allí para siempre.
+static bool planificar_agente(const Jardin& jardin, const Agente& agente,
+                              const std::vector<int>& heuristica,
+                              const TablaReservas& reservas, Vistos& vistos,
+                              std::vector<Posicion>& camino, int& expandidos){
+  int h0 = heuristica[jardin.indice(agente.inicio.fila, agente.inicio.columna)];
+  if(h0 < 0)
+    return false;
+  int limite = h0 + ESPERA_POR_LADO*(jardin.filas() + jardin.columnas());
+
+  std::vector<Nodo> nodos;
+  std::priority_queue<Abierto> abiertos;
+  int elegido = -1, propios = 0;
+
+  vistos.limpiar();
+  Nodo inicio = {agente.inicio, 0, -1};
+  nodos.push_back(inicio);
+  vistos.marcar(jardin.indice(agente.inicio.fila, agente.inicio.columna), 0);
+  abiertos.push(Abierto(h0, 0, 0));
+
+  while(!abiertos.empty() && propios < MAX_EXPANDIDOS){
+    int n = abiertos.top().nodo;
+    abiertos.pop();
+    Nodo actual = nodos[n];
+    ++propios;
+
+    if(actual.pos == agente.destino && reservas.libre_desde(actual.pos, actual.t)){
+      elegido = n;
+      break;
+    }
+    if(actual.t >= limite)
+      continue;
+
+    for(int k = 0; k < OPCIONES; ++k){
+      Posicion q = k < 4? desplazar(actual.pos, MOVIMIENTOS[k]) : actual.pos;
+      if(k < 4 && !jardin.transitable(q.fila, q.columna))
+        continue;
+      if(!reservas.paso_libre(actual.pos, q, actual.t))
+        continue;
+      int c = jardin.indice(q.fila, q.columna);
+      if(heuristica[c] < 0 || !vistos.marcar(c, actual.t + 1))
+        continue;
+
+      Nodo hijo = {q, actual.t + 1, n};
+      nodos.push_back(hijo);
+      abiertos.push(Abierto(actual.t + 1 + heuristica[c], actual.t + 1, nodos.size() - 1));
+    }
+  }
+
+  expandidos += propios;
+  if(elegido < 0)
+    return false;
+
+  camino.clear();
+  for(int n = elegido; n >= 0; n = nodos[n].padre)
+    camino.push_back(nodos[n].pos);
+  std::reverse(camino.begin(), camino.end());
+  return true;
+}
+
+// Reserva el camino de un agente y su destino para siempre desde que llega.
+static void reservar_camino(TablaReservas& reservas, const std::vector<Posicion>& camino){
+  reservas.reservar(camino[0], 0);
+  for(unsigned t = 0; t + 1 < camino.size(); ++t)
+    reservas.reservar_paso(camino[t], camino[t+1], t);
+  reservas.reservar_desde(camino.back(), camino.size() - 1);
+}
+
+PlanMultiagente planificar_agentes(const Jardin& jardin,
+                                   const std::vector<Agente>& agentes,
+                                   int max_intentos){
+  PlanMultiagente plan;
+  QElapsedTimer reloj;
+  reloj.start();
+
+  // Los inicios y los destinos tienen que ser distintos entre sí
+  std::vector<char> inicio_usado(jardin.celdas(), 0), destino_usado(jardin.celdas(), 0);
+  for(unsigned i = 0; i < agentes.size(); ++i){
+    int a = jardin.indice(agentes[i].inicio.fila, agentes[i].inicio.columna);
+    int b = jardin.indice(agentes[i].destino.fila, agentes[i].destino.columna);
+    if(inicio_usado[a] || destino_usado[b])
+      return plan;
+    inicio_usado[a] = destino_usado[b] = 1;
+  }
+
+  std::vector<std::vector<int> > heuristicas(agentes.size());
+  for(unsigned i = 0; i < agentes.size(); ++i){
+    jardin.distancias(agentes[i].destino, heuristicas[i]);
+    int h = heuristicas[i][jardin.indice(agentes[i].inicio.fila, agentes[i].inicio.columna)];
+    if(h < 0)
+      return plan;
+    plan.suma_minimos += h;
+  }
+
+  std::vector<int> orden(agentes.size());
+  for(unsigned i = 0; i < orden.size(); ++i)
+    orden[i] = i;
+
+  TablaReservas reservas(jardin);
+  Vistos vistos(jardin.celdas());
+  plan.caminos.assign(agentes.size(), std::vector<Posicion>());
+
+  while(!plan.exito && plan.intentos < max_intentos){
+    ++plan.intentos;
+    reservas.limpiar();
+
+    // Al principio cada agente ocupa su punto de partida
+    for(unsigned i = 0; i < agentes.size(); ++i)
+      reservas.reservar(agentes[i].inicio, 0);
+
+    int fallido = -1;
+    for(unsigned k = 0; k < orden.size() && fallido < 0; ++k){
+      int i = orden[k];
+      if(planificar_agente(jardin, agentes[i], heuristicas[i], reservas, vistos,
+                           plan.caminos[i], plan.expandidos))
+        reservar_camino(reservas, plan.caminos[i]);
+      else
+        fallido = k;
+    }
+
+    if(fallido < 0)
+      plan.exito = true;
+    else
+      std::rotate(orden.begin(), orden.begin() + fallido, orden.begin() + fallido + 1);
+  }
+
+  if(plan.exito){
+    for(unsigned i = 0; i < plan.caminos.size(); ++i){
+      int llegada = plan.caminos[i].size() - 1;
+      plan.suma_costes += llegada;
+      plan.makespan = std::max(plan.makespan, llegada);
+    }
+  }
+  plan.tiempo_us = reloj.nsecsElapsed()/1000;
+  return plan;
+}
+
+bool sin_conflictos(const PlanMultiagente& plan){
+  const std::vector<std::vector<Posicion> >& c = plan.caminos;
+  if(!plan.exito)
+    return false;
+  for(unsigned i = 0; i < c.size(); ++i)
+    if(c[i].empty())
+      return false;
+
+  for(int t = 0; t <= plan.makespan; ++t)
+    for(unsigned i = 0; i < c.size(); ++i)
+      for(unsigned j = i + 1; j < c.size(); ++j){
+        Posicion a = c[i][std::min<int>(t, c[i].size() - 1)];
+        Posicion b = c[j][std::min<int>(t, c[j].size() - 1)];
+        if(a == b)
+          return false;
+        if(t > 0){
+          Posicion a0 = c[i][std::min<int>(t - 1, c[i].size() - 1)];
+          Posicion b0 = c[j][std::min<int>(t - 1, c[j].size() - 1)];
+          if(a == b0 && b == a0)
+            return false;
+        }
+      }
+  return true;
+}
+
+std::vector<Agente> agentes_aleatorios(const Jardin& jardin, int cantidad,
+                                       unsigned semilla){
+  Aleatorio azar(semilla);
+  std::vector<int> libres;
+  for(int i = 0; i < jardin.celdas(); ++i){
+    Posicion p = jardin.posicion(i);
+    if(jardin.tipo(p.fila, p.columna) == CESPED_A && jardin.transitable(p.fila, p.columna))
+      libres.push_back(i);
+  }
+
+  // Se barajan las celdas libres y se toman de dos en dos. Los inicios y los
+  // destinos salen así todos distintos.
+  for(int i = libres.size() - 1; i > 0; --i)
+    std::swap(libres[i], libres[azar.entero(i + 1)]);
+
+  std::vector<Agente> agentes;
+  std::vector<int> dist;
+  for(unsigned i = 0; i + 1 < libres.size() && (int)agentes.size() < cantidad; i += 2){
+    Posicion a = jardin.posicion(libres[i]), b = jardin.posicion(libres[i+1]);
+    jardin.distancias(a, dist);
+    if(dist[libres[i+1]] > 0)
+      agentes.push_back(Agente(a, b));
+  }
+  return agentes;
+}
@@ -0,0 +1,371 @@
+#include "planificadores.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "mapabits.h"
+
+int celdas_cesped(const Jardin& jardin){
+  int total = 0;
+  for(int i = 0; i < jardin.celdas(); ++i){
+    Posicion p = jardin.posicion(i);
+    if(jardin.transitable(p.fila, p.columna))
+      ++total;
+  }
+  return total;
+}
+
+int coste_recorrido(const Jardin& jardin, const Posicion& inicio,
+                    const std::vector<Movimientos>& movs){
+  Posicion p = inicio;
+  int coste = 0;
+  for(unsigned i = 0; i < movs.size(); ++i){
+    p = desplazar(p, movs[i]);
+    coste += jardin.coste(p.fila, p.columna);
+  }
+  return coste;
+}
+
+int giros_recorrido(const std::vector<Movimientos>& movs){
+  int giros = 0;
+  for(unsigned i = 1; i < movs.size(); ++i)
+    giros += giros_entre(movs[i-1], movs[i]);
+  return giros;
+}
+
+// Celdas de césped a las que se puede llegar desde "inicio", contando la
+// propia celda de inicio si es césped. Sólo hace falta contarlas, así que se
+// usa el relleno por filas del mapa de bits.
+static int celdas_alcanzables(const Jardin& jardin, const Posicion& inicio){
+  return MapaBits(jardin).alcanzables(inicio);
+}
+
+// Movimiento que lleva de una celda a otra vecina.
+static Movimientos direccion(const Posicion& origen, const Posicion& destino){
+  if(destino.fila < origen.fila)
+    return ARRIBA;
+  if(destino.fila > origen.fila)
+    return ABAJO;
+  return destino.columna < origen.columna? IZQUIERDA : DERECHA;
+}
+
+// Suma a los giros del resultado los del movimiento "mov" tras el anterior,
+// que es -1 antes del primer movimiento.
+static void girar(Resultado& res, int& anterior, Movimientos mov){
+  if(anterior >= 0)
+    res.giros += giros_entre(static_cast<Movimientos>(anterior), mov);
+  anterior = mov;
+}
+
+// Cada elemento de la pila es una celda del camino actual junto con el
+// siguiente movimiento que queda por probar desde ella. Entrar en una celda
+// y volver de ella cuesta un movimiento cada uno, igual que en la versión
+// recursiva.
+Resultado cobertura_profundidad(const Jardin& jardin, const Posicion& inicio){
+  Resultado res;
+  std::vector<bool> cortada(jardin.celdas(), false);
+  std::vector<std::pair<Posicion, int> > pila;
+  int anterior = -1;
+
+  res.cesped = celdas_cesped(jardin);
+  cortada[jardin.indice(inicio.fila, inicio.columna)] = true;
+  pila.push_back(std::make_pair(inicio, 0));
+
+  while(!pila.empty()){
+    Posicion p = pila.back().first;
+    int& k = pila.back().second;
+
+    while(k < 4){
+      Movimientos mov = MOVIMIENTOS[k++];
+      Posicion q = desplazar(p, mov);
+      if(jardin.transitable(q.fila, q.columna) &&
+         !cortada[jardin.indice(q.fila, q.columna)]){
+        cortada[jardin.indice(q.fila, q.columna)] = true;
+        ++res.cortadas;
+        ++res.movimientos;
+        girar(res, anterior, mov);
+        res.coste += jardin.coste(q.fila, q.columna);
+        pila.push_back(std::make_pair(q, 0));
+        break;
+      }
+    }
+
+    // Si no se ha podido avanzar se vuelve a la celda anterior
+    if(pila.back().first == p && pila.back().second >= 4){
+      pila.pop_back();
+      if(!pila.empty()){
+        ++res.movimientos;
+        girar(res, anterior, direccion(p, pila.back().first));
+        res.coste += jardin.coste(pila.back().first.fila, pila.back().first.columna);
+      }
+    }
+  }
+
+  // Si la celda de inicio es césped también se corta al salir de ella
+  if(jardin.transitable(inicio.fila, inicio.columna))
+    ++res.cortadas;
+
+  // La búsqueda en profundidad corta todo lo alcanzable, que es todo el
+  // césped si no hay zonas aisladas
+  res.exito = true;
+  return res;
+}
+
+// Memoria de las búsquedas en anchura que se reutiliza entre búsquedas para no
+// reservarla y limpiarla cada vez. Cada búsqueda usa un sello distinto para
+// distinguir las celdas que ya ha visitado.
+struct MemoriaAnchura {
+  MemoriaAnchura(int celdas): marca(celdas, 0), padre(celdas, -1), sello(0) {}
+
+  std::vector<unsigned> marca;
+  std::vector<int> padre;
+  std::vector<int> cola;
+  unsigned sello;
+};
+
+// Busca el camino más corto desde el origen hasta la celda marcada como
+// objetivo más cercana y añade sus movimientos al final de "movs". El camino
+// puede pasar por "inicio", de donde salió la cortadora, aunque no sea
+// transitable; si no, cuando el inicio separa dos zonas de césped la
+// cortadora se quedaría en una de ellas. Devuelve la celda alcanzada o -1
+// si no hay ninguna alcanzable.
+static int hasta_objetivo(const Jardin& jardin, const Posicion& origen, const Posicion& inicio,
+                          const std::vector<bool>& objetivo, MemoriaAnchura& mem,
+                          std::vector<Movimientos>& movs){
+  if(++mem.sello == 0){
+    std::fill(mem.marca.begin(), mem.marca.end(), 0);
+    mem.sello = 1;
+  }
+
+  int primera = jardin.indice(origen.fila, origen.columna), encontrada = -1;
+  mem.cola.clear();
+  mem.cola.push_back(primera);
+  mem.marca[primera] = mem.sello;
+  mem.padre[primera] = -1;
+
+  for(unsigned i = 0; i < mem.cola.size() && encontrada < 0; ++i){
+    Posicion p = jardin.posicion(mem.cola[i]);
+    for(int k = 0; k < 4; ++k){
+      Posicion q = desplazar(p, MOVIMIENTOS[k]);
+      if(q != inicio && !jardin.transitable(q.fila, q.columna))
+        continue;
+      int c = jardin.indice(q.fila, q.columna);
+      if(mem.marca[c] != mem.sello){
+        mem.marca[c] = mem.sello;
+        mem.padre[c] = mem.cola[i];
+        if(objetivo[c]){
+          encontrada = c;
+          break;
+        }
+        mem.cola.push_back(c);
+      }
+    }
+  }
+  if(encontrada < 0)
+    return -1;
+
+  // El camino se reconstruye desde el final y se da la vuelta
+  unsigned antes = movs.size();
+  for(int c = encontrada; mem.padre[c] >= 0; c = mem.padre[c]){
+    int a = mem.padre[c];
+    if(c == a - jardin.columnas())
+      movs.push_back(ARRIBA);
+    else if(c == a + jardin.columnas())
+      movs.push_back(ABAJO);
+    else if(c == a - 1)
+      movs.push_back(IZQUIERDA);
+    else
+      movs.push_back(DERECHA);
+  }
+  std::reverse(movs.begin()+antes, movs.end());
+  return encontrada;
+}
+
+// Avanza como la búsqueda en profundidad mientras haya césped sin cortar al
+// lado. Al quedarse encerrada, todas las celdas del camino hasta la celda sin
+// cortar más cercana están ya cortadas, así que el salto no corta nada nuevo
+// salvo la celda de llegada. La celda más cercana se busca por frentes sobre
+// el mapa de bits, en el que el inicio también está activo para poder volver
+// a pasar por él.
+Resultado cobertura_saltos(const Jardin& jardin, const Posicion& inicio,
+                           std::vector<Movimientos>* movs){
+  Resultado res;
+  MapaBits libres(jardin), pendientes(jardin);
+  MapaBits::Memoria mem;
+  std::vector<Movimientos> propios, salto;
+  std::vector<Movimientos>& salida = movs? *movs : propios;
+  Posicion p = inicio;
+
+  libres.activar(inicio.fila, inicio.columna);
+  res.cesped = celdas_cesped(jardin);
+  salida.clear();
+  if(pendientes.activa(p.fila, p.columna)){
+    pendientes.activar(p.fila, p.columna, false);
+    ++res.cortadas;
+  }
+
+  for(;;){
+    int k = 0;
+    while(k < 4){
+      Posicion q = desplazar(p, MOVIMIENTOS[k]);
+      if(jardin.transitable(q.fila, q.columna) && pendientes.activa(q.fila, q.columna))
+        break;
+      ++k;
+    }
+
+    if(k < 4){
+      p = desplazar(p, MOVIMIENTOS[k]);
+      salida.push_back(MOVIMIENTOS[k]);
+    }
+    else {
+      if(libres.mas_cercana(p, pendientes, salto, mem) < 0)
+        break;
+      for(unsigned i = 0; i < salto.size(); ++i)
+        p = desplazar(p, salto[i]);
+      salida.insert(salida.end(), salto.begin(), salto.end());
+    }
+    pendientes.activar(p.fila, p.columna, false);
+    ++res.cortadas;
+  }
+
+  res.movimientos = salida.size();
+  res.giros = giros_recorrido(salida);
+  res.coste = coste_recorrido(jardin, inicio, salida);
+  res.exito = res.cortadas == celdas_alcanzables(jardin, inicio);
+  return res;
+}
+
+Resultado acortar_recorrido(const Jardin& jardin, const Posicion& inicio,
+                            const std::vector<Movimientos>& movs,
+                            std::vector<Movimientos>& acortado){
+  Resultado res;
+  std::vector<bool> cortada(jardin.celdas(), false);
+  std::vector<int> orden;
+  Posicion p = inicio;
+
+  res.exito = true;
+  // Orden en el que el recorrido original corta cada celda por primera vez.
+  // El recorrido puede volver a pasar por el inicio, como la búsqueda en
+  // profundidad al deshacer el camino
+  cortada[jardin.indice(p.fila, p.columna)] = true;
+  for(unsigned i = 0; i < movs.size(); ++i){
+    p = desplazar(p, movs[i]);
+    if(p != inicio && !jardin.transitable(p.fila, p.columna))
+      break;
+    int c = jardin.indice(p.fila, p.columna);
+    if(!cortada[c]){
+      cortada[c] = true;
+      orden.push_back(c);
+    }
+  }
+
+  // Se rehace el recorrido yendo de cada celda a la siguiente sin cortar por
+  // el camino más corto
+  std::vector<bool> objetivo(jardin.celdas(), false);
+  MemoriaAnchura mem(jardin.celdas());
+  std::fill(cortada.begin(), cortada.end(), false);
+  p = inicio;
+  cortada[jardin.indice(p.fila, p.columna)] = true;
+  if(jardin.transitable(p.fila, p.columna))
+    ++res.cortadas;
+  acortado.clear();
+
+  for(unsigned i = 0; i < orden.size(); ++i){
+    if(cortada[orden[i]])
+      continue;
+
+    unsigned antes = acortado.size();
+    objetivo[orden[i]] = true;
+    if(hasta_objetivo(jardin, p, inicio, objetivo, mem, acortado) < 0)
+      res.exito = false;
+    objetivo[orden[i]] = false;
+
+    for(unsigned j = antes; j < acortado.size(); ++j){
+      p = desplazar(p, acortado[j]);
+      int c = jardin.indice(p.fila, p.columna);
+      if(!cortada[c]){
+        cortada[c] = true;
+        ++res.cortadas;
+      }
+    }
+  }
+
+  res.cesped = celdas_cesped(jardin);
+  res.movimientos = acortado.size();
+  res.giros = giros_recorrido(acortado);
+  res.coste = coste_recorrido(jardin, inicio, acortado);
+  return res;
+}
+
+// Se reproduce la lógica de Cortadora::reach(): en cada paso se va a la
+// vecina no visitada más cercana en distancia Manhattan al destino y, si no
+// hay ninguna, se deshace el último paso.
+Resultado escalada(const Jardin& jardin, const Posicion& origen,
+                   const Posicion& destino){
+  Resultado res;
+  std::vector<bool> visitada(jardin.celdas(), false);
+  std::vector<int> camino;
+  Posicion p = origen;
+  int anterior = -1;
+
+  res.cesped = celdas_cesped(jardin);
+
+  while(p != destino){
+    int dist[4];
+    int minimo = -1, indice = 0;
+
+    for(int k = 0; k < 4; ++k){
+      Posicion q = desplazar(p, MOVIMIENTOS[k]);
+      dist[k] = -1;
+      if(jardin.transitable(q.fila, q.columna) &&
+         !visitada[jardin.indice(q.fila, q.columna)])
+        dist[k] = std::abs(destino.fila - q.fila) + std::abs(destino.columna - q.columna);
+    }
+    for(int k = 0; k < 4; ++k){
+      if(minimo < 0 || (dist[k] >= 0 && dist[k] < minimo)){
+        minimo = dist[k];
+        indice = k;
+      }
+    }
+
+    if(!visitada[jardin.indice(p.fila, p.columna)]){
+      visitada[jardin.indice(p.fila, p.columna)] = true;
+      if(jardin.transitable(p.fila, p.columna))
+        ++res.cortadas;
+    }
+
+    Movimientos mov;
+    if(dist[indice] == -1){
+      if(camino.empty())
+        return res;
+      mov = opuesto(MOVIMIENTOS[camino.back()]);
+      camino.pop_back();
+    }
+    else {
+      camino.push_back(indice);
+      mov = MOVIMIENTOS[indice];
+    }
+
+    p = desplazar(p, mov);
+    ++res.movimientos;
+    girar(res, anterior, mov);
+    res.coste += jardin.coste(p.fila, p.columna);
+  }
+
+  res.exito = true;
+  return res;
+}
+
+Resultado camino_minimo(const Jardin& jardin, const Posicion& origen,
+                        const Posicion& destino){
+  Resultado res;
+  std::vector<Movimientos> movs;
+
+  res.cesped = celdas_cesped(jardin);
+  res.exito = jardin.camino(origen, destino, movs);
+  res.movimientos = movs.size();
+  res.giros = giros_recorrido(movs);
+  res.coste = coste_recorrido(jardin, origen, movs);
+  res.cortadas = res.exito? movs.size() : 0;
+  return res;
+}
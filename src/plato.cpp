@@ -0,0 +1,248 @@
+#include "plato.h"
+
+#include <algorithm>
+
+bool cabe_plato(const Jardin& jardin, const Posicion& p, const PlatoCorte& plato,
+                const Posicion& inicio){
+  if(p.fila < 0 || p.columna < 0 ||
+     p.fila + plato.filas > jardin.filas() ||
+     p.columna + plato.columnas > jardin.columnas())
+    return false;
+
+  for(int i = p.fila; i < p.fila + plato.filas; ++i)
+    for(int j = p.columna; j < p.columna + plato.columnas; ++j){
+      TipoCelda tipo = jardin.tipo(i, j);
+      if(tipo == OBSTACULO || (tipo == INICIO && p != inicio))
+        return false;
+    }
+  return true;
+}
+
+// Estado de la cobertura con plato. Las posiciones del plato se numeran como
+// las celdas de un jardín de (filas - plato.filas + 1) x (columnas -
+// plato.columnas + 1). Para cada una se lleva la cuenta de las celdas sin
+// cortar que tiene debajo, de forma que saber si merece la pena ir a una
+// posición cuesta lo mismo que consultar un vector.
+class CoberturaPlato {
+public:
+  CoberturaPlato(const Jardin& jardin, const Posicion& inicio, const PlatoCorte& plato,
+                 std::vector<Movimientos>& movs, Resultado& res);
+
+  int cubribles() const { return total_cubribles; }
+  void barrer();
+  void repasar();
+
+private:
+  int indice(int f, int c) const { return f*columnas + c; }
+  Posicion posicion(int a) const { return Posicion(a/columnas, a%columnas); }
+  bool valida(const Posicion& p) const {
+    return p.fila >= 0 && p.columna >= 0 && p.fila < filas && p.columna < columnas &&
+           cabe[indice(p.fila, p.columna)];
+  }
+
+  void cortar();
+  void mover(Movimientos mov);
+  bool buscar(int destino);
+
+  const Jardin& jardin;
+  PlatoCorte plato;
+  std::vector<Movimientos>& movs;
+  Resultado& res;
+
+  int filas, columnas, actual, total_cubribles;
+  std::vector<char> cabe, alcanzable, cortada;
+  std::vector<int> pendientes;
+
+  // Búsqueda en anchura entre posiciones del plato
+  std::vector<unsigned> marca;
+  std::vector<int> llegada, cola;
+  unsigned sello;
+};
+
+CoberturaPlato::CoberturaPlato(const Jardin& jardin, const Posicion& inicio,
+                               const PlatoCorte& plato, std::vector<Movimientos>& movs,
+                               Resultado& res):
+  jardin(jardin), plato(plato), movs(movs), res(res),
+  filas(jardin.filas() - plato.filas + 1), columnas(jardin.columnas() - plato.columnas + 1),
+  actual(indice(inicio.fila, inicio.columna)), total_cubribles(0),
+  cabe(filas*columnas, 0), alcanzable(filas*columnas, 0), cortada(jardin.celdas(), 0),
+  pendientes(filas*columnas, 0), marca(filas*columnas, 0), llegada(filas*columnas, -1),
+  sello(0)
+{
+  for(int a = 0; a < filas*columnas; ++a)
+    cabe[a] = cabe_plato(jardin, posicion(a), plato, inicio);
+
+  // Posiciones a las que se puede llegar desde el inicio
+  cola.push_back(actual);
+  alcanzable[actual] = 1;
+  for(unsigned i = 0; i < cola.size(); ++i){
+    Posicion p = posicion(cola[i]);
+    for(int k = 0; k < 4; ++k){
+      Posicion q = desplazar(p, MOVIMIENTOS[k]);
+      if(valida(q) && !alcanzable[indice(q.fila, q.columna)]){
+        alcanzable[indice(q.fila, q.columna)] = 1;
+        cola.push_back(indice(q.fila, q.columna));
+      }
+    }
+  }
+
+  // Césped sin cortar debajo de cada posición alcanzable y césped que queda
+  // debajo de alguna de ellas
+  std::vector<char> cubierta(jardin.celdas(), 0);
+  for(int a = 0; a < filas*columnas; ++a){
+    if(!alcanzable[a])
+      continue;
+    Posicion p = posicion(a);
+    for(int i = p.fila; i < p.fila + plato.filas; ++i)
+      for(int j = p.columna; j < p.columna + plato.columnas; ++j)
+        if(jardin.transitable(i, j)){
+          ++pendientes[a];
+          cubierta[jardin.indice(i, j)] = 1;
+        }
+  }
+  total_cubribles = std::count(cubierta.begin(), cubierta.end(), 1);
+
+  cortar();
+}
+
+// Corta lo que hay debajo del plato y lo descuenta de todas las posiciones
+// que también lo tienen debajo.
+void CoberturaPlato::cortar(){
+  Posicion p = posicion(actual);
+  for(int i = p.fila; i < p.fila + plato.filas; ++i)
+    for(int j = p.columna; j < p.columna + plato.columnas; ++j){
+      if(!jardin.transitable(i, j) || cortada[jardin.indice(i, j)])
+        continue;
+      cortada[jardin.indice(i, j)] = 1;
+      ++res.cortadas;
+
+      for(int f = std::max(0, i - plato.filas + 1); f <= std::min(i, filas - 1); ++f)
+        for(int c = std::max(0, j - plato.columnas + 1); c <= std::min(j, columnas - 1); ++c)
+          if(alcanzable[indice(f, c)])
+            --pendientes[indice(f, c)];
+    }
+}
+
+void CoberturaPlato::mover(Movimientos mov){
+  Posicion p = desplazar(posicion(actual), mov);
+  actual = indice(p.fila, p.columna);
+  if(!movs.empty())
+    res.giros += giros_entre(movs.back(), mov);
+  movs.push_back(mov);
+  ++res.movimientos;
+  res.coste += jardin.coste(p.fila, p.columna);
+  cortar();
+}
+
+// Camino más corto entre posiciones del plato hasta "destino" o, si destino
+// es negativo, hasta la posición más cercana con algo sin cortar debajo.
+// Devuelve false si no hay ninguna.
+bool CoberturaPlato::buscar(int destino){
+  if(++sello == 0){
+    std::fill(marca.begin(), marca.end(), 0);
+    sello = 1;
+  }
+  cola.clear();
+  cola.push_back(actual);
+  marca[actual] = sello;
+
+  int encontrada = -1;
+  for(unsigned i = 0; i < cola.size() && encontrada < 0; ++i){
+    Posicion p = posicion(cola[i]);
+    for(int k = 0; k < 4; ++k){
+      Posicion q = desplazar(p, MOVIMIENTOS[k]);
+      if(!valida(q))
+        continue;
+      int b = indice(q.fila, q.columna);
+      if(marca[b] == sello)
+        continue;
+      marca[b] = sello;
+      llegada[b] = k;
+      ++res.expandidas;
+      if(b == destino || (destino < 0 && pendientes[b] > 0)){
+        encontrada = b;
+        break;
+      }
+      cola.push_back(b);
+    }
+  }
+  if(encontrada < 0)
+    return false;
+
+  std::vector<Movimientos> camino;
+  for(Posicion p = posicion(encontrada); indice(p.fila, p.columna) != actual; ){
+    Movimientos mov = MOVIMIENTOS[llegada[indice(p.fila, p.columna)]];
+    camino.push_back(mov);
+    p = desplazar(p, opuesto(mov));
+  }
+  for(int i = camino.size() - 1; i >= 0; --i)
+    mover(camino[i]);
+  return true;
+}
+
+// Pasadas horizontales separadas por la altura del plato. La última se
+// ajusta al borde inferior para que el plato quepa. En cada columna se va a
+// la posición de la pasada si todavía tiene algo que cortar debajo o, si no
+// cabe por un obstáculo, a la más próxima por encima o por debajo que sí lo
+// tenga. Si la siguiente posición no está al lado se llega a ella por el
+// camino más corto.
+void CoberturaPlato::barrer(){
+  bool derecha = true;
+  for(int banda = 0; banda < jardin.filas(); banda += plato.filas){
+    int f = std::min(banda, filas - 1);
+    for(int k = 0; k < columnas; ++k){
+      int c = derecha? k : columnas - 1 - k;
+      int a = -1;
+      for(int d = 0; d < plato.filas && a < 0; ++d){
+        if(f + d < filas && alcanzable[indice(f + d, c)] && pendientes[indice(f + d, c)] > 0)
+          a = indice(f + d, c);
+        else if(d > 0 && f - d >= 0 && alcanzable[indice(f - d, c)] &&
+                pendientes[indice(f - d, c)] > 0)
+          a = indice(f - d, c);
+      }
+      if(a < 0)
+        continue;
+
+      Posicion p = posicion(actual), q = posicion(a);
+      bool vecina = false;
+      for(int m = 0; m < 4 && !vecina; ++m)
+        if(desplazar(p, MOVIMIENTOS[m]) == q){
+          mover(MOVIMIENTOS[m]);
+          vecina = true;
+        }
+      if(!vecina)
+        buscar(a);
+    }
+    derecha = !derecha;
+  }
+}
+
+// Lo que queda sin cortar tras las pasadas está pegado a obstáculos o a los
+// bordes. Se va siempre a la posición más cercana desde la que se corta algo.
+void CoberturaPlato::repasar(){
+  while(buscar(-1)) {}
+}
+
+Resultado cobertura_plato(const Jardin& jardin, const Posicion& inicio,
+                          const PlatoCorte& plato, std::vector<Movimientos>* movs,
+                          int* cubribles){
+  Resultado res;
+  std::vector<Movimientos> propios;
+  std::vector<Movimientos>& camino = movs? *movs : propios;
+
+  res.cesped = celdas_cesped(jardin);
+  camino.clear();
+  if(cubribles)
+    *cubribles = 0;
+  if(plato.filas < 1 || plato.columnas < 1 || !cabe_plato(jardin, inicio, plato, inicio))
+    return res;
+
+  CoberturaPlato cobertura(jardin, inicio, plato, camino, res);
+  cobertura.barrer();
+  cobertura.repasar();
+
+  if(cubribles)
+    *cubribles = cobertura.cubribles();
+  res.exito = res.cortadas == cobertura.cubribles();
+  return res;
+}
@@ -0,0 +1,186 @@
+#include "ponderado.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <queue>
+#include <utility>
+
+// Reconstruye el camino hasta el destino a partir del movimiento con el que
+// se llegó a cada celda.
+static void reconstruir(const Jardin& jardin, const Posicion& origen,
+                        const Posicion& destino, const std::vector<int>& llegada,
+                        std::vector<Movimientos>& movs){
+  movs.clear();
+  for(Posicion p = destino; p != origen; ){
+    Movimientos mov = MOVIMIENTOS[llegada[jardin.indice(p.fila, p.columna)]];
+    movs.push_back(mov);
+    p = desplazar(p, opuesto(mov));
+  }
+  std::reverse(movs.begin(), movs.end());
+}
+
+// Rellena el resultado a partir del camino encontrado. Las celdas de césped
+// se cuentan si no se indican.
+static Resultado resultado(const Jardin& jardin, const Posicion& origen,
+                           const Posicion& destino, const std::vector<int>& llegada,
+                           int expandidas, std::vector<Movimientos>* movs,
+                           int cesped = -1){
+  Resultado res;
+  std::vector<Movimientos> propios;
+  std::vector<Movimientos>& camino = movs? *movs : propios;
+
+  res.cesped = cesped >= 0? cesped : celdas_cesped(jardin);
+  res.expandidas = expandidas;
+  camino.clear();
+  if(llegada[jardin.indice(destino.fila, destino.columna)] < 0 && origen != destino)
+    return res;
+
+  reconstruir(jardin, origen, destino, llegada, camino);
+  res.movimientos = res.cortadas = camino.size();
+  res.giros = giros_recorrido(camino);
+  res.coste = coste_recorrido(jardin, origen, camino);
+  res.exito = true;
+  return res;
+}
+
+// En el cubo i%(MAX_COSTE_TERRENO+1) están las celdas a distancia i. Al
+// expandir una celda a distancia d sólo se insertan celdas a distancia entre
+// d+1 y d+MAX_COSTE_TERRENO, que nunca caen en el cubo que se está vaciando.
+// Las entradas que quedan obsoletas al mejorar una distancia se descartan al
+// sacarlas. La búsqueda termina al expandir todas las celdas marcadas como
+// destino y devuelve las celdas expandidas.
+static int expandir_dijkstra(const Jardin& jardin, const Posicion& origen,
+                             std::vector<char>& destino, int destinos,
+                             std::vector<int>& llegada){
+  const int CUBOS = MAX_COSTE_TERRENO + 1;
+  std::vector<std::vector<int> > cubos(CUBOS);
+  std::vector<int> dist(jardin.celdas(), -1);
+  int pendientes = 1, expandidas = 0;
+
+  llegada.assign(jardin.celdas(), -1);
+  dist[jardin.indice(origen.fila, origen.columna)] = 0;
+  cubos[0].push_back(jardin.indice(origen.fila, origen.columna));
+
+  for(int d = 0; pendientes > 0; ++d){
+    std::vector<int>& cubo = cubos[d % CUBOS];
+    while(!cubo.empty()){
+      int c = cubo.back();
+      cubo.pop_back();
+      --pendientes;
+      if(dist[c] != d)
+        continue;
+
+      ++expandidas;
+      if(destino[c]){
+        destino[c] = 0;
+        if(--destinos == 0){
+          pendientes = 0;
+          break;
+        }
+      }
+
+      Posicion p = jardin.posicion(c);
+      for(int k = 0; k < 4; ++k){
+        Posicion q = desplazar(p, MOVIMIENTOS[k]);
+        if(!jardin.transitable(q.fila, q.columna))
+          continue;
+        int v = jardin.indice(q.fila, q.columna);
+        int nd = d + jardin.coste(q.fila, q.columna);
+        if(dist[v] < 0 || nd < dist[v]){
+          dist[v] = nd;
+          llegada[v] = k;
+          cubos[nd % CUBOS].push_back(v);
+          ++pendientes;
+        }
+      }
+    }
+  }
+
+  return expandidas;
+}
+
+Resultado dijkstra(const Jardin& jardin, const Posicion& origen,
+                   const Posicion& destino, std::vector<Movimientos>* movs){
+  std::vector<char> marcado(jardin.celdas(), 0);
+  std::vector<int> llegada;
+
+  marcado[jardin.indice(destino.fila, destino.columna)] = 1;
+  int expandidas = expandir_dijkstra(jardin, origen, marcado, 1, llegada);
+  return resultado(jardin, origen, destino, llegada, expandidas, movs);
+}
+
+// Todos los resultados llevan las celdas expandidas por la búsqueda común.
+void dijkstra_destinos(const Jardin& jardin, const Posicion& origen,
+                       const std::vector<Posicion>& destinos,
+                       std::vector<Resultado>& resultados,
+                       std::vector<std::vector<Movimientos> >* movs){
+  std::vector<char> marcado(jardin.celdas(), 0);
+  std::vector<int> llegada;
+  int distintos = 0;
+
+  for(unsigned i = 0; i < destinos.size(); ++i){
+    char& m = marcado[jardin.indice(destinos[i].fila, destinos[i].columna)];
+    if(!m){
+      m = 1;
+      ++distintos;
+    }
+  }
+
+  int expandidas = distintos > 0? expandir_dijkstra(jardin, origen, marcado, distintos, llegada) : 0;
+  int cesped = celdas_cesped(jardin);
+  resultados.resize(destinos.size());
+  if(movs)
+    movs->resize(destinos.size());
+  for(unsigned i = 0; i < destinos.size(); ++i)
+    resultados[i] = resultado(jardin, origen, destinos[i], llegada, expandidas,
+                              movs? &(*movs)[i] : NULL, cesped);
+}
+
+// Cola de prioridad clásica ordenada por g + peso*h. La heurística es la
+// distancia Manhattan, que nunca sobreestima porque ningún movimiento cuesta
+// menos de 1. Las celdas ya cerradas no se vuelven a abrir aunque se
+// encuentre un camino mejor hasta ellas, lo que mantiene la cota del peso.
+Resultado a_estrella_ponderado(const Jardin& jardin, const Posicion& origen,
+                               const Posicion& destino, double peso,
+                               std::vector<Movimientos>* movs){
+  typedef std::pair<double, int> Entrada;
+  std::priority_queue<Entrada, std::vector<Entrada>, std::greater<Entrada> > abiertos;
+  std::vector<int> g(jardin.celdas(), -1), llegada(jardin.celdas(), -1);
+  std::vector<bool> cerrada(jardin.celdas(), false);
+  int fin = jardin.indice(destino.fila, destino.columna);
+  int expandidas = 0;
+
+  int inicio = jardin.indice(origen.fila, origen.columna);
+  g[inicio] = 0;
+  abiertos.push(Entrada(peso*(std::abs(destino.fila - origen.fila) +
+                              std::abs(destino.columna - origen.columna)), inicio));
+
+  while(!abiertos.empty()){
+    int c = abiertos.top().second;
+    abiertos.pop();
+    if(cerrada[c])
+      continue;
+    cerrada[c] = true;
+    ++expandidas;
+    if(c == fin)
+      break;
+
+    Posicion p = jardin.posicion(c);
+    for(int k = 0; k < 4; ++k){
+      Posicion q = desplazar(p, MOVIMIENTOS[k]);
+      if(!jardin.transitable(q.fila, q.columna))
+        continue;
+      int v = jardin.indice(q.fila, q.columna);
+      int ng = g[c] + jardin.coste(q.fila, q.columna);
+      if(!cerrada[v] && (g[v] < 0 || ng < g[v])){
+        g[v] = ng;
+        llegada[v] = k;
+        abiertos.push(Entrada(ng + peso*(std::abs(destino.fila - q.fila) +
+                                         std::abs(destino.columna - q.columna)), v));
+      }
+    }
+  }
+
+  return resultado(jardin, origen, destino, llegada, expandidas, movs);
+}
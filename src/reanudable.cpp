@@ -0,0 +1,236 @@
+#include "reanudable.h"
+
+#include <algorithm>
+
+#include <QFile>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "archivo.h"
+
+// Cabecera del estado guardado: identificador, versión del formato, huella
+// del jardín, dimensiones, inicio, contadores del resultado, último
+// movimiento y niveles de la pila, todo como enteros de 4 bytes en little
+// endian.
+static const int ESTADO_COBERTURA = 0x54504B43; // "CKPT"
+static const int VERSION_ESTADO = 2;
+static const int ENTEROS_CABECERA = 16;
+
+CoberturaReanudable::CoberturaReanudable(const Jardin& jardin, const Posicion& inicio):
+  jardin(jardin), inicio(inicio), actual(inicio), cortadas(jardin.celdas(), 0), anterior(-1)
+{
+  res.cesped = celdas_cesped(jardin);
+  if(!jardin.dentro(inicio.fila, inicio.columna))
+    return;
+
+  Nivel primero = {inicio, -1, 0};
+  cortadas[jardin.indice(inicio.fila, inicio.columna)] = 1;
+  pila.push_back(primero);
+}
+
+// Cada vuelta del bucle es una vuelta del bucle de cobertura_profundidad():
+// o se entra en una celda nueva o se vuelve a la anterior.
+int CoberturaReanudable::avanzar(int pasos, std::vector<Movimientos>* movs){
+  int hechos = 0;
+
+  while(hechos < pasos && !pila.empty()){
+    Nivel& nivel = pila.back();
+    int llegada = -1;
+
+    while(nivel.siguiente < 4 && llegada < 0){
+      Movimientos mov = MOVIMIENTOS[nivel.siguiente++];
+      Posicion q = desplazar(nivel.pos, mov);
+      if(jardin.transitable(q.fila, q.columna) && !cortadas[jardin.indice(q.fila, q.columna)])
+        llegada = mov;
+    }
+
+    if(llegada >= 0){
+      Nivel hijo = {desplazar(nivel.pos, MOVIMIENTOS[llegada]), llegada, 0};
+      cortadas[jardin.indice(hijo.pos.fila, hijo.pos.columna)] = 1;
+      ++res.cortadas;
+      ++res.movimientos;
+      girar(MOVIMIENTOS[llegada]);
+      res.coste += jardin.coste(hijo.pos.fila, hijo.pos.columna);
+      pila.push_back(hijo);
+      actual = hijo.pos;
+      if(movs) movs->push_back(MOVIMIENTOS[llegada]);
+      ++hechos;
+      continue;
+    }
+
+    // Si no se ha podido avanzar se vuelve a la celda anterior
+    Movimientos vuelta = opuesto(MOVIMIENTOS[std::max(nivel.llegada, 0)]);
+    pila.pop_back();
+    if(!pila.empty()){
+      actual = pila.back().pos;
+      ++res.movimientos;
+      girar(vuelta);
+      res.coste += jardin.coste(actual.fila, actual.columna);
+      if(movs) movs->push_back(vuelta);
+      ++hechos;
+    }
+    else {
+      // Si la celda de inicio es césped también se corta al salir de ella
+      if(jardin.transitable(inicio.fila, inicio.columna))
+        ++res.cortadas;
+      res.exito = true;
+    }
+  }
+
+  return hechos;
+}
+
+// Suma a los giros del resultado los del movimiento "mov" tras el anterior.
+void CoberturaReanudable::girar(Movimientos mov){
+  if(anterior >= 0)
+    res.giros += giros_entre(static_cast<Movimientos>(anterior), mov);
+  anterior = mov;
+}
+
+// Las celdas de la pila son siempre vecinas, así que de cada nivel basta con
+// guardar con qué movimiento se llegó y el siguiente que queda por probar:
+// caben los dos en un byte.
+QByteArray CoberturaReanudable::guardar() const {
+  int bits = (jardin.celdas() + 7)/8;
+  QByteArray estado(ENTEROS_CABECERA*ENTERO + bits +
+                    (pila.empty()? 0 : 2*ENTERO + pila.size()), 0);
+  int pos = 0;
+
+  escribir_entero(estado, pos, ESTADO_COBERTURA);
+  escribir_entero(estado, pos, VERSION_ESTADO);
+  escribir_entero(estado, pos, static_cast<int>(jardin.huella()));
+  escribir_entero(estado, pos, jardin.filas());
+  escribir_entero(estado, pos, jardin.columnas());
+  escribir_entero(estado, pos, inicio.fila);
+  escribir_entero(estado, pos, inicio.columna);
+  escribir_entero(estado, pos, res.movimientos);
+  escribir_entero(estado, pos, res.giros);
+  escribir_entero(estado, pos, anterior);
+  escribir_entero(estado, pos, res.coste);
+  escribir_entero(estado, pos, res.cortadas);
+  escribir_entero(estado, pos, res.cesped);
+  escribir_entero(estado, pos, res.expandidas);
+  escribir_entero(estado, pos, res.exito);
+  escribir_entero(estado, pos, pila.size());
+
+  char* datos = estado.data();
+  for(int i = 0; i < jardin.celdas(); ++i)
+    if(cortadas[i])
+      datos[pos + i/8] |= static_cast<char>(1 << (i%8));
+  pos += bits;
+
+  if(!pila.empty()){
+    escribir_entero(estado, pos, pila[0].pos.fila);
+    escribir_entero(estado, pos, pila[0].pos.columna);
+    for(unsigned i = 0; i < pila.size(); ++i)
+      datos[pos++] = static_cast<char>(std::max(pila[i].llegada, 0) | (pila[i].siguiente << 2));
+  }
+
+  return estado;
+}
+
+bool CoberturaReanudable::cargar(const QByteArray& estado){
+  int pos = 0;
+  if(estado.size() < ENTEROS_CABECERA*ENTERO ||
+     leer_entero(estado, pos) != ESTADO_COBERTURA ||
+     leer_entero(estado, pos) != VERSION_ESTADO ||
+     static_cast<unsigned>(leer_entero(estado, pos)) != jardin.huella() ||
+     leer_entero(estado, pos) != jardin.filas() ||
+     leer_entero(estado, pos) != jardin.columnas() ||
+     leer_entero(estado, pos) != inicio.fila ||
+     leer_entero(estado, pos) != inicio.columna)
+    return false;
+
+  Resultado leido;
+  leido.movimientos = leer_entero(estado, pos);
+  leido.giros = leer_entero(estado, pos);
+  int ultimo = leer_entero(estado, pos);
+  leido.coste = leer_entero(estado, pos);
+  leido.cortadas = leer_entero(estado, pos);
+  leido.cesped = leer_entero(estado, pos);
+  leido.expandidas = leer_entero(estado, pos);
+  leido.exito = leer_entero(estado, pos) != 0;
+  int niveles = leer_entero(estado, pos);
+
+  int bits = (jardin.celdas() + 7)/8;
+  if(niveles < 0 || niveles > jardin.celdas() || ultimo < -1 || ultimo > 3 ||
+     estado.size() != pos + bits + (niveles > 0? 2*ENTERO + niveles : 0))
+    return false;
+
+  std::vector<char> leidas(jardin.celdas(), 0);
+  const char* datos = estado.constData();
+  for(int i = 0; i < jardin.celdas(); ++i)
+    leidas[i] = (datos[pos + i/8] >> (i%8)) & 1;
+  pos += bits;
+
+  // Cada nivel tiene que ser una celda cortada vecina de la anterior
+  std::vector<Nivel> leida(niveles);
+  if(niveles > 0){
+    Posicion p;
+    p.fila = leer_entero(estado, pos);
+    p.columna = leer_entero(estado, pos);
+    if(p != inicio)
+      return false;
+    for(int i = 0; i < niveles; ++i){
+      int byte = static_cast<unsigned char>(datos[pos++]);
+      leida[i].llegada = i > 0? (byte & 3) : -1;
+      leida[i].siguiente = byte >> 2;
+      if(i > 0)
+        p = desplazar(p, MOVIMIENTOS[leida[i].llegada]);
+      leida[i].pos = p;
+      if(leida[i].siguiente > 4 || !jardin.dentro(p.fila, p.columna) ||
+         !leidas[jardin.indice(p.fila, p.columna)] ||
+         (i > 0 && !jardin.transitable(p.fila, p.columna)))
+        return false;
+    }
+  }
+
+  res = leido;
+  anterior = ultimo;
+  cortadas.swap(leidas);
+  pila.swap(leida);
+  actual = pila.empty()? inicio : pila.back().pos;
+  return true;
+}
+
+// Obliga al sistema a llevar al disco lo escrito en el fichero. flush() sólo
+// vacía el buffer de Qt y, si el equipo se apaga, el fichero renombrado podría
+// quedar vacío.
+static bool sincronizar(QFile& f){
+#ifdef Q_OS_WIN
+  return _commit(f.handle()) == 0;
+#else
+  return fsync(f.handle()) == 0;
+#endif
+}
+
+bool guardar_punto_control(const QString& fichero, const QByteArray& estado){
+  QString temporal = fichero + ".tmp";
+  QFile f(temporal);
+
+  if(!f.open(QIODevice::WriteOnly))
+    return false;
+  if(f.write(estado) != estado.size() || !f.flush() || !sincronizar(f)){
+    f.close();
+    QFile::remove(temporal);
+    return false;
+  }
+  f.close();
+
+  QFile::remove(fichero);
+  return QFile::rename(temporal, fichero);
+}
+
+// Si el programa se interrumpió justo entre borrar el punto de control
+// anterior y renombrar el nuevo, sólo queda el temporal, que está completo.
+bool leer_punto_control(const QString& fichero, QByteArray& estado){
+  QFile f(QFile::exists(fichero)? fichero : fichero + ".tmp");
+  if(!f.open(QIODevice::ReadOnly))
+    return false;
+  estado = f.readAll();
+  return true;
+}
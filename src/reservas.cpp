@@ -0,0 +1,87 @@
+#include "reservas.h"
+
+#include <climits>
+
+TablaReservas::TablaReservas(const Jardin& jardin):
+  columnas(jardin.columnas()), vertices(jardin.celdas()),
+  aristas(jardin.celdas()), permanentes(jardin.celdas(), INT_MAX),
+  tocada(jardin.celdas(), false)
+{
+}
+
+void TablaReservas::limpiar(){
+  for(unsigned i = 0; i < tocadas.size(); ++i){
+    vertices[tocadas[i]].clear();
+    aristas[tocadas[i]].clear();
+    permanentes[tocadas[i]] = INT_MAX;
+    tocada[tocadas[i]] = false;
+  }
+  tocadas.clear();
+}
+
+void TablaReservas::tocar(int c){
+  if(!tocada[c]){
+    tocada[c] = true;
+    tocadas.push_back(c);
+  }
+}
+
+void TablaReservas::reservar(const Posicion& p, int instante){
+  int c = celda(p);
+  tocar(c);
+  vertices[c].push_back(instante);
+}
+
+// Las aristas se guardan en la celda de salida junto con el instante y la
+// celda de llegada.
+void TablaReservas::reservar_paso(const Posicion& desde, const Posicion& hasta,
+                                  int instante){
+  int c = celda(desde);
+  tocar(c);
+  aristas[c].push_back(std::make_pair(instante, celda(hasta)));
+  reservar(hasta, instante+1);
+}
+
+void TablaReservas::reservar_desde(const Posicion& p, int instante){
+  int c = celda(p);
+  tocar(c);
+  if(instante < permanentes[c])
+    permanentes[c] = instante;
+}
+
+bool TablaReservas::libre(const Posicion& p, int instante) const {
+  int c = celda(p);
+  if(permanentes[c] <= instante)
+    return false;
+
+  const std::vector<int>& v = vertices[c];
+  for(unsigned i = 0; i < v.size(); ++i)
+    if(v[i] == instante)
+      return false;
+  return true;
+}
+
+bool TablaReservas::libre_desde(const Posicion& p, int instante) const {
+  int c = celda(p);
+  if(permanentes[c] != INT_MAX)
+    return false;
+
+  const std::vector<int>& v = vertices[c];
+  for(unsigned i = 0; i < v.size(); ++i)
+    if(v[i] >= instante)
+      return false;
+  return true;
+}
+
+bool TablaReservas::paso_libre(const Posicion& desde, const Posicion& hasta,
+                               int instante) const {
+  if(!libre(hasta, instante+1))
+    return false;
+
+  // Nadie puede estar yendo de "hasta" a "desde" a la vez
+  const std::vector<std::pair<int, int> >& a = aristas[celda(hasta)];
+  for(unsigned i = 0; i < a.size(); ++i)
+    if(a[i].first == instante && a[i].second == celda(desde))
+      return false;
+  return true;
+}
@@ -0,0 +1,179 @@
+#include "ruta.h"
+
+#include <algorithm>
+
+#include <QtConcurrentMap>
+
+// Longitud máxima de los tramos que Or-opt intenta cambiar de sitio.
+static const int MAX_TRAMO_OR_OPT = 3;
+
+// Cada tarea calcula una fila de la matriz de distancias.
+struct TareaDistancias {
+  const Jardin* jardin;
+  const std::vector<Posicion>* puntos;
+  int origen;
+  std::vector<int>* fila;
+};
+
+static void calcular_fila(TareaDistancias& tarea){
+  std::vector<int> dist;
+  const std::vector<Posicion>& puntos = *tarea.puntos;
+
+  tarea.jardin->distancias(puntos[tarea.origen], dist);
+  for(unsigned j = 0; j < puntos.size(); ++j)
+    (*tarea.fila)[j] = dist[tarea.jardin->indice(puntos[j].fila, puntos[j].columna)];
+}
+
+void matriz_distancias(const Jardin& jardin, const std::vector<Posicion>& puntos,
+                       std::vector<std::vector<int> >& matriz){
+  matriz.assign(puntos.size(), std::vector<int>(puntos.size(), -1));
+
+  std::vector<TareaDistancias> tareas(puntos.size());
+  for(unsigned i = 0; i < puntos.size(); ++i){
+    tareas[i].jardin = &jardin;
+    tareas[i].puntos = &puntos;
+    tareas[i].origen = i;
+    tareas[i].fila = &matriz[i];
+  }
+  QtConcurrent::blockingMap(tareas, calcular_fila);
+}
+
+int longitud_ruta(const std::vector<std::vector<int> >& matriz,
+                  const std::vector<int>& orden){
+  int total = 0;
+  for(unsigned i = 1; i < orden.size(); ++i)
+    total += matriz[orden[i-1]][orden[i]];
+  return total;
+}
+
+// Distancia entre dos posiciones de la ruta. Como la ruta no vuelve al
+// origen, ir hacia "después del final" no cuesta nada.
+static int coste(const std::vector<std::vector<int> >& matriz,
+                 const std::vector<int>& orden, int i, int j){
+  if(i < 0 || j >= (int) orden.size())
+    return 0;
+  return matriz[orden[i]][orden[j]];
+}
+
+// Da la vuelta a un tramo de la ruta si así se acorta. Devuelve true si ha
+// encontrado alguna mejora.
+static bool dos_opt(const std::vector<std::vector<int> >& matriz,
+                    std::vector<int>& orden){
+  bool mejorado = false;
+  int n = orden.size();
+
+  for(int i = 1; i < n-1; ++i){
+    for(int j = i+1; j < n; ++j){
+      int antes = coste(matriz, orden, i-1, i) + coste(matriz, orden, j, j+1);
+      int despues = matriz[orden[i-1]][orden[j]] +
+                    (j+1 < n? matriz[orden[i]][orden[j+1]] : 0);
+      if(despues < antes){
+        std::reverse(orden.begin()+i, orden.begin()+j+1);
+        mejorado = true;
+      }
+    }
+  }
+  return mejorado;
+}
+
+// Saca tramos cortos de la ruta y los vuelve a insertar, en cualquiera de los
+// dos sentidos, en el hueco donde menos alargan la ruta. Devuelve true si ha
+// encontrado alguna mejora.
+static bool or_opt(const std::vector<std::vector<int> >& matriz,
+                   std::vector<int>& orden){
+  bool mejorado = false;
+
+  for(int tam = 1; tam <= MAX_TRAMO_OR_OPT; ++tam){
+    for(int i = 1; i+tam <= (int) orden.size(); ++i){
+      int n = orden.size();
+      int fin = i+tam-1;
+      int primero = orden[i], ultimo = orden[fin];
+
+      // Lo que se ahorra quitando el tramo de donde está
+      int ahorro = matriz[orden[i-1]][primero] + coste(matriz, orden, fin, fin+1) -
+                   (fin+1 < n? matriz[orden[i-1]][orden[fin+1]] : 0);
+
+      int mejor = 0, hueco = -1;
+      bool invertir = false;
+      for(int k = 0; k < n; ++k){
+        // El hueco es el que hay entre las posiciones k y k+1 y no puede
+        // tocar el propio tramo
+        if(k >= i-1 && k <= fin)
+          continue;
+        int siguiente = k+1 < n? matriz[orden[k]][orden[k+1]] : 0;
+        int directo = matriz[orden[k]][primero] +
+                      (k+1 < n? matriz[ultimo][orden[k+1]] : 0) - siguiente;
+        int inverso = matriz[orden[k]][ultimo] +
+                      (k+1 < n? matriz[primero][orden[k+1]] : 0) - siguiente;
+        if(ahorro - directo > mejor){
+          mejor = ahorro - directo;
+          hueco = k;
+          invertir = false;
+        }
+        if(ahorro - inverso > mejor){
+          mejor = ahorro - inverso;
+          hueco = k;
+          invertir = true;
+        }
+      }
+
+      if(hueco >= 0){
+        std::vector<int> tramo(orden.begin()+i, orden.begin()+fin+1);
+        if(invertir)
+          std::reverse(tramo.begin(), tramo.end());
+        orden.erase(orden.begin()+i, orden.begin()+fin+1);
+        if(hueco > fin)
+          hueco -= tam;
+        orden.insert(orden.begin()+hueco+1, tramo.begin(), tramo.end());
+        mejorado = true;
+      }
+    }
+  }
+  return mejorado;
+}
+
+std::vector<int> ordenar_ruta(const std::vector<std::vector<int> >& matriz,
+                              int* inicial){
+  std::vector<int> orden;
+  if(matriz.empty())
+    return orden;
+
+  // Ruta inicial: desde cada punto se va al más cercano que quede por visitar
+  std::vector<bool> visitado(matriz.size(), false);
+  orden.push_back(0);
+  visitado[0] = true;
+  for(;;){
+    int actual = orden.back(), siguiente = -1;
+    for(unsigned j = 0; j < matriz.size(); ++j){
+      if(!visitado[j] && matriz[actual][j] >= 0 &&
+         (siguiente < 0 || matriz[actual][j] < matriz[actual][siguiente]))
+        siguiente = j;
+    }
+    if(siguiente < 0)
+      break;
+    orden.push_back(siguiente);
+    visitado[siguiente] = true;
+  }
+
+  if(inicial)
+    *inicial = longitud_ruta(matriz, orden);
+
+  // Se alternan ambas mejoras hasta que la ruta no se acorta más
+  bool mejorado = true;
+  while(mejorado){
+    mejorado = dos_opt(matriz, orden);
+    mejorado = or_opt(matriz, orden) || mejorado;
+  }
+  return orden;
+}
+
+void movimientos_ruta(const Jardin& jardin, const std::vector<Posicion>& puntos,
+                      const std::vector<int>& orden, std::vector<Movimientos>& movs){
+  std::vector<Movimientos> tramo;
+  movs.clear();
+
+  for(unsigned i = 1; i < orden.size(); ++i){
+    jardin.camino(puntos[orden[i-1]], puntos[orden[i]], tramo);
+    movs.insert(movs.end(), tramo.begin(), tramo.end());
+  }
+}
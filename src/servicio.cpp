@@ -0,0 +1,411 @@
+#include "servicio.h"
+
+#include <algorithm>
+
+#include <QFile>
+#include <QFileInfo>
+
+#include "archivo.h"
+#include "ponderado.h"
+
+// Enteros fijos de la petición: identificador, operación, origen, destino y
+// fuente del jardín. Detrás va la huella o el contenido.
+static const int ENTEROS_PETICION = 7;
+
+// Enteros fijos de la respuesta: identificador, operación, estado y huella.
+// Detrás van el resultado y los movimientos, o las medidas del servicio.
+static const int ENTEROS_RESPUESTA = 4;
+static const int ENTEROS_RESULTADO = 7;
+static const int ENTEROS_MEDIDAS = 6;
+
+// Respuestas que se tienen en cuenta en las medidas y segundos de la ventana.
+static const int MUESTRAS = 16384;
+static const qint64 VENTANA_NS = 10LL*1000*1000*1000;
+
+QByteArray codificar_peticion(const PeticionPlan& peticion){
+  bool huella = peticion.fuente == JARDIN_HUELLA;
+  QByteArray mensaje((ENTEROS_PETICION + (huella? 1 : 0))*ENTERO, 0);
+  int pos = 0;
+
+  escribir_entero(mensaje, pos, peticion.id);
+  escribir_entero(mensaje, pos, peticion.operacion);
+  escribir_entero(mensaje, pos, peticion.origen.fila);
+  escribir_entero(mensaje, pos, peticion.origen.columna);
+  escribir_entero(mensaje, pos, peticion.destino.fila);
+  escribir_entero(mensaje, pos, peticion.destino.columna);
+  escribir_entero(mensaje, pos, peticion.fuente);
+  if(huella)
+    escribir_entero(mensaje, pos, static_cast<int>(peticion.huella));
+  else
+    mensaje += peticion.jardin;
+  return mensaje;
+}
+
+bool decodificar_peticion(const QByteArray& mensaje, PeticionPlan& peticion){
+  int pos = 0;
+  if(mensaje.size() < ENTEROS_PETICION*ENTERO)
+    return false;
+
+  PeticionPlan leida;
+  leida.id = leer_entero(mensaje, pos);
+  int operacion = leer_entero(mensaje, pos);
+  leida.origen.fila = leer_entero(mensaje, pos);
+  leida.origen.columna = leer_entero(mensaje, pos);
+  leida.destino.fila = leer_entero(mensaje, pos);
+  leida.destino.columna = leer_entero(mensaje, pos);
+  int fuente = leer_entero(mensaje, pos);
+  if(operacion < 0 || operacion >= NUM_OPERACIONES_PLAN ||
+     fuente < 0 || fuente >= NUM_FUENTES_JARDIN)
+    return false;
+  leida.operacion = static_cast<OperacionPlan>(operacion);
+  leida.fuente = static_cast<FuenteJardin>(fuente);
+
+  if(leida.fuente == JARDIN_HUELLA){
+    if(mensaje.size() != pos + ENTERO)
+      return false;
+    leida.huella = static_cast<unsigned>(leer_entero(mensaje, pos));
+  }
+  else
+    leida.jardin = mensaje.mid(pos);
+
+  peticion = leida;
+  return true;
+}
+
+QByteArray codificar_respuesta(const RespuestaPlan& respuesta){
+  int enteros = ENTEROS_RESPUESTA, bytes = 0;
+  if(respuesta.estado == PLAN_HECHO){
+    if(respuesta.operacion == PLAN_ESTADISTICAS)
+      enteros += ENTEROS_MEDIDAS;
+    else {
+      enteros += ENTEROS_RESULTADO;
+      bytes = (respuesta.movs.size() + 3)/4;
+    }
+  }
+
+  QByteArray mensaje(enteros*ENTERO + bytes, 0);
+  int pos = 0;
+  escribir_entero(mensaje, pos, respuesta.id);
+  escribir_entero(mensaje, pos, respuesta.operacion);
+  escribir_entero(mensaje, pos, respuesta.estado);
+  escribir_entero(mensaje, pos, static_cast<int>(respuesta.huella));
+  if(respuesta.estado != PLAN_HECHO)
+    return mensaje;
+
+  if(respuesta.operacion == PLAN_ESTADISTICAS){
+    const MedidasServicio& m = respuesta.medidas;
+    escribir_entero(mensaje, pos, m.atendidas);
+    escribir_entero(mensaje, pos, m.en_cola);
+    escribir_entero(mensaje, pos, m.jardines);
+    escribir_entero(mensaje, pos, qRound(m.p50_us));
+    escribir_entero(mensaje, pos, qRound(m.p99_us));
+    escribir_entero(mensaje, pos, qRound(m.por_segundo));
+    return mensaje;
+  }
+
+  const Resultado& res = respuesta.resultado;
+  escribir_entero(mensaje, pos, res.movimientos);
+  escribir_entero(mensaje, pos, res.coste);
+  escribir_entero(mensaje, pos, res.cortadas);
+  escribir_entero(mensaje, pos, res.cesped);
+  escribir_entero(mensaje, pos, res.expandidas);
+  escribir_entero(mensaje, pos, res.exito);
+  escribir_entero(mensaje, pos, respuesta.movs.size());
+
+  char* datos = mensaje.data();
+  for(unsigned i = 0; i < respuesta.movs.size(); ++i)
+    datos[pos + i/4] |= static_cast<char>(respuesta.movs[i] << (2*(i%4)));
+  return mensaje;
+}
+
+bool decodificar_respuesta(const QByteArray& mensaje, RespuestaPlan& respuesta){
+  int pos = 0;
+  if(mensaje.size() < ENTEROS_RESPUESTA*ENTERO)
+    return false;
+
+  RespuestaPlan leida;
+  leida.id = leer_entero(mensaje, pos);
+  int operacion = leer_entero(mensaje, pos);
+  int estado = leer_entero(mensaje, pos);
+  leida.huella = static_cast<unsigned>(leer_entero(mensaje, pos));
+  if(operacion < 0 || operacion >= NUM_OPERACIONES_PLAN ||
+     estado < PLAN_HECHO || estado > PLAN_MAL_FORMADA)
+    return false;
+  leida.operacion = static_cast<OperacionPlan>(operacion);
+  leida.estado = static_cast<EstadoPlan>(estado);
+
+  if(leida.estado != PLAN_HECHO){
+    respuesta = leida;
+    return mensaje.size() == pos;
+  }
+
+  if(leida.operacion == PLAN_ESTADISTICAS){
+    if(mensaje.size() != pos + ENTEROS_MEDIDAS*ENTERO)
+      return false;
+    MedidasServicio& m = leida.medidas;
+    m.atendidas = leer_entero(mensaje, pos);
+    m.en_cola = leer_entero(mensaje, pos);
+    m.jardines = leer_entero(mensaje, pos);
+    m.p50_us = leer_entero(mensaje, pos);
+    m.p99_us = leer_entero(mensaje, pos);
+    m.por_segundo = leer_entero(mensaje, pos);
+    respuesta = leida;
+    return true;
+  }
+
+  if(mensaje.size() < pos + ENTEROS_RESULTADO*ENTERO)
+    return false;
+  Resultado& res = leida.resultado;
+  res.movimientos = leer_entero(mensaje, pos);
+  res.coste = leer_entero(mensaje, pos);
+  res.cortadas = leer_entero(mensaje, pos);
+  res.cesped = leer_entero(mensaje, pos);
+  res.expandidas = leer_entero(mensaje, pos);
+  res.exito = leer_entero(mensaje, pos) != 0;
+  int movs = leer_entero(mensaje, pos);
+  if(movs < 0 || mensaje.size() != pos + (movs + 3)/4)
+    return false;
+
+  const char* datos = mensaje.constData();
+  leida.movs.resize(movs);
+  for(int i = 0; i < movs; ++i)
+    leida.movs[i] = static_cast<Movimientos>((datos[pos + i/4] >> (2*(i%4))) & 3);
+  respuesta = leida;
+  return true;
+}
+
+QByteArray enmarcar(const QByteArray& mensaje){
+  QByteArray marco(ENTERO, 0);
+  int pos = 0;
+  escribir_entero(marco, pos, mensaje.size());
+  return marco + mensaje;
+}
+
+int extraer_mensaje(QByteArray& buffer, QByteArray& mensaje){
+  int pos = 0;
+  if(buffer.size() < ENTERO)
+    return 0;
+  int longitud = leer_entero(buffer, pos);
+  if(longitud < 0 || longitud > MAX_MENSAJE)
+    return -1;
+  if(buffer.size() < ENTERO + longitud)
+    return 0;
+
+  mensaje = buffer.mid(ENTERO, longitud);
+  buffer.remove(0, ENTERO + longitud);
+  return 1;
+}
+
+CacheJardines::CacheJardines(int capacidad): capacidad(std::max(capacidad, 1)), usos(0) {}
+
+QSharedPointer<const Jardin> CacheJardines::jardin(const PeticionPlan& peticion, unsigned& huella){
+  DatosJardin datos;
+
+  switch(peticion.fuente){
+  case JARDIN_HUELLA:
+    huella = peticion.huella;
+    return buscar(huella);
+
+  case JARDIN_DATOS:
+    if(!decodificar_jardin(peticion.jardin, datos))
+      return QSharedPointer<const Jardin>();
+    return anadir(datos.jardin, huella);
+
+  case JARDIN_FICHERO: {
+    QString ruta = QString::fromUtf8(peticion.jardin.constData(), peticion.jardin.size());
+    QFileInfo info(ruta);
+    qint64 modificado = info.lastModified().toMSecsSinceEpoch();
+
+    std::map<QString, Fichero>::iterator f = ficheros.find(ruta);
+    if(f != ficheros.end() && f->second.modificado == modificado &&
+       f->second.tamano == info.size()){
+      huella = f->second.huella;
+      QSharedPointer<const Jardin> encontrado = buscar(huella);
+      if(!encontrado.isNull() && encontrado == f->second.jardin.toStrongRef())
+        return encontrado;
+    }
+
+    QFile fichero(ruta);
+    if(!fichero.open(QIODevice::ReadOnly) || !decodificar_jardin(fichero.readAll(), datos))
+      return QSharedPointer<const Jardin>();
+
+    QSharedPointer<const Jardin> leido = anadir(datos.jardin, huella);
+    Fichero nuevo = {huella, modificado, info.size(), leido};
+    ficheros[ruta] = nuevo;
+    return leido;
+  }
+
+  default:
+    return QSharedPointer<const Jardin>();
+  }
+}
+
+QSharedPointer<const Jardin> CacheJardines::buscar(unsigned huella){
+  std::map<unsigned, Entrada>::iterator e = entradas.find(huella);
+  if(e == entradas.end())
+    return QSharedPointer<const Jardin>();
+  e->second.uso = ++usos;
+  return e->second.jardin;
+}
+
+QSharedPointer<const Jardin> CacheJardines::anadir(const Jardin& jardin, unsigned& huella){
+  huella = jardin.huella();
+  QSharedPointer<const Jardin> encontrado = buscar(huella);
+  if(!encontrado.isNull()){
+    if(*encontrado == jardin)
+      return encontrado;
+
+    // Otro jardín con la misma huella: el nuevo ocupa su lugar, y las
+    // peticiones por huella recibirán a partir de ahora el nuevo
+    entradas.erase(huella);
+  }
+
+  if(static_cast<int>(entradas.size()) >= capacidad){
+    std::map<unsigned, Entrada>::iterator viejo = entradas.begin();
+    for(std::map<unsigned, Entrada>::iterator e = entradas.begin(); e != entradas.end(); ++e)
+      if(e->second.uso < viejo->second.uso)
+        viejo = e;
+    entradas.erase(viejo);
+  }
+
+  Entrada entrada;
+  entrada.jardin = QSharedPointer<const Jardin>(new Jardin(jardin));
+  entrada.uso = ++usos;
+  entradas[huella] = entrada;
+  return entrada.jardin;
+}
+
+// Las coberturas no tienen destino, así que sólo se agrupan por el origen.
+void agrupar_peticion(const PeticionPlan& peticion, int etiqueta,
+                      const QSharedPointer<const Jardin>& jardin, unsigned huella,
+                      std::vector<LotePlan>& lotes, IndiceLotes& indices){
+  std::vector<unsigned> clave(4);
+  clave[0] = huella;
+  clave[1] = peticion.operacion;
+  clave[2] = peticion.origen.fila;
+  clave[3] = peticion.origen.columna;
+
+  // Si la caché ha cambiado el jardín de esa huella en la misma tanda, las
+  // peticiones nuevas van a otro lote
+  IndiceLotes::iterator i = indices.find(clave);
+  if(i != indices.end() && lotes[i->second].jardin != jardin){
+    indices.erase(i);
+    i = indices.end();
+  }
+  if(i == indices.end()){
+    i = indices.insert(std::make_pair(clave, static_cast<int>(lotes.size()))).first;
+    lotes.push_back(LotePlan());
+    lotes.back().jardin = jardin;
+    lotes.back().huella = huella;
+  }
+
+  LotePlan& lote = lotes[i->second];
+  lote.peticiones.push_back(peticion);
+  lote.etiquetas.push_back(etiqueta);
+}
+
+// Todas las peticiones del lote comparten el origen: las coberturas se
+// calculan una vez y los caminos salen de una sola búsqueda de Dijkstra
+// hasta el último destino.
+void atender_lote(LotePlan& lote){
+  const Jardin& jardin = *lote.jardin;
+  lote.respuestas.resize(lote.peticiones.size());
+  if(lote.peticiones.empty())
+    return;
+
+  std::vector<Posicion> destinos;
+  std::vector<int> validas;
+  Posicion origen = lote.peticiones[0].origen;
+  bool origen_valido = jardin.dentro(origen.fila, origen.columna);
+
+  for(unsigned i = 0; i < lote.peticiones.size(); ++i){
+    const PeticionPlan& p = lote.peticiones[i];
+    RespuestaPlan& r = lote.respuestas[i];
+    r.id = p.id;
+    r.operacion = p.operacion;
+    r.huella = lote.huella;
+    r.estado = PLAN_MAL_FORMADA;
+    if(!origen_valido ||
+       (p.operacion == PLAN_CAMINO && !jardin.dentro(p.destino.fila, p.destino.columna)))
+      continue;
+    r.estado = PLAN_HECHO;
+    validas.push_back(i);
+    destinos.push_back(p.destino);
+  }
+  if(validas.empty())
+    return;
+
+  if(lote.peticiones[0].operacion == PLAN_COBERTURA){
+    RespuestaPlan& primera = lote.respuestas[validas[0]];
+    primera.resultado = cobertura_saltos(jardin, origen, &primera.movs);
+    for(unsigned i = 1; i < validas.size(); ++i){
+      lote.respuestas[validas[i]].resultado = primera.resultado;
+      lote.respuestas[validas[i]].movs = primera.movs;
+    }
+    return;
+  }
+
+  if(validas.size() == 1){
+    RespuestaPlan& r = lote.respuestas[validas[0]];
+    r.resultado = dijkstra(jardin, origen, destinos[0], &r.movs);
+    return;
+  }
+
+  std::vector<Resultado> resultados;
+  std::vector<std::vector<Movimientos> > movs;
+  dijkstra_destinos(jardin, origen, destinos, resultados, &movs);
+  for(unsigned i = 0; i < validas.size(); ++i){
+    lote.respuestas[validas[i]].resultado = resultados[i];
+    lote.respuestas[validas[i]].movs.swap(movs[i]);
+  }
+}
+
+MedidorServicio::MedidorServicio(): siguiente(0), atendidas(0), primera(-1) {}
+
+void MedidorServicio::anotar(qint64 llegada_ns, qint64 respuesta_ns){
+  Muestra m = {respuesta_ns, respuesta_ns - llegada_ns};
+  if(primera < 0)
+    primera = llegada_ns;
+
+  if(muestras.size() < static_cast<unsigned>(MUESTRAS))
+    muestras.push_back(m);
+  else
+    muestras[siguiente] = m;
+  siguiente = (siguiente + 1) % MUESTRAS;
+  ++atendidas;
+}
+
+// El ritmo se calcula sobre el tiempo que cubren las muestras de la
+// ventana: si se han descartado muestras dentro de ella, desde la más
+// antigua que queda, y si no, desde el principio de la ventana o desde la
+// primera petición.
+MedidasServicio MedidorServicio::medidas(qint64 ahora_ns, int en_cola, int jardines) const {
+  MedidasServicio m;
+  m.atendidas = atendidas;
+  m.en_cola = en_cola;
+  m.jardines = jardines;
+
+  std::vector<qint64> latencias;
+  qint64 desde = std::max(ahora_ns - VENTANA_NS, primera);
+  qint64 antigua = ahora_ns;
+  for(unsigned i = 0; i < muestras.size(); ++i)
+    if(muestras[i].instante >= desde){
+      latencias.push_back(muestras[i].latencia);
+      antigua = std::min(antigua, muestras[i].instante);
+    }
+  if(latencias.empty())
+    return m;
+
+  if(atendidas > static_cast<int>(muestras.size()))
+    desde = std::max(desde, antigua);
+  if(ahora_ns > desde)
+    m.por_segundo = latencias.size()*1e9/(ahora_ns - desde);
+
+  std::vector<qint64>::iterator p50 = latencias.begin() + latencias.size()/2;
+  std::nth_element(latencias.begin(), p50, latencias.end());
+  m.p50_us = *p50/1000.0;
+  std::vector<qint64>::iterator p99 = latencias.begin() + latencias.size()*99/100;
+  std::nth_element(latencias.begin(), p99, latencias.end());
+  m.p99_us = *p99/1000.0;
+  return m;
+}
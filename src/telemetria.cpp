@@ -0,0 +1,238 @@
+#include "telemetria.h"
+
+#include <cstring>
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QtEndian>
+
+// Cabecera del segmento: identificador, versión, tamaño de los registros,
+// capacidad del anillo, último registro escrito, último registro leído e
+// identificador de la sesión del publicador, que cambia cada vez que se crea
+// el segmento. Los contadores se leen y escriben con operaciones atómicas,
+// así que van en el orden de bytes de la máquina.
+static const int TELEMETRIA = 0x4D4C4554; // "TELM"
+static const int VERSION_TELEMETRIA = 1;
+static const int ENTERO = 4;
+static const int CABECERA = 8*ENTERO;
+enum {CAMPO_ID, CAMPO_VERSION, CAMPO_TAMANO, CAMPO_CAPACIDAD, CAMPO_ESCRITOS,
+      CAMPO_LEIDO, CAMPO_SESION};
+
+// Cuando el consumidor va más de medio anillo por detrás, el publicador que
+// agrupa escribe como mucho un registro cada este tiempo.
+static const qint64 INTERVALO_AGRUPADO_NS = 100*1000*1000;
+
+static QAtomicInt* atomico(char* p){
+  return reinterpret_cast<QAtomicInt*>(p);
+}
+
+static QAtomicInt* campo(char* datos, int i){
+  return atomico(datos + i*ENTERO);
+}
+
+// En cada hueco del anillo la secuencia va delante del registro. Mientras se
+// escribe el registro la secuencia vale 0, y el lector sólo da por bueno lo
+// que ha copiado si la secuencia es la que esperaba antes y después de
+// copiarlo.
+static char* hueco(char* datos, unsigned capacidad, unsigned secuencia){
+  return datos + CABECERA + (secuencia & (capacidad - 1))*TAMANO_REGISTRO;
+}
+
+void codificar_registro(const RegistroTelemetria& r, char* destino){
+  uchar* d = reinterpret_cast<uchar*>(destino);
+  qToLittleEndian<quint32>(r.secuencia, d);
+  qToLittleEndian<qint32>(r.evento, d + 4);
+  qToLittleEndian<qint64>(r.tiempo_us, d + 8);
+  qToLittleEndian<qint32>(r.pos.fila, d + 16);
+  qToLittleEndian<qint32>(r.pos.columna, d + 20);
+  qToLittleEndian<qint32>(r.movimientos, d + 24);
+  qToLittleEndian<qint32>(r.cortadas, d + 28);
+  qToLittleEndian<qint32>(r.paso_us, d + 32);
+  qToLittleEndian<qint32>(r.agrupados, d + 36);
+}
+
+RegistroTelemetria decodificar_registro(const char* origen){
+  const uchar* o = reinterpret_cast<const uchar*>(origen);
+  RegistroTelemetria r;
+  r.secuencia = qFromLittleEndian<quint32>(o);
+  int evento = qFromLittleEndian<qint32>(o + 4);
+  r.evento = evento >= 0 && evento < NUM_EVENTOS_TELEMETRIA?
+             static_cast<EventoTelemetria>(evento) : TELEMETRIA_MOVIMIENTO;
+  r.tiempo_us = qFromLittleEndian<qint64>(o + 8);
+  r.pos.fila = qFromLittleEndian<qint32>(o + 16);
+  r.pos.columna = qFromLittleEndian<qint32>(o + 20);
+  r.movimientos = qFromLittleEndian<qint32>(o + 24);
+  r.cortadas = qFromLittleEndian<qint32>(o + 28);
+  r.paso_us = qFromLittleEndian<qint32>(o + 32);
+  r.agrupados = qFromLittleEndian<qint32>(o + 36);
+  return r;
+}
+
+// Si el segmento ya existe, normalmente porque un publicador anterior con la
+// misma clave terminó sin liberarlo, se reutiliza si tiene sitio.
+PublicadorTelemetria::PublicadorTelemetria(const QString& clave, int capacidad,
+                                           PoliticaTelemetria politica):
+  memoria(clave), datos(NULL), capacidad(1), secuencia(0), politica(politica),
+  ultima_muestra_ns(0), ultimo_escrito_ns(0), en_marcha(false), total_agrupadas(0)
+{
+  while(this->capacidad < static_cast<unsigned>(capacidad))
+    this->capacidad *= 2;
+
+  int tamano = CABECERA + this->capacidad*TAMANO_REGISTRO;
+  if(!memoria.create(tamano) &&
+     (memoria.error() != QSharedMemory::AlreadyExists || !memoria.attach() ||
+      memoria.size() < tamano))
+    return;
+
+  datos = static_cast<char*>(memoria.data());
+  std::memset(datos, 0, tamano);
+  int sesion = static_cast<int>(QDateTime::currentMSecsSinceEpoch()) ^
+               static_cast<int>(QCoreApplication::applicationPid() << 16);
+  campo(datos, CAMPO_VERSION)->storeRelease(VERSION_TELEMETRIA);
+  campo(datos, CAMPO_TAMANO)->storeRelease(TAMANO_REGISTRO);
+  campo(datos, CAMPO_CAPACIDAD)->storeRelease(this->capacidad);
+  campo(datos, CAMPO_SESION)->storeRelease(sesion);
+  campo(datos, CAMPO_ID)->storeRelease(TELEMETRIA);
+  reloj.start();
+}
+
+PublicadorTelemetria::~PublicadorTelemetria(){
+  terminar();
+}
+
+void PublicadorTelemetria::empezar(const Posicion& pos){
+  terminar();
+  actual = RegistroTelemetria();
+  reloj.start();
+  ultima_muestra_ns = 0;
+  en_marcha = true;
+  muestra(TELEMETRIA_INICIO, pos);
+  escribir();
+}
+
+// Con la política de agrupar, mientras el último lector vaya retrasado más
+// de medio anillo las muestras se acumulan en el registro actual, que se
+// escribe cuando el lector se pone al día o como mucho cada
+// INTERVALO_AGRUPADO_NS. Un lector que ha dejado de leer, por tanto, no
+// detiene la telemetría sino que la frena.
+void PublicadorTelemetria::mover(const Posicion& pos, int cortadas){
+  if(!en_marcha)
+    return;
+
+  ++actual.movimientos;
+  actual.cortadas += cortadas;
+  muestra(TELEMETRIA_MOVIMIENTO, pos);
+
+  if(politica == TELEMETRIA_AGRUPAR && datos){
+    unsigned leido = campo(datos, CAMPO_LEIDO)->loadAcquire();
+    if(leido != 0 && secuencia - leido >= capacidad/2 &&
+       ultima_muestra_ns - ultimo_escrito_ns < INTERVALO_AGRUPADO_NS){
+      ++total_agrupadas;
+      return;
+    }
+  }
+  escribir();
+}
+
+void PublicadorTelemetria::terminar(){
+  if(!en_marcha)
+    return;
+  muestra(TELEMETRIA_FIN, actual.pos);
+  escribir();
+  en_marcha = false;
+}
+
+// El registro actual acumula las muestras que todavía no se han escrito.
+void PublicadorTelemetria::muestra(EventoTelemetria evento, const Posicion& pos){
+  qint64 ahora = reloj.nsecsElapsed();
+  actual.evento = evento;
+  actual.pos = pos;
+  actual.tiempo_us = ahora/1000;
+  actual.paso_us = static_cast<int>((ahora - ultima_muestra_ns)/1000);
+  ++actual.agrupados;
+  ultima_muestra_ns = ahora;
+}
+
+void PublicadorTelemetria::escribir(){
+  if(datos){
+    char registro[TAMANO_REGISTRO];
+    actual.secuencia = ++secuencia;
+    codificar_registro(actual, registro);
+
+    char* h = hueco(datos, capacidad, secuencia);
+    atomico(h)->fetchAndStoreOrdered(0);
+    std::memcpy(h + ENTERO, registro + ENTERO, TAMANO_REGISTRO - ENTERO);
+    atomico(h)->storeRelease(secuencia);
+    campo(datos, CAMPO_ESCRITOS)->storeRelease(secuencia);
+  }
+  ultimo_escrito_ns = ultima_muestra_ns;
+  actual.agrupados = 0;
+}
+
+LectorTelemetria::LectorTelemetria(const QString& clave):
+  memoria(clave), datos(NULL), capacidad(0), siguiente(0), sesion(0), total_perdidos(0) {}
+
+bool LectorTelemetria::conectar(){
+  if(datos)
+    return true;
+  if(!memoria.attach())
+    return false;
+
+  char* d = static_cast<char*>(memoria.data());
+  unsigned c = campo(d, CAMPO_CAPACIDAD)->loadAcquire();
+  if(memoria.size() < CABECERA ||
+     campo(d, CAMPO_ID)->loadAcquire() != TELEMETRIA ||
+     campo(d, CAMPO_VERSION)->loadAcquire() != VERSION_TELEMETRIA ||
+     campo(d, CAMPO_TAMANO)->loadAcquire() != TAMANO_REGISTRO ||
+     c == 0 || (c & (c - 1)) != 0 ||
+     memoria.size() < CABECERA + static_cast<qint64>(c)*TAMANO_REGISTRO){
+    memoria.detach();
+    return false;
+  }
+
+  datos = d;
+  capacidad = c;
+  siguiente = 0;
+  return true;
+}
+
+// Si el publicador ha vuelto a crear el segmento, la secuencia empieza de
+// nuevo y se vuelve a leer desde el principio del anillo.
+int LectorTelemetria::leer(std::vector<RegistroTelemetria>& registros, int maximo){
+  if(!datos)
+    return 0;
+
+  int s = campo(datos, CAMPO_SESION)->loadAcquire();
+  unsigned escritos = campo(datos, CAMPO_ESCRITOS)->loadAcquire();
+  if(s != sesion || siguiente == 0){
+    sesion = s;
+    siguiente = escritos >= capacidad? escritos - capacidad + 1 : 1;
+  }
+
+  int leidos = 0;
+  char registro[TAMANO_REGISTRO];
+  while(leidos < maximo && static_cast<int>(escritos - siguiente) >= 0){
+    if(escritos - siguiente >= capacidad){
+      total_perdidos += escritos - capacidad + 1 - siguiente;
+      siguiente = escritos - capacidad + 1;
+    }
+
+    char* h = hueco(datos, capacidad, siguiente);
+    unsigned antes = atomico(h)->loadAcquire();
+    std::memcpy(registro + ENTERO, h + ENTERO, TAMANO_REGISTRO - ENTERO);
+    unsigned despues = atomico(h)->fetchAndAddOrdered(0);
+
+    if(antes == siguiente && despues == siguiente){
+      RegistroTelemetria r = decodificar_registro(registro);
+      r.secuencia = siguiente;
+      registros.push_back(r);
+      ++leidos;
+    }
+    else
+      ++total_perdidos;
+    ++siguiente;
+  }
+
+  campo(datos, CAMPO_LEIDO)->storeRelease(siguiente - 1);
+  return leidos;
+}
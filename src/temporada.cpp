@@ -0,0 +1,456 @@
+#include "temporada.h"
+
+#include <algorithm>
+
+#include <QElapsedTimer>
+
+#include "planificadores.h"
+
+static const int DIAS = 120;
+static const double CRECIMIENTO = 4.0;
+static const double ALTURA_CORTE = 30.0;
+static const double ALTURA_INICIAL = 60.0;
+
+// Sin presupuesto, se da el necesario para recorrer el jardín entero en
+// estos días.
+static const int DIAS_CICLO = 4;
+
+// Movimientos del recorrido completo que forman cada tramo. El planificador
+// decide si salta tramos enteros en lugar de celdas sueltas para no dar
+// rodeos por cada celda.
+static const int LONGITUD_TRAMO = 64;
+
+// Filas de cada franja del recorrido completo.
+static const int ALTO_FRANJA = 8;
+
+// Máximo que puede alargar el recorrido por franjas respecto a la cobertura
+// con saltos.
+static const double MAX_EXCESO_FRANJAS = 1.25;
+
+// Crecimiento de cada terreno respecto al llano.
+static double factor_crecimiento(Terreno terreno){
+  switch(terreno){
+  case DENSO:
+    return 1.5;
+  case GRAVA:
+    return 0.25;
+  case PENDIENTE:
+    return 0.75;
+  case LLANO:
+  default:
+    return 1.0;
+  }
+}
+
+const char* nombre_estrategia_temporada(EstrategiaTemporada estrategia){
+  switch(estrategia){
+  case TEMPORADA_ADAPTATIVA:
+    return "Recorrido cíclico saltando lo que puede esperar";
+  case TEMPORADA_CICLICA:
+    return "Recorrido cíclico";
+  default:
+    return "";
+  }
+}
+
+ConfiguracionTemporada::ConfiguracionTemporada():
+  dias(DIAS), presupuesto(0), crecimiento(CRECIMIENTO), altura_corte(ALTURA_CORTE),
+  altura_inicial(ALTURA_INICIAL), estrategia(TEMPORADA_ADAPTATIVA)
+{
+}
+
+namespace {
+
+// Estado de la temporada y memoria de las búsquedas, que se reutiliza de una
+// salida a la siguiente.
+class Temporada {
+public:
+  Temporada(const Jardin& jardin, const ConfiguracionTemporada& config);
+
+  InformeTemporada simular();
+
+private:
+  void empezar_busqueda(int origen);
+  void expandir(unsigned i);
+  void buscar(int origen, int destino);
+  void recorrido_por_franjas();
+  void alargar_recorrido(int destino, std::vector<bool>& en_recorrido);
+
+  void cortar(int c);
+  void ir_a(int destino);
+  void volver();
+  bool avanzar(int celda);
+
+  // Primera y última posición en el recorrido de cada tramo. Empiezan
+  // después de la base, que no se corta
+  int inicio_tramo(int t) const { return 1 + t*LONGITUD_TRAMO; }
+  int fin_tramo(int t) const {
+    return std::min(inicio_tramo(t) + LONGITUD_TRAMO, static_cast<int>(recorrido.size())) - 1;
+  }
+
+  bool puede_esperar(int t) const;
+  void recorrer_dia(bool saltar);
+  void resumir_dia(DiaTemporada& resumen) const;
+
+  const Jardin& jardin;
+  ConfiguracionTemporada config;
+  InformeTemporada informe;
+  int base;
+
+  // Distancia de cada celda a la base y celda siguiente en el camino de
+  // vuelta
+  std::vector<int> dist_base, hacia_base;
+
+  // Celdas del recorrido completo desde la base, en orden, y tramos en los
+  // que se divide
+  std::vector<int> recorrido;
+  int tramos;
+
+  // Altura, ritmo de crecimiento y día del último corte de cada celda.
+  // "cortada" guarda el último día en el que se ha contado la celda entre
+  // las cortadas
+  std::vector<double> altura, ritmo;
+  std::vector<int> ultimo, cortada;
+  std::vector<bool> alcanzable;
+
+  // Crecimiento de la hierba que crece más deprisa
+  double ritmo_max;
+
+  // Salida en curso
+  int dia, posicion, restante;
+  DiaTemporada hoy;
+
+  // Siguiente posición del recorrido, momento en el que empezó la vuelta en
+  // curso y días que duró la anterior, contando las fracciones de día
+  unsigned siguiente;
+  double inicio_vuelta, vuelta;
+
+  // Búsqueda en anchura
+  std::vector<unsigned> marca;
+  std::vector<int> dist, padre, cola, camino;
+  unsigned sello;
+};
+
+}
+
+Temporada::Temporada(const Jardin& jardin, const ConfiguracionTemporada& config):
+  jardin(jardin), config(config), base(jardin.indice(0, 0)), tramos(0), ritmo_max(0),
+  dia(0), posicion(base), restante(0), siguiente(1), inicio_vuelta(1), vuelta(1),
+  marca(jardin.celdas(), 0), dist(jardin.celdas(), -1), padre(jardin.celdas(), -1), sello(0)
+{
+  buscar(base, -1);
+  dist_base.assign(jardin.celdas(), -1);
+  hacia_base.assign(jardin.celdas(), -1);
+  alcanzable.assign(jardin.celdas(), false);
+  for(unsigned i = 0; i < cola.size(); ++i){
+    int c = cola[i];
+    dist_base[c] = dist[c];
+    hacia_base[c] = padre[c];
+    alcanzable[c] = c != base;
+  }
+  int lejos = dist[cola.back()];
+  informe.alcanzables = static_cast<int>(cola.size()) - 1;
+  informe.inalcanzables = celdas_cesped(jardin) - informe.alcanzables;
+
+  altura.assign(jardin.celdas(), config.altura_inicial);
+  ritmo.assign(jardin.celdas(), 0);
+  ultimo.assign(jardin.celdas(), 0);
+  cortada.assign(jardin.celdas(), 0);
+  for(int c = 0; c < jardin.celdas(); ++c){
+    Posicion p = jardin.posicion(c);
+    ritmo[c] = config.crecimiento*factor_crecimiento(jardin.terreno(p.fila, p.columna));
+    if(alcanzable[c])
+      ritmo_max = std::max(ritmo_max, ritmo[c]);
+  }
+
+  // Si el recorrido por franjas sale mucho más largo que la cobertura con
+  // saltos, como pasa en los laberintos, se usa esta, siempre que corte todo
+  // lo alcanzable
+  recorrido_por_franjas();
+  std::vector<Movimientos> movs, acortado;
+  cobertura_saltos(jardin, Posicion(0, 0), &movs);
+  Resultado corto = acortar_recorrido(jardin, Posicion(0, 0), movs, acortado);
+  if(corto.exito && corto.cortadas >= informe.alcanzables &&
+     recorrido.size() - 1 > acortado.size()*MAX_EXCESO_FRANJAS){
+    Posicion p(0, 0);
+    recorrido.assign(1, base);
+    for(unsigned i = 0; i < acortado.size(); ++i){
+      p = desplazar(p, acortado[i]);
+      recorrido.push_back(jardin.indice(p.fila, p.columna));
+    }
+  }
+  informe.recorrido = static_cast<int>(recorrido.size()) - 1;
+
+  std::vector<bool> en_recorrido(jardin.celdas(), false);
+  for(unsigned i = 0; i < recorrido.size(); ++i)
+    en_recorrido[recorrido[i]] = true;
+  for(int c = 0; c < jardin.celdas(); ++c)
+    informe.sin_recorrer += alcanzable[c] && !en_recorrido[c];
+
+  tramos = (informe.recorrido + LONGITUD_TRAMO - 1)/LONGITUD_TRAMO;
+
+  // Sin presupuesto, se da al menos el necesario para llegar a la celda más
+  // lejana y volver
+  informe.presupuesto = config.presupuesto > 0? config.presupuesto :
+                        std::max(2*lejos, (informe.recorrido + DIAS_CICLO - 1)/DIAS_CICLO);
+  vuelta = static_cast<double>(informe.recorrido)/informe.presupuesto;
+}
+
+void Temporada::empezar_busqueda(int origen){
+  if(++sello == 0){
+    std::fill(marca.begin(), marca.end(), 0);
+    sello = 1;
+  }
+
+  cola.clear();
+  cola.push_back(origen);
+  marca[origen] = sello;
+  dist[origen] = 0;
+  padre[origen] = -1;
+}
+
+// Añade a la cola las vecinas sin visitar de la celda en la posición "i". La
+// base no es transitable pero la cortadora puede pasar por ella, y a veces es
+// el único paso entre dos partes del jardín.
+void Temporada::expandir(unsigned i){
+  Posicion p = jardin.posicion(cola[i]);
+  for(int k = 0; k < 4; ++k){
+    Posicion q = desplazar(p, MOVIMIENTOS[k]);
+    if(!jardin.transitable(q.fila, q.columna) && q != jardin.posicion(base))
+      continue;
+    int c = jardin.indice(q.fila, q.columna);
+    if(marca[c] != sello){
+      marca[c] = sello;
+      dist[c] = dist[cola[i]] + 1;
+      padre[c] = cola[i];
+      cola.push_back(c);
+    }
+  }
+}
+
+// Búsqueda en anchura desde "origen" hasta llegar a "destino", que sólo está
+// marcado con el sello actual si se ha llegado. Con -1 se recorre todo lo
+// alcanzable y quedan en "cola" las celdas en orden de distancia.
+void Temporada::buscar(int origen, int destino){
+  empezar_busqueda(origen);
+  for(unsigned i = 0; i < cola.size() && (destino < 0 || marca[destino] != sello); ++i)
+    expandir(i);
+}
+
+// Recorrido completo por franjas horizontales, en zigzag, y dentro de cada
+// franja columna a columna, bajando y subiendo. Así cada tramo cubre un
+// bloque pequeño del jardín, que suele tener un único terreno, y no mezcla
+// hierba que crece a ritmos distintos.
+void Temporada::recorrido_por_franjas(){
+  std::vector<bool> en_recorrido(jardin.celdas(), false);
+  recorrido.assign(1, base);
+  for(int f = 0; f*ALTO_FRANJA < jardin.filas(); ++f)
+    for(int k = 0; k < jardin.columnas(); ++k){
+      int j = f%2 == 0? k : jardin.columnas() - 1 - k;
+      for(int n = 0; n < ALTO_FRANJA; ++n){
+        int i = f*ALTO_FRANJA + (k%2 == 0? n : ALTO_FRANJA - 1 - n);
+        if(i < jardin.filas() && alcanzable[jardin.indice(i, j)] &&
+           !en_recorrido[jardin.indice(i, j)])
+          alargar_recorrido(jardin.indice(i, j), en_recorrido);
+      }
+    }
+}
+
+// Añade al recorrido el camino más corto hasta "destino", parando la
+// búsqueda en cuanto lo encuentra.
+void Temporada::alargar_recorrido(int destino, std::vector<bool>& en_recorrido){
+  buscar(recorrido.back(), destino);
+  if(marca[destino] != sello)
+    return;
+
+  camino.clear();
+  for(int c = destino; c != recorrido.back(); c = padre[c])
+    camino.push_back(c);
+  for(int i = static_cast<int>(camino.size()) - 1; i >= 0; --i){
+    recorrido.push_back(camino[i]);
+    en_recorrido[camino[i]] = true;
+  }
+}
+
+void Temporada::cortar(int c){
+  if(!alcanzable[c])
+    return;
+  altura[c] = config.altura_corte;
+  ultimo[c] = dia;
+  if(cortada[c] != dia){
+    cortada[c] = dia;
+    ++hoy.cortadas;
+  }
+}
+
+// Va por el camino más corto encontrado en la última búsqueda, que tiene que
+// haber empezado en la posición actual, cortando todo lo que pisa. Si no
+// llegó a "destino" no se mueve.
+void Temporada::ir_a(int destino){
+  if(marca[destino] != sello)
+    return;
+
+  camino.clear();
+  for(int c = destino; c != posicion; c = padre[c])
+    camino.push_back(c);
+  for(int i = static_cast<int>(camino.size()) - 1; i >= 0; --i)
+    cortar(camino[i]);
+
+  hoy.movimientos += camino.size();
+  restante -= camino.size();
+  posicion = destino;
+}
+
+void Temporada::volver(){
+  while(posicion != base){
+    posicion = hacia_base[posicion];
+    cortar(posicion);
+    ++hoy.movimientos;
+    --restante;
+  }
+}
+
+// Da un paso a una celda vecina si después queda presupuesto para volver.
+bool Temporada::avanzar(int celda){
+  if(restante < 1 + dist_base[celda])
+    return false;
+  posicion = celda;
+  cortar(celda);
+  ++hoy.movimientos;
+  --restante;
+  return true;
+}
+
+// Un tramo puede esperar a la siguiente vuelta si para entonces, con un día
+// de margen, ninguna de sus celdas habrá pasado de la altura a la que llega
+// la hierba más rápida en una vuelta.
+bool Temporada::puede_esperar(int t) const {
+  double limite = config.altura_corte + ritmo_max*vuelta;
+  for(int i = inicio_tramo(t); i <= fin_tramo(t); ++i){
+    int c = recorrido[i];
+    if(alcanzable[c] && altura[c] + ritmo[c]*(vuelta + 1) > limite)
+      return false;
+  }
+  return true;
+}
+
+// Sigue el recorrido completo desde donde se dejó el día anterior y vuelve a
+// empezarlo cuando lo termina. Con "saltar", los tramos que pueden esperar
+// se saltan y el presupuesto se dedica a la hierba que crece más deprisa.
+// Si el crecimiento es igual en todo el jardín no se salta nada.
+void Temporada::recorrer_dia(bool saltar){
+  if(recorrido.size() < 2)
+    return;
+
+  int saltados = 0;
+  for(;;){
+    if(siguiente == recorrido.size()){
+      double ahora = dia + static_cast<double>(informe.presupuesto - restante)/informe.presupuesto;
+      vuelta = ahora - inicio_vuelta;
+      inicio_vuelta = ahora;
+      siguiente = 1;
+    }
+
+    int t = (siguiente - 1)/LONGITUD_TRAMO;
+    if(saltar && static_cast<int>(siguiente) == inicio_tramo(t) && puede_esperar(t)){
+      // Si todo puede esperar, se sigue cortando en orden para no
+      // desaprovechar el presupuesto
+      if(++saltados > tramos)
+        saltar = false;
+      siguiente = fin_tramo(t) + 1;
+      continue;
+    }
+
+    int objetivo = recorrido[siguiente];
+    if(posicion == recorrido[siguiente - 1]){
+      if(!avanzar(objetivo))
+        return;
+    }
+    else{
+      buscar(posicion, objetivo);
+      if(marca[objetivo] != sello || dist[objetivo] + dist_base[objetivo] > restante){
+        // Si ni desde la base da para llegar a donde se dejó, se empieza de
+        // nuevo
+        if(posicion != base || siguiente == 1)
+          return;
+        siguiente = 1;
+        continue;
+      }
+      ir_a(objetivo);
+    }
+    saltados = 0;
+    ++siguiente;
+  }
+}
+
+void Temporada::resumir_dia(DiaTemporada& resumen) const {
+  double suma_altura = 0, suma_dias = 0;
+  for(int c = 0; c < jardin.celdas(); ++c){
+    if(!alcanzable[c])
+      continue;
+    resumen.altura_max = std::max(resumen.altura_max, altura[c]);
+    resumen.dias_max = std::max(resumen.dias_max, dia - ultimo[c]);
+    suma_altura += altura[c];
+    suma_dias += dia - ultimo[c];
+  }
+  if(informe.alcanzables > 0){
+    resumen.altura_media = suma_altura/informe.alcanzables;
+    resumen.dias_media = suma_dias/informe.alcanzables;
+  }
+}
+
+InformeTemporada Temporada::simular(){
+  QElapsedTimer reloj;
+  reloj.start();
+
+  for(dia = 1; dia <= config.dias; ++dia){
+    for(int c = 0; c < jardin.celdas(); ++c)
+      if(alcanzable[c])
+        altura[c] += ritmo[c];
+
+    hoy = DiaTemporada();
+    posicion = base;
+    restante = informe.presupuesto;
+    recorrer_dia(config.estrategia == TEMPORADA_ADAPTATIVA);
+    volver();
+
+    resumir_dia(hoy);
+    informe.dias.push_back(hoy);
+    informe.altura_max = std::max(informe.altura_max, hoy.altura_max);
+    informe.dias_max = std::max(informe.dias_max, hoy.dias_max);
+    informe.movimientos += hoy.movimientos;
+  }
+
+  informe.tiempo_ms = reloj.elapsed();
+  return informe;
+}
+
+InformeTemporada simular_temporada(const Jardin& jardin, const ConfiguracionTemporada& config){
+  Temporada temporada(jardin, config);
+  return temporada.simular();
+}
+
+QString texto_temporada(const InformeTemporada& informe, const ConfiguracionTemporada& config){
+  QString texto = "---===TEMPORADA DE CORTES===---\n";
+  texto += QString("Estrategia: %1\n").arg(nombre_estrategia_temporada(config.estrategia));
+  texto += QString("Días: %1, presupuesto diario: %2 movimientos (recorrido completo: %3)\n")
+           .arg(config.dias).arg(informe.presupuesto).arg(informe.recorrido);
+  texto += QString("Celdas alcanzables: %1, sin acceso: %2, fuera del recorrido: %3\n")
+           .arg(informe.alcanzables).arg(informe.inalcanzables).arg(informe.sin_recorrer);
+  texto += QString("Crecimiento: %1mm/día, corte a %2mm\n")
+           .arg(config.crecimiento, 0, 'f', 1).arg(config.altura_corte, 0, 'f', 1);
+  texto += QString("Altura máxima de la temporada: %1mm, días máximos sin cortar: %2\n")
+           .arg(informe.altura_max, 0, 'f', 1).arg(informe.dias_max);
+  texto += QString("Movimientos totales: %1\n").arg(informe.movimientos);
+  texto += QString("Tiempo de simulación: %1ms\n\n").arg(informe.tiempo_ms);
+
+  texto += "Día  Movimientos  Cortadas  Altura máx  Altura media  Días máx  Días media\n";
+  for(unsigned i = 0; i < informe.dias.size(); ++i){
+    const DiaTemporada& d = informe.dias[i];
+    texto += QString("%1  %2  %3  %4  %5  %6  %7\n")
+             .arg(static_cast<int>(i) + 1, 3).arg(d.movimientos, 11).arg(d.cortadas, 8)
+             .arg(d.altura_max, 10, 'f', 1).arg(d.altura_media, 12, 'f', 1)
+             .arg(d.dias_max, 8).arg(d.dias_media, 10, 'f', 1);
+  }
+  return texto;
+}
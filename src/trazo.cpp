@@ -0,0 +1,115 @@
+#include "trazo.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+// Tipos que las herramientas no sobrescriben. Los puntos se quitan y se ponen
+// con la edición celda a celda, que es la que lleva la cuenta de ellos.
+static bool fija(TipoCelda tipo){
+  return tipo == INICIO || tipo == CORTADORA || tipo == PUNTO_A || tipo == PUNTO_B ||
+         tipo == PUNTO_RUTA;
+}
+
+int Trazo::pintar(Jardin& jardin, const std::vector<Posicion>& celdas, const Pintura& pintura){
+  int cambiadas = 0;
+  for(unsigned i = 0; i < celdas.size(); ++i){
+    const Posicion& p = celdas[i];
+    if(!jardin.dentro(p.fila, p.columna))
+      continue;
+
+    CambioCelda cambio;
+    cambio.pos = p;
+    cambio.tipo_antes = cambio.tipo = jardin.tipo(p.fila, p.columna);
+    cambio.terreno_antes = cambio.terreno = jardin.terreno(p.fila, p.columna);
+
+    if(pintura.es_terreno){
+      if(cambio.tipo == INICIO || cambio.tipo == OBSTACULO)
+        continue;
+      cambio.terreno = pintura.terreno;
+    }
+    else {
+      if(fija(cambio.tipo))
+        continue;
+      cambio.tipo = pintura.tipo;
+    }
+    if(cambio.tipo == cambio.tipo_antes && cambio.terreno == cambio.terreno_antes)
+      continue;
+
+    jardin.set_tipo(p.fila, p.columna, cambio.tipo);
+    jardin.set_terreno(p.fila, p.columna, cambio.terreno);
+    cambios_.push_back(cambio);
+    ++cambiadas;
+  }
+  return cambiadas;
+}
+
+Trazo Trazo::deshacer(Jardin& jardin) const {
+  Trazo inverso;
+  for(int i = cambios_.size() - 1; i >= 0; --i){
+    const CambioCelda& c = cambios_[i];
+    if(!jardin.dentro(c.pos.fila, c.pos.columna) ||
+       jardin.tipo(c.pos.fila, c.pos.columna) != c.tipo ||
+       jardin.terreno(c.pos.fila, c.pos.columna) != c.terreno)
+      continue;
+
+    CambioCelda vuelta = c;
+    std::swap(vuelta.tipo, vuelta.tipo_antes);
+    std::swap(vuelta.terreno, vuelta.terreno_antes);
+    jardin.set_tipo(c.pos.fila, c.pos.columna, vuelta.tipo);
+    jardin.set_terreno(c.pos.fila, c.pos.columna, vuelta.terreno);
+    inverso.cambios_.push_back(vuelta);
+  }
+  return inverso;
+}
+
+// Se avanza siempre en la dirección que deja la celda más cerca de la recta
+// que une los centros de las dos posiciones.
+void celdas_linea(const Posicion& a, const Posicion& b, std::vector<Posicion>& celdas){
+  int df = std::abs(b.fila - a.fila), dc = std::abs(b.columna - a.columna);
+  int sf = b.fila > a.fila? 1 : -1, sc = b.columna > a.columna? 1 : -1;
+
+  Posicion p = a;
+  celdas.push_back(p);
+  for(int f = 0, c = 0; f < df || c < dc; ){
+    if((1 + 2*c)*df < (1 + 2*f)*dc){
+      p.columna += sc;
+      ++c;
+    }
+    else {
+      p.fila += sf;
+      ++f;
+    }
+    celdas.push_back(p);
+  }
+}
+
+void celdas_rectangulo(const Posicion& a, const Posicion& b, std::vector<Posicion>& celdas){
+  for(int i = std::min(a.fila, b.fila); i <= std::max(a.fila, b.fila); ++i)
+    for(int j = std::min(a.columna, b.columna); j <= std::max(a.columna, b.columna); ++j)
+      celdas.push_back(Posicion(i, j));
+}
+
+void celdas_relleno(const Jardin& jardin, const Posicion& origen, const Pintura& pintura,
+                    std::vector<Posicion>& celdas){
+  if(!jardin.dentro(origen.fila, origen.columna))
+    return;
+
+  TipoCelda tipo = jardin.tipo(origen.fila, origen.columna);
+  Terreno terreno = jardin.terreno(origen.fila, origen.columna);
+  std::vector<char> marcada(jardin.celdas(), 0);
+
+  unsigned primera = celdas.size();
+  celdas.push_back(origen);
+  marcada[jardin.indice(origen.fila, origen.columna)] = 1;
+  for(unsigned i = primera; i < celdas.size(); ++i){
+    for(int k = 0; k < 4; ++k){
+      Posicion q = desplazar(celdas[i], MOVIMIENTOS[k]);
+      if(!jardin.dentro(q.fila, q.columna) || marcada[jardin.indice(q.fila, q.columna)] ||
+         jardin.tipo(q.fila, q.columna) != tipo ||
+         (pintura.es_terreno && jardin.terreno(q.fila, q.columna) != terreno))
+        continue;
+      marcada[jardin.indice(q.fila, q.columna)] = 1;
+      celdas.push_back(q);
+    }
+  }
+}
@@ -0,0 +1,59 @@
+#include "visitas.h"
+
+#include <algorithm>
+
+// Longitud de la barra del grupo más numeroso en el histograma.
+static const int ANCHO_BARRA = 30;
+
+MapaVisitas::MapaVisitas(int filas, int columnas){
+  reiniciar(filas, columnas);
+}
+
+void MapaVisitas::reiniciar(int filas, int columnas){
+  this->filas = filas;
+  this->columnas = columnas;
+  cuentas.assign(filas*columnas, 0);
+}
+
+void MapaVisitas::anotar_recorrido(const Posicion& inicio,
+                                   const std::vector<Movimientos>& movs){
+  Posicion p = inicio;
+  anotar(p.fila, p.columna);
+  for(unsigned i = 0; i < movs.size(); ++i){
+    p = desplazar(p, movs[i]);
+    anotar(p.fila, p.columna);
+  }
+}
+
+HistogramaVisitas MapaVisitas::histograma() const {
+  HistogramaVisitas h;
+  for(unsigned i = 0; i < cuentas.size(); ++i){
+    int n = cuentas[i];
+    if(n == 0)
+      continue;
+    if(n == 1)
+      ++h.una;
+    else if(n == 2)
+      ++h.dos;
+    else
+      ++h.mas;
+    h.repetidas += n - 1;
+    h.maximo = std::max(h.maximo, n);
+  }
+  return h;
+}
+
+// Barra de texto proporcional a "valor" dentro de "total".
+static QString barra(int valor, int total){
+  return QString(total > 0? valor*ANCHO_BARRA/total : 0, QChar('#'));
+}
+
+QString texto_visitas(const HistogramaVisitas& h){
+  int mayor = std::max(h.una, std::max(h.dos, h.mas));
+  return "Celdas visitadas:\n"
+         "-Una vez: " + QString::number(h.una) + " " + barra(h.una, mayor) + "\n"
+         "-Dos veces: " + QString::number(h.dos) + " " + barra(h.dos, mayor) + "\n"
+         "-Tres o más: " + QString::number(h.mas) + " " + barra(h.mas, mayor) + "\n"
+         "-Visitas repetidas: " + QString::number(h.repetidas) + "\n"
+         "-Máximo en una celda: " + QString::number(h.maximo) + "\n";
+}
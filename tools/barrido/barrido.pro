@@ -0,0 +1,14 @@
+QT       += core
+QT       -= gui
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += concurrent
+
+TARGET = ia-barrido
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+
+NUCLEO = $$OUT_PWD/../../core
+include(../../core/nucleo.pri)
+
+SOURCES += main.cpp
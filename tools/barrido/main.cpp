@@ -0,0 +1,63 @@
+#include <cstdio>
+
+#include <QCoreApplication>
+#include <QStringList>
+#include <QTextStream>
+
+#include "barrido.h"
+#include "generador.h"
+
+// Barrido Monte Carlo desde la consola, con el mismo informe que la
+// interfaz.
+//
+//   ia-barrido [-t 25,50,...] [-d 0,10,...] [-n jardines] [-s semilla]
+
+static bool lista(const QString& texto, std::vector<int>& valores){
+  QStringList partes = texto.split(",");
+  valores.clear();
+  for(int i = 0; i < partes.size(); ++i){
+    bool ok;
+    int v = partes[i].toInt(&ok);
+    if(!ok || v < 0)
+      return false;
+    valores.push_back(v);
+  }
+  return !valores.empty();
+}
+
+int main(int argc, char *argv[])
+{
+  QCoreApplication a(argc, argv);
+  QStringList args = a.arguments();
+  QTextStream salida(stdout), error(stderr);
+  ConfiguracionBarrido config;
+
+  for(int i = 1; i < args.size(); ++i){
+    bool ok = i + 1 < args.size();
+    QString valor = ok? args[i+1] : QString();
+    if(args[i] == "-t"){
+      ok = ok && lista(valor, config.tamanos);
+      for(unsigned t = 0; ok && t < config.tamanos.size(); ++t)
+        ok = config.tamanos[t] >= LADO_MINIMO;
+    }
+    else if(args[i] == "-d")
+      ok = ok && lista(valor, config.densidades);
+    else if(args[i] == "-n"){
+      config.jardines = valor.toInt(&ok);
+      ok = ok && config.jardines > 0;
+    }
+    else if(args[i] == "-s")
+      config.semilla = valor.toUInt(&ok);
+    else
+      ok = false;
+
+    if(!ok){
+      error << "Uso: ia-barrido [-t 25,50,...] [-d 0,10,...] [-n jardines] [-s semilla]\n";
+      return 1;
+    }
+    ++i;
+  }
+
+  salida << texto_barrido(ejecutar_barrido(config));
+  return 0;
+}
@@ -0,0 +1,151 @@
+#include <cstdio>
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QStringList>
+#include <QTextStream>
+
+#include "aleatorio.h"
+#include "archivo.h"
+#include "consultas.h"
+#include "generador.h"
+
+// Mide cuántas consultas de camino por segundo se resuelven en un jardín. Las
+// parejas se eligen al azar entre unos pocos puntos, como los de una flota de
+// cortadoras y sus zonas de trabajo, o entre todo el césped con -p 0. Para
+// comparar, una muestra de las consultas se resuelve también una a una con
+// Jardin::camino() y se comprueba que las longitudes coinciden.
+//
+//   ia-consultas [-n consultas] [-p puntos] [-s semilla] [-c] [fichero.garden | FxC]
+
+// Consultas que se resuelven una a una para comparar.
+static const int MUESTRA_UNA_A_UNA = 1000;
+
+static bool dimensiones(const QString& texto, int& filas, int& columnas){
+  QStringList partes = texto.split("x");
+  bool ok_f, ok_c;
+  if(partes.size() != 2)
+    return false;
+  filas = partes[0].toInt(&ok_f);
+  columnas = partes[1].toInt(&ok_c);
+  return ok_f && ok_c;
+}
+
+int main(int argc, char *argv[])
+{
+  QCoreApplication a(argc, argv);
+  QStringList args = a.arguments();
+  QTextStream salida(stdout), error(stderr);
+  int num_consultas = 10000, num_puntos = 100, filas = 150, columnas = 150;
+  unsigned semilla = 1;
+  bool caminos = false;
+  QString fichero;
+
+  for(int i = 1; i < args.size(); ++i){
+    bool ok = true;
+    if(args[i] == "-c")
+      caminos = true;
+    else if(args[i] == "-n" || args[i] == "-p" || args[i] == "-s"){
+      ok = i + 1 < args.size();
+      QString valor = ok? args[++i] : QString();
+      if(args[i-1] == "-n"){
+        num_consultas = valor.toInt(&ok);
+        ok = ok && num_consultas > 0;
+      }
+      else if(args[i-1] == "-p"){
+        num_puntos = valor.toInt(&ok);
+        ok = ok && num_puntos >= 0;
+      }
+      else
+        semilla = valor.toUInt(&ok);
+    }
+    else if(i + 1 == args.size()){
+      if(!dimensiones(args[i], filas, columnas))
+        fichero = args[i];
+      else if(filas < LADO_MINIMO || columnas < LADO_MINIMO){
+        error << "El jardín generado debe ser al menos de " << LADO_MINIMO << "x"
+              << LADO_MINIMO << "\n";
+        return 1;
+      }
+    }
+    else
+      ok = false;
+
+    if(!ok){
+      error << "Uso: ia-consultas [-n consultas] [-p puntos] [-s semilla] [-c] "
+               "[fichero.garden | FxC]\n";
+      return 1;
+    }
+  }
+
+  Jardin jardin;
+  if(fichero.isEmpty()){
+    Posicion pa, pb;
+    jardin = generar_jardin(filas, columnas, Generador(GENERADOR_MANCHAS, semilla), pa, pb);
+  }
+  else{
+    QFile f(fichero);
+    DatosJardin datos;
+    if(!f.open(QIODevice::ReadOnly) || !decodificar_jardin(f.readAll(), datos)){
+      error << "No se ha podido leer el jardín " << fichero << "\n";
+      return 1;
+    }
+    jardin = datos.jardin;
+  }
+
+  std::vector<Posicion> cesped;
+  for(int i = 0; i < jardin.filas(); ++i)
+    for(int j = 0; j < jardin.columnas(); ++j)
+      if(jardin.transitable(i, j))
+        cesped.push_back(Posicion(i, j));
+  if(cesped.empty()){
+    error << "El jardín no tiene césped\n";
+    return 1;
+  }
+
+  Aleatorio aleatorio(semilla);
+  std::vector<Posicion> puntos;
+  for(int i = 0; i < num_puntos; ++i)
+    puntos.push_back(cesped[aleatorio.entero(cesped.size())]);
+  const std::vector<Posicion>& extremos = puntos.empty()? cesped : puntos;
+
+  std::vector<ConsultaCamino> consultas;
+  for(int i = 0; i < num_consultas; ++i)
+    consultas.push_back(ConsultaCamino(extremos[aleatorio.entero(extremos.size())],
+                                       extremos[aleatorio.entero(extremos.size())]));
+
+  std::vector<RespuestaCamino> respuestas;
+  MedidasConsultas medidas;
+  resolver_consultas(jardin, consultas, respuestas, caminos, &medidas);
+
+  // Las mismas consultas una a una, sobre una muestra
+  int muestra = qMin(num_consultas, MUESTRA_UNA_A_UNA), diferencias = 0;
+  std::vector<Movimientos> movs;
+  QElapsedTimer reloj;
+  reloj.start();
+  for(int i = 0; i < muestra; ++i){
+    int longitud = jardin.camino(consultas[i].origen, consultas[i].destino, movs)?
+                   static_cast<int>(movs.size()) : -1;
+    if(longitud != respuestas[i].longitud ||
+       (caminos && longitud >= 0 && static_cast<int>(respuestas[i].movs.size()) != longitud))
+      ++diferencias;
+  }
+  qint64 una_us = reloj.nsecsElapsed()/1000;
+
+  salida << "Jardín de " << jardin.filas() << "x" << jardin.columnas() << ", "
+         << medidas.consultas << " consultas entre "
+         << (puntos.empty()? QString("todo el césped") : QString::number(num_puntos) + " puntos")
+         << (caminos? " con caminos\n" : "\n");
+  salida << "Búsquedas: " << medidas.grupos << " (" << medidas.por_destino
+         << " desde el destino), " << medidas.expandidas << " celdas visitadas\n";
+  salida << "Agrupar: " << medidas.agrupar_us/1000.0 << "ms, resolver: "
+         << medidas.resolver_us/1000.0 << "ms con " << medidas.hilos << " hilos\n";
+  salida << "Consultas por segundo: " << QString::number(medidas.por_segundo, 'f', 0) << "\n";
+  salida << "Una a una (muestra de " << muestra << "): "
+         << QString::number(una_us > 0? muestra*1e6/una_us : 0, 'f', 0)
+         << " consultas por segundo\n";
+  salida << "Diferencias con Jardin::camino(): " << diferencias << "\n";
+
+  return diferencias > 0? 2 : 0;
+}
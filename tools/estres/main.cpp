@@ -0,0 +1,337 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QProcess>
+#include <QStringList>
+#include <QTextStream>
+
+#include "archivo.h"
+#include "estres.h"
+
+// Pruebas de estrés de todos los algoritmos sobre formas de jardín adversas
+// y cada vez más grandes. Cada ejecución se hace en un proceso hijo (este
+// mismo programa con --ejecutar) para poder cortarla si pasa del tiempo
+// límite y para que un desbordamiento de pila no tire abajo las pruebas.
+// Del primer problema de cada serie se busca el menor tamaño en el que
+// aparece y se guarda ese jardín para poder abrirlo en la interfaz.
+// Termina con código 3 si se ha encontrado algún problema.
+//
+//   ia-estres [-t 32,64,...] [-l segundos] [-m megabytes] [-e exponente] [-s semilla]
+//             [-d carpeta]
+
+static const int TAMANOS[] = {32, 64, 128, 256, 512, 1024};
+static const int SEGUNDOS = 10;
+static const int MEGABYTES = 1024;
+static const double EXPONENTE = 1.5;
+static const unsigned SEMILLA = 1;
+
+// Por debajo de estos valores el ruido de la medida es mayor que el
+// crecimiento que se quiere ver.
+static const qint64 MINIMO_US = 2000;
+static const qint64 MINIMO_BYTES = 64*1024;
+
+// La búsqueda del menor tamaño con el fallo para cuando el intervalo es
+// menor que esta fracción del tamaño.
+static const int PRECISION_BISECCION = 32;
+
+static const char* CLAVES_PLANIFICADOR[NUM_PLANIFICADORES] = {
+  "profundidad", "escalada", "camino", "saltos", "giros"
+};
+
+/*
+ * MEMORIA
+ */
+
+// Todas las reservas pasan por aquí para llevar la cuenta de la memoria en
+// uso y de su máximo. Los algoritmos se ejecutan en un solo hilo, así que no
+// hace falta sincronizar. Si hay límite y se supera, la reserva falla como
+// si no quedara memoria.
+static size_t memoria_actual = 0, memoria_pico = 0, memoria_limite = 0;
+
+// Cada bloque lleva delante su tamaño, en una cabecera que respeta la
+// alineación de malloc.
+static const size_t CABECERA = 16;
+
+static void* reservar(size_t n){
+  if(memoria_limite > 0 && memoria_actual + n > memoria_limite)
+    return NULL;
+  char* p = static_cast<char*>(std::malloc(n + CABECERA));
+  if(!p)
+    return NULL;
+  *reinterpret_cast<size_t*>(p) = n;
+  memoria_actual += n;
+  if(memoria_actual > memoria_pico)
+    memoria_pico = memoria_actual;
+  return p + CABECERA;
+}
+
+static void liberar(void* p){
+  if(!p)
+    return;
+  char* bloque = static_cast<char*>(p) - CABECERA;
+  memoria_actual -= *reinterpret_cast<size_t*>(bloque);
+  std::free(bloque);
+}
+
+void* operator new(size_t n){
+  void* p = reservar(n);
+  if(!p)
+    throw std::bad_alloc();
+  return p;
+}
+
+void* operator new[](size_t n){
+  void* p = reservar(n);
+  if(!p)
+    throw std::bad_alloc();
+  return p;
+}
+
+void* operator new(size_t n, const std::nothrow_t&) throw() { return reservar(n); }
+void* operator new[](size_t n, const std::nothrow_t&) throw() { return reservar(n); }
+void operator delete(void* p) throw() { liberar(p); }
+void operator delete[](void* p) throw() { liberar(p); }
+void operator delete(void* p, const std::nothrow_t&) throw() { liberar(p); }
+void operator delete[](void* p, const std::nothrow_t&) throw() { liberar(p); }
+
+/*
+ * PROCESO HIJO
+ */
+
+// Ejecuta un algoritmo sobre una forma y escribe "estado tiempo_us memoria
+// movimientos". La memoria es la que reserva el algoritmo por encima de la
+// que ya ocupa el jardín.
+static int ejecutar(const QStringList& args, QTextStream& salida){
+  if(args.size() != 5)
+    return 1;
+  FormaEstres forma = static_cast<FormaEstres>(args[0].toInt());
+  int tamano = args[1].toInt();
+  Planificador p = static_cast<Planificador>(args[2].toInt());
+  unsigned semilla = args[3].toUInt();
+  size_t megas = args[4].toUInt();
+
+  Posicion a, b;
+  Jardin jardin = jardin_estres(forma, tamano, semilla, a, b);
+
+  // Lo que se espera de cada algoritmo: que corte todo el césped al que se
+  // puede llegar desde el inicio o que llegue a B si hay camino
+  std::vector<int> dist;
+  jardin.distancias(es_cobertura(p)? Posicion(0, 0) : a, dist);
+  bool posible = dist[jardin.indice(b.fila, b.columna)] >= 0;
+  int alcanzables = 0;
+  for(int c = 0; c < jardin.celdas(); ++c){
+    Posicion q = jardin.posicion(c);
+    alcanzables += dist[c] >= 0 && jardin.transitable(q.fila, q.columna);
+  }
+  dist = std::vector<int>();
+
+  MedidaEstres medida;
+  size_t base = memoria_actual;
+  memoria_pico = base;
+  memoria_limite = base + megas*1024*1024;
+  QElapsedTimer reloj;
+  reloj.start();
+  try{
+    Resultado res = ejecutar_planificador(p, jardin, a, b);
+    medida.tiempo_us = reloj.nsecsElapsed()/1000;
+    medida.movimientos = res.movimientos;
+    bool bien = es_cobertura(p)? res.exito && res.cortadas >= alcanzables : res.exito == posible;
+    medida.estado = bien? ESTRES_BIEN : ESTRES_FALLO;
+  }
+  catch(const std::bad_alloc&){
+    medida.tiempo_us = reloj.nsecsElapsed()/1000;
+    medida.estado = ESTRES_MEMORIA;
+  }
+  memoria_limite = 0;
+  medida.memoria = memoria_pico - base;
+
+  salida << medida.estado << " " << medida.tiempo_us << " " << medida.memoria << " "
+         << medida.movimientos << "\n";
+  return 0;
+}
+
+/*
+ * PROCESO PADRE
+ */
+
+struct Limites {
+  int segundos, megabytes;
+  unsigned semilla;
+};
+
+static MedidaEstres medir(FormaEstres forma, Planificador p, int tamano, const Limites& limites){
+  MedidaEstres medida;
+  medida.tamano = tamano;
+  medida.estado = ESTRES_ERROR;
+
+  QProcess proceso;
+  proceso.start(QCoreApplication::applicationFilePath(), QStringList() << "--ejecutar"
+                << QString::number(forma) << QString::number(tamano) << QString::number(p)
+                << QString::number(limites.semilla) << QString::number(limites.megabytes));
+  if(!proceso.waitForStarted())
+    return medida;
+  if(!proceso.waitForFinished(limites.segundos*1000)){
+    proceso.kill();
+    proceso.waitForFinished();
+    medida.estado = ESTRES_TIEMPO;
+    medida.tiempo_us = limites.segundos*1000000LL;
+    return medida;
+  }
+  if(proceso.exitStatus() != QProcess::NormalExit || proceso.exitCode() != 0)
+    return medida;
+
+  QStringList campos = QString::fromUtf8(proceso.readAllStandardOutput()).simplified().split(" ");
+  if(campos.size() != 4)
+    return medida;
+  medida.estado = static_cast<EstadoEstres>(campos[0].toInt());
+  medida.tiempo_us = campos[1].toLongLong();
+  medida.memoria = campos[2].toLongLong();
+  medida.movimientos = campos[3].toInt();
+  return medida;
+}
+
+// Busca por bisección el menor tamaño entre "bueno" y "malo" en el que el
+// algoritmo tampoco termina bien.
+static int menor_fallo(FormaEstres forma, Planificador p, int bueno, int malo,
+                       const Limites& limites){
+  while(malo - bueno > 1 && malo - bueno > malo/PRECISION_BISECCION){
+    int medio = (bueno + malo)/2;
+    if(medir(forma, p, medio, limites).estado == ESTRES_BIEN)
+      bueno = medio;
+    else
+      malo = medio;
+  }
+  return malo;
+}
+
+static bool guardar(const SerieEstres& serie, int tamano, const Limites& limites,
+                    const QString& carpeta, QString& fichero){
+  DatosJardin datos;
+  Posicion a, b;
+  datos.jardin = jardin_estres(serie.forma, tamano, limites.semilla, a, b);
+  datos.ini_x = a.columna;
+  datos.ini_y = a.fila;
+  datos.fin_x = b.columna;
+  datos.fin_y = b.fila;
+
+  fichero = QDir(carpeta).filePath(QString("estres-%1-%2-%3.garden")
+                                   .arg(clave_forma_estres(serie.forma))
+                                   .arg(CLAVES_PLANIFICADOR[serie.planificador]).arg(tamano));
+  QFile out(fichero);
+  QByteArray buffer = codificar_jardin(datos);
+  return out.open(QIODevice::WriteOnly) && out.write(buffer) == buffer.size();
+}
+
+static bool lista(const QString& texto, std::vector<int>& valores){
+  QStringList partes = texto.split(",");
+  valores.clear();
+  for(int i = 0; i < partes.size(); ++i){
+    bool ok;
+    int v = partes[i].toInt(&ok);
+    if(!ok || v <= 0)
+      return false;
+    valores.push_back(v);
+  }
+  return !valores.empty();
+}
+
+int main(int argc, char *argv[])
+{
+  QCoreApplication a(argc, argv);
+  QStringList args = a.arguments();
+  QTextStream salida(stdout), error(stderr);
+
+  if(args.size() > 1 && args[1] == "--ejecutar")
+    return ejecutar(args.mid(2), salida);
+
+  std::vector<int> tamanos(TAMANOS, TAMANOS + sizeof(TAMANOS)/sizeof(int));
+  Limites limites;
+  limites.segundos = SEGUNDOS;
+  limites.megabytes = MEGABYTES;
+  limites.semilla = SEMILLA;
+  double exponente = EXPONENTE;
+  QString carpeta = ".";
+
+  for(int i = 1; i < args.size(); ++i){
+    bool ok = i + 1 < args.size();
+    QString valor = ok? args[i+1] : QString();
+    if(args[i] == "-t")
+      ok = ok && lista(valor, tamanos);
+    else if(args[i] == "-l"){
+      limites.segundos = valor.toInt(&ok);
+      ok = ok && limites.segundos > 0;
+    }
+    else if(args[i] == "-m"){
+      limites.megabytes = valor.toInt(&ok);
+      ok = ok && limites.megabytes > 0;
+    }
+    else if(args[i] == "-e"){
+      exponente = valor.toDouble(&ok);
+      ok = ok && exponente > 0;
+    }
+    else if(args[i] == "-s")
+      limites.semilla = valor.toUInt(&ok);
+    else if(args[i] == "-d")
+      carpeta = valor;
+    else
+      ok = false;
+
+    if(!ok){
+      error << "Uso: ia-estres [-t 32,64,...] [-l segundos] [-m megabytes] [-e exponente] "
+               "[-s semilla] [-d carpeta]\n";
+      return 1;
+    }
+    ++i;
+  }
+  std::sort(tamanos.begin(), tamanos.end());
+
+  std::vector<SerieEstres> series;
+  int problemas = 0;
+  for(int f = 0; f < NUM_FORMAS_ESTRES; ++f)
+    for(int p = 0; p < NUM_PLANIFICADORES; ++p){
+      SerieEstres serie;
+      serie.forma = static_cast<FormaEstres>(f);
+      serie.planificador = static_cast<Planificador>(p);
+      error << nombre_forma_estres(serie.forma) << ", "
+            << nombre_planificador(serie.planificador) << ":";
+      error.flush();
+
+      // Tras pasarse de tiempo o de memoria no tiene sentido seguir creciendo
+      for(unsigned t = 0; t < tamanos.size(); ++t){
+        MedidaEstres medida = medir(serie.forma, serie.planificador, tamanos[t], limites);
+        serie.medidas.push_back(medida);
+        error << " " << tamanos[t];
+        error.flush();
+        if(medida.estado == ESTRES_TIEMPO || medida.estado == ESTRES_MEMORIA)
+          break;
+      }
+      error << "\n";
+
+      analizar_serie(serie, exponente, MINIMO_US, MINIMO_BYTES);
+      if(serie.problema >= 0){
+        ++problemas;
+        const MedidaEstres& medida = serie.medidas[serie.problema];
+        int tamano = medida.tamano;
+        if(medida.estado != ESTRES_BIEN){
+          int bueno = serie.problema > 0? serie.medidas[serie.problema - 1].tamano : 0;
+          tamano = menor_fallo(serie.forma, serie.planificador, bueno, tamano, limites);
+          if(tamano != medida.tamano)
+            serie.motivo += QString("; también falla con %1x%1").arg(tamano);
+        }
+        if(!guardar(serie, tamano, limites, carpeta, serie.fichero)){
+          error << "No se ha podido guardar el jardín en " << serie.fichero << "\n";
+          serie.fichero.clear();
+        }
+      }
+      series.push_back(serie);
+    }
+
+  salida << texto_estres(series);
+  return problemas > 0? 3 : 0;
+}
@@ -0,0 +1,75 @@
+#include <cstdio>
+
+#include <QCoreApplication>
+#include <QStringList>
+#include <QTextStream>
+
+#include "historial.h"
+
+// Consulta el historial de las pruebas: para cada jardín y algoritmo escribe
+// cuántas veces se ha ejecutado, la mejor ejecución y las últimas. Con -r
+// termina con código 3 si la última ejecución de alguno empeoró frente a la
+// mejor anterior, para poder usarlo en scripts.
+//
+//   ia-historial [-f fichero] [-j huella] [-n ultimas] [-r]
+
+static const int ULTIMAS = 5;
+
+int main(int argc, char *argv[])
+{
+  QCoreApplication a(argc, argv);
+  QStringList args = a.arguments();
+  QTextStream salida(stdout), error(stderr);
+  QString fichero = fichero_historial();
+  unsigned huella = 0;
+  int ultimas = ULTIMAS;
+  bool regresiones = false;
+
+  bool ok = true;
+  for(int i = 1; ok && i < args.size(); ++i){
+    if(args[i] == "-f" && i + 1 < args.size())
+      fichero = args[++i];
+    else if(args[i] == "-j" && i + 1 < args.size())
+      huella = args[++i].toUInt(&ok, 16);
+    else if(args[i] == "-n" && i + 1 < args.size())
+      ultimas = args[++i].toInt(&ok);
+    else if(args[i] == "-r")
+      regresiones = true;
+    else
+      ok = false;
+  }
+  if(!ok || ultimas <= 0){
+    error << "Uso: ia-historial [-f fichero] [-j huella] [-n ultimas] [-r]\n";
+    return 1;
+  }
+
+  std::vector<EjecucionHistorial> historial;
+  if(!leer_historial(fichero, historial)){
+    error << "No se ha podido leer el historial de " << fichero << "\n";
+    return 2;
+  }
+  salida << texto_tendencias(historial, huella, ultimas);
+  if(!regresiones)
+    return 0;
+
+  // La última ejecución de cada jardín y algoritmo frente a las anteriores
+  std::vector<ComparacionHistorial> ultimas_regresiones;
+  for(unsigned i = 0; i < historial.size(); ++i){
+    const EjecucionHistorial& e = historial[i];
+    bool ultima = huella == 0 || e.huella == huella;
+    for(unsigned j = i + 1; ultima && j < historial.size(); ++j)
+      ultima = historial[j].huella != e.huella || historial[j].algoritmo != e.algoritmo;
+    if(!ultima)
+      continue;
+
+    std::vector<EjecucionHistorial> anteriores(historial.begin(), historial.begin() + i);
+    ComparacionHistorial c = comparar_ejecucion(anteriores, e);
+    if(c.regresion)
+      ultimas_regresiones.push_back(c);
+  }
+
+  if(ultimas_regresiones.empty())
+    return 0;
+  salida << "\nRegresiones en la última ejecución:\n" << texto_comparaciones(ultimas_regresiones);
+  return 3;
+}
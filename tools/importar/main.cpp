@@ -0,0 +1,103 @@
+#include <cstdio>
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QStringList>
+#include <QTextStream>
+
+#include "archivo.h"
+#include "imagen.h"
+
+// Convierte una imagen PGM en un fichero .garden sin abrir la interfaz e
+// indica cuánto ha tardado. La imagen se lee fila a fila, así que sirve para
+// planos de muchos megapíxeles. Los PNG y demás formatos sólo se pueden
+// importar desde la interfaz, que es la que usa QtGui.
+//
+//   ia-importar [-u umbral] [-e escala] [-p porcentaje] [-i] imagen.pgm [salida.garden]
+
+int main(int argc, char *argv[])
+{
+  QCoreApplication a(argc, argv);
+  QStringList args = a.arguments();
+  QTextStream salida(stdout), error(stderr);
+  OpcionesImagen opciones;
+  QStringList ficheros;
+
+  for(int i = 1; i < args.size(); ++i){
+    bool ok = true;
+    if(args[i] == "-i")
+      opciones.invertir = true;
+    else if(args[i] == "-u" || args[i] == "-e" || args[i] == "-p"){
+      ok = i + 1 < args.size();
+      int valor = ok? args[++i].toInt(&ok) : 0;
+      if(args[i-1] == "-u")
+        opciones.umbral = valor;
+      else if(args[i-1] == "-e")
+        opciones.escala = valor;
+      else
+        opciones.porcentaje = valor;
+      ok = ok && valor >= 0 && (args[i-1] != "-e" || valor > 0);
+    }
+    else
+      ficheros << args[i];
+
+    if(!ok || ficheros.size() > 2){
+      ficheros.clear();
+      break;
+    }
+  }
+  if(ficheros.isEmpty()){
+    error << "Uso: ia-importar [-u umbral] [-e escala] [-p porcentaje] [-i] imagen.pgm "
+             "[salida.garden]\n";
+    return 1;
+  }
+
+  QElapsedTimer reloj;
+  reloj.start();
+  QString motivo;
+  LectorImagen* lector = abrir_imagen(ficheros[0], motivo);
+  if(!lector){
+    error << "No se ha podido importar " << ficheros[0] << ": " << motivo << "\n";
+    return 1;
+  }
+
+  DatosJardin datos;
+  int ancho = lector->ancho(), alto = lector->alto();
+  bool importada = importar_imagen(*lector, opciones, datos.jardin, motivo);
+  delete lector;
+  if(!importada){
+    error << "No se ha podido importar " << ficheros[0] << ": " << motivo << "\n";
+    return 1;
+  }
+  qint64 importar_us = reloj.nsecsElapsed()/1000;
+
+  const Jardin& jardin = datos.jardin;
+  qint64 obstaculos = 0;
+  for(int i = 0; i < jardin.filas(); ++i)
+    for(int j = 0; j < jardin.columnas(); ++j)
+      obstaculos += jardin.tipo(i, j) == OBSTACULO;
+
+  salida << "Imagen de " << ancho << "x" << alto << " píxeles\n";
+  salida << "Jardín de " << jardin.filas() << "x" << jardin.columnas() << " ("
+         << opciones.escala << "x" << opciones.escala << " píxeles por celda), "
+         << obstaculos << " obstáculos ("
+         << QString::number(obstaculos*100.0/jardin.celdas(), 'f', 1) << "%)\n";
+  salida << "Importar: " << QString::number(importar_us/1000.0, 'f', 1) << "ms ("
+         << QString::number(importar_us > 0? static_cast<double>(ancho)*alto/importar_us : 0, 'f', 1)
+         << " megapíxeles por segundo)\n";
+
+  if(ficheros.size() < 2)
+    return 0;
+
+  reloj.start();
+  QFile out(ficheros[1]);
+  QByteArray buffer = codificar_jardin(datos);
+  if(!out.open(QIODevice::WriteOnly) || out.write(buffer) != buffer.size()){
+    error << "No se ha podido guardar el jardín en " << ficheros[1] << "\n";
+    return 2;
+  }
+  out.close();
+  salida << "Guardar: " << QString::number(reloj.nsecsElapsed()/1000000.0, 'f', 1) << "ms\n";
+  return 0;
+}
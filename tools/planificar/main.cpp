@@ -0,0 +1,144 @@
+#include <cstdio>
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QStringList>
+#include <QTextStream>
+
+#include "archivo.h"
+#include "giros.h"
+#include "historial.h"
+#include "planificadores.h"
+
+// Ejecuta los planificadores sobre ficheros .garden sin abrir la interfaz y
+// escribe los resultados con el mismo formato que las pruebas. Con -h las
+// ejecuciones se añaden además al historial de las pruebas y se comparan con
+// las anteriores en el mismo jardín.
+//
+//   ia-planificar [-h] fichero.garden...
+
+static QString texto_resultado(const QString& nombre, const Resultado& res, qint64 ns){
+  QString texto = "-" + nombre + "\n";
+  texto += "  Iteraciones: " + QString::number(res.movimientos) + "\n";
+  texto += "  Giros: " + QString::number(res.giros) + "\n";
+  texto += "  Coste del terreno: " + QString::number(res.coste) + "\n";
+  if(res.cesped > 0)
+    texto += "  Césped cortado: " + QString::number(res.cortadas) + " de " +
+             QString::number(res.cesped) + "\n";
+  if(res.expandidas > 0)
+    texto += "  Celdas expandidas: " + QString::number(res.expandidas) + "\n";
+  texto += QString("  Éxito: ") + (res.exito? "sí" : "no") + "\n";
+  texto += "  Tiempo: " + QString::number(ns/1000.0, 'f', 1) + "us\n";
+  return texto;
+}
+
+static void anotar(std::vector<EjecucionHistorial>* ejecuciones, const Jardin& jardin,
+                   const QString& algoritmo, const Resultado& res, qint64 ns){
+  if(!ejecuciones)
+    return;
+
+  EjecucionHistorial e;
+  e.fecha_ms = QDateTime::currentMSecsSinceEpoch();
+  e.huella = jardin.huella();
+  e.filas = jardin.filas();
+  e.columnas = jardin.columnas();
+  e.compilacion = id_compilacion();
+  e.algoritmo = algoritmo;
+  e.movimientos = res.movimientos;
+  e.coste = res.coste;
+  e.cortado = res.cesped > 0? (res.cortadas*100)/static_cast<double>(res.cesped) : 0;
+  e.fases.push_back(FaseEjecucion("planificar", ns/1000));
+  ejecuciones->push_back(e);
+}
+
+static QString planificar(const DatosJardin& datos, std::vector<EjecucionHistorial>* ejecuciones){
+  const Jardin& jardin = datos.jardin;
+  QString texto = QString("Jardín de %1x%2\n").arg(jardin.filas()).arg(jardin.columnas());
+  QElapsedTimer reloj;
+  qint64 ns;
+
+  reloj.start();
+  Resultado res = cobertura_profundidad(jardin, Posicion(0, 0));
+  ns = reloj.nsecsElapsed();
+  texto += texto_resultado("Cortar todo el césped (profundidad)", res, ns);
+  anotar(ejecuciones, jardin, "profundidad", res, ns);
+
+  reloj.start();
+  res = cobertura_saltos(jardin, Posicion(0, 0));
+  ns = reloj.nsecsElapsed();
+  texto += texto_resultado("Cortar todo el césped (con saltos)", res, ns);
+  anotar(ejecuciones, jardin, "saltos", res, ns);
+
+  reloj.start();
+  res = cobertura_giros(jardin, Posicion(0, 0));
+  ns = reloj.nsecsElapsed();
+  texto += texto_resultado("Cortar todo el césped (minimizando giros)", res, ns);
+  anotar(ejecuciones, jardin, "giros", res, ns);
+
+  if(datos.ini_x < 0 || datos.fin_x < 0)
+    return texto;
+
+  Posicion origen(datos.ini_y, datos.ini_x), destino(datos.fin_y, datos.fin_x);
+  reloj.start();
+  res = escalada(jardin, origen, destino);
+  ns = reloj.nsecsElapsed();
+  texto += texto_resultado("Camino entre 2 puntos (escalada)", res, ns);
+  anotar(ejecuciones, jardin, "escalada", res, ns);
+
+  reloj.start();
+  res = camino_minimo(jardin, origen, destino);
+  ns = reloj.nsecsElapsed();
+  texto += texto_resultado("Camino entre 2 puntos (anchura)", res, ns);
+  anotar(ejecuciones, jardin, "anchura", res, ns);
+  return texto;
+}
+
+int main(int argc, char *argv[])
+{
+  QCoreApplication a(argc, argv);
+  QStringList args = a.arguments();
+  QTextStream salida(stdout), error(stderr);
+  int errores = 0, primero = 1;
+  bool guardar = args.size() >= 2 && args[1] == "-h";
+  std::vector<EjecucionHistorial> historial;
+
+  if(guardar)
+    ++primero;
+  if(args.size() <= primero){
+    error << "Uso: ia-planificar [-h] fichero.garden...\n";
+    return 1;
+  }
+  if(guardar && !leer_historial(fichero_historial(), historial)){
+    error << "No se ha podido leer el historial de " << fichero_historial() << "\n";
+    return 1;
+  }
+
+  for(int i = primero; i < args.size(); ++i){
+    QFile f(args[i]);
+    DatosJardin datos;
+    std::vector<EjecucionHistorial> ejecuciones;
+    if(!f.open(QIODevice::ReadOnly) || !decodificar_jardin(f.readAll(), datos)){
+      error << "No se ha podido leer el jardín " << args[i] << "\n";
+      ++errores;
+      continue;
+    }
+    salida << "---===" << args[i] << "===---\n\n"
+           << planificar(datos, guardar? &ejecuciones : NULL) << "\n";
+    if(!guardar)
+      continue;
+
+    std::vector<ComparacionHistorial> comparaciones;
+    for(unsigned j = 0; j < ejecuciones.size(); ++j)
+      comparaciones.push_back(comparar_ejecucion(historial, ejecuciones[j]));
+    salida << "Historial:\n" << texto_comparaciones(comparaciones) << "\n";
+    if(!anadir_historial(fichero_historial(), ejecuciones)){
+      error << "No se ha podido guardar en " << fichero_historial() << "\n";
+      ++errores;
+    }
+    historial.insert(historial.end(), ejecuciones.begin(), ejecuciones.end());
+  }
+
+  return errores > 0? 2 : 0;
+}
@@ -0,0 +1,194 @@
+#include <algorithm>
+#include <cstdio>
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QStringList>
+#include <QTextStream>
+#include <QThreadPool>
+
+#include "aleatorio.h"
+#include "archivo.h"
+#include "servidor.h"
+
+// Servicio de planificación para otros procesos de la misma máquina.
+//
+//   ia-servicio [-s nombre] [-c jardines] [-h hilos]
+//   ia-servicio [-s nombre] --carga fichero.garden peticiones
+//
+// La segunda forma es un cliente de prueba: pide caminos entre celdas de
+// césped al azar sobre el jardín del fichero y mide el servicio.
+
+static const char* NOMBRE = "ia-planificacion";
+static const int CACHE = 16;
+
+// Peticiones de la carga que se envían sin esperar respuesta y orígenes
+// distintos entre los que se reparten, como las bases de varias cortadoras.
+static const int EN_VUELO = 256;
+static const int ORIGENES_CARGA = 8;
+static const int ESPERA_MS = 30000;
+
+static QString texto_medidas(const MedidasServicio& m){
+  return QString("Atendidas: %1, en cola: %2, p50: %3us, p99: %4us, por segundo: %5, jardines: %6\n")
+         .arg(m.atendidas).arg(m.en_cola).arg(m.p50_us, 0, 'f', 1).arg(m.p99_us, 0, 'f', 1)
+         .arg(m.por_segundo, 0, 'f', 1).arg(m.jardines);
+}
+
+static bool enviar(QLocalSocket& socket, const PeticionPlan& peticion){
+  return socket.write(enmarcar(codificar_peticion(peticion))) >= 0;
+}
+
+static bool recibir(QLocalSocket& socket, QByteArray& buffer, RespuestaPlan& respuesta){
+  QByteArray mensaje;
+  int leido;
+  while((leido = extraer_mensaje(buffer, mensaje)) == 0){
+    if(!socket.waitForReadyRead(ESPERA_MS))
+      return false;
+    buffer += socket.readAll();
+  }
+  return leido > 0 && decodificar_respuesta(mensaje, respuesta);
+}
+
+static int carga(const QString& nombre, const QString& fichero, int peticiones){
+  QTextStream salida(stdout), error(stderr);
+  QFile f(fichero);
+  DatosJardin datos;
+  if(!f.open(QIODevice::ReadOnly) || !decodificar_jardin(f.readAll(), datos)){
+    error << "No se ha podido leer el jardín " << fichero << "\n";
+    return 2;
+  }
+
+  const Jardin& jardin = datos.jardin;
+  std::vector<Posicion> cesped;
+  for(int i = 0; i < jardin.filas(); ++i)
+    for(int j = 0; j < jardin.columnas(); ++j)
+      if(jardin.transitable(i, j))
+        cesped.push_back(Posicion(i, j));
+  if(cesped.empty()){
+    error << "El jardín no tiene césped\n";
+    return 2;
+  }
+
+  QLocalSocket socket;
+  socket.connectToServer(nombre);
+  if(!socket.waitForConnected(ESPERA_MS)){
+    error << "No se ha podido conectar con " << nombre << "\n";
+    return 2;
+  }
+
+  // La primera petición hace que el servicio lea el fichero y devuelve la
+  // huella con la que se piden las demás
+  QByteArray buffer;
+  RespuestaPlan respuesta;
+  PeticionPlan peticion;
+  peticion.operacion = PLAN_CAMINO;
+  peticion.fuente = JARDIN_FICHERO;
+  peticion.jardin = QFileInfo(fichero).absoluteFilePath().toUtf8();
+  peticion.origen = peticion.destino = cesped[0];
+  if(!enviar(socket, peticion) || !recibir(socket, buffer, respuesta) ||
+     respuesta.estado != PLAN_HECHO){
+    error << "El servicio no ha podido leer el jardín\n";
+    return 2;
+  }
+
+  Aleatorio aleatorio;
+  std::vector<Posicion> origenes;
+  for(int i = 0; i < ORIGENES_CARGA; ++i)
+    origenes.push_back(cesped[aleatorio.entero(cesped.size())]);
+
+  std::vector<qint64> enviada(peticiones), latencias;
+  QElapsedTimer reloj;
+  reloj.start();
+  int enviadas = 0, recibidas = 0, fallos = 0;
+
+  peticion.fuente = JARDIN_HUELLA;
+  peticion.huella = respuesta.huella;
+  peticion.jardin.clear();
+  while(recibidas < peticiones){
+    for(; enviadas < peticiones && enviadas - recibidas < EN_VUELO; ++enviadas){
+      peticion.id = enviadas;
+      peticion.origen = origenes[aleatorio.entero(origenes.size())];
+      peticion.destino = cesped[aleatorio.entero(cesped.size())];
+      enviada[enviadas] = reloj.nsecsElapsed();
+      enviar(socket, peticion);
+    }
+    socket.flush();
+
+    if(!recibir(socket, buffer, respuesta) || respuesta.id < 0 || respuesta.id >= peticiones){
+      error << "Se ha perdido la conexión con el servicio\n";
+      return 2;
+    }
+    latencias.push_back(reloj.nsecsElapsed() - enviada[respuesta.id]);
+    if(respuesta.estado != PLAN_HECHO || !respuesta.resultado.exito)
+      ++fallos;
+    ++recibidas;
+  }
+  qint64 total = reloj.nsecsElapsed();
+
+  std::sort(latencias.begin(), latencias.end());
+  salida << "---===CARGA DEL SERVICIO===---\n\n";
+  salida << "Peticiones: " << peticiones << ", sin camino o con error: " << fallos << "\n";
+  salida << "Latencia en el cliente: p50 " << QString::number(latencias[latencias.size()/2]/1000.0, 'f', 1)
+         << "us, p99 " << QString::number(latencias[latencias.size()*99/100]/1000.0, 'f', 1) << "us\n";
+  salida << "Peticiones por segundo: " << QString::number(peticiones*1e9/std::max(total, 1LL), 'f', 1) << "\n";
+
+  peticion.operacion = PLAN_ESTADISTICAS;
+  if(enviar(socket, peticion) && recibir(socket, buffer, respuesta) && respuesta.estado == PLAN_HECHO)
+    salida << "Servicio: " << texto_medidas(respuesta.medidas);
+  return 0;
+}
+
+int main(int argc, char *argv[])
+{
+  QCoreApplication a(argc, argv);
+  QStringList args = a.arguments();
+  QTextStream salida(stdout), error(stderr);
+  QString nombre = NOMBRE, fichero;
+  int cache = CACHE, hilos = 0, peticiones = 0;
+
+  for(int i = 1; i < args.size(); ++i){
+    bool ok = i + 1 < args.size();
+    QString valor = ok? args[i+1] : QString();
+    if(args[i] == "-s")
+      nombre = valor;
+    else if(args[i] == "-c")
+      cache = valor.toInt(&ok);
+    else if(args[i] == "-h")
+      hilos = valor.toInt(&ok);
+    else if(args[i] == "--carga" && i + 2 < args.size()){
+      fichero = valor;
+      peticiones = args[i+2].toInt(&ok);
+      ok = ok && peticiones > 0;
+      ++i;
+    }
+    else
+      ok = false;
+
+    if(!ok || cache <= 0 || hilos < 0){
+      error << "Uso: ia-servicio [-s nombre] [-c jardines] [-h hilos]\n"
+               "     ia-servicio [-s nombre] --carga fichero.garden peticiones\n";
+      return 1;
+    }
+    ++i;
+  }
+
+  if(!fichero.isEmpty())
+    return carga(nombre, fichero, peticiones);
+
+  if(hilos > 0)
+    QThreadPool::globalInstance()->setMaxThreadCount(hilos);
+
+  ServidorPlanificacion servidor(cache);
+  if(!servidor.escuchar(nombre)){
+    error << "No se ha podido escuchar en " << nombre << ": " << servidor.error() << "\n";
+    return 2;
+  }
+  salida << "Escuchando en " << nombre << " con "
+         << QThreadPool::globalInstance()->maxThreadCount() << " hilos\n";
+  salida.flush();
+
+  return a.exec();
+}
@@ -0,0 +1,175 @@
+#include "servidor.h"
+
+#include <cstdio>
+
+#include <QTextStream>
+#include <QtConcurrentMap>
+
+// Cada cuánto se escriben las medidas en la salida estándar si ha habido
+// peticiones desde la última vez.
+static const int INFORME_MS = 5000;
+
+ServidorPlanificacion::ServidorPlanificacion(int capacidad_cache, QObject* parent):
+  QObject(parent), cache(capacidad_cache), ocupado(false), despacho_programado(false),
+  ultimas_atendidas(0)
+{
+  reloj.start();
+  connect(&servidor, SIGNAL(newConnection()), this, SLOT(nueva_conexion()));
+  connect(&tanda, SIGNAL(finished()), this, SLOT(tanda_terminada()));
+  connect(&temporizador, SIGNAL(timeout()), this, SLOT(informar()));
+  temporizador.start(INFORME_MS);
+}
+
+// Si quedó el socket de una ejecución anterior que terminó mal se borra.
+bool ServidorPlanificacion::escuchar(const QString& nombre){
+  QLocalServer::removeServer(nombre);
+  return servidor.listen(nombre);
+}
+
+MedidasServicio ServidorPlanificacion::medidas() const {
+  return medidor.medidas(reloj.nsecsElapsed(), cola.size() + en_curso.size(), cache.jardines());
+}
+
+void ServidorPlanificacion::nueva_conexion(){
+  while(servidor.hasPendingConnections()){
+    QLocalSocket* socket = servidor.nextPendingConnection();
+    buffers[socket] = QByteArray();
+    connect(socket, SIGNAL(readyRead()), this, SLOT(leer()));
+    connect(socket, SIGNAL(disconnected()), this, SLOT(desconectado()));
+  }
+}
+
+// Las estadísticas se responden en cuanto llegan; el resto de peticiones
+// esperan en la cola al siguiente despacho. Si llega un mensaje que no se
+// puede entender se responde con el error, y si lo que no se entiende es la
+// longitud se cierra la conexión.
+void ServidorPlanificacion::leer(){
+  QLocalSocket* socket = qobject_cast<QLocalSocket*>(sender());
+  if(!socket || !buffers.contains(socket))
+    return;
+
+  QByteArray& buffer = buffers[socket];
+  buffer += socket->readAll();
+
+  QByteArray mensaje;
+  int leido;
+  while((leido = extraer_mensaje(buffer, mensaje)) > 0){
+    Pendiente pendiente;
+    pendiente.socket = socket;
+    pendiente.llegada = reloj.nsecsElapsed();
+
+    if(!decodificar_peticion(mensaje, pendiente.peticion)){
+      RespuestaPlan respuesta;
+      respuesta.estado = PLAN_MAL_FORMADA;
+      responder(pendiente, respuesta);
+      continue;
+    }
+    if(pendiente.peticion.operacion == PLAN_ESTADISTICAS){
+      RespuestaPlan respuesta;
+      respuesta.id = pendiente.peticion.id;
+      respuesta.operacion = PLAN_ESTADISTICAS;
+      respuesta.medidas = medidas();
+      responder(pendiente, respuesta);
+      continue;
+    }
+    cola.push_back(pendiente);
+  }
+
+  if(leido < 0){
+    buffers.remove(socket);
+    socket->abort();
+    socket->deleteLater();
+  }
+  programar_despacho();
+}
+
+void ServidorPlanificacion::desconectado(){
+  QLocalSocket* socket = qobject_cast<QLocalSocket*>(sender());
+  if(!socket)
+    return;
+  buffers.remove(socket);
+  socket->deleteLater();
+}
+
+// El despacho se hace cuando vuelve el bucle de eventos, para que entren en
+// la misma tanda las peticiones que ya han llegado por todas las conexiones.
+void ServidorPlanificacion::programar_despacho(){
+  if(ocupado || despacho_programado || cola.empty())
+    return;
+  despacho_programado = true;
+  QTimer::singleShot(0, this, SLOT(despachar()));
+}
+
+// Los jardines se buscan en la caché desde este hilo, que es el único que
+// la toca; los lotes sólo leen los jardines que se les dan.
+void ServidorPlanificacion::despachar(){
+  despacho_programado = false;
+  if(ocupado || cola.empty())
+    return;
+
+  en_curso.clear();
+  en_curso.swap(cola);
+  lotes.clear();
+  IndiceLotes indices;
+
+  for(unsigned i = 0; i < en_curso.size(); ++i){
+    const PeticionPlan& peticion = en_curso[i].peticion;
+    unsigned huella = 0;
+    QSharedPointer<const Jardin> jardin = cache.jardin(peticion, huella);
+    if(jardin.isNull()){
+      RespuestaPlan respuesta;
+      respuesta.id = peticion.id;
+      respuesta.operacion = peticion.operacion;
+      respuesta.huella = huella;
+      respuesta.estado = PLAN_JARDIN_DESCONOCIDO;
+      responder(en_curso[i], respuesta);
+      continue;
+    }
+    agrupar_peticion(peticion, i, jardin, huella, lotes, indices);
+  }
+
+  if(lotes.empty()){
+    en_curso.clear();
+    programar_despacho();
+    return;
+  }
+
+  ocupado = true;
+  tanda.setFuture(QtConcurrent::map(lotes, atender_lote));
+}
+
+void ServidorPlanificacion::tanda_terminada(){
+  for(unsigned i = 0; i < lotes.size(); ++i)
+    for(unsigned j = 0; j < lotes[i].respuestas.size(); ++j)
+      responder(en_curso[lotes[i].etiquetas[j]], lotes[i].respuestas[j]);
+
+  lotes.clear();
+  en_curso.clear();
+  ocupado = false;
+  programar_despacho();
+}
+
+// Las conexiones que se han cerrado mientras se atendía la petición se
+// saltan, pero la petición cuenta igualmente en las medidas. Las medidas son
+// sólo de las planificaciones resueltas: las estadísticas y los errores se
+// responden sin pasar por la cola y falsearían las latencias.
+void ServidorPlanificacion::responder(const Pendiente& pendiente, const RespuestaPlan& respuesta){
+  if(pendiente.socket)
+    pendiente.socket->write(enmarcar(codificar_respuesta(respuesta)));
+  if(respuesta.estado == PLAN_HECHO && respuesta.operacion != PLAN_ESTADISTICAS)
+    medidor.anotar(pendiente.llegada, reloj.nsecsElapsed());
+}
+
+void ServidorPlanificacion::informar(){
+  MedidasServicio m = medidas();
+  if(m.atendidas == ultimas_atendidas)
+    return;
+  ultimas_atendidas = m.atendidas;
+
+  QTextStream salida(stdout);
+  salida << "Atendidas: " << m.atendidas << ", en cola: " << m.en_cola
+         << ", p50: " << QString::number(m.p50_us, 'f', 1) << "us"
+         << ", p99: " << QString::number(m.p99_us, 'f', 1) << "us"
+         << ", por segundo: " << QString::number(m.por_segundo, 'f', 1)
+         << ", jardines: " << m.jardines << "\n";
+}
@@ -0,0 +1,66 @@
+#ifndef SERVIDOR_H
+#define SERVIDOR_H
+
+#include <vector>
+
+#include <QElapsedTimer>
+#include <QFutureWatcher>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QMap>
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+
+#include "servicio.h"
+
+// Servidor de planificación sobre un socket local. Las peticiones que llegan
+// mientras se atiende una tanda se quedan en la cola; al terminar la tanda,
+// toda la cola se reparte en lotes por jardín, operación y origen, y los
+// lotes se atienden en paralelo en el grupo de hilos global.
+class ServidorPlanificacion: public QObject {
+  Q_OBJECT
+
+public:
+  explicit ServidorPlanificacion(int capacidad_cache, QObject* parent = 0);
+
+  bool escuchar(const QString& nombre);
+  QString error() const { return servidor.errorString(); }
+
+  MedidasServicio medidas() const;
+
+private slots:
+  void nueva_conexion();
+  void leer();
+  void desconectado();
+  void despachar();
+  void tanda_terminada();
+  void informar();
+
+private:
+  // Petición en la cola, con la conexión a la que hay que responder y el
+  // instante en el que llegó
+  struct Pendiente {
+    QPointer<QLocalSocket> socket;
+    PeticionPlan peticion;
+    qint64 llegada;
+  };
+
+  void responder(const Pendiente& pendiente, const RespuestaPlan& respuesta);
+  void programar_despacho();
+
+  QLocalServer servidor;
+  QMap<QLocalSocket*, QByteArray> buffers;
+  CacheJardines cache;
+  MedidorServicio medidor;
+  QElapsedTimer reloj;
+  QTimer temporizador;
+
+  std::vector<Pendiente> cola, en_curso;
+  std::vector<LotePlan> lotes;
+  QFutureWatcher<void> tanda;
+  bool ocupado, despacho_programado;
+  int ultimas_atendidas;
+};
+
+#endif // SERVIDOR_H
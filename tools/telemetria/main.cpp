@@ -0,0 +1,94 @@
+#include <cstdio>
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QTextStream>
+#include <QThread>
+
+#include "telemetria.h"
+
+// Consumidor de la telemetría de una simulación. Cada segundo escribe un
+// resumen con los registros recibidos, los perdidos y el último estado de la
+// cortadora; con -t escribe además cada registro.
+//
+//   ia-telemetria clave [-t] [-i ms] [-n segundos]
+
+static const int INTERVALO_MS = 50;
+static const int RESUMEN_MS = 1000;
+
+static const char* nombre_evento(EventoTelemetria evento){
+  switch(evento){
+  case TELEMETRIA_INICIO:
+    return "inicio";
+  case TELEMETRIA_FIN:
+    return "fin";
+  default:
+    return "movimiento";
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  QCoreApplication a(argc, argv);
+  QStringList args = a.arguments();
+  QTextStream salida(stdout), error(stderr);
+  bool todos = false;
+  int intervalo = INTERVALO_MS, segundos = 0;
+
+  bool ok = args.size() >= 2;
+  for(int i = 2; ok && i < args.size(); ++i){
+    if(args[i] == "-t")
+      todos = true;
+    else if(args[i] == "-i" && i + 1 < args.size())
+      intervalo = args[++i].toInt(&ok);
+    else if(args[i] == "-n" && i + 1 < args.size())
+      segundos = args[++i].toInt(&ok);
+    else
+      ok = false;
+  }
+  if(!ok || intervalo <= 0 || segundos < 0){
+    error << "Uso: ia-telemetria clave [-t] [-i ms] [-n segundos]\n";
+    return 1;
+  }
+
+  LectorTelemetria lector(args[1]);
+  std::vector<RegistroTelemetria> registros;
+  RegistroTelemetria ultimo;
+  QElapsedTimer total, resumen;
+  qint64 recibidos = 0, perdidos = 0;
+  total.start();
+  resumen.start();
+
+  while(segundos == 0 || total.elapsed() < segundos*1000LL){
+    QThread::msleep(intervalo);
+    if(!lector.conectar())
+      continue;
+
+    registros.clear();
+    lector.leer(registros);
+    for(unsigned i = 0; i < registros.size(); ++i){
+      const RegistroTelemetria& r = registros[i];
+      if(todos)
+        salida << r.secuencia << " " << nombre_evento(r.evento) << " " << r.tiempo_us << "us ("
+               << r.pos.fila << ", " << r.pos.columna << ") movimientos " << r.movimientos
+               << ", cortadas " << r.cortadas << ", paso " << r.paso_us << "us, agrupados "
+               << r.agrupados << "\n";
+      ultimo = r;
+    }
+    recibidos += registros.size();
+
+    if(resumen.elapsed() >= RESUMEN_MS){
+      salida << "Registros: " << recibidos << ", perdidos: " << lector.perdidos() - perdidos
+             << ", última posición: (" << ultimo.pos.fila << ", " << ultimo.pos.columna
+             << "), movimientos: " << ultimo.movimientos << ", cortadas: " << ultimo.cortadas
+             << "\n";
+      salida.flush();
+      recibidos = 0;
+      perdidos = lector.perdidos();
+      resumen.restart();
+    }
+  }
+
+  return 0;
+}
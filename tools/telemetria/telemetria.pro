@@ -0,0 +1,12 @@
+QT       += core
+QT       -= gui
+
+TARGET = ia-telemetria
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+
+NUCLEO = $$OUT_PWD/../../core
+include(../../core/nucleo.pri)
+
+SOURCES += main.cpp
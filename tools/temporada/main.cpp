@@ -0,0 +1,130 @@
+#include <cstdio>
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QStringList>
+#include <QTextStream>
+
+#include "archivo.h"
+#include "estres.h"
+#include "generador.h"
+#include "temporada.h"
+
+// Simula una temporada de cortes diarios en la que el césped vuelve a crecer
+// y muestra el informe día a día de cada estrategia del planificador, o sólo
+// de la elegida con -e. Sin fichero se genera un jardín con el generador -g,
+// que con 4 (parterres) incluye terrenos que crecen a distinto ritmo, o con
+// -f con una de las formas de las pruebas de estrés, de lado F. Termina con
+// código 3 si el recorrido completo deja fuera alguna celda alcanzable, como
+// pasaba con -f 4 cuando el inicio es el único paso entre las dos mitades.
+//
+//   ia-temporada [-d dias] [-p presupuesto] [-c crecimiento] [-e estrategia]
+//                [-g generador | -f forma] [-s semilla] [fichero.garden | FxC]
+
+static bool dimensiones(const QString& texto, int& filas, int& columnas){
+  QStringList partes = texto.split("x");
+  bool ok_f, ok_c;
+  if(partes.size() != 2)
+    return false;
+  filas = partes[0].toInt(&ok_f);
+  columnas = partes[1].toInt(&ok_c);
+  return ok_f && ok_c;
+}
+
+int main(int argc, char *argv[])
+{
+  QCoreApplication a(argc, argv);
+  QStringList args = a.arguments();
+  QTextStream salida(stdout), error(stderr);
+  ConfiguracionTemporada config;
+  int estrategia = -1, generador = GENERADOR_MANCHAS, forma = -1, filas = 150, columnas = 150;
+  unsigned semilla = 1;
+  QString fichero;
+
+  for(int i = 1; i < args.size(); ++i){
+    bool ok = true;
+    if(args[i] == "-d" || args[i] == "-p" || args[i] == "-c" || args[i] == "-e" ||
+       args[i] == "-g" || args[i] == "-f" || args[i] == "-s"){
+      ok = i + 1 < args.size();
+      QString valor = ok? args[++i] : QString();
+      if(args[i-1] == "-d"){
+        config.dias = valor.toInt(&ok);
+        ok = ok && config.dias > 0;
+      }
+      else if(args[i-1] == "-p"){
+        config.presupuesto = valor.toInt(&ok);
+        ok = ok && config.presupuesto >= 0;
+      }
+      else if(args[i-1] == "-c"){
+        config.crecimiento = valor.toDouble(&ok);
+        ok = ok && config.crecimiento >= 0;
+      }
+      else if(args[i-1] == "-e"){
+        estrategia = valor.toInt(&ok);
+        ok = ok && estrategia >= 0 && estrategia < NUM_ESTRATEGIAS_TEMPORADA;
+      }
+      else if(args[i-1] == "-g"){
+        generador = valor.toInt(&ok);
+        ok = ok && generador >= 0 && generador < NUM_GENERADORES;
+      }
+      else if(args[i-1] == "-f"){
+        forma = valor.toInt(&ok);
+        ok = ok && forma >= 0 && forma < NUM_FORMAS_ESTRES;
+      }
+      else
+        semilla = valor.toUInt(&ok);
+    }
+    else if(i + 1 == args.size()){
+      if(!dimensiones(args[i], filas, columnas))
+        fichero = args[i];
+      else if(filas < LADO_MINIMO || columnas < LADO_MINIMO){
+        error << "El jardín generado debe ser al menos de " << LADO_MINIMO << "x"
+              << LADO_MINIMO << "\n";
+        return 1;
+      }
+    }
+    else
+      ok = false;
+
+    if(!ok){
+      error << "Uso: ia-temporada [-d dias] [-p presupuesto] [-c crecimiento] [-e estrategia] "
+               "[-g generador | -f forma] [-s semilla] [fichero.garden | FxC]\n";
+      for(int e = 0; e < NUM_ESTRATEGIAS_TEMPORADA; ++e)
+        error << "  -e " << e << ": "
+              << nombre_estrategia_temporada(static_cast<EstrategiaTemporada>(e)) << "\n";
+      for(int f = 0; f < NUM_FORMAS_ESTRES; ++f)
+        error << "  -f " << f << ": " << nombre_forma_estres(static_cast<FormaEstres>(f)) << "\n";
+      return 1;
+    }
+  }
+
+  Jardin jardin;
+  Posicion pa, pb;
+  if(fichero.isEmpty() && forma >= 0)
+    jardin = jardin_estres(static_cast<FormaEstres>(forma), filas, semilla, pa, pb);
+  else if(fichero.isEmpty())
+    jardin = generar_jardin(filas, columnas,
+                            Generador(static_cast<TipoGenerador>(generador), semilla), pa, pb);
+  else{
+    QFile f(fichero);
+    DatosJardin datos;
+    if(!f.open(QIODevice::ReadOnly) || !decodificar_jardin(f.readAll(), datos)){
+      error << "No se ha podido leer el jardín " << fichero << "\n";
+      return 1;
+    }
+    jardin = datos.jardin;
+    jardin.set_tipo(0, 0, INICIO);
+  }
+
+  bool completo = true;
+  for(int e = 0; e < NUM_ESTRATEGIAS_TEMPORADA; ++e){
+    if(estrategia >= 0 && e != estrategia)
+      continue;
+    config.estrategia = static_cast<EstrategiaTemporada>(e);
+    InformeTemporada informe = simular_temporada(jardin, config);
+    salida << texto_temporada(informe, config) << "\n";
+    completo = completo && informe.sin_recorrer == 0;
+  }
+
+  return completo? 0 : 3;
+}
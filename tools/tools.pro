@@ -0,0 +1,13 @@
+# Herramientas de consola. Cada una es un ejecutable que enlaza con el núcleo
+# y no necesita pantalla, así que se pueden usar en servidores y en scripts.
+TEMPLATE = subdirs
+
+SUBDIRS = barrido \
+    consultas \
+    estres \
+    historial \
+    importar \
+    planificar \
+    servicio \
+    telemetria \
+    temporada